@@ -0,0 +1,559 @@
+#include "KeyReplay.hpp"
+#include "../TUI/TerminalIO/TerminalIO.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// Ends a recording; the same key as in telnet
+constexpr char RECORD_END_KEY = 0x1d; // Ctrl+]
+// Shorter pauses are thinking time, the replay waits for each frame anyway
+constexpr int RECORD_MIN_SLEEP_MS = 500;
+
+const std::string MARKER = TerminalIO::FRAME_MARKER;
+
+double elapsedMs(Clock::time_point since) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - since).count();
+}
+
+std::runtime_error scriptError(const std::string& source, std::size_t line, const std::string& message) {
+    return std::runtime_error(source + ":" + std::to_string(line) + ": " + message);
+}
+
+int parseCount(const std::string& text, const std::string& source, std::size_t line) {
+    if (text.empty()) {
+        return 1;
+    }
+    char* end = nullptr;
+    const long value = std::strtol(text.c_str(), &end, 10);
+    if (*end != '\0' || value < 0 || value > 100000) {
+        throw scriptError(source, line, "invalid number: '" + text + "'");
+    }
+    return static_cast<int>(value);
+}
+
+KeyStep keyStep(const std::string& bytes, const std::string& label, std::size_t line) {
+    KeyStep step;
+    step.kind = KeyStep::Kind::Keys;
+    step.bytes = bytes;
+    step.label = label;
+    step.line = line;
+    return step;
+}
+
+// Length of the key at the start of the input: escape sequence, UTF-8 character or single byte
+std::size_t keyLength(const std::string& input, std::size_t pos) {
+    const auto c = static_cast<unsigned char>(input[pos]);
+    if (c == '\033' && pos + 2 < input.size() && input[pos + 1] == '[') {
+        return 3;
+    }
+    if (c >= 0xF0) return 4;
+    if (c >= 0xE0) return 3;
+    if (c >= 0xC0) return 2;
+    return 1;
+}
+}
+
+/**
+ * @brief Parses a key script.
+ *
+ * One command per line; empty lines and lines starting with '#' are ignored:
+ *   up [n], down [n]   arrow keys, optionally repeated
+ *   enter, esc, backspace
+ *   type <text>        every character is a key press of its own
+ *   sleep <ms>         pause, e.g. while the program shows a message for some time
+ *   expect <text>      wait until the text appeared since the last key
+ *
+ * @param stream The script content.
+ * @param sourceName Name used in error messages.
+ * @return The steps in script order.
+ * @throws std::runtime_error With file and line number for unknown commands.
+ */
+std::vector<KeyStep> KeyScript::parse(std::istream& stream, const std::string& sourceName) {
+    std::vector<KeyStep> steps;
+    std::string text;
+    std::size_t lineNumber = 0;
+    while (std::getline(stream, text)) {
+        lineNumber++;
+        if (!text.empty() && text.back() == '\r') {
+            text.pop_back();
+        }
+        const std::size_t first = text.find_first_not_of(" \t");
+        if (first == std::string::npos || text[first] == '#') {
+            continue;
+        }
+        text.erase(0, first);
+        const std::size_t space = text.find(' ');
+        const std::string command = text.substr(0, space);
+        const std::string argument = space == std::string::npos ? "" : text.substr(space + 1);
+
+        if (command == "up" || command == "down") {
+            const int count = parseCount(argument, sourceName, lineNumber);
+            for (int i = 0; i < count; ++i) {
+                steps.push_back(keyStep(command == "up" ? "\033[A" : "\033[B", command, lineNumber));
+            }
+        } else if (command == "enter" || command == "esc" || command == "backspace") {
+            if (!argument.empty()) {
+                throw scriptError(sourceName, lineNumber, command + " takes no argument");
+            }
+            const char* bytes = command == "enter" ? "\r" : command == "esc" ? "\033" : "\177";
+            steps.push_back(keyStep(bytes, command, lineNumber));
+        } else if (command == "type") {
+            if (argument.empty()) {
+                throw scriptError(sourceName, lineNumber, "type needs a text");
+            }
+            for (std::size_t pos = 0; pos < argument.size();) {
+                const std::size_t length = keyLength(argument, pos);
+                const std::string key = argument.substr(pos, length);
+                steps.push_back(keyStep(key, "type " + key, lineNumber));
+                pos += length;
+            }
+        } else if (command == "sleep") {
+            KeyStep step;
+            step.kind = KeyStep::Kind::Sleep;
+            step.sleepMs = parseCount(argument, sourceName, lineNumber);
+            step.label = text;
+            step.line = lineNumber;
+            steps.push_back(step);
+        } else if (command == "expect") {
+            if (argument.empty()) {
+                throw scriptError(sourceName, lineNumber, "expect needs a text");
+            }
+            KeyStep step;
+            step.kind = KeyStep::Kind::Expect;
+            step.bytes = argument;
+            step.label = text;
+            step.line = lineNumber;
+            steps.push_back(step);
+        } else {
+            throw scriptError(sourceName, lineNumber, "unknown key script command: '" + command + "'");
+        }
+    }
+    return steps;
+}
+
+/**
+ * @brief Loads and parses a key script file.
+ * @param path Path of the script.
+ * @return The steps in script order.
+ * @throws std::runtime_error If the file cannot be opened or is malformed.
+ */
+std::vector<KeyStep> KeyScript::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open key script: " + path);
+    }
+    return parse(file, path);
+}
+
+/**
+ * @brief Returns the script line for the bytes of one key press.
+ * @param keys Bytes of exactly one key.
+ * @return The script line, or an empty string if the key has no script command.
+ */
+std::string KeyScript::tokenFor(const std::string& keys) {
+    if (keys == "\033[A") return "up";
+    if (keys == "\033[B") return "down";
+    if (keys == "\r" || keys == "\n") return "enter";
+    if (keys == "\033") return "esc";
+    if (keys == "\177" || keys == "\b") return "backspace";
+    const auto first = static_cast<unsigned char>(keys.empty() ? 0 : keys[0]);
+    if ((first >= 0x20 && first < 0x7F && keys.size() == 1) || first >= 0xC0) {
+        return "type " + keys;
+    }
+    return "";
+}
+
+/**
+ * @brief Starts a program on a new pseudo-terminal.
+ *
+ * The program gets the pty as controlling terminal with 80x24 characters and
+ * TICKETAUTOMAT_FRAME_MARKER set, so the ticket machine marks every complete frame.
+ *
+ * @param command Program and arguments; the program is searched in PATH.
+ * @param workdir Working directory of the program; empty for the current one.
+ * @throws std::runtime_error If the pty or the process cannot be created.
+ */
+PtySession::PtySession(const std::vector<std::string>& command, const std::string& workdir) {
+    if (command.empty()) {
+        throw std::runtime_error("No program given for the pty session");
+    }
+    master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (master >= 0) close(master);
+        throw std::runtime_error("Cannot create pseudo-terminal: " + reason);
+    }
+    const std::string slaveName = ptsname(master);
+    winsize size{};
+    size.ws_row = 24;
+    size.ws_col = 80;
+    ioctl(master, TIOCSWINSZ, &size);
+
+    // Built before fork so that the child only has to exec
+    std::vector<char*> arguments;
+    for (const auto& argument : command) {
+        arguments.push_back(const_cast<char*>(argument.c_str()));
+    }
+    arguments.push_back(nullptr);
+
+    child = fork();
+    if (child < 0) {
+        const std::string reason = std::strerror(errno);
+        close(master);
+        throw std::runtime_error("Cannot start " + command.front() + ": " + reason);
+    }
+    if (child == 0) {
+        setsid();
+        const int slave = open(slaveName.c_str(), O_RDWR);
+        if (slave < 0) {
+            _exit(127);
+        }
+        ioctl(slave, TIOCSCTTY, 0);
+        dup2(slave, STDIN_FILENO);
+        dup2(slave, STDOUT_FILENO);
+        dup2(slave, STDERR_FILENO);
+        if (slave > STDERR_FILENO) close(slave);
+        close(master);
+        if (!workdir.empty() && chdir(workdir.c_str()) != 0) {
+            _exit(127);
+        }
+        setenv("TICKETAUTOMAT_FRAME_MARKER", "1", 1);
+        setenv("TERM", "xterm-256color", 0);
+        execvp(arguments[0], arguments.data());
+        _exit(127);
+    }
+}
+
+/**
+ * @brief Stops the program if it still runs and closes the pty.
+ */
+PtySession::~PtySession() {
+    terminate();
+    if (master >= 0) {
+        close(master);
+    }
+}
+
+/**
+ * @brief Types bytes into the terminal.
+ * @param bytes The bytes, e.g. "\033[B" for arrow down.
+ * @throws std::runtime_error If the terminal is closed.
+ */
+void PtySession::send(const std::string& bytes) {
+    std::size_t written = 0;
+    while (written < bytes.size()) {
+        const ssize_t n = write(master, bytes.data() + written, bytes.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            throw std::runtime_error(std::string("Cannot write to pseudo-terminal: ") + std::strerror(errno));
+        }
+        written += static_cast<std::size_t>(n);
+    }
+}
+
+/**
+ * @brief Appends the output that arrives within the timeout to the buffer.
+ * @param buffer Receives the output.
+ * @param timeoutMs Maximum wait for the first byte; 0 only collects what is there.
+ * @return Number of bytes appended; 0 on timeout or when the program closed the terminal.
+ */
+std::size_t PtySession::readAvailable(std::string& buffer, int timeoutMs) {
+    if (outputClosed) {
+        return 0;
+    }
+    pollfd descriptor{master, POLLIN, 0};
+    if (poll(&descriptor, 1, timeoutMs) <= 0) {
+        return 0;
+    }
+    char chunk[4096];
+    const ssize_t n = read(master, chunk, sizeof(chunk));
+    if (n <= 0) {
+        // Linux reports EIO once the last slave descriptor is closed
+        if (n == 0 || errno != EINTR) {
+            outputClosed = true;
+        }
+        return 0;
+    }
+    buffer.append(chunk, static_cast<std::size_t>(n));
+    return static_cast<std::size_t>(n);
+}
+
+/**
+ * @brief Returns true once the program has closed the terminal.
+ */
+bool PtySession::closed() const {
+    return outputClosed;
+}
+
+/**
+ * @brief Returns true while the program runs.
+ */
+bool PtySession::running() {
+    if (child <= 0) {
+        return false;
+    }
+    int status = 0;
+    if (waitpid(child, &status, WNOHANG) == child) {
+        exitStatus = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+        child = -1;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Stops the program: SIGTERM, and SIGKILL if it has not ended after two seconds.
+ * @return Exit code of the program, 128 + signal number if it was killed by a signal.
+ */
+int PtySession::terminate() {
+    if (!running()) {
+        return exitStatus;
+    }
+    kill(child, SIGTERM);
+    const auto begin = Clock::now();
+    std::string discarded;
+    while (running() && elapsedMs(begin) < 2000) {
+        // Keep reading so that the program does not block on a full terminal
+        readAvailable(discarded, 10);
+        discarded.clear();
+    }
+    if (running()) {
+        kill(child, SIGKILL);
+        int status = 0;
+        waitpid(child, &status, 0);
+        exitStatus = 128 + SIGKILL;
+        child = -1;
+    }
+    return exitStatus;
+}
+
+int PtySession::masterFd() const {
+    return master;
+}
+
+/**
+ * @brief Removes all frame markers from the text.
+ * @param text Terminal output.
+ * @return Number of markers removed.
+ */
+std::size_t KeyReplay::stripFrameMarkers(std::string& text) {
+    std::size_t count = 0;
+    std::size_t out = 0;
+    for (std::size_t pos = 0; pos < text.size();) {
+        if (text.compare(pos, MARKER.size(), MARKER) == 0) {
+            pos += MARKER.size();
+            count++;
+        } else {
+            text[out++] = text[pos++];
+        }
+    }
+    text.resize(out);
+    return count;
+}
+
+/**
+ * @brief Replays a key script and measures every key press.
+ *
+ * Waits for the first frame, then sends one key at a time. The latency of a key
+ * is the time until the next frame marker; output that follows within settleMs
+ * (e.g. a second frame) still counts towards its bytes. Without a marker within
+ * frameTimeoutMs the time of the last output byte is used. Output between keys,
+ * e.g. during a sleep, is captured but not counted.
+ *
+ * @param session The running program.
+ * @param steps Parsed key script.
+ * @param config Timeouts.
+ * @param capture Receives the complete output without frame markers; may be nullptr.
+ * @return One result per key press.
+ * @throws std::runtime_error If an expected text does not appear or the program ends early.
+ */
+std::vector<StepResult> KeyReplay::replay(PtySession& session, const std::vector<KeyStep>& steps,
+                                          const ReplayConfig& config, std::ostream* capture) {
+    std::vector<StepResult> results;
+    std::string recent; // Output since the last key, for expect
+
+    auto keep = [&](std::string text) {
+        stripFrameMarkers(text);
+        if (capture != nullptr) {
+            *capture << text;
+        }
+        recent += text;
+    };
+
+    // Reads until a frame marker arrived (or the timeout passed) and the output settled
+    auto collectFrame = [&](StepResult& result, Clock::time_point sent) {
+        std::string raw;
+        double lastByteMs = 0.0;
+        while (!session.closed()) {
+            const double elapsed = elapsedMs(sent);
+            int waitMs = config.settleMs;
+            if (!result.framed) {
+                if (elapsed >= config.frameTimeoutMs) {
+                    break;
+                }
+                waitMs = static_cast<int>(config.frameTimeoutMs - elapsed) + 1;
+            }
+            const std::size_t before = raw.size();
+            if (session.readAvailable(raw, waitMs) == 0) {
+                if (result.framed) {
+                    break;
+                }
+                continue;
+            }
+            lastByteMs = elapsedMs(sent);
+            const std::size_t from = before >= MARKER.size() ? before - MARKER.size() + 1 : 0;
+            if (!result.framed && raw.find(MARKER, from) != std::string::npos) {
+                result.framed = true;
+                result.latencyMs = lastByteMs;
+            }
+        }
+        if (!result.framed) {
+            result.latencyMs = lastByteMs;
+        }
+        keep(raw);
+        result.bytes = raw.size() - stripFrameMarkers(raw) * MARKER.size();
+    };
+
+    StepResult startup;
+    collectFrame(startup, Clock::now());
+
+    for (const auto& step : steps) {
+        if (step.kind == KeyStep::Kind::Sleep) {
+            std::string raw;
+            const auto begin = Clock::now();
+            while (elapsedMs(begin) < step.sleepMs && !session.closed()) {
+                session.readAvailable(raw, std::max(1, step.sleepMs - static_cast<int>(elapsedMs(begin))));
+            }
+            keep(raw);
+            continue;
+        }
+        if (step.kind == KeyStep::Kind::Expect) {
+            std::string raw;
+            const auto begin = Clock::now();
+            while (recent.find(step.bytes) == std::string::npos) {
+                if (session.closed() || elapsedMs(begin) >= config.expectTimeoutMs) {
+                    throw std::runtime_error("Line " + std::to_string(step.line) + ": text did not appear: '" +
+                                             step.bytes + "'");
+                }
+                raw.clear();
+                session.readAvailable(raw, 50);
+                keep(raw);
+            }
+            continue;
+        }
+
+        // Output that arrived late belongs to no key
+        std::string late;
+        while (session.readAvailable(late, 0) > 0) {
+        }
+        keep(late);
+        if (session.closed()) {
+            throw std::runtime_error("Line " + std::to_string(step.line) + ": program ended before '" +
+                                     step.label + "'");
+        }
+
+        recent.clear();
+        StepResult result;
+        result.label = step.label;
+        const auto sent = Clock::now();
+        session.send(step.bytes);
+        collectFrame(result, sent);
+        results.push_back(result);
+    }
+    return results;
+}
+
+/**
+ * @brief Records a key script while a person uses the program.
+ *
+ * The keyboard is switched to raw mode and every key is passed to the program;
+ * its output goes to stdout. Pauses longer than RECORD_MIN_SLEEP_MS become
+ * sleep lines. Recording ends with Ctrl+] or when the program ends.
+ *
+ * @param session The running program.
+ * @param keyboardFd Terminal the keys are read from, usually STDIN_FILENO.
+ * @param script Receives the key script.
+ * @param capture Receives the program output without frame markers; may be nullptr.
+ */
+void KeyReplay::record(PtySession& session, int keyboardFd, std::ostream& script, std::ostream* capture) {
+    termios saved{};
+    const bool isTerminal = tcgetattr(keyboardFd, &saved) == 0;
+    if (isTerminal) {
+        termios raw = saved;
+        cfmakeraw(&raw);
+        tcsetattr(keyboardFd, TCSANOW, &raw);
+    }
+
+    script << "# Aufgenommen mit replay_keys --record\n";
+    auto lastKey = Clock::now();
+    bool done = false;
+    while (!done && !session.closed()) {
+        pollfd descriptors[2] = {{keyboardFd, POLLIN, 0}, {session.masterFd(), POLLIN, 0}};
+        if (poll(descriptors, 2, 100) <= 0) {
+            continue;
+        }
+        if (descriptors[1].revents != 0) {
+            std::string output;
+            session.readAvailable(output, 0);
+            stripFrameMarkers(output);
+            if (write(STDOUT_FILENO, output.data(), output.size()) < 0) {
+                done = true;
+            }
+            if (capture != nullptr) {
+                *capture << output;
+            }
+        }
+        if (descriptors[0].revents != 0) {
+            char chunk[64];
+            const ssize_t n = read(keyboardFd, chunk, sizeof(chunk));
+            if (n <= 0) {
+                break;
+            }
+            const std::string input(chunk, static_cast<std::size_t>(n));
+            for (std::size_t pos = 0; pos < input.size() && !done;) {
+                if (input[pos] == RECORD_END_KEY) {
+                    done = true;
+                    break;
+                }
+                const std::size_t length = std::min(keyLength(input, pos), input.size() - pos);
+                const std::string key = input.substr(pos, length);
+                pos += length;
+
+                const auto pauseMs = static_cast<int>(elapsedMs(lastKey));
+                lastKey = Clock::now();
+                if (pauseMs >= RECORD_MIN_SLEEP_MS) {
+                    script << "sleep " << pauseMs << "\n";
+                }
+                const std::string token = KeyScript::tokenFor(key);
+                if (token.empty()) {
+                    script << "# Taste ohne Befehl ausgelassen (" << key.size() << " Bytes)\n";
+                } else {
+                    script << token << "\n";
+                }
+                session.send(key);
+            }
+        }
+    }
+
+    if (isTerminal) {
+        tcsetattr(keyboardFd, TCSANOW, &saved);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// One line of a key script
+struct KeyStep {
+    enum class Kind { Keys, Sleep, Expect };
+    Kind kind = Kind::Keys;
+    std::string bytes;      // Keys: bytes sent to the terminal; Expect: text to wait for
+    int sleepMs = 0;        // Sleep: pause in milliseconds
+    std::string label;      // Script token, used in reports
+    std::size_t line = 0;   // Line in the script file
+};
+
+// Measurement of one key press
+struct StepResult {
+    std::string label;
+    double latencyMs = 0.0;  // Key sent until the frame was complete
+    std::size_t bytes = 0;   // Bytes written by the program for this key, without frame markers
+    bool framed = false;     // False if no frame marker came and the end of output was used
+};
+
+struct ReplayConfig {
+    int frameTimeoutMs = 2000;  // Maximum wait for a frame after a key
+    int settleMs = 30;          // Output pause after which a key is considered handled
+    int expectTimeoutMs = 5000; // Maximum wait for an expect line
+};
+
+class KeyScript {
+public:
+    static std::vector<KeyStep> parse(std::istream& stream, const std::string& sourceName);
+    static std::vector<KeyStep> load(const std::string& path);
+    static std::string tokenFor(const std::string& keys);
+};
+
+// Runs a program on the slave side of a pseudo-terminal (80x24)
+class PtySession {
+public:
+    PtySession(const std::vector<std::string>& command, const std::string& workdir);
+    ~PtySession();
+    PtySession(const PtySession&) = delete;
+    PtySession& operator=(const PtySession&) = delete;
+
+    void send(const std::string& bytes);
+    std::size_t readAvailable(std::string& buffer, int timeoutMs);
+    bool closed() const;
+    bool running();
+    int terminate();
+    int masterFd() const;
+
+private:
+    int master = -1;
+    pid_t child = -1;
+    int exitStatus = -1;
+    bool outputClosed = false;
+};
+
+class KeyReplay {
+public:
+    static std::vector<StepResult> replay(PtySession& session, const std::vector<KeyStep>& steps,
+                                          const ReplayConfig& config, std::ostream* capture);
+    static void record(PtySession& session, int keyboardFd, std::ostream& script, std::ostream* capture);
+    static std::size_t stripFrameMarkers(std::string& text);
+};
@@ -0,0 +1,151 @@
+#include "NetworkGenerator.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// Name parts in the style of the real network, including umlauts and U+2011
+const char* const PREFIXES[] = {
+    "Stötter", "Holz", "Möcker", "Lößn", "Schöne", "Grün", "Gohl", "Connew", "Plagw", "Lindenau",
+    "Mühl", "Rosen", "Wilhelm‑Leuschner‑", "Karl‑Heine‑", "Göhren", "Kleinzschocher", "Reudn", "Thekl"
+};
+const char* const SUFFIXES[] = {
+    "itz", "häuser", "ern", "ig", "feld", "au", "is", "witz", "heim", "dorf", "Platz", "brücke"
+};
+const char* const STREETS[] = {
+    "Straße", "Str.", "Allee", "Ring", "Markt", "Bahnhof", "Kirche", "Schule", "Friedhof", "Wendeschleife"
+};
+constexpr std::size_t PREFIX_COUNT = sizeof(PREFIXES) / sizeof(PREFIXES[0]);
+constexpr std::size_t SUFFIX_COUNT = sizeof(SUFFIXES) / sizeof(SUFFIXES[0]);
+constexpr std::size_t STREET_COUNT = sizeof(STREETS) / sizeof(STREETS[0]);
+}
+
+/**
+ * @brief Builds a deterministic, realistic-looking stop name.
+ *
+ * Different ids give different names, so stops are only shared between lines
+ * where the generator explicitly reuses an id.
+ *
+ * @param id Unique id of the stop.
+ * @param longName Whether to pad the name to at least longNameLength bytes.
+ * @param longNameLength Minimum length of long names in bytes.
+ * @return The stop name as UTF-8.
+ */
+std::string NetworkGenerator::stopName(std::uint64_t id, bool longName, std::size_t longNameLength) {
+    std::string name = PREFIXES[id % PREFIX_COUNT];
+    name += SUFFIXES[(id / PREFIX_COUNT) % SUFFIX_COUNT];
+    name += ", ";
+    name += PREFIXES[(id / 7) % PREFIX_COUNT];
+    name += SUFFIXES[(id / 11) % SUFFIX_COUNT];
+    name += " ";
+    name += STREETS[(id / (PREFIX_COUNT * SUFFIX_COUNT)) % STREET_COUNT];
+    name += " " + std::to_string(id);
+
+    if (longName) {
+        name += " (über ";
+        std::uint64_t part = id;
+        while (name.size() < longNameLength) {
+            part = part * 6364136223846793005ULL + 1442695040888963407ULL;
+            name += PREFIXES[(part >> 33) % PREFIX_COUNT];
+            name += SUFFIXES[(part >> 45) % SUFFIX_COUNT];
+            name += " ";
+        }
+        name += ")";
+    }
+    return name;
+}
+
+/**
+ * @brief Writes a synthetic network of line files into a directory.
+ *
+ * Every line gets its own stops plus a configurable share of transfer stops drawn
+ * from a pool shared by all lines, so large networks have realistic hubs.
+ * Output is fully determined by the configuration and seed.
+ *
+ * @param folderPath Target directory; created if missing.
+ * @param config Size and shape of the network.
+ * @return Total number of bytes written.
+ * @throws std::runtime_error If a file cannot be written.
+ */
+std::size_t NetworkGenerator::generate(const std::string& folderPath, const NetworkConfig& config) {
+    std::filesystem::create_directories(folderPath);
+    std::mt19937_64 random(config.seed);
+
+    auto uniform = [&random]() {
+        return static_cast<double>(random() >> 11) * 0x1.0p-53;
+    };
+
+    // Roughly one hub per four lines, but at least a handful
+    const std::uint64_t hubCount = std::max<std::uint64_t>(8, config.lines / 4);
+    std::uint64_t nextStopId = hubCount;
+    std::size_t bytesWritten = 0;
+
+    for (std::size_t line = 1; line <= config.lines; ++line) {
+        const std::string path = folderPath + "/Linie" + std::to_string(line) + ".txt";
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not write file: " + path);
+        }
+
+        std::string content = "Linie " + std::to_string(line) + "\n" + std::to_string(1 + random() % 9) + "\n";
+        std::set<std::uint64_t> hubsOnLine;
+        for (std::size_t stop = 0; stop < config.stopsPerLine; ++stop) {
+            // A line passes each hub at most once
+            const std::uint64_t hub = random() % hubCount;
+            const bool transfer = uniform() < config.transferShare && hubsOnLine.insert(hub).second;
+            const std::uint64_t id = transfer ? hub : nextStopId++;
+            // Hubs keep their short name, so the same name appears on every line through them
+            const bool longName = !transfer && uniform() < config.longNameShare;
+            content += stopName(id, longName, config.longNameLength);
+            content += '\n';
+        }
+
+        file << content;
+        if (!file) {
+            throw std::runtime_error("Could not write file: " + path);
+        }
+        bytesWritten += content.size();
+
+        if (config.timetables) {
+            const std::string timesPath = folderPath + "/Linie" + std::to_string(line) + ".times";
+            std::ofstream times(timesPath, std::ios::binary);
+            const std::string schedule = timetable(config.stopsPerLine, random());
+            times << schedule;
+            if (!times) {
+                throw std::runtime_error("Could not write file: " + timesPath);
+            }
+            bytesWritten += schedule.size();
+        }
+    }
+    return bytesWritten;
+}
+
+/**
+ * @brief Builds a full-day timetable for a line in the .times format.
+ * Both directions run from about 04:30 to after midnight, every 5 to 10 minutes,
+ * with 1 to 3 minutes between stops.
+ * @param stops Number of stops of the line.
+ * @param seed Seed for running times and interval.
+ * @return The content of the .times file.
+ */
+std::string NetworkGenerator::timetable(std::size_t stops, std::uint64_t seed) {
+    std::mt19937_64 random(seed);
+    std::string content;
+    for (const char* direction : {"outbound", "inbound"}) {
+        content += direction;
+        content += "\nruntimes";
+        int minutes = 0;
+        for (std::size_t stop = 0; stop < stops; ++stop) {
+            content += " " + std::to_string(minutes);
+            minutes += 1 + static_cast<int>(random() % 3);
+        }
+        const int offset = static_cast<int>(random() % 10);
+        content += "\nevery 04:3" + std::to_string(offset) + " 00:3" + std::to_string(offset) + " " +
+                   std::to_string(5 + random() % 6) + "\n";
+    }
+    return content;
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct NetworkConfig {
+    std::size_t lines = 10;
+    std::size_t stopsPerLine = 30;
+    // Share of stops per line taken from a pool of transfer stops shared between lines
+    double transferShare = 0.2;
+    // Share of stop names padded to at least longNameLength bytes
+    double longNameShare = 0.1;
+    std::size_t longNameLength = 80;
+    // Whether to write a full-day timetable (.times) next to every line file
+    bool timetables = false;
+    std::uint64_t seed = 1;
+};
+
+class NetworkGenerator {
+public:
+    static std::size_t generate(const std::string& folderPath, const NetworkConfig& config);
+    static std::string stopName(std::uint64_t id, bool longName, std::size_t longNameLength);
+    static std::string timetable(std::size_t stops, std::uint64_t seed);
+};
@@ -0,0 +1,383 @@
+#include "FareLedger.hpp"
+#include "../TicketCode/SipHash.hpp"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct FareLedger::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t slotBytes;
+    std::uint64_t capacity;
+    std::uint64_t count;
+    // Card ids are only stored as keyed hashes; the key never leaves the machine
+    std::uint8_t hashKey[16];
+    std::uint8_t reserved[16];
+};
+
+namespace {
+constexpr char MAGIC[8] = {'T', 'K', 'F', 'A', 'R', 'E', '0', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 64;
+constexpr std::size_t MAX_CARD_ID = 32;
+constexpr std::size_t MIN_CARD_ID = 4;
+
+std::size_t fileBytes(std::size_t capacity) {
+    return HEADER_BYTES + capacity * sizeof(LedgerSlot);
+}
+
+std::size_t roundUpPowerOfTwo(std::size_t value) {
+    std::size_t result = 16;
+    while (result < value) {
+        result *= 2;
+    }
+    return result;
+}
+
+// Writes an empty ledger with the given key under a temporary name and renames it into place
+void createFile(const std::string& path, std::size_t capacity, const std::uint8_t key[16]) {
+    const std::string partial = path + ".tmp";
+    const int fd = ::open(partial.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write file: " + partial);
+    }
+    std::uint8_t header[HEADER_BYTES] = {};
+    std::memcpy(header, MAGIC, sizeof(MAGIC));
+    const std::uint32_t version = VERSION;
+    const auto slotBytes = static_cast<std::uint32_t>(sizeof(LedgerSlot));
+    const std::uint64_t slotCount = capacity;
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 12, &slotBytes, 4);
+    std::memcpy(header + 16, &slotCount, 8);
+    std::memcpy(header + 32, key, 16);
+
+    // Slots are zero, i.e. empty, without writing them
+    const bool written = write(fd, header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)) &&
+                         ftruncate(fd, static_cast<off_t>(fileBytes(capacity))) == 0 && fsync(fd) == 0;
+    close(fd);
+    if (!written) {
+        std::filesystem::remove(partial);
+        throw std::runtime_error("Could not write file: " + partial);
+    }
+    std::filesystem::rename(partial, path);
+}
+}
+
+static_assert(sizeof(LedgerSlot) == 24, "Ledger slot layout changed");
+
+/**
+ * @brief Creates the ledger; call open() before use.
+ * @param path Ledger file, e.g. state/fares.ledger.
+ * @param caps Daily and weekly cap.
+ * @param initialCapacity Number of slots of a new ledger, rounded up to a power of two.
+ */
+FareLedger::FareLedger(std::string path, CapConfig caps, std::size_t initialCapacity)
+    : path(std::move(path)), caps(caps), initialCapacity(roundUpPowerOfTwo(initialCapacity)) {}
+
+FareLedger::~FareLedger() {
+    unmap();
+}
+
+/**
+ * @brief Maps the ledger file into memory, creating it with a new random hash key if missing.
+ * @throws std::runtime_error If the file cannot be created or is not a valid ledger.
+ */
+void FareLedger::open() {
+    static_assert(sizeof(Header) == HEADER_BYTES, "Ledger header layout changed");
+    std::lock_guard<std::mutex> lock(mutex);
+    unmap();
+    if (!std::filesystem::exists(path)) {
+        const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        if (!parent.empty()) {
+            std::filesystem::create_directories(parent);
+        }
+        std::uint8_t key[16];
+        std::random_device random;
+        for (std::size_t i = 0; i < sizeof(key); i += 4) {
+            const std::uint32_t word = random();
+            std::memcpy(key + i, &word, 4);
+        }
+        createFile(path, initialCapacity, key);
+    }
+
+    const std::size_t bytes = std::filesystem::file_size(path);
+    if (bytes < HEADER_BYTES) {
+        throw std::runtime_error("Invalid fare ledger: " + path);
+    }
+    map(path, bytes, false);
+    const Header* head = header();
+    const bool valid = std::memcmp(head->magic, MAGIC, sizeof(MAGIC)) == 0 && head->version == VERSION &&
+                       head->slotBytes == sizeof(LedgerSlot) && head->capacity >= 16 &&
+                       (head->capacity & (head->capacity - 1)) == 0 && fileBytes(head->capacity) == bytes &&
+                       head->count <= head->capacity;
+    if (!valid) {
+        unmap();
+        throw std::runtime_error("Invalid fare ledger: " + path);
+    }
+}
+
+/**
+ * @brief Maps a ledger file read-write and shared, so every change goes to the file.
+ */
+void FareLedger::map(const std::string& file, std::size_t bytes, bool create) {
+    fd = ::open(file.c_str(), O_RDWR | (create ? O_CREAT : 0), 0600);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + file);
+    }
+    mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        close(fd);
+        fd = -1;
+        throw std::runtime_error("Could not map file: " + file);
+    }
+    mappedBytes = bytes;
+}
+
+void FareLedger::unmap() {
+    if (mapping != nullptr) {
+        msync(mapping, mappedBytes, MS_ASYNC);
+        munmap(mapping, mappedBytes);
+        mapping = nullptr;
+        mappedBytes = 0;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+FareLedger::Header* FareLedger::header() const {
+    if (mapping == nullptr) {
+        throw std::runtime_error("Fare ledger is not open");
+    }
+    return static_cast<Header*>(mapping);
+}
+
+LedgerSlot* FareLedger::slots() const {
+    return reinterpret_cast<LedgerSlot*>(static_cast<char*>(mapping) + HEADER_BYTES);
+}
+
+/**
+ * @brief Checks that a card id has 4 to 32 letters, digits or dashes.
+ */
+bool FareLedger::isValidCardId(std::string_view cardId) {
+    if (cardId.size() < MIN_CARD_ID || cardId.size() > MAX_CARD_ID) {
+        return false;
+    }
+    return std::all_of(cardId.begin(), cardId.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '-';
+    });
+}
+
+/**
+ * @brief Returns the week (Monday to Sunday) a day belongs to.
+ * @param day Days since 1970-01-01, which was a Thursday.
+ * @return Weeks since the Monday before 1970-01-01.
+ */
+std::uint16_t FareLedger::weekOfDay(std::uint16_t day) {
+    return static_cast<std::uint16_t>((day + 3) / 7);
+}
+
+/**
+ * @brief Maps a card id to the rider key used in the ledger.
+ * Letters are compared without case. The result is a SipHash with the key of
+ * this ledger, so the file does not reveal card ids.
+ * @param cardId The card id as entered.
+ * @return The rider key, never 0.
+ */
+std::uint64_t FareLedger::riderId(std::string_view cardId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string normalized(cardId);
+    for (char& c : normalized) {
+        c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    }
+    const std::uint64_t hash = SipHash::hash24(header()->hashKey,
+                                               reinterpret_cast<const std::uint8_t*>(normalized.data()),
+                                               normalized.size());
+    return hash == 0 ? 1 : hash;
+}
+
+/**
+ * @brief Finds the slot of a rider by linear probing.
+ * @return The slot, or nullptr if the rider is not in the ledger.
+ */
+const LedgerSlot* FareLedger::find(std::uint64_t rider) const {
+    const std::size_t mask = header()->capacity - 1;
+    const LedgerSlot* table = slots();
+    for (std::size_t index = rider & mask;; index = (index + 1) & mask) {
+        if (table[index].rider == rider) return &table[index];
+        if (table[index].rider == 0) return nullptr;
+    }
+}
+
+/**
+ * @brief Finds the slot of a rider or claims an empty one.
+ * The table is rebuilt before it is more than three quarters full.
+ */
+LedgerSlot& FareLedger::findOrInsert(std::uint64_t rider, std::uint16_t day) {
+    if (const LedgerSlot* slot = find(rider)) {
+        return *const_cast<LedgerSlot*>(slot);
+    }
+    if ((header()->count + 1) * 4 > header()->capacity * 3) {
+        rebuild(day);
+    }
+    Header* head = header();
+    const std::size_t mask = head->capacity - 1;
+    LedgerSlot* table = slots();
+    std::size_t index = rider & mask;
+    while (table[index].rider != 0) {
+        index = (index + 1) & mask;
+    }
+    table[index] = LedgerSlot{};
+    table[index].rider = rider;
+    table[index].day = day;
+    table[index].week = weekOfDay(day);
+    head->count++;
+    return table[index];
+}
+
+/**
+ * @brief Copies the riders of the current week into a new table and replaces the file.
+ *
+ * Riders from earlier weeks have nothing left to cap and are dropped, so the
+ * ledger does not grow with every card ever seen. The table doubles until it
+ * is at most half full. Runs once per many inserts, so the cost per sale stays constant.
+ */
+void FareLedger::rebuild(std::uint16_t day) {
+    const Header* old = header();
+    const std::uint16_t week = weekOfDay(day);
+    const LedgerSlot* oldSlots = slots();
+
+    std::size_t live = 0;
+    for (std::size_t i = 0; i < old->capacity; ++i) {
+        live += oldSlots[i].rider != 0 && oldSlots[i].week == week;
+    }
+    std::size_t capacity = std::max<std::size_t>(initialCapacity, 16);
+    while ((live + 1) * 2 > capacity) {
+        capacity *= 2;
+    }
+
+    const std::string next = path + ".new";
+    createFile(next, capacity, old->hashKey);
+    const int nextFd = ::open(next.c_str(), O_RDWR);
+    void* nextMapping = nextFd < 0 ? MAP_FAILED
+                                   : mmap(nullptr, fileBytes(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, nextFd, 0);
+    if (nextMapping == MAP_FAILED) {
+        if (nextFd >= 0) close(nextFd);
+        throw std::runtime_error("Could not map file: " + next);
+    }
+
+    auto* nextHeader = static_cast<Header*>(nextMapping);
+    auto* nextSlots = reinterpret_cast<LedgerSlot*>(static_cast<char*>(nextMapping) + HEADER_BYTES);
+    const std::size_t mask = capacity - 1;
+    for (std::size_t i = 0; i < old->capacity; ++i) {
+        const LedgerSlot& slot = oldSlots[i];
+        if (slot.rider == 0 || slot.week != week) continue;
+        std::size_t index = slot.rider & mask;
+        while (nextSlots[index].rider != 0) {
+            index = (index + 1) & mask;
+        }
+        nextSlots[index] = slot;
+    }
+    nextHeader->count = live;
+    const bool synced = msync(nextMapping, fileBytes(capacity), MS_SYNC) == 0;
+    munmap(nextMapping, fileBytes(capacity));
+    close(nextFd);
+    if (!synced) {
+        std::filesystem::remove(next);
+        throw std::runtime_error("Could not write file: " + next);
+    }
+
+    std::filesystem::rename(next, path);
+    unmap();
+    map(path, fileBytes(capacity), false);
+}
+
+/**
+ * @brief Returns what a rider has paid on the given day and in its week.
+ * @param rider Rider key from riderId().
+ * @param day Days since 1970-01-01.
+ */
+RiderTotals FareLedger::totals(std::uint64_t rider, std::uint16_t day) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    RiderTotals result;
+    const LedgerSlot* slot = find(rider);
+    if (slot == nullptr) {
+        return result;
+    }
+    // Totals of an earlier day or week have rolled over
+    if (slot->day == day) result.day = slot->daySpent;
+    if (slot->week == weekOfDay(day)) result.week = slot->weekSpent;
+    return result;
+}
+
+/**
+ * @brief Returns how much a rider may still be charged before a cap is reached.
+ * @param rider Rider key from riderId().
+ * @param day Days since 1970-01-01.
+ * @return The remaining amount; INT_MAX if both caps are off.
+ */
+int FareLedger::allowance(std::uint64_t rider, std::uint16_t day) const {
+    const RiderTotals spent = totals(rider, day);
+    int remaining = INT_MAX;
+    if (caps.dailyCap > 0) remaining = std::min(remaining, std::max(0, caps.dailyCap - spent.day));
+    if (caps.weeklyCap > 0) remaining = std::min(remaining, std::max(0, caps.weeklyCap - spent.week));
+    return remaining;
+}
+
+/**
+ * @brief Adds a paid amount to the rider's day and week totals.
+ * The change goes straight into the mapped file; the kernel writes it back
+ * without the sale waiting for the disk.
+ * @param rider Rider key from riderId().
+ * @param amount The amount charged; nothing is recorded for 0.
+ * @param day Days since 1970-01-01.
+ */
+void FareLedger::record(std::uint64_t rider, int amount, std::uint16_t day) {
+    if (amount <= 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    LedgerSlot& slot = findOrInsert(rider, day);
+    const std::uint16_t week = weekOfDay(day);
+    if (slot.week != week) {
+        slot.week = week;
+        slot.weekSpent = 0;
+    }
+    if (slot.day != day) {
+        slot.day = day;
+        slot.daySpent = 0;
+    }
+    slot.daySpent += amount;
+    slot.weekSpent += amount;
+
+    const auto pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+    const auto page = reinterpret_cast<std::uintptr_t>(&slot) & ~(pageSize - 1);
+    msync(reinterpret_cast<void*>(page), pageSize, MS_ASYNC);
+}
+
+/**
+ * @brief Returns the number of riders in the ledger, including ones from earlier weeks.
+ */
+std::size_t FareLedger::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return header()->count;
+}
+
+/**
+ * @brief Returns the number of slots of the hash table.
+ */
+std::size_t FareLedger::capacity() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return header()->capacity;
+}
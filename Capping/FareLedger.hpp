@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Spending limits per rider; 0 switches a cap off
+struct CapConfig {
+    int dailyCap = 45;
+    int weeklyCap = 180;
+};
+
+// What a rider has paid in the current day and week
+struct RiderTotals {
+    int day = 0;
+    int week = 0;
+};
+
+// One slot of the ledger file; rider 0 marks an empty slot
+struct LedgerSlot {
+    std::uint64_t rider = 0;
+    std::int32_t daySpent = 0;
+    std::int32_t weekSpent = 0;
+    // Day and week the totals belong to; older totals count as 0
+    std::uint16_t day = 0;
+    std::uint16_t week = 0;
+    std::uint32_t reserved = 0;
+};
+
+// Running totals per rider in an open-addressing hash table (linear probing)
+// that lives in a memory-mapped file. Day and week rollover happen lazily per slot.
+class FareLedger {
+public:
+    explicit FareLedger(std::string path, CapConfig caps = CapConfig{}, std::size_t initialCapacity = 1 << 16);
+    ~FareLedger();
+    FareLedger(const FareLedger&) = delete;
+    FareLedger& operator=(const FareLedger&) = delete;
+
+    void open();
+    [[nodiscard]] std::uint64_t riderId(std::string_view cardId) const;
+    [[nodiscard]] RiderTotals totals(std::uint64_t rider, std::uint16_t day) const;
+    [[nodiscard]] int allowance(std::uint64_t rider, std::uint16_t day) const;
+    void record(std::uint64_t rider, int amount, std::uint16_t day);
+
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] std::size_t capacity() const;
+    [[nodiscard]] const CapConfig& getCaps() const { return caps; }
+
+    static bool isValidCardId(std::string_view cardId);
+    static std::uint16_t weekOfDay(std::uint16_t day);
+
+private:
+    std::string path;
+    CapConfig caps;
+    std::size_t initialCapacity;
+    int fd = -1;
+    void* mapping = nullptr;
+    std::size_t mappedBytes = 0;
+    mutable std::mutex mutex;
+
+    struct Header;
+    [[nodiscard]] Header* header() const;
+    [[nodiscard]] LedgerSlot* slots() const;
+    [[nodiscard]] const LedgerSlot* find(std::uint64_t rider) const;
+    LedgerSlot& findOrInsert(std::uint64_t rider, std::uint16_t day);
+    void rebuild(std::uint16_t day);
+    void map(const std::string& file, std::size_t bytes, bool create);
+    void unmap();
+};
@@ -0,0 +1,338 @@
+#include "LineCatalog.hpp"
+#include "../Logging/Logger.hpp"
+#include "../TramParser/EmbeddedNetwork.hpp"
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace {
+#ifdef __linux__
+constexpr uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE |
+                                IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+// Quiet period after the last change before re-parsing, so multi-step writes are picked up once
+constexpr int DEBOUNCE_MS = 50;
+// Upper bound for delaying a reload while changes keep coming in
+constexpr auto MAX_DELAY = std::chrono::milliseconds(500);
+// Interval for re-adding a lost watch and for the polling fallback
+constexpr int IDLE_MS = 500;
+}
+
+/**
+ * @brief Finds a line by its file name.
+ * @param fileName Base name of the line file (without extension).
+ * @return Pointer to the line, or nullptr if the snapshot does not contain it.
+ */
+const CatalogLine* CatalogSnapshot::find(const std::string& fileName) const {
+    for (const auto& line : lines) {
+        if (line.entry.fileName == fileName) {
+            return &line;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Constructs the catalog and loads all lines of the given directory.
+ * @param folderPath Directory containing the line files.
+ */
+LineCatalog::LineCatalog(std::string folderPath) : folderPath(std::move(folderPath)) {
+    reload();
+}
+
+/**
+ * @brief Stops the watcher thread, if running.
+ */
+LineCatalog::~LineCatalog() {
+    stopWatching();
+}
+
+/**
+ * @brief Returns the currently published snapshot.
+ *
+ * The returned pointer stays valid for as long as the caller holds it, even if
+ * newer data is published in the meantime. This is what keeps a purchase in
+ * progress on the data it started with.
+ *
+ * @return The current immutable snapshot.
+ */
+std::shared_ptr<const CatalogSnapshot> LineCatalog::snapshot() const {
+    return std::atomic_load(&current);
+}
+
+/**
+ * @brief Returns the directory this catalog reads from.
+ * @return The folder path.
+ */
+const std::string& LineCatalog::getFolderPath() const {
+    return folderPath;
+}
+
+/**
+ * @brief Rescans the directory and re-parses every line file.
+ */
+void LineCatalog::reload() {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+
+    auto next = std::make_shared<CatalogSnapshot>();
+    for (const auto& entry : TramParser::getAvailableLines(folderPath)) {
+        CatalogLine line;
+        if (loadLine(entry.fileName, line)) {
+            next->lines.push_back(std::move(line));
+        }
+    }
+    publish(std::move(next));
+}
+
+/**
+ * @brief Re-parses only the given line files and publishes a new snapshot.
+ *
+ * Lines whose file no longer exists are removed, new files are appended.
+ * If a changed file cannot be parsed, the previous version of that line is kept.
+ *
+ * @param fileNames Base names (without extension) of the changed files.
+ */
+void LineCatalog::reloadLines(const std::set<std::string>& fileNames) {
+    std::lock_guard<std::mutex> lock(reloadMutex);
+
+    auto next = std::make_shared<CatalogSnapshot>(*snapshot());
+    for (const auto& fileName : fileNames) {
+        auto it = next->lines.begin();
+        while (it != next->lines.end() && it->entry.fileName != fileName) {
+            ++it;
+        }
+
+        if (!std::filesystem::exists(std::filesystem::path(folderPath) / (fileName + ".txt"))) {
+            if (it != next->lines.end()) {
+                next->lines.erase(it);
+            }
+            continue;
+        }
+
+        CatalogLine line;
+        if (!loadLine(fileName, line)) {
+            continue;
+        }
+        if (it != next->lines.end()) {
+            *it = std::move(line);
+        } else {
+            next->lines.push_back(std::move(line));
+        }
+    }
+    publish(std::move(next));
+}
+
+/**
+ * @brief Starts the background thread that watches the directory for changes.
+ *
+ * Uses inotify on Linux and falls back to polling modification times elsewhere.
+ */
+void LineCatalog::startWatching() {
+    // Embedded lines are part of the executable and never change
+    if (EmbeddedNetwork::serves(folderPath)) {
+        return;
+    }
+    if (watching.exchange(true)) {
+        return;
+    }
+    if (pipe(wakeupPipe) != 0) {
+        watching = false;
+        throw std::runtime_error("Could not create wakeup pipe for line watcher");
+    }
+#ifdef __linux__
+    // Register the watch before returning, so no change after this call is missed
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd >= 0) {
+        watchFd = inotify_add_watch(inotifyFd, folderPath.c_str(), WATCH_MASK);
+    }
+#endif
+    watcher = std::thread(&LineCatalog::watchLoop, this);
+}
+
+/**
+ * @brief Stops and joins the watcher thread.
+ */
+void LineCatalog::stopWatching() {
+    if (!watching.exchange(false)) {
+        return;
+    }
+    // Wake the watcher from poll() so it notices the stop request immediately
+    const char signal = 'x';
+    (void) write(wakeupPipe[1], &signal, 1);
+    watcher.join();
+    close(wakeupPipe[0]);
+    close(wakeupPipe[1]);
+    wakeupPipe[0] = wakeupPipe[1] = -1;
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+        inotifyFd = watchFd = -1;
+    }
+}
+
+/**
+ * @brief Builds the stop index and publishes a new snapshot with the next version number.
+ * @param next The snapshot to publish. Must not be modified afterwards.
+ */
+void LineCatalog::publish(std::shared_ptr<CatalogSnapshot> next) {
+    next->stops = StopIndex::build(next->lines);
+    auto previous = snapshot();
+    next->version = previous ? previous->version + 1 : 1;
+    std::atomic_store(&current, std::shared_ptr<const CatalogSnapshot>(std::move(next)));
+}
+
+/**
+ * @brief Watcher thread body: collects inotify events and re-parses changed files.
+ */
+void LineCatalog::watchLoop() {
+#ifdef __linux__
+    if (inotifyFd < 0) {
+        pollLoop();
+        return;
+    }
+
+    std::set<std::string> pending;
+    bool fullReload = false;
+    auto firstChange = std::chrono::steady_clock::now();
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    while (watching) {
+        // The directory may have been removed and re-created in the meantime
+        if (watchFd < 0) {
+            watchFd = inotify_add_watch(inotifyFd, folderPath.c_str(), WATCH_MASK);
+            if (watchFd >= 0) {
+                fullReload = true;
+            }
+        }
+
+        const bool hasPending = fullReload || !pending.empty();
+        pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {wakeupPipe[0], POLLIN, 0}};
+        const int ready = poll(fds, 2, hasPending ? DEBOUNCE_MS : IDLE_MS);
+        if (!watching) {
+            break;
+        }
+
+        if (ready > 0 && (fds[0].revents & POLLIN)) {
+            if (!hasPending) {
+                firstChange = std::chrono::steady_clock::now();
+            }
+            ssize_t length;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                for (char* ptr = buffer; ptr < buffer + length;) {
+                    const auto* event = reinterpret_cast<const inotify_event*>(ptr);
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        fullReload = true;
+                    } else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+                        if (!(event->mask & IN_IGNORED)) {
+                            inotify_rm_watch(inotifyFd, watchFd);
+                        }
+                        watchFd = -1;
+                        fullReload = true;
+                    } else if (event->len > 0) {
+                        const std::filesystem::path name(event->name);
+                        if (name.extension() == ".txt" || name.extension() == ".times") {
+                            pending.insert(name.stem().string());
+                        }
+                    }
+                    ptr += sizeof(inotify_event) + event->len;
+                }
+            }
+            // Keep collecting until the directory is quiet, but not forever
+            if (std::chrono::steady_clock::now() - firstChange < MAX_DELAY) {
+                continue;
+            }
+        }
+
+        if (fullReload) {
+            reload();
+        } else if (!pending.empty()) {
+            reloadLines(pending);
+        }
+        fullReload = false;
+        pending.clear();
+    }
+#else
+    pollLoop();
+#endif
+}
+
+/**
+ * @brief Fallback watcher: compares modification times and sizes periodically.
+ */
+void LineCatalog::pollLoop() {
+    namespace fs = std::filesystem;
+    using Stamp = std::pair<fs::file_time_type, std::uintmax_t>;
+
+    auto scan = [this]() {
+        std::map<std::string, Stamp> stamps;
+        std::error_code error;
+        for (const auto& entry : fs::directory_iterator(folderPath, error)) {
+            if (entry.path().extension() == ".txt" || entry.path().extension() == ".times") {
+                stamps[entry.path().filename().string()] = {entry.last_write_time(error), entry.file_size(error)};
+            }
+        }
+        return stamps;
+    };
+
+    auto known = scan();
+    while (watching) {
+        pollfd wakeup = {wakeupPipe[0], POLLIN, 0};
+        poll(&wakeup, 1, IDLE_MS);
+        if (!watching) {
+            break;
+        }
+
+        auto latest = scan();
+        std::set<std::string> changed;
+        for (const auto& [name, stamp] : latest) {
+            auto it = known.find(name);
+            if (it == known.end() || it->second != stamp) {
+                changed.insert(fs::path(name).stem().string());
+            }
+        }
+        for (const auto& [name, stamp] : known) {
+            if (latest.find(name) == latest.end()) {
+                changed.insert(fs::path(name).stem().string());
+            }
+        }
+        if (!changed.empty()) {
+            reloadLines(changed);
+        }
+        known = std::move(latest);
+    }
+}
+
+/**
+ * @brief Parses a single line file and its timetable, if there is one.
+ * @param fileName Base name of the file (without extension).
+ * @param line Target for the parsed entry and data.
+ * @return True on success, false if the file could not be parsed.
+ */
+bool LineCatalog::loadLine(const std::string& fileName, CatalogLine& line) const {
+    try {
+        line.data = TramParser::parseTramFile(folderPath, fileName);
+        // The display name is the first line of the file, which the parser already read
+        line.entry = {line.data.name, fileName};
+    } catch (const std::exception& e) {
+        Logger::warning("Linie %s konnte nicht geladen werden: %s", fileName.c_str(), e.what());
+        return false;
+    }
+
+    // A broken timetable only costs the departure times, not the line
+    const std::string timesPath = folderPath + "/" + fileName + ".times";
+    std::error_code error;
+    if (std::filesystem::exists(timesPath, error)) {
+        try {
+            line.timetable = std::make_shared<const Timetable>(Timetable::load(timesPath, line.data.stops.size()));
+        } catch (const std::exception& e) {
+            Logger::warning("Fahrplan %s konnte nicht geladen werden: %s", timesPath.c_str(), e.what());
+        }
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "../TramParser/TramParser.hpp"
+#include "StopIndex.hpp"
+#include "../Timetable/Timetable.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CatalogLine {
+    FileEntry entry;
+    TramData data;
+    // Departures from the companion .times file; nullptr if the line has none
+    std::shared_ptr<const Timetable> timetable;
+};
+
+// Immutable view of all lines; replaced as a whole whenever data/ changes
+struct CatalogSnapshot {
+    std::uint64_t version = 0;
+    std::vector<CatalogLine> lines;
+    // Stop -> lines index over lines; rebuilt with every published snapshot
+    StopIndex stops;
+
+    [[nodiscard]] const CatalogLine* find(const std::string& fileName) const;
+};
+
+class LineCatalog {
+public:
+    explicit LineCatalog(std::string folderPath = "data");
+    ~LineCatalog();
+    LineCatalog(const LineCatalog&) = delete;
+    LineCatalog& operator=(const LineCatalog&) = delete;
+
+    [[nodiscard]] std::shared_ptr<const CatalogSnapshot> snapshot() const;
+    [[nodiscard]] const std::string& getFolderPath() const;
+    void reload();
+    void reloadLines(const std::set<std::string>& fileNames);
+    void startWatching();
+    void stopWatching();
+
+private:
+    std::string folderPath;
+    // Only accessed through std::atomic_load / std::atomic_store
+    std::shared_ptr<const CatalogSnapshot> current;
+    std::thread watcher;
+    std::atomic<bool> watching{false};
+    // Serializes writers; readers never take it
+    std::mutex reloadMutex;
+    int wakeupPipe[2] = {-1, -1};
+    int inotifyFd = -1;
+    int watchFd = -1;
+
+    void publish(std::shared_ptr<CatalogSnapshot> next);
+    void watchLoop();
+    void pollLoop();
+    [[nodiscard]] bool loadLine(const std::string& fileName, CatalogLine& line) const;
+};
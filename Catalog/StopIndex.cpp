@@ -0,0 +1,179 @@
+#include "StopIndex.hpp"
+#include "LineCatalog.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <numeric>
+#include <tuple>
+#include <functional>
+
+/**
+ * @brief Normalizes a stop name for matching across lines.
+ * Leading and trailing whitespace is dropped, inner whitespace collapsed to one
+ * space and ASCII letters lowered; other UTF-8 bytes are kept as they are.
+ * @param name Stop name as written in the line file.
+ * @return The key under which the stop is indexed.
+ */
+std::string StopIndex::normalize(std::string_view name) {
+    std::string key;
+    key.reserve(name.size());
+    bool space = false;
+    for (const char c : name) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space = !key.empty();
+            continue;
+        }
+        if (space) {
+            key += ' ';
+            space = false;
+        }
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return key;
+}
+
+/**
+ * @brief Builds the index for the lines of a snapshot.
+ * Every stop name is normalized and hashed once; all later lookups work on stop ids.
+ * @param lines Lines of the snapshot; the index refers to them by position.
+ * @return The finished index.
+ */
+StopIndex StopIndex::build(const std::vector<CatalogLine>& lines) {
+    StopIndex index;
+    std::size_t occurrences = 0;
+    for (const auto& line : lines) {
+        occurrences += line.data.stops.size();
+    }
+    // Open-addressing table of stop ids (id + 1, 0 = empty); the hash is compared before the key
+    std::size_t capacity = 16;
+    while (capacity < 2 * occurrences) {
+        capacity *= 2;
+    }
+    std::vector<std::uint32_t> table(capacity, 0);
+    std::vector<std::string> firstKeys;
+    std::vector<std::size_t> hashes;
+    index.lineStops.reserve(occurrences);
+    index.lineOffsets.reserve(lines.size() + 1);
+    index.lineOffsets.push_back(0);
+    const std::hash<std::string> hasher;
+    for (const auto& line : lines) {
+        for (const auto& stop : line.data.stops) {
+            std::string key = normalize(stop);
+            const std::size_t hash = hasher(key);
+            std::size_t slot = hash & (capacity - 1);
+            while (table[slot] != 0 &&
+                   (hashes[table[slot] - 1] != hash || firstKeys[table[slot] - 1] != key)) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            if (table[slot] == 0) {
+                table[slot] = static_cast<std::uint32_t>(firstKeys.size()) + 1;
+                firstKeys.push_back(std::move(key));
+                hashes.push_back(hash);
+                index.names.push_back(stop);
+            }
+            index.lineStops.push_back(table[slot] - 1);
+        }
+        index.lineOffsets.push_back(static_cast<std::uint32_t>(index.lineStops.size()));
+        index.linePrices.push_back(line.data.pricePerStop);
+    }
+
+    // Renumber stops alphabetically, so menus list them in order and find() can bisect
+    std::vector<std::uint32_t> order(firstKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&firstKeys](std::uint32_t a, std::uint32_t b) { return firstKeys[a] < firstKeys[b]; });
+    std::vector<std::uint32_t> renumber(order.size());
+    std::vector<std::string> names(order.size());
+    index.keys.resize(order.size());
+    for (std::uint32_t id = 0; id < order.size(); ++id) {
+        renumber[order[id]] = id;
+        names[id] = std::move(index.names[order[id]]);
+        index.keys[id] = std::move(firstKeys[order[id]]);
+    }
+    index.names = std::move(names);
+    for (auto& stop : index.lineStops) {
+        stop = renumber[stop];
+    }
+
+    // Postings in line and route order: count, prefix sum, fill
+    index.servingOffsets.assign(index.names.size() + 1, 0);
+    for (const auto stop : index.lineStops) {
+        index.servingOffsets[stop + 1]++;
+    }
+    std::partial_sum(index.servingOffsets.begin(), index.servingOffsets.end(), index.servingOffsets.begin());
+    index.servingList.resize(index.lineStops.size());
+    std::vector<std::uint32_t> fill(index.servingOffsets.begin(), index.servingOffsets.end() - 1);
+    for (std::uint32_t line = 0; line < lines.size(); ++line) {
+        for (std::uint32_t slot = index.lineOffsets[line]; slot < index.lineOffsets[line + 1]; ++slot) {
+            index.servingList[fill[index.lineStops[slot]]++] = {line, slot - index.lineOffsets[line]};
+        }
+    }
+    return index;
+}
+
+/**
+ * @brief Looks up a stop by name.
+ * @param name Stop name; matched after normalization.
+ * @return The stop id, or NO_STOP if no line serves the stop.
+ */
+std::uint32_t StopIndex::find(std::string_view name) const {
+    const std::string key = normalize(name);
+    const auto it = std::lower_bound(keys.begin(), keys.end(), key);
+    if (it == keys.end() || *it != key) {
+        return NO_STOP;
+    }
+    return static_cast<std::uint32_t>(it - keys.begin());
+}
+
+/**
+ * @brief Returns the lines serving a stop with the stop's position on each.
+ * A line passing a stop twice (e.g. a loop) appears twice.
+ */
+StopIndex::Servings StopIndex::servings(std::uint32_t stop) const {
+    const StopServing* data = servingList.data();
+    return {data + servingOffsets[stop], data + servingOffsets[stop + 1]};
+}
+
+/**
+ * @brief Returns the stop id at a position of a line.
+ */
+std::uint32_t StopIndex::stopAt(std::uint32_t line, std::uint32_t position) const {
+    return lineStops[lineOffsets[line] + position];
+}
+
+/**
+ * @brief Lists every stop reachable without changing from the given start stop.
+ * If several lines connect the two stops, the cheapest journey is kept (then the one with fewer stops).
+ * @param start Stop id of the start.
+ * @return One connection per destination, ordered by destination id (i.e. alphabetically).
+ */
+std::vector<StopConnection> StopIndex::destinations(std::uint32_t start) const {
+    std::vector<StopConnection> connections;
+    for (const auto& serving : servings(start)) {
+        const std::uint32_t first = lineOffsets[serving.line];
+        const std::uint32_t length = lineOffsets[serving.line + 1] - first;
+        for (std::uint32_t position = 0; position < length; ++position) {
+            const std::uint32_t destination = lineStops[first + position];
+            if (destination == start) {
+                continue;
+            }
+            const int stops = std::abs(static_cast<int>(position) - static_cast<int>(serving.position));
+            connections.push_back({destination, serving.line, serving.position, position,
+                                   stops * linePrices[serving.line]});
+        }
+    }
+
+    const auto stopsBetween = [](const StopConnection& c) {
+        return std::abs(static_cast<int>(c.destinationPosition) - static_cast<int>(c.startPosition));
+    };
+    std::sort(connections.begin(), connections.end(), [&](const StopConnection& a, const StopConnection& b) {
+        return std::make_tuple(a.destination, a.price, stopsBetween(a), a.line) <
+               std::make_tuple(b.destination, b.price, stopsBetween(b), b.line);
+    });
+    connections.erase(std::unique(connections.begin(), connections.end(),
+                                  [](const StopConnection& a, const StopConnection& b) {
+                                      return a.destination == b.destination;
+                                  }),
+                      connections.end());
+    return connections;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct CatalogLine;
+
+// A line passing a stop: index of the line in the snapshot and position of the stop on it
+struct StopServing {
+    std::uint32_t line;
+    std::uint32_t position;
+};
+
+// Cheapest direct journey from a start stop to one destination
+struct StopConnection {
+    std::uint32_t destination;
+    std::uint32_t line;
+    std::uint32_t startPosition;
+    std::uint32_t destinationPosition;
+    int price;
+};
+
+// Inverted index from stop to the lines serving it, built once per catalog snapshot.
+// Stops with the same normalized name are one stop, so a transfer stop lists every line through it.
+// Stop ids follow the alphabetical order of the normalized names.
+class StopIndex {
+public:
+    static constexpr std::uint32_t NO_STOP = UINT32_MAX;
+
+    struct Servings {
+        const StopServing* first;
+        const StopServing* last;
+        [[nodiscard]] const StopServing* begin() const { return first; }
+        [[nodiscard]] const StopServing* end() const { return last; }
+        [[nodiscard]] std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    };
+
+    static StopIndex build(const std::vector<CatalogLine>& lines);
+    static std::string normalize(std::string_view name);
+
+    [[nodiscard]] std::size_t stopCount() const { return names.size(); }
+    [[nodiscard]] const std::string& name(std::uint32_t stop) const { return names[stop]; }
+    [[nodiscard]] std::uint32_t find(std::string_view name) const;
+    [[nodiscard]] Servings servings(std::uint32_t stop) const;
+    [[nodiscard]] std::uint32_t stopAt(std::uint32_t line, std::uint32_t position) const;
+    [[nodiscard]] std::vector<StopConnection> destinations(std::uint32_t start) const;
+
+private:
+    // Per stop: normalized name (sorted) and the name as first seen in the data
+    std::vector<std::string> keys;
+    std::vector<std::string> names;
+    // Lines serving each stop; those of stop s are servingList[servingOffsets[s] .. servingOffsets[s + 1])
+    std::vector<std::uint32_t> servingOffsets;
+    std::vector<StopServing> servingList;
+    // Stop ids of each line in route order, laid out the same way, and the price per stop
+    std::vector<std::uint32_t> lineOffsets;
+    std::vector<std::uint32_t> lineStops;
+    std::vector<int> linePrices;
+};
@@ -0,0 +1,451 @@
+#include "Logger.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr std::size_t MESSAGE_BYTES = 240;
+constexpr std::size_t WRITE_BATCH_BYTES = 64 * 1024;
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warning: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+// One preallocated message slot. The sequence number tells producers and the
+// writer whose turn it is (bounded MPMC queue after Dmitry Vyukov).
+struct LogRecord {
+    std::atomic<std::size_t> sequence{0};
+    std::int64_t timeMs = 0;
+    LogLevel level = LogLevel::Info;
+    std::uint16_t length = 0;
+    char text[MESSAGE_BYTES];
+};
+
+class LogQueue {
+public:
+    explicit LogQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        records = std::make_unique<LogRecord[]>(size);
+        mask = size - 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            records[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Claims a free slot; returns nullptr if the queue is full
+    LogRecord* claim(std::size_t& position) {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            LogRecord& record = records[position & mask];
+            const std::size_t sequence = record.sequence.load(std::memory_order_acquire);
+            const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+            if (difference == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    return &record;
+                }
+            } else if (difference < 0) {
+                return nullptr;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    static void publish(LogRecord& record, std::size_t position) {
+        record.sequence.store(position + 1, std::memory_order_release);
+    }
+
+    // Single consumer: returns the next published record or nullptr
+    LogRecord* front() {
+        LogRecord& record = records[dequeuePosition & mask];
+        if (record.sequence.load(std::memory_order_acquire) != dequeuePosition + 1) {
+            return nullptr;
+        }
+        return &record;
+    }
+
+    void pop() {
+        records[dequeuePosition & mask].sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+        ++dequeuePosition;
+    }
+
+private:
+    std::unique_ptr<LogRecord[]> records;
+    std::size_t mask = 0;
+    alignas(64) std::atomic<std::size_t> enqueuePosition{0};
+    alignas(64) std::size_t dequeuePosition = 0;
+};
+
+struct LoggerState {
+    std::mutex lifecycle;
+    std::atomic<LogLevel> minLevel{LogLevel::Info};
+    std::atomic<bool> running{false};
+    std::atomic<bool> stopRequested{false};
+    // Log calls between the running check and publishing their record; stop() waits for them
+    std::atomic<int> producers{0};
+    // The idle writer sleeps on wake; producers only take wakeMutex if writerIdle is set
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> writerIdle{false};
+    std::atomic<std::uint64_t> dropped{0};
+    std::unique_ptr<LogQueue> queue;
+    // Queues of earlier runs stay allocated; a thread may still be inside a log call during restart
+    std::vector<std::unique_ptr<LogQueue>> retiredQueues;
+    std::thread writer;
+    LogConfig config;
+    int fd = -1;
+    std::size_t fileBytes = 0;
+    std::uint64_t reportedDrops = 0;
+    // Cached "YYYY-MM-DD HH:MM:SS" of the last second written
+    std::int64_t cachedSecond = -1;
+    char cachedTime[32] = {};
+};
+
+// Never destroyed, so log calls from detached threads during exit stay valid
+LoggerState& state() {
+    static auto* instance = new LoggerState();
+    return *instance;
+}
+
+std::int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void openLogFile(LoggerState& s) {
+    const std::filesystem::path path(s.config.path);
+    if (path.has_parent_path()) {
+        std::error_code ignored;
+        std::filesystem::create_directories(path.parent_path(), ignored);
+    }
+    s.fd = ::open(s.config.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    s.fileBytes = 0;
+    if (s.fd >= 0) {
+        const off_t size = ::lseek(s.fd, 0, SEEK_END);
+        s.fileBytes = size > 0 ? static_cast<std::size_t>(size) : 0;
+    }
+}
+
+// Renames path.(n-1) -> path.n ... path -> path.1 and starts a new file
+void rotate(LoggerState& s) {
+    if (s.fd >= 0) {
+        ::close(s.fd);
+        s.fd = -1;
+    }
+    const std::string& path = s.config.path;
+    if (s.config.maxFiles <= 0) {
+        ::unlink(path.c_str());
+    } else {
+        ::unlink((path + "." + std::to_string(s.config.maxFiles)).c_str());
+        for (int i = s.config.maxFiles - 1; i >= 1; --i) {
+            ::rename((path + "." + std::to_string(i)).c_str(), (path + "." + std::to_string(i + 1)).c_str());
+        }
+        ::rename(path.c_str(), (path + ".1").c_str());
+    }
+    openLogFile(s);
+}
+
+void writeBatch(LoggerState& s, const char* data, std::size_t size) {
+    if (s.fd < 0) {
+        // Logging must never stop the machine; without a file the messages are lost
+        return;
+    }
+    std::size_t offset = 0;
+    while (offset < size) {
+        const ssize_t written = ::write(s.fd, data + offset, size - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += static_cast<std::size_t>(written);
+    }
+    s.fileBytes += offset;
+}
+
+void appendLine(LoggerState& s, std::string& batch, std::int64_t timeMs, LogLevel level,
+                const char* text, std::size_t length) {
+    const std::int64_t second = timeMs / 1000;
+    if (second != s.cachedSecond) {
+        const auto seconds = static_cast<std::time_t>(second);
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::strftime(s.cachedTime, sizeof(s.cachedTime), "%Y-%m-%d %H:%M:%S", &local);
+        s.cachedSecond = second;
+    }
+    char prefix[64];
+    const int prefixLength = std::snprintf(prefix, sizeof(prefix), "%s.%03d %-5s ", s.cachedTime,
+                                           static_cast<int>(timeMs % 1000), levelName(level));
+    batch.append(prefix, static_cast<std::size_t>(prefixLength));
+    batch.append(text, length);
+    batch += '\n';
+}
+
+// Adds a line to the batch; if it would not fit into the current file any more,
+// the lines before it are written and the file is rotated first
+void appendRecord(LoggerState& s, std::string& batch, std::int64_t timeMs, LogLevel level,
+                  const char* text, std::size_t length) {
+    const std::size_t before = batch.size();
+    appendLine(s, batch, timeMs, level, text, length);
+    if (s.fileBytes + batch.size() > s.config.maxFileBytes && s.fileBytes + before > 0) {
+        writeBatch(s, batch.data(), before);
+        rotate(s);
+        batch.erase(0, before);
+    } else if (batch.size() >= WRITE_BATCH_BYTES) {
+        writeBatch(s, batch.data(), batch.size());
+        batch.clear();
+    }
+}
+
+// Moves all queued records into the file; returns the number of records written
+std::size_t drain(LoggerState& s, std::string& batch) {
+    std::size_t count = 0;
+    batch.clear();
+    while (LogRecord* record = s.queue->front()) {
+        appendRecord(s, batch, record->timeMs, record->level, record->text, record->length);
+        s.queue->pop();
+        ++count;
+    }
+
+    const std::uint64_t dropped = s.dropped.load(std::memory_order_relaxed);
+    if (dropped != s.reportedDrops) {
+        char text[96];
+        const int length = std::snprintf(text, sizeof(text), "%llu Meldung(en) verworfen, Warteschlange voll",
+                                         static_cast<unsigned long long>(dropped - s.reportedDrops));
+        appendRecord(s, batch, nowMs(), LogLevel::Warning, text, static_cast<std::size_t>(length));
+        s.reportedDrops = dropped;
+    }
+    writeBatch(s, batch.data(), batch.size());
+    return count;
+}
+
+void writerLoop(LoggerState& s) {
+    std::string batch;
+    batch.reserve(WRITE_BATCH_BYTES + 2 * MESSAGE_BYTES);
+    while (!s.stopRequested.load(std::memory_order_acquire)) {
+        if (drain(s, batch) > 0) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(s.wakeMutex);
+        s.writerIdle.store(true, std::memory_order_relaxed);
+        // Pairs with the fence in wakeWriter(): either the producer sees writerIdle or we see its record
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s.wake.wait(lock, [&s]() {
+            return s.stopRequested.load(std::memory_order_acquire) || s.queue->front() != nullptr;
+        });
+        s.writerIdle.store(false, std::memory_order_relaxed);
+    }
+    drain(s, batch);
+}
+
+void wakeWriter(LoggerState& s) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (s.writerIdle.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(s.wakeMutex);
+        s.wake.notify_one();
+    }
+}
+
+void vlog(LogLevel level, const char* format, va_list arguments) {
+    LoggerState& s = state();
+    if (level < s.minLevel.load(std::memory_order_relaxed) || level >= LogLevel::Off) {
+        return;
+    }
+
+    // Registered before the running check, so stop() cannot drain past this call
+    s.producers.fetch_add(1, std::memory_order_seq_cst);
+    if (!s.running.load(std::memory_order_seq_cst)) {
+        s.producers.fetch_sub(1, std::memory_order_release);
+        // Without a started logger (tools, tests) only problems are shown, directly on stderr
+        if (level >= LogLevel::Warning) {
+            char text[MESSAGE_BYTES];
+            std::vsnprintf(text, sizeof(text), format, arguments);
+            std::fprintf(stderr, "%s: %s\n", level == LogLevel::Error ? "Fehler" : "Warnung", text);
+        }
+        return;
+    }
+
+    std::size_t position = 0;
+    LogRecord* record = s.queue->claim(position);
+    if (record == nullptr) {
+        s.dropped.fetch_add(1, std::memory_order_relaxed);
+        s.producers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+    // Formatting happens directly in the slot; longer messages are truncated
+    const int length = std::vsnprintf(record->text, MESSAGE_BYTES, format, arguments);
+    record->length = static_cast<std::uint16_t>(std::clamp(length, 0, static_cast<int>(MESSAGE_BYTES) - 1));
+    record->level = level;
+    record->timeMs = nowMs();
+    LogQueue::publish(*record, position);
+    wakeWriter(s);
+    s.producers.fetch_sub(1, std::memory_order_release);
+}
+}
+
+/**
+ * @brief Starts the background writer.
+ *
+ * From now on messages are queued by the calling thread and written to the log
+ * file by a separate thread, so logging never waits for the disk.
+ * Calling start() on a running logger restarts it with the new configuration.
+ *
+ * @param config Log file, minimum level, rotation and queue size.
+ */
+void Logger::start(const LogConfig& config) {
+    stop();
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.lifecycle);
+    s.config = config;
+    if (s.queue) {
+        s.retiredQueues.push_back(std::move(s.queue));
+    }
+    s.queue = std::make_unique<LogQueue>(config.queueCapacity);
+    s.dropped.store(0, std::memory_order_relaxed);
+    s.reportedDrops = 0;
+    s.cachedSecond = -1;
+    openLogFile(s);
+    s.minLevel.store(config.minLevel, std::memory_order_relaxed);
+    s.stopRequested.store(false, std::memory_order_relaxed);
+    s.writer = std::thread(writerLoop, std::ref(s));
+    s.running.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Writes all queued messages and stops the background writer.
+ *
+ * Log calls already past the running check are waited for, so their messages
+ * are written too. Afterwards warnings and errors go directly to stderr again.
+ * Does nothing if the logger is not running.
+ */
+void Logger::stop() {
+    LoggerState& s = state();
+    std::lock_guard<std::mutex> lock(s.lifecycle);
+    if (!s.running.load(std::memory_order_acquire)) {
+        return;
+    }
+    s.running.store(false, std::memory_order_seq_cst);
+    // Log calls never block, so this wait is short
+    while (s.producers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    {
+        std::lock_guard<std::mutex> wakeLock(s.wakeMutex);
+        s.stopRequested.store(true, std::memory_order_release);
+    }
+    s.wake.notify_one();
+    s.writer.join();
+    if (s.fd >= 0) {
+        ::fsync(s.fd);
+        ::close(s.fd);
+        s.fd = -1;
+    }
+}
+
+/**
+ * @brief Changes the minimum level of messages that are logged.
+ * @param level Messages below this level are discarded without formatting.
+ */
+void Logger::setLevel(LogLevel level) {
+    state().minLevel.store(level, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks whether messages of a level would be logged.
+ * Lets callers skip building expensive arguments.
+ */
+bool Logger::enabled(LogLevel level) {
+    return level >= state().minLevel.load(std::memory_order_relaxed) && level < LogLevel::Off;
+}
+
+/**
+ * @brief Parses a level name such as "debug" or "WARN".
+ * @param name Level name, case-insensitive.
+ * @return The level.
+ * @throws std::runtime_error If the name is unknown.
+ */
+LogLevel Logger::parseLevel(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (lower == "debug") return LogLevel::Debug;
+    if (lower == "info") return LogLevel::Info;
+    if (lower == "warn" || lower == "warning") return LogLevel::Warning;
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "off") return LogLevel::Off;
+    throw std::runtime_error("Unknown log level: " + name);
+}
+
+/**
+ * @brief Number of messages discarded since start() because the queue was full.
+ */
+std::uint64_t Logger::droppedMessages() {
+    return state().dropped.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief Logs a printf-style message with the given level.
+ *
+ * The message is formatted straight into a preallocated queue slot; the caller
+ * never allocates or touches the disk, and only takes a lock to wake an idle writer. If the queue is full the message is
+ * dropped and counted, and the writer reports the count in the log.
+ */
+void Logger::log(LogLevel level, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vlog(level, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::debug(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vlog(LogLevel::Debug, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::info(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vlog(LogLevel::Info, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::warning(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vlog(LogLevel::Warning, format, arguments);
+    va_end(arguments);
+}
+
+void Logger::error(const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    vlog(LogLevel::Error, format, arguments);
+    va_end(arguments);
+}
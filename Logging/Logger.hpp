@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class LogLevel : std::uint8_t {
+    Debug,
+    Info,
+    Warning,
+    Error,
+    Off
+};
+
+struct LogConfig {
+    std::string path = "logs/ticketautomat.log";
+    LogLevel minLevel = LogLevel::Info;
+    // The file is rotated to path.1 ... path.maxFiles when it would grow beyond this size
+    std::size_t maxFileBytes = 1 << 20;
+    int maxFiles = 3;
+    // Number of preallocated message slots; rounded up to a power of two
+    std::size_t queueCapacity = 4096;
+};
+
+#define LOG_PRINTF_FORMAT(formatIndex) __attribute__((format(printf, formatIndex, formatIndex + 1)))
+
+class Logger {
+public:
+    static void start(const LogConfig& config);
+    static void stop();
+    static void setLevel(LogLevel level);
+    static bool enabled(LogLevel level);
+    static LogLevel parseLevel(const std::string& name);
+    static std::uint64_t droppedMessages();
+
+    static void log(LogLevel level, const char* format, ...) LOG_PRINTF_FORMAT(2);
+    static void debug(const char* format, ...) LOG_PRINTF_FORMAT(1);
+    static void info(const char* format, ...) LOG_PRINTF_FORMAT(1);
+    static void warning(const char* format, ...) LOG_PRINTF_FORMAT(1);
+    static void error(const char* format, ...) LOG_PRINTF_FORMAT(1);
+};
@@ -1,23 +1,104 @@
 #include "Payment.hpp"
+#include "../Logging/Logger.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 /**
  * @brief Default constructor.
  * Initializes the internal change box with default coin/bill counts.
  */
-Payment::Payment() {
+Payment::Payment() : Payment(defaultChangeBox()) {}
+
+/**
+ * @brief Constructs a payment unit with a custom initial change box.
+ * Used to size the cassettes, e.g. by the change box simulator.
+ * @param initialStock Map of coin/bill values to the number of units loaded on reset.
+ */
+Payment::Payment(const std::map<int, int>& initialStock) : Payment(initialStock, defaultCapacity()) {}
+
+/**
+ * @brief Constructs a payment unit that recycles inserted coins into the change box.
+ * @param initialStock Map of coin/bill values to the number of units loaded on reset.
+ * @param capacity Most units per value the change box holds; values without capacity are not recycled.
+ * @param notes Further accepted values that always go to the cashbox.
+ */
+Payment::Payment(const std::map<int, int>& initialStock, const std::map<int, int>& capacity,
+                 const std::vector<int>& notes)
+    : initialChangeBox(initialStock), capacity(capacity), notes(notes) {
     setChangeBox();
 }
 
+/**
+ * @brief Takes one inserted coin or note into escrow.
+ * @param denomination Value of the piece.
+ * @return False if the machine does not accept the value; the piece is handed back.
+ */
+bool Payment::insert(int denomination) {
+    const std::vector<int> accepted = acceptedDenominations();
+    if (std::find(accepted.begin(), accepted.end(), denomination) == accepted.end()) {
+        Logger::debug("Nicht angenommen: %d Geld", denomination);
+        return false;
+    }
+    escrow[denomination]++;
+    return true;
+}
+
+/**
+ * @brief Returns the sum of the pieces in escrow.
+ * @return Amount inserted by the current customer so far.
+ */
+int Payment::insertedAmount() const {
+    int amount = 0;
+    for (const auto& [value, count] : escrow) {
+        amount += value * count;
+    }
+    return amount;
+}
+
+/**
+ * @brief Hands the pieces in escrow back to the customer, e.g. on cancel.
+ * @return Map of coin/bill values to the count returned.
+ */
+std::map<int, int> Payment::returnInserted() {
+    std::map<int, int> returned;
+    returned.swap(escrow);
+    return returned;
+}
+
 /**
  * @brief Main method to pay out change.
- * Delegates to sub-functions for selecting coins, validating, and updating the storage.
+ * The pieces in escrow are credited first, so the customer's own coins can already be given
+ * as change. Delegates to sub-functions for selecting coins, validating, and updating the storage.
+ * If the change cannot be given, nothing is credited and the escrow stays with the customer.
  * @param amount The total amount to dispense as change.
  * @return A map of coin/bill values to the count of each dispensed.
  */
 std::map<int, int> Payment::payOutChange(const int& amount) {
+    const std::map<int, int> recycled = recycleInserted();
     int remainingAmount = amount;
     std::map<int, int> payOut = takeFromChangeBox(remainingAmount);
+    if (remainingAmount > 0) {
+        Logger::info("Wechselgeld nicht verfügbar: %d von %d Geld nicht auszahlbar", remainingAmount, amount);
+        for (const auto& [value, count] : recycled) {
+            changeBox[value] -= count;
+        }
+    }
     validateRemainingAmount(remainingAmount);
+
+    // The sale stands: pieces the change box had no room for go to the cashbox
+    for (const auto& [value, count] : escrow) {
+        const auto kept = recycled.find(value);
+        const int overflow = count - (kept != recycled.end() ? kept->second : 0);
+        if (overflow > 0) {
+            cashBox[value] += overflow;
+        }
+    }
+    escrow.clear();
+    if (Logger::enabled(LogLevel::Debug)) {
+        for (const auto& [value, count] : payOut) {
+            Logger::debug("Wechselgeld: %d x %d Geld, Bestand danach %d", count, value, changeBox[value] - count);
+        }
+    }
     updateChangeBox(payOut);
     return payOut;
 }
@@ -35,10 +116,96 @@ int Payment::calculateChange(const int &ticketPrice, const int &insertedAmount)
 }
 
 /**
- * @brief Resets the internal change box to default coin/bill counts.
+ * @brief Service visit: refills the change box to its initial counts and empties the cashbox.
  */
 void Payment::reset() {
     setChangeBox();
+    cashBox.clear();
+    escrow.clear();
+}
+
+/**
+ * @brief Returns the current stock of the change box.
+ * @return Map of coin/bill values to the number of units still available.
+ */
+std::map<int, int> Payment::getChangeBox() const {
+    return {changeBox.begin(), changeBox.end()};
+}
+
+/**
+ * @brief Returns the pieces collected in the cashbox since the last reset.
+ * @return Map of coin/bill values to the number of units.
+ */
+std::map<int, int> Payment::getCashBox() const {
+    return cashBox;
+}
+
+/**
+ * @brief Returns every value the machine takes, largest first.
+ * These are the values of the change box and the notes.
+ * @return The accepted coin/bill values.
+ */
+std::vector<int> Payment::acceptedDenominations() const {
+    std::vector<int> accepted(notes.begin(), notes.end());
+    for (const auto& [value, count] : initialChangeBox) accepted.push_back(value);
+    for (const auto& [value, count] : capacity) accepted.push_back(value);
+    std::sort(accepted.begin(), accepted.end(), std::greater<>());
+    accepted.erase(std::unique(accepted.begin(), accepted.end()), accepted.end());
+    accepted.erase(std::remove_if(accepted.begin(), accepted.end(), [](int value) { return value <= 0; }),
+                   accepted.end());
+    return accepted;
+}
+
+/**
+ * @brief Returns the default initial stock of the change box.
+ * For simplicity, every denomination starts with 2 units.
+ * @return Map of coin/bill values to counts.
+ */
+std::map<int, int> Payment::defaultChangeBox() {
+    return {{17, 2}, {11, 2}, {7, 2}, {5, 2}, {3, 2}, {2, 2}, {1, 2}};
+}
+
+/**
+ * @brief Returns how many units of each value the change box holds at most.
+ * Every value of the default change box is recycled, with room for 20 units.
+ * @return Map of coin/bill values to capacities.
+ */
+std::map<int, int> Payment::defaultCapacity() {
+    std::map<int, int> capacity;
+    for (const auto& [value, count] : defaultChangeBox()) {
+        capacity[value] = 20;
+    }
+    return capacity;
+}
+
+/**
+ * @brief Returns the notes the machine accepts by default; they are never paid out.
+ * @return Note values.
+ */
+std::vector<int> Payment::defaultNotes() {
+    return {10, 20, 50};
+}
+
+/**
+ * @brief Moves the pieces in escrow into the change box as far as there is room.
+ * The escrow itself is left unchanged; payOutChange() settles or rolls back.
+ * @return Map of coin/bill values to the count added to the change box.
+ */
+std::map<int, int> Payment::recycleInserted() {
+    std::map<int, int> recycled;
+    for (const auto& [value, count] : escrow) {
+        const auto limit = capacity.find(value);
+        if (limit == capacity.end()) {
+            continue;
+        }
+        const int stock = changeBox.count(value) != 0 ? changeBox[value] : 0;
+        const int room = std::min(count, std::max(limit->second - stock, 0));
+        if (room > 0) {
+            changeBox[value] = stock + room;
+            recycled[value] = room;
+        }
+    }
+    return recycled;
 }
 
 /**
@@ -100,15 +267,11 @@ void Payment::updateChangeBox(const std::map<int, int>& payOut) {
 }
 
 /**
- * @brief Initializes the change box with default coin/bill counts.
- * For simplicity, every denomination starts with 2 units.
+ * @brief Initializes the change box with the configured initial coin/bill counts.
  */
 void Payment::setChangeBox() {
-    changeBox[17] = 2;
-    changeBox[11] = 2;
-    changeBox[7]  = 2;
-    changeBox[5]  = 2;
-    changeBox[3]  = 2;
-    changeBox[2]  = 2;
-    changeBox[1]  = 2;
+    changeBox.clear();
+    for (const auto& [value, count] : initialChangeBox) {
+        changeBox[value] = count;
+    }
 }
\ No newline at end of file
@@ -1,19 +1,41 @@
 #pragma once
 #include <map>
 #include <functional>
+#include <vector>
 
 class Payment {
 public:
     Payment();
+    explicit Payment(const std::map<int, int>& initialStock);
+    Payment(const std::map<int, int>& initialStock, const std::map<int, int>& capacity,
+            const std::vector<int>& notes = defaultNotes());
+    bool insert(int denomination);
+    [[nodiscard]] int insertedAmount() const;
+    std::map<int, int> returnInserted();
     std::map<int, int> payOutChange(const int& amount);
     static int calculateChange(const int& ticketPrice, const int& insertedAmount);
     void reset();
+    [[nodiscard]] std::map<int, int> getChangeBox() const;
+    [[nodiscard]] std::map<int, int> getCashBox() const;
+    [[nodiscard]] std::vector<int> acceptedDenominations() const;
+    static std::map<int, int> defaultChangeBox();
+    static std::map<int, int> defaultCapacity();
+    static std::vector<int> defaultNotes();
 
 private:
     std::map<int, int, std::greater<>> changeBox;
+    std::map<int, int> initialChangeBox;
+    // Most pieces of a denomination the change box holds; inserted pieces beyond go to the cashbox
+    std::map<int, int> capacity;
+    // Accepted, but never paid out
+    std::vector<int> notes;
+    // Pieces of the current customer, returned on cancel and credited with the payout
+    std::map<int, int> escrow;
+    std::map<int, int> cashBox;
 
     std::map<int, int> takeFromChangeBox(int& remainingAmount);
+    std::map<int, int> recycleInserted();
     static void validateRemainingAmount(const int& remainingAmount);
     void updateChangeBox(const std::map<int, int>& payOut);
     void setChangeBox();
-};
\ No newline at end of file
+};
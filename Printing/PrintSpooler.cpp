@@ -0,0 +1,214 @@
+#include "PrintSpooler.hpp"
+#include "../Logging/Logger.hpp"
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace {
+// How often a write waiting for the device checks whether shutdown gave up on it
+constexpr int WRITE_POLL_MS = 50;
+}
+
+/**
+ * @brief Starts the print thread.
+ * @param devicePath Printer device or file; documents are appended to it.
+ * @param capacity Maximum number of queued documents before submit() blocks.
+ * @param retryDelay Pause before a failed document is written again.
+ */
+PrintSpooler::PrintSpooler(std::string devicePath, std::size_t capacity, std::chrono::milliseconds retryDelay)
+    : devicePath(std::move(devicePath)), retryDelay(retryDelay), queue(capacity) {
+    // Output files may live in a folder that does not exist yet; devices are unaffected
+    std::error_code ignored;
+    const std::filesystem::path parent = std::filesystem::path(this->devicePath).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent, ignored);
+    }
+    worker = std::thread(&PrintSpooler::run, this);
+}
+
+/**
+ * @brief Prints the remaining documents (at most five seconds) and stops the print thread.
+ */
+PrintSpooler::~PrintSpooler() {
+    shutdown(std::chrono::seconds(5));
+}
+
+/**
+ * @brief Queues a rendered document for printing and returns immediately.
+ * If the queue is full (printer slower than sales or offline), waits for space:
+ * this is the backpressure that keeps paid tickets from being dropped.
+ * @param document The document, e.g. a rendered ticket.
+ * @param timeout Maximum time to wait for space in the queue.
+ * @return True if queued, false if the queue stayed full or the spooler is shut down.
+ */
+bool PrintSpooler::submit(std::string document, std::chrono::milliseconds timeout) {
+    if (stopping) {
+        return false;
+    }
+
+    if (!queue.tryPush(document)) {
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        const bool space = documentPrinted.wait_for(lock, timeout, [this]() { return !queue.full(); });
+        lock.unlock();
+        if (!space || !queue.tryPush(document)) {
+            return false;
+        }
+    }
+
+    // Taking the lock orders the push before the worker's emptiness check, so no wakeup is lost
+    { std::lock_guard<std::mutex> lock(wakeMutex); }
+    documentQueued.notify_one();
+    return true;
+}
+
+/**
+ * @brief Waits until every queued document has been written.
+ * @param timeout Maximum waiting time.
+ * @return True if the queue is empty.
+ */
+bool PrintSpooler::flush(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    return documentPrinted.wait_for(lock, timeout, [this]() { return queue.size() == 0; });
+}
+
+/**
+ * @brief Stops accepting documents, prints what is queued and stops the print thread.
+ * Documents still queued after the timeout (printer offline or not taking data) are
+ * reported as an error; the print thread stops within WRITE_POLL_MS after the timeout,
+ * since it never blocks on the device. Calling it again has no effect.
+ * @param timeout Maximum time to wait for the queue to drain.
+ */
+void PrintSpooler::shutdown(std::chrono::milliseconds timeout) {
+    if (!worker.joinable()) {
+        return;
+    }
+    stopping = true;
+    { std::lock_guard<std::mutex> lock(wakeMutex); }
+    documentQueued.notify_one();
+
+    if (!flush(timeout)) {
+        abandoned = true;
+        { std::lock_guard<std::mutex> lock(wakeMutex); }
+        documentQueued.notify_one();
+    }
+    worker.join();
+
+    if (queue.size() != 0) {
+        reportError(std::to_string(queue.size()) + " Dokument(e) nicht gedruckt (" + devicePath + ")", LogLevel::Error);
+    }
+}
+
+/**
+ * @brief Returns and clears the errors reported since the last call.
+ * The UI polls this between sales.
+ */
+std::vector<std::string> PrintSpooler::takeErrors() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    std::vector<std::string> taken;
+    taken.swap(errors);
+    return taken;
+}
+
+void PrintSpooler::reportError(std::string message, LogLevel level) {
+    Logger::log(level, "%s", message.c_str());
+    std::lock_guard<std::mutex> lock(errorMutex);
+    errors.push_back(std::move(message));
+}
+
+/**
+ * @brief Print thread: writes queued documents in order.
+ * A document leaves the queue only after it was written completely. On an error
+ * it is retried after retryDelay, and the error is reported once per outage.
+ */
+void PrintSpooler::run() {
+    bool failing = false;
+    while (true) {
+        std::string* document = queue.front();
+        if (document == nullptr) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            documentQueued.wait(lock, [this]() { return queue.front() != nullptr || stopping; });
+            if (queue.front() == nullptr) {
+                return;
+            }
+            continue;
+        }
+        if (abandoned) {
+            return;
+        }
+
+        std::string error;
+        if (writeDocument(*document, error)) {
+            queue.pop();
+            if (failing) {
+                reportError("Drucker wieder bereit (" + devicePath + ")", LogLevel::Info);
+                failing = false;
+            }
+            { std::lock_guard<std::mutex> lock(wakeMutex); }
+            documentPrinted.notify_all();
+            continue;
+        }
+
+        if (abandoned) {
+            return;
+        }
+        if (!failing) {
+            reportError("Druckfehler: " + error, LogLevel::Error);
+            failing = true;
+        }
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        documentQueued.wait_for(lock, retryDelay, [this]() { return abandoned.load(); });
+    }
+}
+
+/**
+ * @brief Writes one document to the device.
+ * The device is opened per document, so a printer that was switched off and on
+ * again (or a rotated output file) is picked up without a restart. The device is
+ * opened non-blocking and a busy device is polled, so shutdown() can give up on
+ * a printer that takes no data instead of waiting forever.
+ * @param document The document.
+ * @param error Receives a description of the failure.
+ * @return True if every byte was written.
+ */
+bool PrintSpooler::writeDocument(const std::string& document, std::string& error) const {
+    // A FIFO or device without a reader fails here (ENXIO) instead of blocking
+    const int fd = open(devicePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC | O_NONBLOCK, 0644);
+    if (fd < 0) {
+        error = devicePath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::size_t written = 0;
+    while (written < document.size()) {
+        const ssize_t result = write(fd, document.data() + written, document.size() - written);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (abandoned) {
+                error = devicePath + ": shutdown while the printer was busy";
+                close(fd);
+                return false;
+            }
+            pollfd ready = {fd, POLLOUT, 0};
+            poll(&ready, 1, WRITE_POLL_MS);
+            continue;
+        }
+        if (result <= 0) {
+            error = devicePath + ": " + std::strerror(errno);
+            close(fd);
+            return false;
+        }
+        written += static_cast<std::size_t>(result);
+    }
+
+    if (close(fd) != 0) {
+        error = devicePath + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "SpscRing.hpp"
+#include "../Logging/Logger.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PrintSpooler {
+public:
+    explicit PrintSpooler(std::string devicePath, std::size_t capacity = 16,
+                          std::chrono::milliseconds retryDelay = std::chrono::milliseconds(500));
+    ~PrintSpooler();
+
+    PrintSpooler(const PrintSpooler&) = delete;
+    PrintSpooler& operator=(const PrintSpooler&) = delete;
+
+    bool submit(std::string document, std::chrono::milliseconds timeout);
+    bool flush(std::chrono::milliseconds timeout);
+    void shutdown(std::chrono::milliseconds timeout);
+    std::vector<std::string> takeErrors();
+    [[nodiscard]] std::size_t pending() const { return queue.size(); }
+    [[nodiscard]] const std::string& getDevicePath() const { return devicePath; }
+
+private:
+    std::string devicePath;
+    std::chrono::milliseconds retryDelay;
+    SpscRing<std::string> queue;
+    std::thread worker;
+    // Set once no new documents will come; the worker drains the queue and exits
+    std::atomic<bool> stopping{false};
+    // Set when the flush on shutdown timed out; the worker exits without draining
+    std::atomic<bool> abandoned{false};
+
+    std::mutex wakeMutex;
+    std::condition_variable documentQueued;
+    std::condition_variable documentPrinted;
+
+    std::mutex errorMutex;
+    std::vector<std::string> errors;
+
+    void run();
+    bool writeDocument(const std::string& document, std::string& error) const;
+    // Also writes the message to the log with the given level
+    void reportError(std::string message, LogLevel level);
+};
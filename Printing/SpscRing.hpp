@@ -0,0 +1,70 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free ring buffer for exactly one producer and one consumer thread.
+ *
+ * The producer only writes tail, the consumer only writes head; each side reads
+ * the other index with acquire ordering, so an element is fully written before
+ * the consumer can see it. The indices sit on separate cache lines so the two
+ * threads do not invalidate each other's line on every operation.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) : slots(roundUpToPowerOfTwo(capacity)), mask(slots.size() - 1) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer only: returns false if the ring is full; the value is left untouched then
+    bool tryPush(T& value) {
+        const std::size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) == slots.size()) {
+            return false;
+        }
+        slots[currentTail & mask] = std::move(value);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only: oldest element, or nullptr if the ring is empty; stays queued until pop()
+    T* front() {
+        const std::size_t currentHead = head.load(std::memory_order_relaxed);
+        if (currentHead == tail.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &slots[currentHead & mask];
+    }
+
+    // Consumer only: removes the element returned by front()
+    void pop() {
+        const std::size_t currentHead = head.load(std::memory_order_relaxed);
+        slots[currentHead & mask] = T();
+        head.store(currentHead + 1, std::memory_order_release);
+    }
+
+    // Approximate when called concurrently; exact when both sides are idle
+    [[nodiscard]] std::size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    [[nodiscard]] bool full() const { return size() == slots.size(); }
+    [[nodiscard]] std::size_t capacity() const { return slots.size(); }
+
+private:
+    static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+        std::size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    std::vector<T> slots;
+    const std::size_t mask;
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
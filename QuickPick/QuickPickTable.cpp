@@ -0,0 +1,180 @@
+#include "QuickPickTable.hpp"
+#include "../Logging/Logger.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr char MAGIC[4] = {'T', 'K', 'Q', '1'};
+
+void writeString(std::ofstream& file, const std::string& value) {
+    const auto length = static_cast<std::uint16_t>(std::min<std::size_t>(value.size(), 0xffff));
+    file.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    file.write(value.data(), length);
+}
+
+bool readString(std::ifstream& file, std::string& value) {
+    std::uint16_t length = 0;
+    if (!file.read(reinterpret_cast<char*>(&length), sizeof(length))) {
+        return false;
+    }
+    value.resize(length);
+    return static_cast<bool>(file.read(value.data(), length));
+}
+}
+
+/**
+ * @brief Creates an empty table; call load() to restore the saved state.
+ * @param path File the table is persisted to, e.g. state/quickpick.bin.
+ * @param capacity Maximum number of journeys kept; the weakest is evicted first.
+ * @param halfLifeHours Time after which a sale counts half as much.
+ */
+QuickPickTable::QuickPickTable(std::string path, std::size_t capacity, double halfLifeHours)
+    : path(std::move(path)), capacity(capacity), halfLifeSeconds(halfLifeHours * 3600.0) {}
+
+/**
+ * @brief Returns the score of an entry decayed to the given time.
+ */
+double QuickPickTable::decayedScore(const QuickPickEntry& entry, std::time_t now) const {
+    const double age = std::max<double>(0.0, static_cast<double>(now - entry.lastSale));
+    return entry.score * std::exp2(-age / halfLifeSeconds);
+}
+
+/**
+ * @brief Counts one sale of a journey.
+ * Scores are decayed lazily: an entry is only brought up to date when it is
+ * sold again or ranked, so recording is O(table size) at most.
+ * @param line Name of the tram line.
+ * @param startStop Name of the start stop.
+ * @param destinationStop Name of the destination stop.
+ * @param now Time of the sale.
+ */
+void QuickPickTable::record(const std::string& line, const std::string& startStop,
+                            const std::string& destinationStop, std::time_t now) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& entry : entries) {
+        if (entry.line == line && entry.startStop == startStop && entry.destinationStop == destinationStop) {
+            entry.score = decayedScore(entry, now) + 1.0;
+            entry.lastSale = now;
+            return;
+        }
+    }
+
+    if (entries.size() >= capacity && !entries.empty()) {
+        // Replace the journey with the lowest current score
+        const auto weakest = std::min_element(entries.begin(), entries.end(),
+            [this, now](const QuickPickEntry& a, const QuickPickEntry& b) {
+                return decayedScore(a, now) < decayedScore(b, now);
+            });
+        entries.erase(weakest);
+    }
+    entries.push_back({line, startStop, destinationStop, 1.0, static_cast<std::int64_t>(now)});
+}
+
+/**
+ * @brief Returns the most frequently sold journeys.
+ * @param count Maximum number of journeys.
+ * @param now Time the scores are decayed to.
+ * @return Up to count journeys, highest score first, with scores decayed to now.
+ */
+std::vector<QuickPickEntry> QuickPickTable::top(std::size_t count, std::time_t now) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<QuickPickEntry> ranked = entries;
+    for (auto& entry : ranked) {
+        entry.score = decayedScore(entry, now);
+    }
+    const std::size_t n = std::min(count, ranked.size());
+    std::partial_sort(ranked.begin(), ranked.begin() + static_cast<std::ptrdiff_t>(n), ranked.end(),
+                      [](const QuickPickEntry& a, const QuickPickEntry& b) { return a.score > b.score; });
+    ranked.resize(n);
+    return ranked;
+}
+
+/**
+ * @brief Returns the number of journeys in the table.
+ */
+std::size_t QuickPickTable::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+/**
+ * @brief Restores the table from its file.
+ * A missing file gives an empty table. A damaged file is ignored with a warning,
+ * as quick picks are only a shortcut and must never block a sale.
+ */
+void QuickPickTable::load() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+
+    char magic[sizeof(MAGIC)] = {};
+    std::uint32_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        Logger::warning("Schnellwahl-Datei ungültig, starte leer: %s", path.c_str());
+        return;
+    }
+
+    std::vector<QuickPickEntry> loaded;
+    for (std::uint32_t i = 0; i < count && loaded.size() < capacity; ++i) {
+        QuickPickEntry entry;
+        float score = 0.0f;
+        if (!readString(file, entry.line) || !readString(file, entry.startStop) ||
+            !readString(file, entry.destinationStop) ||
+            !file.read(reinterpret_cast<char*>(&score), sizeof(score)) ||
+            !file.read(reinterpret_cast<char*>(&entry.lastSale), sizeof(entry.lastSale))) {
+            Logger::warning("Schnellwahl-Datei ungültig, starte leer: %s", path.c_str());
+            return;
+        }
+        entry.score = score;
+        loaded.push_back(std::move(entry));
+    }
+    entries = std::move(loaded);
+}
+
+/**
+ * @brief Writes the table to its file.
+ * The file is written next to the target and renamed over it, so a crash
+ * leaves either the old or the new table. Scores are stored as float.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void QuickPickTable::save() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+
+    const std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        const auto count = static_cast<std::uint32_t>(entries.size());
+        file.write(MAGIC, sizeof(MAGIC));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        for (const auto& entry : entries) {
+            writeString(file, entry.line);
+            writeString(file, entry.startStop);
+            writeString(file, entry.destinationStop);
+            const auto score = static_cast<float>(entry.score);
+            file.write(reinterpret_cast<const char*>(&score), sizeof(score));
+            file.write(reinterpret_cast<const char*>(&entry.lastSale), sizeof(entry.lastSale));
+        }
+        if (!file) {
+            throw std::runtime_error("Could not write file: " + temporary);
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct QuickPickEntry {
+    std::string line;
+    std::string startStop;
+    std::string destinationStop;
+    // Decayed number of sales; one sale adds 1.0
+    double score = 0.0;
+    std::int64_t lastSale = 0;
+};
+
+class QuickPickTable {
+public:
+    explicit QuickPickTable(std::string path, std::size_t capacity = 256, double halfLifeHours = 72.0);
+
+    void record(const std::string& line, const std::string& startStop, const std::string& destinationStop,
+                std::time_t now);
+    [[nodiscard]] std::vector<QuickPickEntry> top(std::size_t count, std::time_t now) const;
+    [[nodiscard]] std::size_t size() const;
+
+    void load();
+    void save() const;
+
+private:
+    std::string path;
+    std::size_t capacity;
+    double halfLifeSeconds;
+    std::vector<QuickPickEntry> entries;
+    mutable std::mutex mutex;
+
+    [[nodiscard]] double decayedScore(const QuickPickEntry& entry, std::time_t now) const;
+};
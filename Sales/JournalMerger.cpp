@@ -0,0 +1,461 @@
+#include "JournalMerger.hpp"
+#include "SalesJournal.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+const std::string JournalMerger::MERGED_HEADER = "# ticketautomat-merged v1";
+
+namespace {
+constexpr std::size_t MIN_READ_BUFFER = 64u << 10;
+constexpr std::size_t MAX_READ_BUFFER = 4u << 20;
+constexpr std::size_t WRITE_BUFFER = 4u << 20;
+
+// Collects output and writes it in large blocks
+class BufferedWriter {
+public:
+    explicit BufferedWriter(const std::string& path) : path(path) {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Could not write file: " + path);
+        }
+        buffer.reserve(WRITE_BUFFER);
+    }
+    ~BufferedWriter() {
+        if (fd >= 0) close(fd);
+    }
+
+    void writeLine(const std::string& text) {
+        if (buffer.size() + text.size() + 1 > WRITE_BUFFER) {
+            flush();
+        }
+        buffer += text;
+        buffer += '\n';
+    }
+
+    // Same as writeLine(JournalMerger::formatMergedRecord(record)) without the temporary string
+    void writeRecord(const JournalRecord& record) {
+        if (buffer.size() + record.machine.size() + record.text.size() + 2 > WRITE_BUFFER) {
+            flush();
+        }
+        buffer += record.machine;
+        buffer += '\t';
+        buffer += record.text;
+        buffer += '\n';
+    }
+
+    // Writes the rest and makes the file durable
+    void finish() {
+        flush();
+        const bool synced = fdatasync(fd) == 0;
+        close(fd);
+        fd = -1;
+        if (!synced) {
+            throw std::runtime_error("Could not write file: " + path);
+        }
+    }
+
+private:
+    std::string path;
+    int fd = -1;
+    std::string buffer;
+
+    void flush() {
+        std::size_t written = 0;
+        while (written < buffer.size()) {
+            const ssize_t n = write(fd, buffer.data() + written, buffer.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                throw std::runtime_error("Could not write file: " + path);
+            }
+            written += static_cast<std::size_t>(n);
+        }
+        buffer.clear();
+    }
+};
+
+// Merge order: time of sale, then machine, then serial (tickets of one purchase share a second)
+bool keyLess(const JournalRecord& a, const JournalRecord& b) {
+    if (a.timestamp != b.timestamp) return a.timestamp < b.timestamp;
+    const int machineOrder = a.machine.compare(b.machine);
+    if (machineOrder != 0) return machineOrder < 0;
+    return a.serial < b.serial;
+}
+
+bool sameKey(const JournalRecord& a, const JournalRecord& b) {
+    return a.timestamp == b.timestamp && a.serial == b.serial && a.machine == b.machine;
+}
+
+template <typename T>
+bool parseNumber(std::string_view text, T& value) {
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size() && !text.empty();
+}
+
+// Current record of one input
+struct Cursor {
+    std::unique_ptr<JournalReader> reader;
+    JournalRecord record;
+    // Key of the record read before, to notice inputs that are not ordered by time
+    bool hasPrevious = false;
+    JournalRecord previous;
+};
+
+/**
+ * One k-way merge over at most maxOpenFiles inputs. Records are compared by key
+ * and passed on as read, without parsing the rest. Duplicates are dropped here;
+ * serial gaps and reused serials are only checked in the final pass, where every
+ * sale of a machine comes by.
+ */
+void mergePass(const std::vector<std::string>& paths, const JournalMerger::Sink& sink, const MergeConfig& config,
+               MergeReport& report, bool finalPass, bool originalInputs) {
+    const std::size_t bufferBytes =
+        std::clamp(config.memoryBudget / std::max<std::size_t>(paths.size(), 1), MIN_READ_BUFFER, MAX_READ_BUFFER);
+
+    std::vector<Cursor> cursors(paths.size());
+    auto advance = [&](std::size_t index) {
+        Cursor& cursor = cursors[index];
+        if (!cursor.reader->next(cursor.record)) {
+            return false;
+        }
+        if (originalInputs) {
+            report.recordsRead++;
+            if (cursor.hasPrevious && keyLess(cursor.record, cursor.previous)) {
+                report.outOfOrder++;
+            }
+            cursor.hasPrevious = true;
+            cursor.previous.timestamp = cursor.record.timestamp;
+            cursor.previous.serial = cursor.record.serial;
+            cursor.previous.machine = cursor.record.machine;
+        }
+        return true;
+    };
+
+    // Min-heap of input indices by their current record
+    auto greater = [&cursors](std::size_t a, std::size_t b) {
+        const JournalRecord& x = cursors[a].record;
+        const JournalRecord& y = cursors[b].record;
+        if (keyLess(y, x)) return true;
+        if (keyLess(x, y)) return false;
+        return a > b;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> heap(greater);
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        cursors[i].reader = std::make_unique<JournalReader>(paths[i], bufferBytes);
+        if (advance(i)) {
+            heap.push(i);
+        }
+    }
+
+    bool hasLast = false;
+    JournalRecord last;
+    // Highest serial per machine; a few hundred entries for the whole fleet
+    std::unordered_map<std::string, std::uint32_t> highestSerial;
+
+    while (!heap.empty()) {
+        const std::size_t index = heap.top();
+        heap.pop();
+        Cursor& cursor = cursors[index];
+        const JournalRecord& record = cursor.record;
+
+        if (hasLast && sameKey(record, last)) {
+            if (record.text == last.text) {
+                report.duplicates++;
+            } else {
+                report.conflicts++;
+            }
+        } else {
+            if (finalPass) {
+                auto [highest, first] = highestSerial.try_emplace(record.machine, record.serial);
+                if (!first && record.serial > highest->second + 1) {
+                    report.gapCount++;
+                    report.missingSerials += record.serial - highest->second - 1;
+                    if (report.gaps.size() < config.maxReportedIssues) {
+                        report.gaps.push_back({record.machine, highest->second, record.serial});
+                    }
+                } else if (!first && record.serial <= highest->second) {
+                    report.duplicateSerialCount++;
+                    if (report.duplicateSerials.size() < config.maxReportedIssues) {
+                        report.duplicateSerials.push_back({record.machine, record.serial, record.timestamp});
+                    }
+                }
+                highest->second = std::max(highest->second, record.serial);
+                report.recordsWritten++;
+            }
+            sink(record);
+            hasLast = true;
+            // The cursor reads its next record into the swapped-out buffers
+            std::swap(last, cursor.record);
+        }
+
+        if (advance(index)) {
+            heap.push(index);
+        }
+    }
+}
+
+void removeAll(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) {
+        std::error_code ignored;
+        std::filesystem::remove(path, ignored);
+    }
+}
+}
+
+/**
+ * @brief Opens a journal and reads its header.
+ * @param path Journal of one machine or merged journal.
+ * @param bufferBytes Size of the read buffer; lines longer than this grow it.
+ * @throws std::runtime_error If the file cannot be opened or has no journal header.
+ */
+JournalReader::JournalReader(const std::string& path, std::size_t bufferBytes)
+    : path(path), buffer(std::max<std::size_t>(bufferBytes, 4096)) {
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    // Lets the kernel read ahead further than for random access
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    std::string_view header;
+    if (!nextLine(header)) {
+        throw std::runtime_error(path + ":1: missing journal header");
+    }
+    if (header == JournalMerger::MERGED_HEADER) {
+        merged = true;
+    } else if (header.substr(0, SalesJournal::HEADER_PREFIX.size()) == SalesJournal::HEADER_PREFIX) {
+        machineId.assign(header.substr(SalesJournal::HEADER_PREFIX.size()));
+    } else {
+        throw std::runtime_error(path + ":1: missing journal header");
+    }
+}
+
+JournalReader::~JournalReader() {
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * @brief Reads the next record without parsing more than its key.
+ * A truncated last line (power failure during a write) is ignored, as in SalesJournal::read().
+ * @param record Receives the record; its buffers are reused.
+ * @return False at the end of the journal.
+ * @throws std::runtime_error With file and line number if the record has the wrong
+ *         number of fields or a malformed serial or timestamp.
+ */
+bool JournalReader::next(JournalRecord& record) {
+    std::string_view line;
+    while (nextLine(line)) {
+        if (line.empty()) continue;
+        if (merged) {
+            const std::size_t tab = line.find('\t');
+            if (tab == std::string_view::npos) {
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) +
+                                         ": Invalid merged record: missing machine");
+            }
+            record.machine.assign(line.substr(0, tab));
+            line.remove_prefix(tab + 1);
+        } else {
+            record.machine = machineId;
+        }
+
+        // Fields: serial, timestamp, date, line, start, destination, price, change, code,
+        // and since batch, fare cap and departure are journaled also those three
+        const std::size_t firstTab = line.find('\t');
+        const std::size_t secondTab = firstTab == std::string_view::npos ? firstTab : line.find('\t', firstTab + 1);
+        const auto tabs = std::count(line.begin(), line.end(), '\t');
+        if ((tabs != 8 && tabs != 11) ||
+            !parseNumber(line.substr(0, firstTab), record.serial) ||
+            !parseNumber(line.substr(firstTab + 1, secondTab - firstTab - 1), record.timestamp)) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": Invalid journal record");
+        }
+        record.text.assign(line);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Reads the next sale with all fields.
+ * @param ticket Receives the sale.
+ * @param machine Receives the id of the machine that sold it.
+ * @return False at the end of the journal.
+ * @throws std::runtime_error With file and line number if a record is malformed.
+ */
+bool JournalReader::next(TicketData& ticket, std::string& machine) {
+    JournalRecord record;
+    if (!next(record)) {
+        return false;
+    }
+    try {
+        ticket = SalesJournal::parseRecord(record.text);
+    } catch (const std::runtime_error& e) {
+        throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+    }
+    machine = std::move(record.machine);
+    return true;
+}
+
+/**
+ * @brief Returns the next complete line; the view is valid until the next call.
+ */
+bool JournalReader::nextLine(std::string_view& line) {
+    while (true) {
+        const char* data = buffer.data();
+        const void* newline = std::memchr(data + begin, '\n', end - begin);
+        if (newline != nullptr) {
+            const std::size_t length = static_cast<const char*>(newline) - (data + begin);
+            line = std::string_view(data + begin, length);
+            begin += length + 1;
+            lineNumber++;
+            return true;
+        }
+        if (endOfFile || !fill()) {
+            // Bytes without newline at the end of the file: the write was interrupted
+            endOfFile = true;
+            begin = end;
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Reads the next block behind the unread rest of the buffer.
+ * @return False at the end of the file.
+ */
+bool JournalReader::fill() {
+    if (begin > 0) {
+        std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+        end -= begin;
+        begin = 0;
+    }
+    if (end == buffer.size()) {
+        // A single line longer than the buffer
+        buffer.resize(buffer.size() * 2);
+    }
+    while (true) {
+        const ssize_t n = read(fd, buffer.data() + end, buffer.size() - end);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            throw std::runtime_error("Could not read file: " + path);
+        }
+        end += static_cast<std::size_t>(n);
+        return n > 0;
+    }
+}
+
+/**
+ * @brief Merges sales journals into one history ordered by time of sale.
+ *
+ * Every input must be ordered by time, as journals written by a machine are;
+ * sales that are not are counted in outOfOrder. Memory stays bounded: one read
+ * buffer per input (memoryBudget in total) and one serial per machine. With more
+ * than maxOpenFiles inputs, groups are first merged into temporary files.
+ * The same sale in several inputs is passed on once. Gaps in the serials of a
+ * machine and serials used for two different sales are reported.
+ *
+ * @param paths Journals of single machines or merged journals, in any mix.
+ * @param sink Called once per sale in merged order.
+ * @param config Memory and file limits.
+ * @return Counts and the first gaps and reused serials.
+ * @throws std::runtime_error If an input is missing or malformed.
+ */
+MergeReport JournalMerger::merge(const std::vector<std::string>& paths, const Sink& sink, const MergeConfig& config) {
+    MergeReport report;
+    report.inputs = paths.size();
+    const std::size_t groupSize = std::max<std::size_t>(config.maxOpenFiles, 2);
+    const std::filesystem::path tempFolder =
+        config.tempFolder.empty() ? std::filesystem::temp_directory_path() : std::filesystem::path(config.tempFolder);
+
+    std::vector<std::string> current = paths;
+    std::vector<std::string> temporary;
+    bool originalInputs = true;
+    try {
+        while (current.size() > groupSize) {
+            std::vector<std::string> next;
+            for (std::size_t first = 0; first < current.size(); first += groupSize) {
+                const std::vector<std::string> group(current.begin() + first,
+                                                     current.begin() + std::min(first + groupSize, current.size()));
+                const std::string part = (tempFolder / ("journal-merge-" + std::to_string(getpid()) + "-" +
+                                                        std::to_string(report.passes) + "-" +
+                                                        std::to_string(next.size()))).string();
+                BufferedWriter writer(part);
+                next.push_back(part);
+                temporary.push_back(part);
+                writer.writeLine(MERGED_HEADER);
+                mergePass(group, [&writer](const JournalRecord& record) {
+                    writer.writeRecord(record);
+                }, config, report, false, originalInputs);
+                writer.finish();
+            }
+            // Parts of the previous pass are no longer needed
+            if (!originalInputs) {
+                removeAll(current);
+            }
+            current = next;
+            originalInputs = false;
+            report.passes++;
+        }
+        mergePass(current, sink, config, report, true, originalInputs);
+        report.passes++;
+    } catch (...) {
+        removeAll(temporary);
+        throw;
+    }
+    removeAll(temporary);
+    return report;
+}
+
+/**
+ * @brief Merges sales journals into a merged journal file.
+ *
+ * The file is written under a temporary name and renamed when complete, so
+ * readers never see half a history. Temporary parts go next to the output.
+ *
+ * @param paths Journals of single machines or merged journals.
+ * @param outputPath The merged journal.
+ * @param config Memory and file limits.
+ * @return Counts and the first gaps and reused serials.
+ * @throws std::runtime_error If an input is malformed or the output cannot be written.
+ */
+MergeReport JournalMerger::mergeToFile(const std::vector<std::string>& paths, const std::string& outputPath,
+                                       const MergeConfig& config) {
+    MergeConfig fileConfig = config;
+    const std::filesystem::path parent = std::filesystem::path(outputPath).parent_path();
+    if (fileConfig.tempFolder.empty()) {
+        fileConfig.tempFolder = parent.empty() ? "." : parent.string();
+    }
+    const std::string partial = outputPath + ".tmp";
+
+    MergeReport report;
+    try {
+        BufferedWriter writer(partial);
+        writer.writeLine(MERGED_HEADER);
+        report = merge(paths, [&writer](const JournalRecord& record) { writer.writeRecord(record); }, fileConfig);
+        writer.finish();
+    } catch (...) {
+        std::error_code ignored;
+        std::filesystem::remove(partial, ignored);
+        throw;
+    }
+    std::filesystem::rename(partial, outputPath);
+    return report;
+}
+
+/**
+ * @brief Formats one record of a merged journal: machine id, tab, journal record.
+ */
+std::string JournalMerger::formatMergedRecord(const JournalRecord& record) {
+    return record.machine + '\t' + record.text;
+}
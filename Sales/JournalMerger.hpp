@@ -0,0 +1,101 @@
+#pragma once
+#include "../TicketMachine/TicketMachine.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One journal record as read from a file; only the merge key is parsed
+struct JournalRecord {
+    std::string machine;
+    std::uint32_t serial = 0;
+    std::int64_t timestamp = 0;
+    // The record in journal format, without the machine
+    std::string text;
+};
+
+// Reads a sales journal front to back with large sequential reads. Accepts the
+// journal of one machine as well as a merged journal with the machine in every record.
+class JournalReader {
+public:
+    JournalReader(const std::string& path, std::size_t bufferBytes);
+    ~JournalReader();
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    bool next(JournalRecord& record);
+    bool next(TicketData& ticket, std::string& machine);
+    [[nodiscard]] const std::string& getPath() const { return path; }
+    [[nodiscard]] std::size_t getLineNumber() const { return lineNumber; }
+    [[nodiscard]] bool isMerged() const { return merged; }
+
+private:
+    std::string path;
+    int fd = -1;
+    std::vector<char> buffer;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    bool endOfFile = false;
+    bool merged = false;
+    std::string machineId;
+    std::size_t lineNumber = 0;
+
+    bool nextLine(std::string_view& line);
+    bool fill();
+};
+
+// Serials missing between two sales of one machine: after+1 .. next-1
+struct SerialGap {
+    std::string machine;
+    std::uint32_t after = 0;
+    std::uint32_t next = 0;
+};
+
+// A serial seen again with a different sale
+struct DuplicateSerial {
+    std::string machine;
+    std::uint32_t serial = 0;
+    std::int64_t timestamp = 0;
+};
+
+struct MergeConfig {
+    // Read buffers of all open inputs together; each input gets a share of 64 KiB to 4 MiB
+    std::size_t memoryBudget = 64u << 20;
+    // More inputs are merged in several passes over temporary files
+    std::size_t maxOpenFiles = 256;
+    // Details beyond this are only counted, so the report stays small for broken data
+    std::size_t maxReportedIssues = 1000;
+    // Where the temporary files of multi-pass merges go; empty for the system temp directory
+    std::string tempFolder;
+};
+
+struct MergeReport {
+    std::size_t inputs = 0;
+    std::size_t passes = 0;
+    std::size_t recordsRead = 0;
+    std::size_t recordsWritten = 0;
+    // Same sale in more than one input (e.g. a journal collected twice); written once
+    std::size_t duplicates = 0;
+    // Same machine, serial and time but different content; the first one is kept
+    std::size_t conflicts = 0;
+    // Sales whose time lies before the previous sale of the same input (clock set back)
+    std::size_t outOfOrder = 0;
+    std::size_t missingSerials = 0;
+    std::size_t duplicateSerialCount = 0;
+    std::vector<SerialGap> gaps;
+    std::vector<DuplicateSerial> duplicateSerials;
+    std::size_t gapCount = 0;
+};
+
+class JournalMerger {
+public:
+    using Sink = std::function<void(const JournalRecord& record)>;
+
+    static MergeReport merge(const std::vector<std::string>& paths, const Sink& sink, const MergeConfig& config);
+    static MergeReport mergeToFile(const std::vector<std::string>& paths, const std::string& outputPath,
+                                   const MergeConfig& config);
+    static std::string formatMergedRecord(const JournalRecord& record);
+
+    static const std::string MERGED_HEADER;
+};
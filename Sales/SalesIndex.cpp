@@ -0,0 +1,534 @@
+#include "SalesIndex.hpp"
+#include "SalesJournal.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char SERIAL_MAGIC[8] = {'T', 'K', 'S', 'E', 'R', 'I', 'X', '1'};
+constexpr char DATE_MAGIC[8] = {'T', 'K', 'D', 'A', 'T', 'E', 'X', '1'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_BYTES = 16;
+constexpr std::size_t ENTRY_BYTES = sizeof(SalesIndexEntry);
+constexpr std::size_t READ_BYTES = 64 * 1024;
+constexpr std::uint64_t TO_END = std::numeric_limits<std::uint64_t>::max();
+
+// Closes a file descriptor of the read paths when it goes out of scope
+struct ReadFile {
+    int fd;
+    explicit ReadFile(const std::string& path) : fd(::open(path.c_str(), O_RDONLY)) {}
+    ~ReadFile() {
+        if (fd >= 0) ::close(fd);
+    }
+    ReadFile(const ReadFile&) = delete;
+    ReadFile& operator=(const ReadFile&) = delete;
+};
+
+std::uint64_t fileSize(int fd) {
+    struct stat info {};
+    return fstat(fd, &info) == 0 ? static_cast<std::uint64_t>(info.st_size) : 0;
+}
+
+bool readAt(int fd, void* out, std::size_t bytes, std::uint64_t offset) {
+    return pread(fd, out, bytes, static_cast<off_t>(offset)) == static_cast<ssize_t>(bytes);
+}
+
+SalesIndexEntry readEntry(int fd, std::uint64_t index) {
+    SalesIndexEntry entry;
+    if (!readAt(fd, &entry, ENTRY_BYTES, HEADER_BYTES + index * ENTRY_BYTES)) {
+        throw std::runtime_error("Could not read sales index");
+    }
+    return entry;
+}
+
+// Checks magic and version and returns the stride, or false for a foreign or damaged file
+bool readHeader(int fd, bool serials, std::uint32_t& stride) {
+    char header[HEADER_BYTES];
+    std::uint32_t version = 0;
+    if (!readAt(fd, header, sizeof(header), 0) ||
+        std::memcmp(header, serials ? SERIAL_MAGIC : DATE_MAGIC, sizeof(SERIAL_MAGIC)) != 0) {
+        return false;
+    }
+    std::memcpy(&version, header + 8, 4);
+    std::memcpy(&stride, header + 12, 4);
+    return version == VERSION && (fileSize(fd) - HEADER_BYTES) % ENTRY_BYTES == 0;
+}
+
+// Writes a complete index under a temporary name and renames it into place
+void writeFile(const std::string& path, bool serials, std::uint32_t stride,
+               const std::vector<SalesIndexEntry>& entries) {
+    const std::string next = path + ".new";
+    const int fd = ::open(next.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write file: " + next);
+    }
+    std::string data(HEADER_BYTES + entries.size() * ENTRY_BYTES, '\0');
+    std::memcpy(data.data(), serials ? SERIAL_MAGIC : DATE_MAGIC, sizeof(SERIAL_MAGIC));
+    std::memcpy(data.data() + 8, &VERSION, 4);
+    std::memcpy(data.data() + 12, &stride, 4);
+    if (!entries.empty()) {
+        std::memcpy(data.data() + HEADER_BYTES, entries.data(), entries.size() * ENTRY_BYTES);
+    }
+    const bool written = write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && fsync(fd) == 0;
+    ::close(fd);
+    if (!written) {
+        std::filesystem::remove(next);
+        throw std::runtime_error("Could not write file: " + next);
+    }
+    std::filesystem::rename(next, path);
+}
+
+std::string describe(const SalesIndexEntry& entry) {
+    return "key " + std::to_string(entry.key) + ", serial " + std::to_string(entry.serial) + ", offset " +
+           std::to_string(entry.offset);
+}
+}
+
+static_assert(sizeof(SalesIndexEntry) == 16, "Sales index entry layout changed");
+
+/**
+ * @brief Creates the indexes of a journal; call open() before adding sales.
+ * Lookups work without open() and never write.
+ * @param journalPath Journal file, e.g. state/sales.journal.
+ * @param stride Every how many records the serial index gets an entry.
+ */
+SalesIndex::SalesIndex(std::string journalPath, std::uint32_t stride)
+    : journalPath(std::move(journalPath)), stride(std::max<std::uint32_t>(stride, 1)) {}
+
+SalesIndex::~SalesIndex() {
+    close();
+}
+
+void SalesIndex::close() {
+    if (serialFd >= 0) ::close(serialFd);
+    if (dateFd >= 0) ::close(dateFd);
+    serialFd = -1;
+    dateFd = -1;
+}
+
+std::string SalesIndex::serialPath(const std::string& journalPath) {
+    return journalPath + ".serials";
+}
+
+std::string SalesIndex::datePath(const std::string& journalPath) {
+    return journalPath + ".dates";
+}
+
+/**
+ * @brief Turns a sale date into the key of the date index.
+ * @param date Date as YYYY-MM-DD.
+ * @return The date as YYYYMMDD, or 0 if it is malformed.
+ */
+std::uint32_t SalesIndex::dateKey(const std::string& date) {
+    if (date.size() != 10 || date[4] != '-' || date[7] != '-') {
+        return 0;
+    }
+    std::uint32_t key = 0;
+    for (std::size_t i = 0; i < date.size(); ++i) {
+        if (i == 4 || i == 7) continue;
+        if (!std::isdigit(static_cast<unsigned char>(date[i]))) return 0;
+        key = key * 10 + static_cast<std::uint32_t>(date[i] - '0');
+    }
+    const std::uint32_t month = key / 100 % 100;
+    const std::uint32_t day = key % 100;
+    return month >= 1 && month <= 12 && day >= 1 && day <= 31 ? key : 0;
+}
+
+/**
+ * @brief Opens the indexes for adding sales and brings them up to date with the journal.
+ * Sales appended while the index was not open are indexed now; this reads only the records
+ * after the last entries. Missing, foreign or damaged index files are rebuilt.
+ * @return True if the indexes had to be rebuilt.
+ * @throws std::runtime_error If the journal cannot be read or an index cannot be written.
+ */
+bool SalesIndex::open() {
+    close();
+    std::uint64_t journalBytes = 0;
+    {
+        ReadFile journal(journalPath);
+        if (journal.fd >= 0) journalBytes = fileSize(journal.fd);
+    }
+
+    SalesIndexEntry lastSerial;
+    SalesIndexEntry lastDateEntry;
+    bool hasSerial = false;
+    bool hasDate = false;
+    const auto check = [&]() {
+        return checkFile(serialPath(journalPath), true, journalBytes, lastSerial, hasSerial) &&
+               checkFile(datePath(journalPath), false, journalBytes, lastDateEntry, hasDate);
+    };
+    bool rebuilt = false;
+    if (!check()) {
+        rebuild();
+        rebuilt = true;
+        if (!check()) {
+            throw std::runtime_error("Could not rebuild sales index of " + journalPath);
+        }
+    }
+
+    serialFd = ::open(serialPath(journalPath).c_str(), O_WRONLY | O_APPEND);
+    dateFd = ::open(datePath(journalPath).c_str(), O_WRONLY | O_APPEND);
+    if (serialFd < 0 || dateFd < 0) {
+        close();
+        throw std::runtime_error("Could not write file: " + serialPath(journalPath));
+    }
+
+    // Catch up from the older of the two last entries; records up to an entry are indexed already
+    serialStarted = false;
+    sinceEntry = 0;
+    dateStarted = false;
+    lastDate = 0;
+    if (journalBytes == 0) {
+        return rebuilt;
+    }
+    const std::uint64_t begin = std::min(hasSerial ? lastSerial.offset : 0, hasDate ? lastDateEntry.offset : 0);
+    scanJournal(begin, TO_END, [&](const TicketData& ticket, std::uint64_t offset) {
+        if (hasSerial && offset == lastSerial.offset) {
+            serialStarted = true;
+            sinceEntry = 0;
+        } else if (!hasSerial || offset > lastSerial.offset) {
+            noteSerial(ticket, offset, nullptr);
+        }
+        if (hasDate && offset == lastDateEntry.offset) {
+            dateStarted = true;
+            lastDate = lastDateEntry.key;
+        } else if (!hasDate || offset > lastDateEntry.offset) {
+            noteDate(ticket, offset, nullptr);
+        }
+        return true;
+    });
+    return rebuilt;
+}
+
+/**
+ * @brief Indexes a sale that was just appended to the journal.
+ * Writes an entry only for every STRIDE-th sale and the first sale of a day.
+ * @param ticket The sale.
+ * @param offset Byte offset of its record in the journal.
+ * @throws std::runtime_error If the index is not open or cannot be written.
+ */
+void SalesIndex::add(const TicketData& ticket, std::uint64_t offset) {
+    if (serialFd < 0 || dateFd < 0) {
+        throw std::runtime_error("Sales index is not open");
+    }
+    noteSerial(ticket, offset, nullptr);
+    noteDate(ticket, offset, nullptr);
+}
+
+void SalesIndex::noteSerial(const TicketData& ticket, std::uint64_t offset, std::vector<SalesIndexEntry>* entries) {
+    if (serialStarted && ++sinceEntry < stride) {
+        return;
+    }
+    const SalesIndexEntry entry{ticket.serial, ticket.serial, offset};
+    if (entries != nullptr) {
+        entries->push_back(entry);
+    } else if (write(serialFd, &entry, ENTRY_BYTES) != static_cast<ssize_t>(ENTRY_BYTES)) {
+        throw std::runtime_error("Could not write file: " + serialPath(journalPath));
+    }
+    serialStarted = true;
+    sinceEntry = 0;
+}
+
+void SalesIndex::noteDate(const TicketData& ticket, std::uint64_t offset, std::vector<SalesIndexEntry>* entries) {
+    const std::uint32_t date = dateKey(ticket.date);
+    if (dateStarted && date == lastDate) {
+        return;
+    }
+    const SalesIndexEntry entry{date, ticket.serial, offset};
+    if (entries != nullptr) {
+        entries->push_back(entry);
+    } else if (write(dateFd, &entry, ENTRY_BYTES) != static_cast<ssize_t>(ENTRY_BYTES)) {
+        throw std::runtime_error("Could not write file: " + datePath(journalPath));
+    }
+    dateStarted = true;
+    lastDate = date;
+}
+
+/**
+ * @brief Writes both indexes from scratch by reading the whole journal.
+ * The new files replace the old ones atomically, so readers never see a half-written index.
+ * @throws std::runtime_error If the journal is malformed or an index cannot be written.
+ */
+void SalesIndex::rebuild() {
+    close();
+    serialStarted = false;
+    sinceEntry = 0;
+    dateStarted = false;
+    lastDate = 0;
+    std::vector<SalesIndexEntry> serials;
+    std::vector<SalesIndexEntry> dates;
+    if (std::filesystem::exists(journalPath)) {
+        scanJournal(0, TO_END, [&](const TicketData& ticket, std::uint64_t offset) {
+            noteSerial(ticket, offset, &serials);
+            noteDate(ticket, offset, &dates);
+            return true;
+        });
+    }
+    const std::filesystem::path parent = std::filesystem::path(journalPath).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+    writeFile(serialPath(journalPath), true, stride, serials);
+    writeFile(datePath(journalPath), false, 0, dates);
+}
+
+/**
+ * @brief Checks the header of an index file and that its last entry points at the right record.
+ * @return False if the file is missing, foreign or does not match the journal.
+ */
+bool SalesIndex::checkFile(const std::string& path, bool serials, std::uint64_t journalBytes, SalesIndexEntry& last,
+                           bool& hasLast) const {
+    ReadFile file(path);
+    std::uint32_t fileStride = 0;
+    if (file.fd < 0 || !readHeader(file.fd, serials, fileStride) || fileStride != (serials ? stride : 0)) {
+        return false;
+    }
+    const std::uint64_t count = (fileSize(file.fd) - HEADER_BYTES) / ENTRY_BYTES;
+    hasLast = count > 0;
+    if (!hasLast) {
+        return true;
+    }
+    last = readEntry(file.fd, count - 1);
+    if (last.offset == 0 || last.offset >= journalBytes) {
+        return false;
+    }
+
+    // The entry must start a record, i.e. follow a newline, and name that record
+    ReadFile journal(journalPath);
+    char before = 0;
+    if (journal.fd < 0 || !readAt(journal.fd, &before, 1, last.offset - 1) || before != '\n') {
+        return false;
+    }
+    bool matches = false;
+    try {
+        scanJournal(last.offset, TO_END, [&](const TicketData& ticket, std::uint64_t offset) {
+            matches = offset == last.offset && ticket.serial == last.serial &&
+                      (serials ? ticket.serial == last.key : dateKey(ticket.date) == last.key);
+            return false;
+        });
+    } catch (const std::runtime_error&) {
+        return false;
+    }
+    return matches;
+}
+
+/**
+ * @brief Reads all entries of an index file.
+ * @param fileStride Receives the stride from the header, if not nullptr.
+ * @throws std::runtime_error If the file is missing or not an index of this kind.
+ */
+std::vector<SalesIndexEntry> SalesIndex::readEntries(const std::string& path, bool serials,
+                                                     std::uint32_t* fileStride) {
+    ReadFile file(path);
+    if (file.fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    std::uint32_t stride = 0;
+    if (!readHeader(file.fd, serials, stride)) {
+        throw std::runtime_error(path + ": not a sales index or damaged");
+    }
+    if (fileStride != nullptr) *fileStride = stride;
+    std::vector<SalesIndexEntry> entries((fileSize(file.fd) - HEADER_BYTES) / ENTRY_BYTES);
+    if (!entries.empty() && !readAt(file.fd, entries.data(), entries.size() * ENTRY_BYTES, HEADER_BYTES)) {
+        throw std::runtime_error("Could not read file: " + path);
+    }
+    return entries;
+}
+
+/**
+ * @brief Finds a sale by its serial number.
+ * A binary search over the serial index finds the last entry at or before the serial;
+ * then at most STRIDE records from that offset are read.
+ * @param serial The serial number.
+ * @param ticket Receives the sale if found.
+ * @return True if the journal contains the serial.
+ * @throws std::runtime_error If the index is missing or does not match the journal.
+ */
+bool SalesIndex::findSerial(std::uint32_t serial, TicketData& ticket) const {
+    const std::string path = serialPath(journalPath);
+    ReadFile file(path);
+    std::uint32_t fileStride = 0;
+    if (file.fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    if (!readHeader(file.fd, true, fileStride)) {
+        throw std::runtime_error(path + ": not a sales index or damaged");
+    }
+    const std::uint64_t count = (fileSize(file.fd) - HEADER_BYTES) / ENTRY_BYTES;
+
+    // First entry with a larger serial; the one before it starts the segment to read
+    std::uint64_t low = 0;
+    std::uint64_t high = count;
+    while (low < high) {
+        const std::uint64_t middle = low + (high - low) / 2;
+        if (readEntry(file.fd, middle).key <= serial) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == 0) {
+        return false;
+    }
+    const SalesIndexEntry entry = readEntry(file.fd, low - 1);
+    const std::uint64_t end = low < count ? readEntry(file.fd, low).offset : TO_END;
+
+    bool first = true;
+    bool found = false;
+    scanJournal(entry.offset, end, [&](const TicketData& sale, std::uint64_t) {
+        if (first && sale.serial != entry.serial) {
+            throw std::runtime_error(path + " does not match the journal; rebuild the index");
+        }
+        first = false;
+        if (sale.serial == serial) {
+            ticket = sale;
+            found = true;
+        }
+        return !found && sale.serial < serial;
+    });
+    if (first) {
+        throw std::runtime_error(path + " does not match the journal; rebuild the index");
+    }
+    return found;
+}
+
+/**
+ * @brief Finds all sales of a date range in journal order.
+ * Reads only the days inside the range, one segment per date index entry.
+ * @param from First date, YYYY-MM-DD.
+ * @param to Last date, YYYY-MM-DD.
+ * @return The sales.
+ * @throws std::runtime_error If a date is malformed or the index is missing or does not match the journal.
+ */
+std::vector<TicketData> SalesIndex::findDates(const std::string& from, const std::string& to) const {
+    const std::uint32_t first = dateKey(from);
+    const std::uint32_t last = dateKey(to);
+    if (first == 0 || last == 0) {
+        throw std::runtime_error("Invalid date: " + (first == 0 ? from : to) + " (expected YYYY-MM-DD)");
+    }
+    const std::string path = datePath(journalPath);
+    const std::vector<SalesIndexEntry> entries = readEntries(path, false);
+
+    std::vector<TicketData> sales;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const SalesIndexEntry& entry = entries[i];
+        if (entry.key < first || entry.key > last) continue;
+        // The last segment runs to the end and may hold sales not indexed yet, so dates are checked
+        const std::uint64_t end = i + 1 < entries.size() ? entries[i + 1].offset : TO_END;
+        bool start = true;
+        scanJournal(entry.offset, end, [&](const TicketData& sale, std::uint64_t) {
+            if (start && sale.serial != entry.serial) {
+                throw std::runtime_error(path + " does not match the journal; rebuild the index");
+            }
+            start = false;
+            const std::uint32_t date = dateKey(sale.date);
+            if (date >= first && date <= last) {
+                sales.push_back(sale);
+            }
+            return true;
+        });
+    }
+    return sales;
+}
+
+/**
+ * @brief Compares both index files with indexes built from the journal.
+ * @return Empty if both match, otherwise a description of the first difference.
+ * @throws std::runtime_error If the journal cannot be read.
+ */
+std::string SalesIndex::verify() const {
+    SalesIndex expected(journalPath, stride);
+    std::vector<SalesIndexEntry> expectedSerials;
+    std::vector<SalesIndexEntry> expectedDates;
+    if (std::filesystem::exists(journalPath)) {
+        scanJournal(0, TO_END, [&](const TicketData& ticket, std::uint64_t offset) {
+            expected.noteSerial(ticket, offset, &expectedSerials);
+            expected.noteDate(ticket, offset, &expectedDates);
+            return true;
+        });
+    }
+
+    for (const bool serials : {true, false}) {
+        const std::string path = serials ? serialPath(journalPath) : datePath(journalPath);
+        const auto& wanted = serials ? expectedSerials : expectedDates;
+        std::vector<SalesIndexEntry> entries;
+        std::uint32_t fileStride = 0;
+        try {
+            entries = readEntries(path, serials, &fileStride);
+        } catch (const std::runtime_error& e) {
+            return e.what();
+        }
+        if (serials && fileStride != stride) {
+            return path + ": stride " + std::to_string(fileStride) + ", expected " + std::to_string(stride);
+        }
+        for (std::size_t i = 0; i < std::min(entries.size(), wanted.size()); ++i) {
+            if (std::memcmp(&entries[i], &wanted[i], ENTRY_BYTES) != 0) {
+                return path + ": entry " + std::to_string(i) + " is " + describe(entries[i]) + ", expected " +
+                       describe(wanted[i]);
+            }
+        }
+        if (entries.size() != wanted.size()) {
+            return path + ": " + std::to_string(entries.size()) + " entries, expected " +
+                   std::to_string(wanted.size());
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Reads the journal records in [begin, end) with large positioned reads.
+ * The header line is skipped; a last line without newline (interrupted write) is ignored,
+ * as in SalesJournal::read.
+ * @param begin Offset of the first record.
+ * @param end Offset after the last record, or TO_END.
+ * @param onRecord Called per record with its offset; returning false stops the scan.
+ * @throws std::runtime_error If the journal cannot be read or a record is malformed.
+ */
+void SalesIndex::scanJournal(std::uint64_t begin, std::uint64_t end, const RecordCallback& onRecord) const {
+    ReadFile journal(journalPath);
+    if (journal.fd < 0) {
+        throw std::runtime_error("Could not open file: " + journalPath);
+    }
+    std::vector<char> buffer(READ_BYTES);
+    std::string line;
+    std::uint64_t position = begin;
+    std::uint64_t lineStart = begin;
+    while (position < end) {
+        const auto wanted = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), end - position));
+        const ssize_t got = pread(journal.fd, buffer.data(), wanted, static_cast<off_t>(position));
+        if (got < 0) {
+            throw std::runtime_error("Could not read file: " + journalPath);
+        }
+        if (got == 0) {
+            break;
+        }
+        std::size_t from = 0;
+        for (std::size_t i = 0; i < static_cast<std::size_t>(got); ++i) {
+            if (buffer[i] != '\n') continue;
+            line.append(buffer.data() + from, i - from);
+            if (!line.empty() && line[0] != '#') {
+                TicketData ticket;
+                try {
+                    ticket = SalesJournal::parseRecord(line);
+                } catch (const std::runtime_error& e) {
+                    throw std::runtime_error(journalPath + ": offset " + std::to_string(lineStart) + ": " + e.what());
+                }
+                if (!onRecord(ticket, lineStart)) {
+                    return;
+                }
+            }
+            line.clear();
+            from = i + 1;
+            lineStart = position + from;
+        }
+        line.append(buffer.data() + from, static_cast<std::size_t>(got) - from);
+        position += static_cast<std::uint64_t>(got);
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "../TicketMachine/TicketMachine.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Entry of an index file: the journal record at offset has the given serial;
+// key is the serial in <journal>.serials and the sale date (YYYYMMDD) in <journal>.dates
+struct SalesIndexEntry {
+    std::uint32_t key = 0;
+    std::uint32_t serial = 0;
+    std::uint64_t offset = 0;
+};
+
+// Sparse indexes next to a sales journal, so a sale is found by serial or date with a
+// few reads instead of a scan over months of records. <journal>.serials points at every
+// STRIDE-th record, <journal>.dates at the first record of every day. Both only speed up
+// reading and are rebuilt from the journal when missing or damaged.
+class SalesIndex {
+public:
+    static constexpr std::uint32_t DEFAULT_STRIDE = 64;
+
+    explicit SalesIndex(std::string journalPath, std::uint32_t stride = DEFAULT_STRIDE);
+    ~SalesIndex();
+    SalesIndex(const SalesIndex&) = delete;
+    SalesIndex& operator=(const SalesIndex&) = delete;
+
+    bool open();
+    void add(const TicketData& ticket, std::uint64_t offset);
+    void rebuild();
+
+    [[nodiscard]] bool findSerial(std::uint32_t serial, TicketData& ticket) const;
+    [[nodiscard]] std::vector<TicketData> findDates(const std::string& from, const std::string& to) const;
+    [[nodiscard]] std::string verify() const;
+
+    static std::string serialPath(const std::string& journalPath);
+    static std::string datePath(const std::string& journalPath);
+    static std::uint32_t dateKey(const std::string& date);
+
+private:
+    using RecordCallback = std::function<bool(const TicketData& ticket, std::uint64_t offset)>;
+
+    std::string journalPath;
+    std::uint32_t stride;
+    int serialFd = -1;
+    int dateFd = -1;
+    // Writer state: records since the last serial entry and the date of the last date entry
+    bool serialStarted = false;
+    std::uint32_t sinceEntry = 0;
+    bool dateStarted = false;
+    std::uint32_t lastDate = 0;
+
+    void close();
+    // Append an entry if the record needs one; to the vector if given, else to the open file
+    void noteSerial(const TicketData& ticket, std::uint64_t offset, std::vector<SalesIndexEntry>* entries);
+    void noteDate(const TicketData& ticket, std::uint64_t offset, std::vector<SalesIndexEntry>* entries);
+    [[nodiscard]] bool checkFile(const std::string& path, bool serials, std::uint64_t journalBytes,
+                                 SalesIndexEntry& last, bool& hasLast) const;
+    static std::vector<SalesIndexEntry> readEntries(const std::string& path, bool serials,
+                                                    std::uint32_t* fileStride = nullptr);
+    void scanJournal(std::uint64_t begin, std::uint64_t end, const RecordCallback& onRecord) const;
+};
@@ -0,0 +1,274 @@
+#include "SalesJournal.hpp"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+const std::string SalesJournal::HEADER_PREFIX = "# ticketautomat-journal v1 machine=";
+
+namespace {
+// Records written before batch, fare cap and departure were journaled have 9 fields;
+// a journal can hold both after an update, so the version is told per record
+constexpr std::size_t V1_FIELD_COUNT = 9;
+constexpr std::size_t FIELD_COUNT = 12;
+
+// Stop and line names come from user-edited files, so separators are escaped
+std::string escape(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char c : value) {
+        switch (c) {
+            case '\\': escaped += "\\\\"; break;
+            case '\t': escaped += "\\t"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string unescape(const std::string& value) {
+    std::string plain;
+    plain.reserve(value.size());
+    for (std::size_t i = 0; i < value.size(); ++i) {
+        if (value[i] != '\\' || i + 1 == value.size()) {
+            plain += value[i];
+            continue;
+        }
+        const char next = value[++i];
+        plain += next == 't' ? '\t' : next == 'n' ? '\n' : next == 'r' ? '\r' : next;
+    }
+    return plain;
+}
+
+std::string formatChange(const std::map<int, int>& change) {
+    std::string text;
+    for (const auto& [value, count] : change) {
+        if (count == 0) continue;
+        if (!text.empty()) text += ',';
+        text += std::to_string(value) + "x" + std::to_string(count);
+    }
+    return text.empty() ? "-" : text;
+}
+
+std::map<int, int> parseChange(const std::string& text) {
+    std::map<int, int> change;
+    if (text == "-") {
+        return change;
+    }
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const std::size_t separator = item.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Invalid change: " + text);
+        }
+        change[std::stoi(item.substr(0, separator))] = std::stoi(item.substr(separator + 1));
+    }
+    return change;
+}
+
+// Cuts an unterminated last record (power failure during a write) so the next
+// record does not get glued onto it. Returns the new size, or -1 on error.
+off_t trimTornRecord(int fd, off_t size) {
+    char buffer[512];
+    off_t end = size;
+    while (end > 0) {
+        const off_t begin = end > static_cast<off_t>(sizeof(buffer)) ? end - static_cast<off_t>(sizeof(buffer)) : 0;
+        const auto length = static_cast<std::size_t>(end - begin);
+        if (pread(fd, buffer, length, begin) != static_cast<ssize_t>(length)) {
+            return -1;
+        }
+        for (std::size_t i = length; i > 0; --i) {
+            if (buffer[i - 1] == '\n') {
+                const off_t kept = begin + static_cast<off_t>(i);
+                if (kept == size) return size;
+                return ftruncate(fd, kept) == 0 ? kept : -1;
+            }
+        }
+        end = begin;
+    }
+    // Not even the header was completed
+    return ftruncate(fd, 0) == 0 ? 0 : -1;
+}
+}
+
+/**
+ * @brief Opens the sales journal of one machine; the file is created on the first sale.
+ * @param path Journal file, e.g. state/sales.journal.
+ * @param machineId Id of this machine, written to the journal header.
+ */
+SalesJournal::SalesJournal(std::string path, std::string machineId)
+    : path(std::move(path)), machineId(std::move(machineId)) {}
+
+/**
+ * @brief Opens the serial and date index of the journal and keeps it up to date from now on.
+ * @return True if the index was missing or damaged and has been rebuilt from the journal.
+ * @throws std::runtime_error If the index cannot be opened; sales are then journaled without it.
+ */
+bool SalesJournal::openIndex() {
+    std::lock_guard<std::mutex> lock(mutex);
+    index.reset();
+    auto opened = std::make_unique<SalesIndex>(path);
+    const bool rebuilt = opened->open();
+    index = std::move(opened);
+    return rebuilt;
+}
+
+/**
+ * @brief Appends one sale and flushes it to disk before returning.
+ * A torn last record left by a power failure is cut off first, as read() skips it anyway.
+ * The sale is indexed afterwards; if that fails, the index is dropped and caught up at the next openIndex().
+ * @param ticket The sold ticket.
+ * @throws std::runtime_error If the journal cannot be written.
+ */
+void SalesJournal::append(const TicketData& ticket) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+
+    const int fd = open(path.c_str(), O_RDWR | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+
+    std::string text;
+    const off_t end = lseek(fd, 0, SEEK_END);
+    const off_t size = end > 0 ? trimTornRecord(fd, end) : end;
+    if (size < 0) {
+        close(fd);
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    // A new journal starts with its header
+    if (size == 0) {
+        text = HEADER_PREFIX + machineId + "\n";
+    }
+    const auto offset = static_cast<std::uint64_t>(size) + text.size();
+    text += formatRecord(ticket) + "\n";
+
+    const bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()) &&
+                         fdatasync(fd) == 0;
+    close(fd);
+    if (!written) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+
+    // The sale is durable; a failing index must not fail it
+    if (index) {
+        try {
+            index->add(ticket, offset);
+        } catch (const std::runtime_error&) {
+            index.reset();
+        }
+    }
+}
+
+/**
+ * @brief Formats a ticket as one tab-separated journal record (without newline).
+ * Fields: serial, timestamp, date, line, start, destination, price, change, code,
+ * batch ("index/size"), fare cap discount, departure. Everything a reprint shows is kept.
+ * @param ticket The ticket.
+ * @return The record.
+ */
+std::string SalesJournal::formatRecord(const TicketData& ticket) {
+    return std::to_string(ticket.serial) + '\t' + std::to_string(ticket.timestamp) + '\t' + ticket.date + '\t' +
+           escape(ticket.tram) + '\t' + escape(ticket.startStop) + '\t' + escape(ticket.destinationStop) + '\t' +
+           std::to_string(ticket.price) + '\t' + formatChange(ticket.change) + '\t' +
+           (ticket.code.empty() ? "-" : ticket.code) + '\t' + std::to_string(ticket.batchIndex) + '/' +
+           std::to_string(ticket.batchSize) + '\t' + std::to_string(ticket.capDiscount) + '\t' +
+           (ticket.departure.empty() ? "-" : escape(ticket.departure));
+}
+
+/**
+ * @brief Parses one journal record.
+ * Records with only the first 9 fields (older journals) read as single tickets without cap or departure.
+ * @param record The record without newline.
+ * @return The ticket.
+ * @throws std::runtime_error If the record is malformed.
+ */
+TicketData SalesJournal::parseRecord(const std::string& record) {
+    std::vector<std::string> fields;
+    std::size_t begin = 0;
+    while (true) {
+        const std::size_t tab = record.find('\t', begin);
+        fields.push_back(record.substr(begin, tab - begin));
+        if (tab == std::string::npos) break;
+        begin = tab + 1;
+    }
+    if (fields.size() != FIELD_COUNT && fields.size() != V1_FIELD_COUNT) {
+        throw std::runtime_error("Invalid journal record: expected " + std::to_string(FIELD_COUNT) + " fields");
+    }
+
+    TicketData ticket;
+    try {
+        ticket.serial = static_cast<std::uint32_t>(std::stoul(fields[0]));
+        ticket.timestamp = std::stoll(fields[1]);
+        ticket.price = std::stoi(fields[6]);
+        ticket.change = parseChange(fields[7]);
+        if (fields.size() == FIELD_COUNT) {
+            const std::size_t slash = fields[9].find('/');
+            if (slash == std::string::npos) {
+                throw std::runtime_error("Invalid journal record: malformed batch");
+            }
+            ticket.batchIndex = std::stoi(fields[9].substr(0, slash));
+            ticket.batchSize = std::stoi(fields[9].substr(slash + 1));
+            ticket.capDiscount = std::stoi(fields[10]);
+        }
+    } catch (const std::logic_error&) {
+        throw std::runtime_error("Invalid journal record: malformed number");
+    }
+    ticket.date = fields[2];
+    ticket.tram = unescape(fields[3]);
+    ticket.startStop = unescape(fields[4]);
+    ticket.destinationStop = unescape(fields[5]);
+    ticket.code = fields[8] == "-" ? "" : fields[8];
+    if (fields.size() == FIELD_COUNT && fields[11] != "-") {
+        ticket.departure = unescape(fields[11]);
+    }
+    return ticket;
+}
+
+/**
+ * @brief Reads a journal and passes every sale to a callback.
+ * A truncated last line (power failure during a write) is ignored.
+ * @param path Journal file.
+ * @param onSale Called once per sale in file order.
+ * @return The machine id from the journal header.
+ * @throws std::runtime_error If the file is missing or a record is malformed.
+ */
+std::string SalesJournal::read(const std::string& path, const std::function<void(const TicketData&)>& onSale) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    std::string line;
+    if (!std::getline(file, line) || line.rfind(HEADER_PREFIX, 0) != 0) {
+        throw std::runtime_error(path + ":1: missing journal header");
+    }
+    const std::string machine = line.substr(HEADER_PREFIX.size());
+
+    std::size_t lineNumber = 1;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (file.eof()) {
+            // No newline at the end: the write was interrupted
+            break;
+        }
+        if (line.empty()) continue;
+        try {
+            onSale(parseRecord(line));
+        } catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+        }
+    }
+    return machine;
+}
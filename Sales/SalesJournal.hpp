@@ -0,0 +1,30 @@
+#pragma once
+#include "../TicketMachine/TicketMachine.hpp"
+#include "SalesIndex.hpp"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+class SalesJournal {
+public:
+    SalesJournal(std::string path, std::string machineId);
+
+    bool openIndex();
+    void append(const TicketData& ticket);
+    [[nodiscard]] bool isIndexed() const { return index != nullptr; }
+    [[nodiscard]] const std::string& getMachineId() const { return machineId; }
+
+    static std::string read(const std::string& path, const std::function<void(const TicketData&)>& onSale);
+    static std::string formatRecord(const TicketData& ticket);
+    static TicketData parseRecord(const std::string& record);
+
+    static const std::string HEADER_PREFIX;
+
+private:
+    std::string path;
+    std::string machineId;
+    std::mutex mutex;
+    // Serial and date index kept up to date with every sale; nullptr if not opened or failed
+    std::unique_ptr<SalesIndex> index;
+};
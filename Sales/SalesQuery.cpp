@@ -0,0 +1,336 @@
+#include "SalesQuery.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+
+namespace {
+// Rows per work item handed to a thread
+constexpr std::size_t CHUNK_ROWS = 1 << 16;
+// Rows per vector block inside a chunk; block buffers stay in L1
+constexpr std::size_t BLOCK_ROWS = 1024;
+// Largest group count aggregated in dense arrays, per thread
+constexpr std::uint64_t DENSE_GROUP_LIMIT = 1 << 22;
+
+/**
+ * @brief Runs work over all rows in chunks on several threads.
+ * @param rows Number of rows.
+ * @param threads Number of threads; 0 means one per core.
+ * @param work Called as work(threadIndex, begin, end) for every chunk.
+ * @return The number of threads used.
+ */
+unsigned forEachChunk(std::size_t rows, unsigned threads,
+                      const std::function<void(unsigned, std::size_t, std::size_t)>& work) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const std::size_t chunks = (rows + CHUNK_ROWS - 1) / CHUNK_ROWS;
+    threads = static_cast<unsigned>(std::max<std::size_t>(1, std::min<std::size_t>(threads, chunks)));
+
+    std::atomic<std::size_t> nextChunk{0};
+    auto worker = [&](unsigned threadIndex) {
+        for (std::size_t chunk = nextChunk++; chunk < chunks; chunk = nextChunk++) {
+            const std::size_t begin = chunk * CHUNK_ROWS;
+            work(threadIndex, begin, std::min(rows, begin + CHUNK_ROWS));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    return threads;
+}
+
+/**
+ * @brief Calls kernel(fixed, blockBegin, count) for every block of a chunk.
+ * Full blocks pass their size as a compile-time constant, so the kernels see a
+ * fixed trip count and GCC vectorizes them at -O2; the tail block passes 0.
+ */
+template <typename Kernel>
+void forEachBlock(std::size_t begin, std::size_t end, Kernel&& kernel) {
+    std::size_t block = begin;
+    for (; block + BLOCK_ROWS <= end; block += BLOCK_ROWS) {
+        kernel(std::integral_constant<std::size_t, BLOCK_ROWS>{}, block, BLOCK_ROWS);
+    }
+    if (block < end) {
+        kernel(std::integral_constant<std::size_t, 0>{}, block, end - block);
+    }
+}
+
+/**
+ * @brief Computes the filter mask of one block: 1 for selected rows, 0 otherwise.
+ * Branch-free, so the compiler turns it into vector compares. Requires fromDay <= toDay.
+ */
+template <std::size_t FIXED>
+void selectBlock(const std::uint16_t* __restrict day, const std::uint32_t* __restrict line, const QueryFilter& filter,
+                 std::size_t count, std::uint8_t* __restrict mask) {
+    const std::size_t rows = FIXED != 0 ? FIXED : count;
+    const std::uint16_t fromDay = filter.fromDay;
+    const auto span = static_cast<std::uint16_t>(filter.toDay - filter.fromDay);
+    const std::uint32_t wantedLine = filter.line;
+    const std::uint8_t anyLine = filter.filterLine ? 0 : 1;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const std::uint8_t inRange = static_cast<std::uint16_t>(day[i] - fromDay) <= span;
+        mask[i] = inRange & (anyLine | static_cast<std::uint8_t>(line[i] == wantedLine));
+    }
+}
+
+/**
+ * @brief Masked sum of one coin column over a block.
+ */
+template <std::size_t FIXED>
+std::uint64_t sumBlock(const std::uint16_t* __restrict coins, const std::uint8_t* __restrict mask, std::size_t count) {
+    const std::size_t rows = FIXED != 0 ? FIXED : count;
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < rows; ++i) {
+        sum += static_cast<std::uint32_t>(coins[i]) * mask[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief Group keys line * dayCount + day offset for one block.
+ * Days are clamped, so masked-out rows stay inside the key space.
+ */
+template <std::size_t FIXED>
+void lineDayKeys(const std::uint32_t* __restrict line, const std::uint16_t* __restrict day, std::uint16_t firstDay,
+                 std::uint16_t lastDay, std::uint64_t dayCount, std::size_t count, std::uint64_t* __restrict keys) {
+    const std::size_t rows = FIXED != 0 ? FIXED : count;
+    for (std::size_t i = 0; i < rows; ++i) {
+        const std::uint16_t clamped = day[i] < firstDay ? firstDay : (day[i] > lastDay ? lastDay : day[i]);
+        keys[i] = line[i] * dayCount + static_cast<std::uint16_t>(clamped - firstDay);
+    }
+}
+
+/**
+ * @brief Group keys start * stopCount + destination for one block.
+ */
+template <std::size_t FIXED>
+void stopPairKeys(const std::uint32_t* __restrict start, const std::uint32_t* __restrict destination,
+                  std::uint64_t stopCount, std::size_t count, std::uint64_t* __restrict keys) {
+    const std::size_t rows = FIXED != 0 ? FIXED : count;
+    for (std::size_t i = 0; i < rows; ++i) {
+        keys[i] = start[i] * stopCount + destination[i];
+    }
+}
+
+// Sum and count per group key; dense arrays for small key spaces, a hash map otherwise
+class GroupSums {
+public:
+    explicit GroupSums(std::uint64_t groups) : dense(groups <= DENSE_GROUP_LIMIT) {
+        if (dense) {
+            sums.assign(groups, 0);
+            counts.assign(groups, 0);
+        }
+    }
+
+    // Masked rows are added as zero, so the dense path needs no branches
+    void add(const std::uint64_t* keys, const std::int32_t* values, const std::uint8_t* mask, std::size_t count) {
+        if (dense) {
+            for (std::size_t i = 0; i < count; ++i) {
+                sums[keys[i]] += static_cast<std::int64_t>(values[i]) * mask[i];
+                counts[keys[i]] += mask[i];
+            }
+            return;
+        }
+        for (std::size_t i = 0; i < count; ++i) {
+            if (mask[i]) {
+                auto& group = sparse[keys[i]];
+                group.first += values[i];
+                group.second++;
+            }
+        }
+    }
+
+    void mergeInto(GroupSums& total) const {
+        if (dense) {
+            for (std::size_t key = 0; key < sums.size(); ++key) {
+                total.sums[key] += sums[key];
+                total.counts[key] += counts[key];
+            }
+            return;
+        }
+        for (const auto& [key, group] : sparse) {
+            auto& target = total.sparse[key];
+            target.first += group.first;
+            target.second += group.second;
+        }
+    }
+
+    // Calls visit(key, sum, count) for every non-empty group
+    template <typename F>
+    void forEach(F&& visit) const {
+        if (dense) {
+            for (std::size_t key = 0; key < sums.size(); ++key) {
+                if (counts[key] != 0) visit(static_cast<std::uint64_t>(key), sums[key], counts[key]);
+            }
+            return;
+        }
+        for (const auto& [key, group] : sparse) {
+            visit(key, group.first, group.second);
+        }
+    }
+
+private:
+    bool dense;
+    std::vector<std::int64_t> sums;
+    std::vector<std::uint64_t> counts;
+    std::unordered_map<std::uint64_t, std::pair<std::int64_t, std::uint64_t>> sparse;
+};
+
+/**
+ * @brief Group-by-sum of the price column over keys computed per block.
+ * @param makeKeys Called as makeKeys(fixed, begin, count, keys) to fill the group keys of a block.
+ */
+template <typename MakeKeys>
+GroupSums groupPrices(const SalesStore& store, const QueryFilter& filter, unsigned threads, std::uint64_t groups,
+                      MakeKeys makeKeys) {
+    const SalesColumns& columns = store.data();
+    const unsigned maxThreads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    std::vector<GroupSums> partial(maxThreads, GroupSums(0));
+    std::vector<char> used(maxThreads, 0);
+
+    forEachChunk(store.size(), maxThreads, [&](unsigned threadIndex, std::size_t begin, std::size_t end) {
+        if (!used[threadIndex]) {
+            partial[threadIndex] = GroupSums(groups);
+            used[threadIndex] = 1;
+        }
+        std::uint8_t mask[BLOCK_ROWS];
+        std::uint64_t keys[BLOCK_ROWS];
+        forEachBlock(begin, end, [&](auto fixed, std::size_t block, std::size_t count) {
+            selectBlock<decltype(fixed)::value>(columns.day.data() + block, columns.line.data() + block, filter,
+                                                count, mask);
+            makeKeys(fixed, block, count, keys);
+            // The scatter into the groups stays scalar; SSE/AVX2 have no conflict-free scatter
+            partial[threadIndex].add(keys, columns.price.data() + block, mask, count);
+        });
+    });
+
+    GroupSums total(groups);
+    for (unsigned i = 0; i < maxThreads; ++i) {
+        if (used[i]) partial[i].mergeInto(total);
+    }
+    return total;
+}
+}
+
+/**
+ * @brief Sums revenue and ticket count per line and day.
+ * @param store The sales.
+ * @param filter Day range and optional line.
+ * @param threads Number of threads; 0 means one per core.
+ * @return One entry per line and day with sales, ordered by line id and day.
+ */
+std::vector<LineDayRevenue> SalesQuery::revenuePerLinePerDay(const SalesStore& store, const QueryFilter& filter,
+                                                             unsigned threads) {
+    if (store.size() == 0) {
+        return {};
+    }
+    const SalesColumns& columns = store.data();
+    const auto [minDay, maxDay] = std::minmax_element(columns.day.begin(), columns.day.end());
+    const std::uint16_t firstDay = std::max(*minDay, filter.fromDay);
+    const std::uint16_t lastDay = std::min(*maxDay, filter.toDay);
+    if (firstDay > lastDay) {
+        return {};
+    }
+    const std::uint64_t dayCount = lastDay - firstDay + 1u;
+
+    const GroupSums sums = groupPrices(store, filter, threads, store.lines.size() * dayCount,
+        [&](auto fixed, std::size_t begin, std::size_t count, std::uint64_t* keys) {
+            lineDayKeys<decltype(fixed)::value>(columns.line.data() + begin, columns.day.data() + begin, firstDay,
+                                                lastDay, dayCount, count, keys);
+        });
+
+    std::vector<LineDayRevenue> result;
+    sums.forEach([&](std::uint64_t key, std::int64_t revenue, std::uint64_t tickets) {
+        result.push_back({static_cast<std::uint32_t>(key / dayCount),
+                          static_cast<std::uint16_t>(firstDay + key % dayCount), revenue, tickets});
+    });
+    std::sort(result.begin(), result.end(), [](const LineDayRevenue& a, const LineDayRevenue& b) {
+        return a.line != b.line ? a.line < b.line : a.day < b.day;
+    });
+    return result;
+}
+
+/**
+ * @brief Counts tickets and revenue per start and destination stop.
+ * @param store The sales.
+ * @param filter Day range and optional line.
+ * @param threads Number of threads; 0 means one per core.
+ * @return One entry per stop pair with sales, most frequent first; empty for an inverted day range.
+ */
+std::vector<OriginDestination> SalesQuery::originDestination(const SalesStore& store, const QueryFilter& filter,
+                                                             unsigned threads) {
+    // selectBlock() compares unsigned day offsets, which would wrap for an inverted range
+    if (store.size() == 0 || filter.fromDay > filter.toDay) {
+        return {};
+    }
+    const SalesColumns& columns = store.data();
+    const std::uint64_t stopCount = store.stops.size();
+
+    const GroupSums sums = groupPrices(store, filter, threads, stopCount * stopCount,
+        [&](auto fixed, std::size_t begin, std::size_t count, std::uint64_t* keys) {
+            stopPairKeys<decltype(fixed)::value>(columns.start.data() + begin, columns.destination.data() + begin,
+                                                 stopCount, count, keys);
+        });
+
+    std::vector<OriginDestination> result;
+    sums.forEach([&](std::uint64_t key, std::int64_t revenue, std::uint64_t tickets) {
+        result.push_back({static_cast<std::uint32_t>(key / stopCount), static_cast<std::uint32_t>(key % stopCount),
+                          revenue, tickets});
+    });
+    std::sort(result.begin(), result.end(), [](const OriginDestination& a, const OriginDestination& b) {
+        if (a.tickets != b.tickets) return a.tickets > b.tickets;
+        return a.start != b.start ? a.start < b.start : a.destination < b.destination;
+    });
+    return result;
+}
+
+/**
+ * @brief Sums the coins paid out as change per denomination.
+ * @param store The sales.
+ * @param filter Day range and optional line.
+ * @param threads Number of threads; 0 means one per core.
+ * @return One entry per denomination, largest first; empty for an inverted day range.
+ */
+std::vector<ChangeTotal> SalesQuery::changeTotals(const SalesStore& store, const QueryFilter& filter,
+                                                  unsigned threads) {
+    if (filter.fromDay > filter.toDay) {
+        return {};
+    }
+    const SalesColumns& columns = store.data();
+    const std::size_t denominations = columns.denominations.size();
+    const unsigned maxThreads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    std::vector<std::vector<std::uint64_t>> partial(maxThreads, std::vector<std::uint64_t>(denominations, 0));
+
+    forEachChunk(store.size(), maxThreads, [&](unsigned threadIndex, std::size_t begin, std::size_t end) {
+        std::uint8_t mask[BLOCK_ROWS];
+        forEachBlock(begin, end, [&](auto fixed, std::size_t block, std::size_t count) {
+            selectBlock<decltype(fixed)::value>(columns.day.data() + block, columns.line.data() + block, filter,
+                                                count, mask);
+            for (std::size_t k = 0; k < denominations; ++k) {
+                partial[threadIndex][k] += sumBlock<decltype(fixed)::value>(columns.change[k].data() + block, mask, count);
+            }
+        });
+    });
+
+    std::vector<ChangeTotal> result;
+    for (std::size_t k = 0; k < denominations; ++k) {
+        std::uint64_t coins = 0;
+        for (const auto& sums : partial) {
+            coins += sums[k];
+        }
+        result.push_back({columns.denominations[k], coins});
+    }
+    std::sort(result.begin(), result.end(), [](const ChangeTotal& a, const ChangeTotal& b) {
+        return a.denomination > b.denomination;
+    });
+    return result;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "SalesStore.hpp"
+#include <cstdint>
+#include <vector>
+
+struct QueryFilter {
+    // Inclusive range of days since 1970-01-01
+    std::uint16_t fromDay = 0;
+    std::uint16_t toDay = 0xffff;
+    bool filterLine = false;
+    std::uint32_t line = 0;
+};
+
+struct LineDayRevenue {
+    std::uint32_t line;
+    std::uint16_t day;
+    std::int64_t revenue;
+    std::uint64_t tickets;
+};
+
+struct OriginDestination {
+    std::uint32_t start;
+    std::uint32_t destination;
+    std::int64_t revenue;
+    std::uint64_t tickets;
+};
+
+struct ChangeTotal {
+    int denomination;
+    std::uint64_t coins;
+};
+
+class SalesQuery {
+public:
+    static std::vector<LineDayRevenue> revenuePerLinePerDay(const SalesStore& store, const QueryFilter& filter,
+                                                            unsigned threads = 0);
+    static std::vector<OriginDestination> originDestination(const SalesStore& store, const QueryFilter& filter,
+                                                            unsigned threads = 0);
+    static std::vector<ChangeTotal> changeTotals(const SalesStore& store, const QueryFilter& filter,
+                                                 unsigned threads = 0);
+};
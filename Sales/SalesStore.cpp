@@ -0,0 +1,324 @@
+#include "SalesStore.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+constexpr char MAGIC[8] = {'T', 'K', 'S', 'A', 'L', 'E', 'S', '1'};
+
+template <typename T>
+void writeColumn(std::ofstream& file, const std::vector<T>& column) {
+    file.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(T)));
+}
+
+template <typename T>
+void readColumn(std::ifstream& file, std::vector<T>& column, std::size_t rows) {
+    column.resize(rows);
+    file.read(reinterpret_cast<char*>(column.data()), static_cast<std::streamsize>(rows * sizeof(T)));
+}
+
+template <typename T>
+void writeValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T readValue(std::ifstream& file) {
+    T value{};
+    file.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return value;
+}
+
+void writeDictionary(std::ofstream& file, const StringDictionary& dictionary) {
+    writeValue<std::uint32_t>(file, static_cast<std::uint32_t>(dictionary.size()));
+    for (const auto& value : dictionary.values()) {
+        writeValue<std::uint32_t>(file, static_cast<std::uint32_t>(value.size()));
+        file.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+}
+
+void readDictionary(std::ifstream& file, StringDictionary& dictionary) {
+    const auto count = readValue<std::uint32_t>(file);
+    for (std::uint32_t i = 0; i < count && file; ++i) {
+        std::string value(readValue<std::uint32_t>(file), '\0');
+        file.read(value.data(), static_cast<std::streamsize>(value.size()));
+        dictionary.intern(value);
+    }
+}
+
+// Ids index dense arrays in the query kernels, so a corrupt file must not get past loading
+template <typename T>
+bool idsBelow(const std::vector<T>& column, std::size_t limit) {
+    T maximum = 0;
+    for (const T id : column) {
+        maximum = std::max(maximum, id);
+    }
+    return column.empty() || static_cast<std::size_t>(maximum) < limit;
+}
+}
+
+/**
+ * @brief Returns the id of a string, adding it to the dictionary if it is new.
+ * @param value The string.
+ * @return Its dense id.
+ */
+std::uint32_t StringDictionary::intern(std::string_view value) {
+    const auto found = ids.find(std::string(value));
+    if (found != ids.end()) {
+        return found->second;
+    }
+    const auto id = static_cast<std::uint32_t>(strings.size());
+    strings.emplace_back(value);
+    ids.emplace(strings.back(), id);
+    return id;
+}
+
+/**
+ * @brief Looks up the id of a string without adding it.
+ * @param value The string.
+ * @param id Receives the id if found.
+ * @return True if the string is in the dictionary.
+ */
+bool StringDictionary::find(std::string_view value, std::uint32_t& id) const {
+    const auto found = ids.find(std::string(value));
+    if (found == ids.end()) {
+        return false;
+    }
+    id = found->second;
+    return true;
+}
+
+/**
+ * @brief Adds a sold ticket, dictionary-encoding machine, line and stops.
+ * @param ticket The ticket as recorded by the machine.
+ * @param machineId Id of the selling machine.
+ * @throws std::runtime_error If the ticket date is invalid or there are too many machines.
+ */
+void SalesStore::append(const TicketData& ticket, const std::string& machineId) {
+    const std::uint32_t machine = machines.intern(machineId);
+    if (machine > 0xffff) {
+        throw std::runtime_error("Too many machines in one sales store");
+    }
+
+    SaleRow row;
+    row.serial = ticket.serial;
+    row.machine = static_cast<std::uint16_t>(machine);
+    row.day = TicketCode::dayFromDate(ticket.date);
+    const std::time_t time = static_cast<std::time_t>(ticket.timestamp);
+    std::tm localTime{};
+    localtime_r(&time, &localTime);
+    row.secondOfDay = static_cast<std::uint32_t>(localTime.tm_hour * 3600 + localTime.tm_min * 60 + localTime.tm_sec);
+    row.line = lines.intern(ticket.tram);
+    row.start = stops.intern(ticket.startStop);
+    row.destination = stops.intern(ticket.destinationStop);
+    row.price = ticket.price;
+    appendRow(row, ticket.change);
+}
+
+/**
+ * @brief Adds an already encoded sale.
+ * @param row The sale; its ids must come from this store's dictionaries.
+ * @param change Coins paid out, by denomination.
+ */
+void SalesStore::appendRow(const SaleRow& row, const std::map<int, int>& change) {
+    columns.serial.push_back(row.serial);
+    columns.machine.push_back(row.machine);
+    columns.day.push_back(row.day);
+    columns.secondOfDay.push_back(row.secondOfDay);
+    columns.line.push_back(row.line);
+    columns.start.push_back(row.start);
+    columns.destination.push_back(row.destination);
+    columns.price.push_back(row.price);
+
+    for (auto& column : columns.change) {
+        column.push_back(0);
+    }
+    for (const auto& [denomination, count] : change) {
+        if (count != 0) {
+            columns.change[denominationColumn(denomination)].back() = static_cast<std::uint16_t>(count);
+        }
+    }
+}
+
+/**
+ * @brief Returns the change column of a denomination, adding a zero-filled column if it is new.
+ */
+std::size_t SalesStore::denominationColumn(int denomination) {
+    const auto found = std::find(columns.denominations.begin(), columns.denominations.end(), denomination);
+    if (found != columns.denominations.end()) {
+        return static_cast<std::size_t>(found - columns.denominations.begin());
+    }
+    columns.denominations.push_back(denomination);
+    columns.change.emplace_back(size(), 0);
+    return columns.denominations.size() - 1;
+}
+
+/**
+ * @brief Reserves space for the given number of rows in every column.
+ */
+void SalesStore::reserve(std::size_t rows) {
+    columns.serial.reserve(rows);
+    columns.machine.reserve(rows);
+    columns.day.reserve(rows);
+    columns.secondOfDay.reserve(rows);
+    columns.line.reserve(rows);
+    columns.start.reserve(rows);
+    columns.destination.reserve(rows);
+    columns.price.reserve(rows);
+    for (auto& column : columns.change) {
+        column.reserve(rows);
+    }
+}
+
+/**
+ * @brief Appends all sales of another store, translating its dictionary ids into ours.
+ * @param other The store to merge, e.g. the export of another machine.
+ * @throws std::runtime_error If the merged store would have too many machines.
+ */
+void SalesStore::merge(const SalesStore& other) {
+    // Translation tables from the other store's ids to ours
+    auto translate = [](const StringDictionary& from, StringDictionary& to) {
+        std::vector<std::uint32_t> mapping(from.size());
+        for (std::size_t id = 0; id < from.size(); ++id) {
+            mapping[id] = to.intern(from.at(static_cast<std::uint32_t>(id)));
+        }
+        return mapping;
+    };
+    const auto machineIds = translate(other.machines, machines);
+    if (machines.size() > 0x10000) {
+        throw std::runtime_error("Too many machines in one sales store");
+    }
+    const auto lineIds = translate(other.lines, lines);
+    const auto stopIds = translate(other.stops, stops);
+
+    const SalesColumns& source = other.columns;
+    const std::size_t offset = size();
+    const std::size_t rows = other.size();
+    reserve(offset + rows);
+
+    columns.serial.insert(columns.serial.end(), source.serial.begin(), source.serial.end());
+    columns.day.insert(columns.day.end(), source.day.begin(), source.day.end());
+    columns.secondOfDay.insert(columns.secondOfDay.end(), source.secondOfDay.begin(), source.secondOfDay.end());
+    columns.price.insert(columns.price.end(), source.price.begin(), source.price.end());
+
+    // Dictionary columns are translated with a gather per row
+    columns.machine.resize(offset + rows);
+    columns.line.resize(offset + rows);
+    columns.start.resize(offset + rows);
+    columns.destination.resize(offset + rows);
+    for (std::size_t i = 0; i < rows; ++i) {
+        columns.machine[offset + i] = static_cast<std::uint16_t>(machineIds[source.machine[i]]);
+        columns.line[offset + i] = lineIds[source.line[i]];
+        columns.start[offset + i] = stopIds[source.start[i]];
+        columns.destination[offset + i] = stopIds[source.destination[i]];
+    }
+
+    for (auto& column : columns.change) {
+        column.resize(offset + rows, 0);
+    }
+    for (std::size_t k = 0; k < source.denominations.size(); ++k) {
+        auto& column = columns.change[denominationColumn(source.denominations[k])];
+        std::copy(source.change[k].begin(), source.change[k].end(), column.begin() + static_cast<std::ptrdiff_t>(offset));
+    }
+}
+
+/**
+ * @brief Writes the store as a binary column file.
+ * Layout: magic, row count, dictionaries, denominations, then every column as
+ * one contiguous array in host byte order, so loading is a plain read per column.
+ * @param path Target file.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void SalesStore::save(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+
+    file.write(MAGIC, sizeof(MAGIC));
+    writeValue<std::uint64_t>(file, size());
+    writeDictionary(file, machines);
+    writeDictionary(file, lines);
+    writeDictionary(file, stops);
+    writeValue<std::uint32_t>(file, static_cast<std::uint32_t>(columns.denominations.size()));
+    for (const int denomination : columns.denominations) {
+        writeValue<std::int32_t>(file, denomination);
+    }
+
+    writeColumn(file, columns.serial);
+    writeColumn(file, columns.machine);
+    writeColumn(file, columns.day);
+    writeColumn(file, columns.secondOfDay);
+    writeColumn(file, columns.line);
+    writeColumn(file, columns.start);
+    writeColumn(file, columns.destination);
+    writeColumn(file, columns.price);
+    for (const auto& column : columns.change) {
+        writeColumn(file, column);
+    }
+
+    if (!file) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+}
+
+/**
+ * @brief Reads a column file written by save().
+ * @param path The file.
+ * @return The store.
+ * @throws std::runtime_error If the file is missing, truncated or inconsistent.
+ */
+SalesStore SalesStore::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    char magic[sizeof(MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Invalid sales store: " + path);
+    }
+
+    SalesStore store;
+    const auto rows = static_cast<std::size_t>(readValue<std::uint64_t>(file));
+    readDictionary(file, store.machines);
+    readDictionary(file, store.lines);
+    readDictionary(file, store.stops);
+    const auto denominationCount = readValue<std::uint32_t>(file);
+    for (std::uint32_t i = 0; i < denominationCount && file; ++i) {
+        store.columns.denominations.push_back(readValue<std::int32_t>(file));
+    }
+
+    // A corrupt row count must not trigger a huge allocation
+    const std::size_t bytesPerRow = 3 * sizeof(std::uint32_t) + 2 * sizeof(std::uint16_t) + 2 * sizeof(std::uint32_t) +
+                                    sizeof(std::int32_t) + denominationCount * sizeof(std::uint16_t);
+    const auto position = static_cast<std::uintmax_t>(file.tellg());
+    if (!file || std::filesystem::file_size(path) - position != rows * bytesPerRow) {
+        throw std::runtime_error("Invalid sales store: " + path);
+    }
+
+    SalesColumns& columns = store.columns;
+    readColumn(file, columns.serial, rows);
+    readColumn(file, columns.machine, rows);
+    readColumn(file, columns.day, rows);
+    readColumn(file, columns.secondOfDay, rows);
+    readColumn(file, columns.line, rows);
+    readColumn(file, columns.start, rows);
+    readColumn(file, columns.destination, rows);
+    readColumn(file, columns.price, rows);
+    columns.change.resize(columns.denominations.size());
+    for (auto& column : columns.change) {
+        readColumn(file, column, rows);
+    }
+
+    if (!file || !idsBelow(columns.machine, store.machines.size()) || !idsBelow(columns.line, store.lines.size()) ||
+        !idsBelow(columns.start, store.stops.size()) || !idsBelow(columns.destination, store.stops.size())) {
+        throw std::runtime_error("Invalid sales store: " + path);
+    }
+    return store;
+}
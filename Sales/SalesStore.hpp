@@ -0,0 +1,74 @@
+#pragma once
+#include "../TicketMachine/TicketMachine.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Maps strings to dense ids in insertion order
+class StringDictionary {
+public:
+    std::uint32_t intern(std::string_view value);
+    [[nodiscard]] bool find(std::string_view value, std::uint32_t& id) const;
+    [[nodiscard]] const std::string& at(std::uint32_t id) const { return strings.at(id); }
+    [[nodiscard]] std::size_t size() const { return strings.size(); }
+    [[nodiscard]] const std::vector<std::string>& values() const { return strings; }
+
+private:
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, std::uint32_t> ids;
+};
+
+// One sale with all strings already replaced by dictionary ids
+struct SaleRow {
+    std::uint32_t serial = 0;
+    std::uint16_t machine = 0;
+    // Days since 1970-01-01
+    std::uint16_t day = 0;
+    std::uint32_t secondOfDay = 0;
+    std::uint32_t line = 0;
+    std::uint32_t start = 0;
+    std::uint32_t destination = 0;
+    std::int32_t price = 0;
+};
+
+// Struct of arrays: element i of every column belongs to sale i
+struct SalesColumns {
+    std::vector<std::uint32_t> serial;
+    std::vector<std::uint16_t> machine;
+    std::vector<std::uint16_t> day;
+    std::vector<std::uint32_t> secondOfDay;
+    std::vector<std::uint32_t> line;
+    std::vector<std::uint32_t> start;
+    std::vector<std::uint32_t> destination;
+    std::vector<std::int32_t> price;
+    // One column of coin counts per denomination, in the order of denominations
+    std::vector<int> denominations;
+    std::vector<std::vector<std::uint16_t>> change;
+};
+
+class SalesStore {
+public:
+    void append(const TicketData& ticket, const std::string& machineId);
+    void appendRow(const SaleRow& row, const std::map<int, int>& change);
+    void merge(const SalesStore& other);
+    void reserve(std::size_t rows);
+
+    void save(const std::string& path) const;
+    static SalesStore load(const std::string& path);
+
+    [[nodiscard]] std::size_t size() const { return columns.price.size(); }
+    [[nodiscard]] const SalesColumns& data() const { return columns; }
+
+    StringDictionary machines;
+    StringDictionary lines;
+    // Start and destination share one dictionary, so origin-destination matrices are square
+    StringDictionary stops;
+
+private:
+    SalesColumns columns;
+
+    std::size_t denominationColumn(int denomination);
+};
@@ -0,0 +1,282 @@
+#include "ChangeBoxSimulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief SplitMix64 step, used to derive independent per-day seeds.
+ * @param x Input value.
+ * @return Well-mixed 64-bit value.
+ */
+std::uint64_t splitMix64(std::uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief Small random source on top of std::mt19937_64.
+ *
+ * The standard distributions are implementation-defined, so the conversions are
+ * done by hand to keep results identical across compilers and platforms.
+ */
+class DayRandom {
+public:
+    explicit DayRandom(std::uint64_t seed) : engine(seed) {}
+
+    // Uniform double in [0, 1)
+    double uniform() {
+        return static_cast<double>(engine() >> 11) * 0x1.0p-53;
+    }
+
+    // Uniform integer in [0, bound)
+    std::size_t below(std::size_t bound) {
+        return static_cast<std::size_t>(uniform() * static_cast<double>(bound));
+    }
+
+    // Exponentially distributed value with the given mean
+    double exponential(double mean) {
+        return -std::log(1.0 - uniform()) * mean;
+    }
+
+private:
+    std::mt19937_64 engine;
+};
+
+} // namespace
+
+/**
+ * @brief Constructs a simulator for the given network and configuration.
+ * @param lines  Tram lines the simulated journeys are drawn from.
+ * @param config Arrival, payment and change box parameters.
+ * @throws std::invalid_argument If no line with at least two stops is given.
+ */
+ChangeBoxSimulator::ChangeBoxSimulator(std::vector<TramData> lines, SimulationConfig config)
+    : lines(std::move(lines)), config(std::move(config)) {
+    // Journeys need two different stops, so drop lines that cannot provide them
+    this->lines.erase(std::remove_if(this->lines.begin(), this->lines.end(),
+                                     [](const TramData& line) { return line.stops.size() < 2; }),
+                      this->lines.end());
+    if (this->lines.empty()) {
+        throw std::invalid_argument("Simulation needs at least one line with two stops.");
+    }
+    // Notes are searched from the smallest upwards
+    std::sort(this->config.notes.begin(), this->config.notes.end());
+}
+
+/**
+ * @brief Loads all tram lines from the "data" directory.
+ * @return Parsed tram lines.
+ */
+std::vector<TramData> ChangeBoxSimulator::loadLines() {
+    std::vector<TramData> lines;
+    for (const auto& entry : TramParser::getAvailableLines("data")) {
+        lines.push_back(TramParser::parseTramFile(entry.fileName));
+    }
+    return lines;
+}
+
+/**
+ * @brief Runs all configured days in parallel and aggregates the results.
+ *
+ * Every day is seeded independently from the base seed and its index, so the
+ * report does not depend on the number of threads or their scheduling.
+ *
+ * @return Aggregated report over all simulated days.
+ */
+SimulationReport ChangeBoxSimulator::run() const {
+    std::vector<DayResult> results(static_cast<std::size_t>(std::max(config.days, 0)));
+    std::atomic<int> nextDay{0};
+
+    unsigned threadCount = config.threads != 0 ? config.threads : std::thread::hardware_concurrency();
+    threadCount = std::max(1u, std::min<unsigned>(threadCount, static_cast<unsigned>(results.size())));
+
+    auto worker = [&]() {
+        // Each thread claims the next unsimulated day until all are done
+        for (int day = nextDay++; day < config.days; day = nextDay++) {
+            results[static_cast<std::size_t>(day)] = simulateDay(day);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return aggregate(results, config.operatingMinutes * std::max(config.daysBetweenRefills, 1));
+}
+
+/**
+ * @brief Simulates the operating days until the next refill, starting with a freshly refilled change box.
+ *
+ * Customers arrive as a Poisson process, pick a random line and two different
+ * stops, and insert coins and notes according to the configured behaviour; coins
+ * are recycled into the change box up to its capacity. If change is not available,
+ * the machine returns the pieces and the customer pays the exact amount instead,
+ * as the machine asks them to.
+ *
+ * @param day Index of the refill period, used to derive its seed.
+ * @return Statistics for this period.
+ */
+DayResult ChangeBoxSimulator::simulateDay(int day) const {
+    DayRandom random(splitMix64(config.seed ^ splitMix64(static_cast<std::uint64_t>(day))));
+    Payment payment(config.initialStock, config.capacity, config.notes);
+    DayResult result;
+
+    const double meanGap = config.operatingMinutes / std::max(config.customersPerDay, 1e-9);
+    const int periodMinutes = config.operatingMinutes * std::max(config.daysBetweenRefills, 1);
+    double minute = random.exponential(meanGap);
+
+    while (minute < periodMinutes) {
+        // Draw a journey from the real network
+        const TramData& line = lines[random.below(lines.size())];
+        const std::size_t start = random.below(line.stops.size());
+        std::size_t destination = random.below(line.stops.size() - 1);
+        if (destination >= start) {
+            destination++;
+        }
+        // Same formula as TicketMachine::calculatePrice()
+        const int routeLength = std::abs(static_cast<int>(start) - static_cast<int>(destination));
+        const int price = routeLength * line.pricePerStop;
+
+        insertPieces(payment, chooseInsertedAmount(price, random.uniform()));
+        const int changeAmount = Payment::calculateChange(price, payment.insertedAmount());
+
+        try {
+            for (const auto& [value, count] : payment.payOutChange(std::abs(changeAmount))) {
+                result.paidOut[value] += count;
+                result.piecesPaidOut += count;
+            }
+        } catch (const std::runtime_error&) {
+            result.failedPayouts++;
+            if (result.minutesUntilStockout < 0) {
+                result.minutesUntilStockout = static_cast<int>(minute);
+            }
+            (void) payment.returnInserted();
+            insertPieces(payment, price);
+            (void) payment.payOutChange(0);
+        }
+        result.sales++;
+
+        minute += random.exponential(meanGap);
+    }
+
+    for (const auto& [value, count] : payment.getCashBox()) {
+        result.cashBox[value] += count;
+    }
+    return result;
+}
+
+/**
+ * @brief Inserts the given amount as the fewest accepted coins and notes, largest first.
+ * If the values cannot form the amount exactly, the customer overpays with the smallest piece.
+ * @param payment Payment unit taking the pieces.
+ * @param amount  Amount to insert.
+ */
+void ChangeBoxSimulator::insertPieces(Payment& payment, int amount) {
+    const std::vector<int> accepted = payment.acceptedDenominations();
+    if (accepted.empty()) {
+        return;
+    }
+    int remaining = amount;
+    for (const int value : accepted) {
+        for (; remaining >= value; remaining -= value) {
+            (void) payment.insert(value);
+        }
+    }
+    if (remaining > 0) {
+        (void) payment.insert(accepted.back());
+    }
+}
+
+/**
+ * @brief Determines how much a customer inserts for the given price.
+ * @param price Ticket price.
+ * @param roll  Uniform random value in [0, 1) selecting the behaviour.
+ * @return The inserted amount, always at least the price.
+ */
+int ChangeBoxSimulator::chooseInsertedAmount(int price, double roll) const {
+    if (roll < config.exactShare) {
+        return price;
+    }
+    if (roll < config.exactShare + config.roundUpShare && config.roundUpStep > 0) {
+        return (price + config.roundUpStep - 1) / config.roundUpStep * config.roundUpStep;
+    }
+
+    // Pay with the smallest note that covers the price
+    for (int note : config.notes) {
+        if (note >= price) {
+            return note;
+        }
+    }
+    // Otherwise use as many of the largest note as needed
+    if (!config.notes.empty() && config.notes.back() > 0) {
+        const int largest = config.notes.back();
+        return (price + largest - 1) / largest * largest;
+    }
+    return price;
+}
+
+/**
+ * @brief Combines per-day results into a report.
+ *
+ * Periods without a stockout are counted with their full length when computing
+ * the refill percentiles, since no refill was needed before the planned one.
+ *
+ * @param results       Per-period results in order.
+ * @param refillMinutes Operating minutes between two planned refills.
+ * @return The aggregated report.
+ */
+SimulationReport ChangeBoxSimulator::aggregate(const std::vector<DayResult>& results, int refillMinutes) {
+    SimulationReport report;
+    report.days = static_cast<int>(results.size());
+
+    long piecesPaidOut = 0;
+    long stockoutMinutes = 0;
+    std::vector<int> minutesUntilRefill;
+    minutesUntilRefill.reserve(results.size());
+
+    for (const auto& day : results) {
+        report.sales += day.sales;
+        report.failedPayouts += day.failedPayouts;
+        piecesPaidOut += day.piecesPaidOut;
+        for (const auto& [value, count] : day.paidOut) {
+            report.paidOut[value] += count;
+        }
+        for (const auto& [value, count] : day.cashBox) {
+            report.cashBox[value] += count;
+        }
+        if (day.minutesUntilStockout >= 0) {
+            report.daysWithStockout++;
+            stockoutMinutes += day.minutesUntilStockout;
+            minutesUntilRefill.push_back(day.minutesUntilStockout);
+        } else {
+            minutesUntilRefill.push_back(refillMinutes);
+        }
+    }
+
+    if (report.daysWithStockout > 0) {
+        report.meanMinutesUntilStockout = static_cast<double>(stockoutMinutes) / report.daysWithStockout;
+    }
+    if (report.sales > 0) {
+        report.piecesPerSale = static_cast<double>(piecesPaidOut) / static_cast<double>(report.sales);
+    }
+    if (!minutesUntilRefill.empty()) {
+        std::sort(minutesUntilRefill.begin(), minutesUntilRefill.end());
+        report.p10MinutesUntilRefill = minutesUntilRefill[minutesUntilRefill.size() / 10];
+        report.medianMinutesUntilRefill = minutesUntilRefill[minutesUntilRefill.size() / 2];
+    }
+    return report;
+}
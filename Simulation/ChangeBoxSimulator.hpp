@@ -0,0 +1,69 @@
+#pragma once
+#include "../TramParser/TramParser.hpp"
+#include "../Payment/Payment.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct SimulationConfig {
+    std::uint64_t seed = 1;
+    int days = 1000;
+    double customersPerDay = 400.0;
+    int operatingMinutes = 19 * 60;
+    // Operating days between two refills of the change box; every simulated day starts one such period
+    int daysBetweenRefills = 1;
+    std::map<int, int> initialStock = Payment::defaultChangeBox();
+    // Most pieces per value the change box takes from customers; empty = no recycling
+    std::map<int, int> capacity = Payment::defaultCapacity();
+    // Share of customers paying the exact price
+    double exactShare = 0.2;
+    // Share of customers rounding up to the next multiple of roundUpStep
+    double roundUpShare = 0.3;
+    int roundUpStep = 5;
+    // Everybody else pays with the smallest note covering the price
+    std::vector<int> notes = Payment::defaultNotes();
+    // 0 = use all available cores
+    unsigned threads = 0;
+};
+
+struct DayResult {
+    long sales = 0;
+    long failedPayouts = 0;
+    // Operating minute since the refill at which change ran out first, -1 if never
+    int minutesUntilStockout = -1;
+    long piecesPaidOut = 0;
+    std::map<int, long> paidOut;
+    // Inserted pieces that did not fit into the change box
+    std::map<int, long> cashBox;
+};
+
+struct SimulationReport {
+    int days = 0;
+    long sales = 0;
+    long failedPayouts = 0;
+    int daysWithStockout = 0;
+    double meanMinutesUntilStockout = 0.0;
+    int medianMinutesUntilRefill = 0;
+    int p10MinutesUntilRefill = 0;
+    double piecesPerSale = 0.0;
+    std::map<int, long> paidOut;
+    std::map<int, long> cashBox;
+};
+
+class ChangeBoxSimulator {
+public:
+    ChangeBoxSimulator(std::vector<TramData> lines, SimulationConfig config);
+
+    static std::vector<TramData> loadLines();
+    [[nodiscard]] SimulationReport run() const;
+    [[nodiscard]] DayResult simulateDay(int day) const;
+
+private:
+    std::vector<TramData> lines;
+    SimulationConfig config;
+
+    [[nodiscard]] int chooseInsertedAmount(int price, double roll) const;
+    static void insertPieces(Payment& payment, int amount);
+    static SimulationReport aggregate(const std::vector<DayResult>& results, int refillMinutes);
+};
@@ -0,0 +1,487 @@
+#include "DeltaSync.hpp"
+#include "../TicketCode/SipHash.hpp"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+constexpr char SIGNATURE_MAGIC[8] = {'T', 'K', 'S', 'I', 'G', 'N', '0', '1'};
+constexpr char DELTA_MAGIC[8] = {'T', 'K', 'D', 'E', 'L', 'T', 'A', '1'};
+// Fixed key: the strong checksum only has to tell blocks apart, it protects nothing
+constexpr std::uint8_t STRONG_KEY[16] = {'t', 'i', 'c', 'k', 'e', 't', 'a', 'u',
+                                         't', 'o', 'm', 'a', 't', 's', 'y', 'n'};
+constexpr char OP_COPY = 'C';
+constexpr char OP_LITERAL = 'L';
+
+bool isLineFile(const std::filesystem::path& path) {
+    return path.extension() == ".txt" || path.extension() == ".times";
+}
+
+std::string readFile(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path.string());
+    }
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Reads the encoded signatures and deltas; every read past the end is an error
+class Reader {
+public:
+    Reader(std::string_view bytes, const char* what) : bytes(bytes), what(what) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(value)).data(), sizeof(value));
+        return value;
+    }
+
+    std::string_view take(std::size_t length) {
+        if (length > bytes.size() - position) {
+            throw std::runtime_error(std::string("Truncated ") + what);
+        }
+        const std::string_view part = bytes.substr(position, length);
+        position += length;
+        return part;
+    }
+
+    void expectEnd() const {
+        if (position != bytes.size()) {
+            throw std::runtime_error(std::string("Trailing bytes after ") + what);
+        }
+    }
+
+private:
+    std::string_view bytes;
+    const char* what;
+    std::size_t position = 0;
+};
+}
+
+/**
+ * @brief Computes the block checksums of a file the receiver already has.
+ * @param data Content of the live file.
+ * @param blockSize Length of a block in bytes; the last block may be shorter.
+ * @return The signature to send to the side holding the new file.
+ * @throws std::invalid_argument If blockSize is 0.
+ */
+FileSignature DeltaSync::signature(std::string_view data, std::uint32_t blockSize) {
+    if (blockSize == 0) {
+        throw std::invalid_argument("Block size must be positive.");
+    }
+    FileSignature result;
+    result.blockSize = blockSize;
+    result.fileSize = data.size();
+    result.fileHash = strongHash(data);
+    result.blocks.reserve((data.size() + blockSize - 1) / blockSize);
+    for (std::size_t offset = 0; offset < data.size(); offset += blockSize) {
+        const std::string_view block = data.substr(offset, blockSize);
+        result.blocks.push_back({weakChecksum(block), strongHash(block)});
+    }
+    return result;
+}
+
+/**
+ * @brief Describes target as blocks of the signed file plus literal bytes.
+ *
+ * A window of one block slides over target byte by byte. Its weak checksum is
+ * updated in constant time per step and looked up in a table of the signed blocks;
+ * only on a hit the strong checksum is computed. Consecutive blocks are merged into
+ * one copy, so an unchanged file becomes a single operation.
+ *
+ * @param signature Signature of the live file.
+ * @param target Content of the new file.
+ * @return Delta that turns the live file into target.
+ */
+FileDelta DeltaSync::delta(const FileSignature& signature, std::string_view target) {
+    FileDelta result;
+    result.blockSize = signature.blockSize;
+    result.resultSize = target.size();
+    result.resultHash = strongHash(target);
+
+    const std::size_t blockSize = signature.blockSize;
+    const std::size_t blockCount = signature.blocks.size();
+    // A shorter last block can only match the end of target
+    const std::size_t lastLength = blockCount == 0 ? 0 : signature.fileSize - (blockCount - 1) * blockSize;
+    const std::size_t fullBlocks = lastLength == blockSize ? blockCount : blockCount - (blockCount > 0 ? 1 : 0);
+
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> byWeak;
+    byWeak.reserve(fullBlocks);
+    for (std::uint32_t i = 0; i < fullBlocks; ++i) {
+        byWeak[signature.blocks[i].weak].push_back(i);
+    }
+
+    auto emitLiteral = [&](std::size_t from, std::size_t to) {
+        if (from == to) return;
+        if (!result.ops.empty() && result.ops.back().count == 0) {
+            result.ops.back().literal.append(target.substr(from, to - from));
+        } else {
+            result.ops.push_back({0, 0, std::string(target.substr(from, to - from))});
+        }
+    };
+    auto emitCopy = [&](std::uint32_t block) {
+        DeltaOp* last = result.ops.empty() ? nullptr : &result.ops.back();
+        if (last != nullptr && last->count > 0 && last->block + last->count == block) {
+            last->count++;
+        } else {
+            result.ops.push_back({block, 1, {}});
+        }
+    };
+    auto findBlock = [&](std::uint32_t weak, std::string_view window) -> long {
+        const auto candidates = byWeak.find(weak);
+        if (candidates == byWeak.end()) return -1;
+        const std::uint64_t strong = strongHash(window);
+        const DeltaOp* last = result.ops.empty() ? nullptr : &result.ops.back();
+        long found = -1;
+        for (const std::uint32_t block : candidates->second) {
+            if (signature.blocks[block].strong != strong) continue;
+            // Prefer the block that extends the current copy
+            if (last != nullptr && last->count > 0 && last->block + last->count == block) return block;
+            if (found < 0) found = block;
+        }
+        return found;
+    };
+
+    std::size_t literalStart = 0;
+    std::size_t position = 0;
+    if (fullBlocks > 0 && target.size() >= blockSize) {
+        // Rolling checksum as in rsync: a = sum of bytes, b = sum of a over the window
+        std::uint32_t a = 0;
+        std::uint32_t b = 0;
+        auto reset = [&]() {
+            a = b = 0;
+            for (std::size_t i = 0; i < blockSize; ++i) {
+                a += static_cast<unsigned char>(target[position + i]);
+                b += static_cast<std::uint32_t>(blockSize - i) * static_cast<unsigned char>(target[position + i]);
+            }
+        };
+        reset();
+        while (position + blockSize <= target.size()) {
+            const std::uint32_t weak = (a & 0xffff) | (b << 16);
+            const long block = findBlock(weak, target.substr(position, blockSize));
+            if (block >= 0) {
+                emitLiteral(literalStart, position);
+                emitCopy(static_cast<std::uint32_t>(block));
+                position += blockSize;
+                literalStart = position;
+                if (position + blockSize <= target.size()) reset();
+                continue;
+            }
+            if (position + blockSize == target.size()) break;
+            const auto out = static_cast<unsigned char>(target[position]);
+            const auto in = static_cast<unsigned char>(target[position + blockSize]);
+            a += in - out;
+            b += a - static_cast<std::uint32_t>(blockSize) * out;
+            position++;
+        }
+    }
+
+    // The short last block, if the end of target still matches it
+    const std::size_t tail = target.size() - literalStart;
+    if (lastLength > 0 && lastLength < blockSize && tail >= lastLength) {
+        const std::uint32_t lastBlock = static_cast<std::uint32_t>(blockCount - 1);
+        const std::string_view end = target.substr(target.size() - lastLength);
+        if (signature.blocks[lastBlock].weak == weakChecksum(end) &&
+            signature.blocks[lastBlock].strong == strongHash(end)) {
+            emitLiteral(literalStart, target.size() - lastLength);
+            emitCopy(lastBlock);
+            literalStart = target.size();
+        }
+    }
+    emitLiteral(literalStart, target.size());
+    return result;
+}
+
+/**
+ * @brief Rebuilds the new file from the live file and a delta.
+ * @param basis Content of the live file the signature was made from.
+ * @param delta Delta from delta().
+ * @return Content of the new file.
+ * @throws std::runtime_error If the delta refers to missing blocks or the result does not match.
+ */
+std::string DeltaSync::patch(std::string_view basis, const FileDelta& delta) {
+    if (delta.blockSize == 0) {
+        throw std::runtime_error("Invalid delta: block size 0");
+    }
+    std::string result;
+    result.reserve(delta.resultSize);
+    for (const auto& op : delta.ops) {
+        if (op.count == 0) {
+            result += op.literal;
+            continue;
+        }
+        const std::uint64_t offset = static_cast<std::uint64_t>(op.block) * delta.blockSize;
+        if (offset >= basis.size()) {
+            throw std::runtime_error("Delta refers to block " + std::to_string(op.block) + " beyond the file");
+        }
+        result.append(basis.substr(offset, static_cast<std::uint64_t>(op.count) * delta.blockSize));
+    }
+    // Catches a delta made against another version of the file
+    if (result.size() != delta.resultSize || strongHash(result) != delta.resultHash) {
+        throw std::runtime_error("Patched file does not match the delta");
+    }
+    return result;
+}
+
+/**
+ * @brief Checks whether target equals the signed file, so nothing has to be shipped.
+ * @param signature Signature of the live file.
+ * @param target Content of the new file.
+ * @return True if size and checksum of the whole file match.
+ */
+bool DeltaSync::unchanged(const FileSignature& signature, std::string_view target) {
+    return signature.fileSize == target.size() && signature.fileHash == strongHash(target);
+}
+
+/**
+ * @brief Encodes a signature for the link: header and 12 bytes per block.
+ * @param signature Signature to encode.
+ * @return Bytes as sent to the other side.
+ */
+std::string DeltaSync::encode(const FileSignature& signature) {
+    std::string out(SIGNATURE_MAGIC, sizeof(SIGNATURE_MAGIC));
+    put(out, signature.blockSize);
+    put(out, signature.fileSize);
+    put(out, signature.fileHash);
+    put(out, static_cast<std::uint32_t>(signature.blocks.size()));
+    for (const auto& block : signature.blocks) {
+        put(out, block.weak);
+        put(out, block.strong);
+    }
+    return out;
+}
+
+/**
+ * @brief Encodes a delta for the link: a tagged record per copy or literal.
+ * @param delta Delta to encode.
+ * @return Bytes as sent to the other side.
+ */
+std::string DeltaSync::encode(const FileDelta& delta) {
+    std::string out(DELTA_MAGIC, sizeof(DELTA_MAGIC));
+    put(out, delta.blockSize);
+    put(out, delta.resultSize);
+    put(out, delta.resultHash);
+    put(out, static_cast<std::uint32_t>(delta.ops.size()));
+    for (const auto& op : delta.ops) {
+        if (op.count > 0) {
+            out += OP_COPY;
+            put(out, op.block);
+            put(out, op.count);
+        } else {
+            out += OP_LITERAL;
+            put(out, static_cast<std::uint32_t>(op.literal.size()));
+            out += op.literal;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Decodes a signature written by encode().
+ * @param bytes Encoded signature.
+ * @return The signature.
+ * @throws std::runtime_error If the bytes are not a complete signature.
+ */
+FileSignature DeltaSync::decodeSignature(std::string_view bytes) {
+    Reader reader(bytes, "signature");
+    if (reader.take(sizeof(SIGNATURE_MAGIC)) != std::string_view(SIGNATURE_MAGIC, sizeof(SIGNATURE_MAGIC))) {
+        throw std::runtime_error("Not a signature");
+    }
+    FileSignature signature;
+    signature.blockSize = reader.get<std::uint32_t>();
+    signature.fileSize = reader.get<std::uint64_t>();
+    signature.fileHash = reader.get<std::uint64_t>();
+    const auto count = reader.get<std::uint32_t>();
+    if (signature.blockSize == 0 ||
+        count != (signature.fileSize + signature.blockSize - 1) / signature.blockSize) {
+        throw std::runtime_error("Invalid signature header");
+    }
+    signature.blocks.resize(count);
+    for (auto& block : signature.blocks) {
+        block.weak = reader.get<std::uint32_t>();
+        block.strong = reader.get<std::uint64_t>();
+    }
+    reader.expectEnd();
+    return signature;
+}
+
+/**
+ * @brief Decodes a delta written by encode().
+ * @param bytes Encoded delta.
+ * @return The delta.
+ * @throws std::runtime_error If the bytes are not a complete delta.
+ */
+FileDelta DeltaSync::decodeDelta(std::string_view bytes) {
+    Reader reader(bytes, "delta");
+    if (reader.take(sizeof(DELTA_MAGIC)) != std::string_view(DELTA_MAGIC, sizeof(DELTA_MAGIC))) {
+        throw std::runtime_error("Not a delta");
+    }
+    FileDelta delta;
+    delta.blockSize = reader.get<std::uint32_t>();
+    delta.resultSize = reader.get<std::uint64_t>();
+    delta.resultHash = reader.get<std::uint64_t>();
+    const auto count = reader.get<std::uint32_t>();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        DeltaOp op;
+        const char tag = reader.take(1)[0];
+        if (tag == OP_COPY) {
+            op.block = reader.get<std::uint32_t>();
+            op.count = reader.get<std::uint32_t>();
+            if (op.count == 0) {
+                throw std::runtime_error("Invalid delta: empty copy");
+            }
+        } else if (tag == OP_LITERAL) {
+            op.literal = std::string(reader.take(reader.get<std::uint32_t>()));
+        } else {
+            throw std::runtime_error("Invalid delta operation");
+        }
+        delta.ops.push_back(std::move(op));
+    }
+    reader.expectEnd();
+    return delta;
+}
+
+/**
+ * @brief Brings the line files of livePath to the state of stagingPath.
+ *
+ * Both sides first compare size and checksum of every .txt and .times file. Only
+ * files that differ go through the block steps as over the link: signature of the
+ * live file, delta against the staged file, patch. Signature and delta are encoded
+ * and decoded on the way, so the byte counts are what the link would carry. Unchanged files are
+ * not touched; changed ones are written under a temporary name and renamed into place,
+ * so the catalog never sees a half-written file and re-parses only the changed lines.
+ *
+ * @param stagingPath Directory with the new line files.
+ * @param livePath Directory the machine reads, usually data/.
+ * @param options Block size, removal of missing files and dry run.
+ * @return Changed lines and transfer statistics.
+ * @throws std::runtime_error If a directory or file cannot be read or written.
+ */
+SyncResult DeltaSync::syncDirectory(const std::string& stagingPath, const std::string& livePath,
+                                    const SyncOptions& options) {
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(stagingPath)) {
+        throw std::runtime_error("Not a directory: " + stagingPath);
+    }
+    if (!fs::is_directory(livePath)) {
+        throw std::runtime_error("Not a directory: " + livePath);
+    }
+
+    // Sorted, so the output and the order of renames do not depend on the file system
+    std::set<std::string> staged;
+    for (const auto& entry : fs::directory_iterator(stagingPath)) {
+        if (entry.is_regular_file() && isLineFile(entry.path())) {
+            staged.insert(entry.path().filename().string());
+        }
+    }
+
+    SyncResult result;
+    std::set<std::string> changed;
+    for (const auto& name : staged) {
+        const fs::path live = fs::path(livePath) / name;
+        const std::string target = readFile(fs::path(stagingPath) / name);
+        const std::string basis = fs::exists(live) ? readFile(live) : std::string();
+        result.filesChecked++;
+        result.stagedBytes += target.size();
+
+        // First round: name, size and checksum of the whole file; most files end here
+        result.manifestBytes += name.size() + 1 + sizeof(std::uint64_t) * 2;
+        const FileSignature summary{options.blockSize, basis.size(), strongHash(basis), {}};
+        if (fs::exists(live) && unchanged(summary, target)) {
+            continue;
+        }
+
+        const std::string signatureBytes = encode(signature(basis, options.blockSize));
+        result.signatureBytes += signatureBytes.size();
+        const FileSignature received = decodeSignature(signatureBytes);
+
+        const FileDelta fileDelta = delta(received, target);
+        for (const auto& op : fileDelta.ops) {
+            result.literalBytes += op.literal.size();
+        }
+        const std::string deltaBytes = encode(fileDelta);
+        result.deltaBytes += deltaBytes.size();
+        changed.insert(fs::path(name).stem().string());
+        if (!options.dryRun) {
+            writeAtomically(live.string(), patch(basis, decodeDelta(deltaBytes)));
+            result.filesWritten++;
+        }
+    }
+
+    if (options.removeMissing) {
+        for (const auto& entry : fs::directory_iterator(livePath)) {
+            const std::string name = entry.path().filename().string();
+            if (!entry.is_regular_file() || !isLineFile(entry.path()) || staged.count(name) != 0) {
+                continue;
+            }
+            changed.insert(entry.path().stem().string());
+            if (!options.dryRun) {
+                fs::remove(entry.path());
+                result.filesRemoved++;
+            }
+        }
+    }
+
+    result.changedLines.assign(changed.begin(), changed.end());
+    return result;
+}
+
+/**
+ * @brief SipHash-2-4 of a block or file, used as strong checksum.
+ * @param data Bytes to hash.
+ * @return 64-bit checksum.
+ */
+std::uint64_t DeltaSync::strongHash(std::string_view data) {
+    return SipHash::hash24(STRONG_KEY, reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+}
+
+/**
+ * @brief Rolling checksum of a whole block, computed from scratch.
+ * @param data Block bytes.
+ * @return Low 16 bits: sum of the bytes; high 16 bits: weighted sum.
+ */
+std::uint32_t DeltaSync::weakChecksum(std::string_view data) {
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        a += static_cast<unsigned char>(data[i]);
+        b += static_cast<std::uint32_t>(data.size() - i) * static_cast<unsigned char>(data[i]);
+    }
+    return (a & 0xffff) | (b << 16);
+}
+
+/**
+ * @brief Writes a file next to its target, syncs it and renames it over the target.
+ * The temporary name has no .txt or .times extension, so the catalog ignores it.
+ * @param path Target file.
+ * @param data New content.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void DeltaSync::writeAtomically(const std::string& path, const std::string& data) {
+    const std::filesystem::path target(path);
+    const std::string temporary = (target.parent_path() / ("." + target.filename().string() + ".sync")).string();
+    const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write file: " + temporary);
+    }
+    const bool written =
+        write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && fsync(fd) == 0;
+    ::close(fd);
+    if (!written) {
+        std::filesystem::remove(temporary);
+        throw std::runtime_error("Could not write file: " + temporary);
+    }
+    std::filesystem::rename(temporary, target);
+}
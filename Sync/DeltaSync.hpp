@@ -0,0 +1,83 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checksums of one block of the file a machine already has
+struct BlockSignature {
+    std::uint32_t weak = 0;
+    std::uint64_t strong = 0;
+};
+
+// What the machine sends: block checksums of its live file; the last block may be shorter
+struct FileSignature {
+    std::uint32_t blockSize = 0;
+    std::uint64_t fileSize = 0;
+    std::uint64_t fileHash = 0;
+    std::vector<BlockSignature> blocks;
+};
+
+// One step of rebuilding the new file: copy count blocks starting at block, or insert literal
+struct DeltaOp {
+    std::uint32_t block = 0;
+    std::uint32_t count = 0;
+    std::string literal;
+};
+
+// What is shipped back: the new file as blocks of the live file and literal bytes
+struct FileDelta {
+    std::uint32_t blockSize = 0;
+    std::uint64_t resultSize = 0;
+    std::uint64_t resultHash = 0;
+    std::vector<DeltaOp> ops;
+};
+
+struct SyncOptions {
+    std::uint32_t blockSize = 256;
+    // Remove line files from the live directory that are missing in staging
+    bool removeMissing = false;
+    // Only compute what would change
+    bool dryRun = false;
+};
+
+struct SyncResult {
+    // Base names (without extension) of the lines whose .txt or .times changed, sorted
+    std::vector<std::string> changedLines;
+    std::size_t filesChecked = 0;
+    std::size_t filesWritten = 0;
+    std::size_t filesRemoved = 0;
+    // Size of the staged files, i.e. what copying them would transfer
+    std::uint64_t stagedBytes = 0;
+    // What the delta sync transfers: names with file checksums, then signatures and
+    // deltas of the files that differ
+    std::uint64_t manifestBytes = 0;
+    std::uint64_t signatureBytes = 0;
+    std::uint64_t deltaBytes = 0;
+    std::uint64_t literalBytes = 0;
+};
+
+// Block-checksum delta sync of line files (rsync algorithm): the machine describes its
+// file by block checksums, the sender finds those blocks in the new file with a rolling
+// checksum and ships only references and the bytes in between.
+class DeltaSync {
+public:
+    static FileSignature signature(std::string_view data, std::uint32_t blockSize);
+    static FileDelta delta(const FileSignature& signature, std::string_view target);
+    static std::string patch(std::string_view basis, const FileDelta& delta);
+    [[nodiscard]] static bool unchanged(const FileSignature& signature, std::string_view target);
+
+    static std::string encode(const FileSignature& signature);
+    static std::string encode(const FileDelta& delta);
+    static FileSignature decodeSignature(std::string_view bytes);
+    static FileDelta decodeDelta(std::string_view bytes);
+
+    static SyncResult syncDirectory(const std::string& stagingPath, const std::string& livePath,
+                                    const SyncOptions& options = SyncOptions{});
+
+private:
+    static std::uint64_t strongHash(std::string_view data);
+    static std::uint32_t weakChecksum(std::string_view data);
+    static void writeAtomically(const std::string& path, const std::string& data);
+};
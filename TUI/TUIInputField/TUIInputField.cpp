@@ -1,9 +1,7 @@
 #include "TUIInputField.hpp"
+#include "../TerminalIO/TerminalIO.hpp"
 #include <iostream>
-#include <termios.h>
-#include <unistd.h>
 #include <cctype>
-#include <fcntl.h>
 
 /**
  * @brief Enables or disables terminal raw mode.
@@ -11,15 +9,7 @@
  * @param enable Set to true to enable raw mode, false to restore normal mode.
  */
 void TUIInputField::setRawMode(bool enable) {
-    static struct termios oldt, newt;
-    if (enable) {
-        tcgetattr(STDIN_FILENO, &oldt);
-        newt = oldt;
-        newt.c_lflag &= ~(ICANON | ECHO); // Disable canonical mode and echo
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    } else {
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    }
+    TerminalIO::setRawMode(enable);
 }
 
 /**
@@ -34,50 +24,54 @@ void TUIInputField::setRawMode(bool enable) {
  * @param prompt The text displayed before the user input.
  * @return The string entered by the user.
  * @throws InputCancelledException if the user presses ESC.
+ * @throws InputClosedException if the input ends before Enter.
  */
 std::string TUIInputField::getInput(const std::string &prompt) {
     std::string input;
-    std::cout << prompt << std::flush;
+    std::ostream& out = TerminalIO::out();
+    out << prompt;
+    TerminalIO::endFrame();
 
     setRawMode(true);
 
-    char c;
-    while (read(STDIN_FILENO, &c, 1) == 1) {
+    while (true) {
+        char c;
+        try {
+            c = TerminalIO::readByte();
+        } catch (...) {
+            setRawMode(false);
+            throw;
+        }
         if (c == '\033') { // ESC or Escape Sequence
             char seq;
-            int flags = fcntl(STDIN_FILENO, F_GETFL);
-            fcntl(STDIN_FILENO, F_SETFL, flags | O_NONBLOCK);
-            ssize_t n = read(STDIN_FILENO, &seq, 1);
-            fcntl(STDIN_FILENO, F_SETFL, flags); // Restore blocking
-
-            if (n > 0 && seq == '[') {
+            // An escape sequence arrives in one piece; a lone ESC has nothing behind it
+            if (TerminalIO::pollByte(seq, 0) && seq == '[') {
                 // It is an escape sequence (e.g. arrow key), consume the next char
-                read(STDIN_FILENO, &seq, 1);
+                TerminalIO::pollByte(seq, 100);
                 continue; // Ignore
             } else {
                 // Standalone ESC
                 setRawMode(false);
-                std::cout << std::endl;
+                out << std::endl;
                 throw InputCancelledException();
             }
         } else if (c == '\n' || c == '\r') { // Enter
             setRawMode(false);
-            std::cout << std::endl;
+            out << std::endl;
             return input;
         } else if (c == 127 || c == '\b') { // Backspace
             if (!input.empty()) {
                 input.pop_back();
-                std::cout << "\b \b" << std::flush;
+                out << "\b \b";
+                TerminalIO::endFrame();
             }
         } else {
             // Only accept printable characters
-            if (isprint(c)) {
+            if (isprint(static_cast<unsigned char>(c))) {
                 input += c;
-                std::cout << c << std::flush;
+                out << c;
+                TerminalIO::endFrame();
             }
         }
     }
-
-    setRawMode(false);
-    return input;
 }
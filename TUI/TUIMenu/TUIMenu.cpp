@@ -1,9 +1,7 @@
 #include "TUIMenu.hpp"
+#include "../TerminalIO/TerminalIO.hpp"
 #include <iostream>
-#include <termios.h>
-#include <unistd.h>
 #include <utility>
-#include <cstdlib>
 
 /**
  * @brief Constructs a new TUIMenu instance.
@@ -28,19 +26,44 @@ void TUIMenu::addOption(std::string title, std::function<void()> action) {
     options.push_back({std::move(title), std::move(action)});
 }
 
+/**
+ * @brief Adds a range of rows that are identified by their index.
+ *
+ * Instead of one title and one action per row, the menu keeps only the number of
+ * rows and a function returning the label of a row. The rows appear after the
+ * options added so far and before options added later. run() returns the index
+ * of the chosen row, so building a menu of 5000 stops costs the same as one of 5.
+ *
+ * @param count Number of rows.
+ * @param labels Returns the label of row i; the viewed text must stay valid while the menu is used.
+ */
+void TUIMenu::setItems(std::size_t count, std::function<std::string_view(std::size_t)> labels) {
+    itemLabels = std::move(labels);
+    itemCount = count;
+    itemsPosition = options.size();
+}
+
+/**
+ * @brief Adds one row per label without copying the labels.
+ * @param labels The labels; must outlive the menu.
+ */
+void TUIMenu::setItems(const std::vector<std::string>& labels) {
+    setItems(labels.size(), [&labels](std::size_t index) { return std::string_view(labels[index]); });
+}
+
 /**
  * @brief Adds a standard cancellation option to the menu.
  *
- * Inserts a menu entry labeled "Cancel" that immediately terminates
- * the program when selected.
+ * Inserts a menu entry labeled "Cancel" that terminates the program when selected.
  *
- * The cancellation action prints a short message to the console and
- * exits the program with status code 0.
+ * The cancellation action prints a short message to the console and throws
+ * ExitRequestedException, so the caller can shut down in order (print queued
+ * tickets, flush the log) instead of exiting on the spot.
  */
 void TUIMenu::addCancelationOption() {
     addOption("Cancel", []() {
-        std::cout << "Program terminated by user.\n";
-        std::exit(0);
+        TerminalIO::out() << "Program terminated by user.\n";
+        throw ExitRequestedException();
     });
 }
 
@@ -54,60 +77,88 @@ void TUIMenu::addCancelationOption() {
  * @param enable Set to true to enable raw mode, false to restore normal mode.
  */
 void TUIMenu::setRawMode(bool enable) {
-    static struct termios oldt, newt;
+    TerminalIO::setRawMode(enable);
     if (enable) {
-        // Save current terminal attributes to restore later
-        tcgetattr(STDIN_FILENO, &oldt);
-        newt = oldt;
-        // Disable canonical mode (line-by-line input) and echo
-        newt.c_lflag &= ~(ICANON | ECHO);
-        // Apply new terminal attributes
-        tcsetattr(STDIN_FILENO, TCSANOW, &newt);
         // Hide the cursor to improve UI appearance
-        std::cout << "\033[?25l" << std::flush; // Cursor off
+        TerminalIO::out() << "\033[?25l" << std::flush; // Cursor off
     } else {
-        // Restore saved terminal attributes
-        tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
         // Show the cursor again
-        std::cout << "\033[?25h" << std::flush; // Cursor on
+        TerminalIO::out() << "\033[?25h" << std::flush; // Cursor on
     }
 }
 
 /**
  * @brief Draws the menu to the terminal.
  *
- * Clears the screen, prints the menu title, and renders all menu options.
- * The currently selected option is highlighted.
+ * Clears the screen and renders the menu with the current selection.
  */
 void TUIMenu::draw() const {
     // Clear the screen and move cursor to home position
-    std::cout << "\033[H\033[J"; // Screen Clear
-    
+    std::ostream& out = TerminalIO::out();
+    out << "\033[H\033[J"; // Screen Clear
+    render(out);
+    // Send the whole frame at once
+    TerminalIO::endFrame();
+}
+
+/**
+ * @brief Renders the menu title and all options into a stream.
+ *
+ * The currently selected option is highlighted.
+ *
+ * @param out Target stream, e.g. std::cout or a buffer for measurements.
+ */
+void TUIMenu::render(std::ostream& out) const {
     // Render the menu title with cyan color
-    std::cout << "\033[1;36m" << menuTitle << "\033[0m\n";
-    std::cout << "============================\n\n";
+    out << "\033[1;36m" << menuTitle << "\033[0m\n";
+    out << "============================\n\n";
 
-    // Loop over all options to render them
-    for (std::size_t i = 0; i < options.size(); ++i) {
+    // Loop over all rows to render them
+    const std::size_t rows = rowCount();
+    for (std::size_t i = 0; i < rows; ++i) {
         if (i == selected) {
             // Highlight the selected option with a cyan bullet
-            std::cout << "  \033[1;36m● " << options[i].title << "\033[0m\n";
+            out << "  \033[1;36m● " << rowLabel(i) << "\033[0m\n";
         } else {
             // Render unselected options with a hollow bullet
-            std::cout << "  ○ " << options[i].title << "\n";
+            out << "  ○ " << rowLabel(i) << "\n";
         }
     }
 }
 
+/**
+ * @brief Returns the number of rows: options plus index-mode items.
+ */
+std::size_t TUIMenu::rowCount() const {
+    return options.size() + itemCount;
+}
+
+/**
+ * @brief Returns the label of a row, taking the item range into account.
+ * @param row Row index in display order.
+ */
+std::string_view TUIMenu::rowLabel(std::size_t row) const {
+    if (row < itemsPosition) {
+        return options[row].title;
+    }
+    if (row < itemsPosition + itemCount) {
+        return itemLabels(row - itemsPosition);
+    }
+    return options[row - itemCount].title;
+}
+
 /**
  * @brief Starts the menu event loop.
  *
  * Handles keyboard input (arrow keys and Enter), updates the selection,
  * and executes the selected action when Enter is pressed.
+ *
+ * @return Index of the chosen item (see setItems()), or NO_ITEM if an option was chosen.
  */
-void TUIMenu::run() {
-    if (options.empty()) return;
+std::size_t TUIMenu::run() {
+    if (rowCount() == 0) return NO_ITEM;
     bool running = true;
+    std::size_t chosenItem = NO_ITEM;
 
     // Step 1: Enable raw mode to read input byte-by-byte immediately
     // This is moved outside the loop to prevent saving the already modified state
@@ -119,15 +170,20 @@ void TUIMenu::run() {
         draw();
 
         char c;
-        // Read one character from stdin
-        read(STDIN_FILENO, &c, 1); // keyboard input
+        // Read one character from the terminal
+        try {
+            c = TerminalIO::readByte(); // keyboard input
+        } catch (...) {
+            setRawMode(false);
+            throw;
+        }
 
         // Check if input was an escape sequence (likely arrow keys)
         if (c == '\033') {
-            char seq[2];
+            char seq[2] = {0, 0};
             // Read the next two bytes to determine the sequence
-            read(STDIN_FILENO, &seq[0], 1);
-            read(STDIN_FILENO, &seq[1], 1);
+            TerminalIO::pollByte(seq[0], 100);
+            TerminalIO::pollByte(seq[1], 100);
             
             // 'A' is Up Arrow, 'B' is Down Arrow
             if (seq[1] == 'A') moveCursorUp(); 
@@ -139,11 +195,19 @@ void TUIMenu::run() {
             // Disable raw mode before executing action to allow normal input if needed
             setRawMode(false);
             // Clear screen before running action
-            std::cout << "\033[H\033[J";
+            TerminalIO::out() << "\033[H\033[J";
             
+            // An item is only reported back; the caller acts on the index
+            if (selected >= itemsPosition && selected < itemsPosition + itemCount) {
+                chosenItem = selected - itemsPosition;
+                running = false;
+                continue;
+            }
+
             // Perform action of selected option safely
+            const Option& option = options[selected < itemsPosition ? selected : selected - itemCount];
             try {
-                options[selected].action();
+                option.action();
             } catch (...) {
                 // If an exception occurs, ensure we aren't stuck in a weird state
                 setRawMode(false); // Ensure raw mode is definitely off
@@ -154,6 +218,7 @@ void TUIMenu::run() {
     }
     // Final cleanup: Ensure raw mode is disabled when exiting
     setRawMode(false);
+    return chosenItem;
 }
 
 /**
@@ -165,12 +230,27 @@ void TUIMenu::waitForKey() {
     // Enable raw mode to catch single character
     setRawMode(true);
     char c;
-    // Wait for one byte of input
-    read(STDIN_FILENO, &c, 1);
+    // Wait for one byte of input; end of input counts as a key
+    TerminalIO::pollByte(c, -1);
     // Restore normal terminal settings
     setRawMode(false);
 }
 
+/**
+ * @brief Waits for a single key press, but at most timeoutMs milliseconds.
+ * Used where the next customer should not have to press a key to continue.
+ * @param timeoutMs Maximum waiting time in milliseconds.
+ * @return True if a key was pressed, false on timeout.
+ */
+bool TUIMenu::waitForKey(int timeoutMs) {
+    setRawMode(true);
+    // Consumes the key so it does not reach the next menu
+    char c;
+    const bool pressed = TerminalIO::pollByte(c, timeoutMs);
+    setRawMode(false);
+    return pressed;
+}
+
 /**
  * @brief Moves the cursor down.
  * Jumps back to the first element if at the end.
@@ -179,7 +259,7 @@ void TUIMenu::waitForKey() {
  */
 void TUIMenu::moveCursorDown() {
     // Increment selected index with wrap-around using modulo
-    selected = (selected + 1) % options.size();
+    selected = (selected + 1) % rowCount();
 }
 
 /**
@@ -191,5 +271,5 @@ void TUIMenu::moveCursorDown() {
 void TUIMenu::moveCursorUp() {
     // Decrement selected index with wrap-around.
     // Adding options.size() before subtracting 1 prevents unsigned underflow.
-    selected = (selected + options.size() - 1 ) % options.size();
+    selected = (selected + rowCount() - 1 ) % rowCount();
 }
\ No newline at end of file
@@ -3,6 +3,17 @@
 #include <string>
 #include <functional>
 #include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <exception>
+
+// Thrown by the "Cancel" option; main prints queued tickets and flushes the log before exiting
+struct ExitRequestedException : public std::exception {
+    const char* what() const noexcept override {
+        return "Program terminated by user";
+    }
+};
 
 class TUIMenu {
 private:
@@ -14,6 +25,10 @@ private:
     std::vector<Option> options;
     std::string menuTitle;
     std::size_t selected = 0;
+    // Index mode: itemCount rows labelled by itemLabels, shown at itemsPosition among the options
+    std::function<std::string_view(std::size_t)> itemLabels;
+    std::size_t itemCount = 0;
+    std::size_t itemsPosition = 0;
 
     // Enables or disables terminal raw mode (no echo, no canonical input)
     static void setRawMode(bool enable);
@@ -23,11 +38,25 @@ private:
     void moveCursorUp();
     // Moves the selection one item down (with wrap-around)
     void moveCursorDown();
+    [[nodiscard]] std::size_t rowCount() const;
+    [[nodiscard]] std::string_view rowLabel(std::size_t row) const;
 
 public:
+    // Returned by run() if an option with an action was chosen instead of an item
+    static constexpr std::size_t NO_ITEM = SIZE_MAX;
+
     explicit TUIMenu(std::string title);
     void addOption(std::string title, std::function<void()> action);
+    // Adds count rows whose labels are fetched on drawing; nothing is copied per row
+    void setItems(std::size_t count, std::function<std::string_view(std::size_t)> labels);
+    // Non-owning view over labels; the vector must outlive the menu
+    void setItems(const std::vector<std::string>& labels);
     void addCancelationOption();
-    void run();
+    // Runs the menu; returns the index of the chosen item or NO_ITEM
+    std::size_t run();
+    // Renders the menu into the given stream without clearing the screen
+    void render(std::ostream& out) const;
     static void waitForKey();
+    // Waits for a key press or until the timeout expires; returns true if a key was pressed
+    static bool waitForKey(int timeoutMs);
 };
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "TerminalIO.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+std::ostream* outputStream = nullptr;
+int inputFd = STDIN_FILENO;
+
+bool frameMarkerEnabled() {
+    static const bool enabled = std::getenv("TICKETAUTOMAT_FRAME_MARKER") != nullptr;
+    return enabled;
+}
+}
+
+/**
+ * @brief Returns the stream the TUI draws to.
+ * @return std::cout unless redirected with setOutput().
+ */
+std::ostream& TerminalIO::out() {
+    return outputStream != nullptr ? *outputStream : std::cout;
+}
+
+/**
+ * @brief Redirects the TUI output, e.g. into a std::ostringstream in tests.
+ * @param stream Target stream, or nullptr for std::cout.
+ */
+void TerminalIO::setOutput(std::ostream* stream) {
+    outputStream = stream;
+}
+
+/**
+ * @brief Returns the file descriptor keys are read from.
+ */
+int TerminalIO::input() {
+    return inputFd;
+}
+
+/**
+ * @brief Reads keys from another file descriptor, e.g. a pipe in tests.
+ * @param fd File descriptor to read from; STDIN_FILENO by default.
+ */
+void TerminalIO::setInput(int fd) {
+    inputFd = fd;
+}
+
+/**
+ * @brief Reads one byte of input, waiting as long as necessary.
+ * @return The byte read.
+ * @throws InputClosedException If the input has reached end of file.
+ */
+char TerminalIO::readByte() {
+    char c = 0;
+    while (true) {
+        const ssize_t n = read(inputFd, &c, 1);
+        if (n == 1) {
+            return c;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        throw InputClosedException();
+    }
+}
+
+/**
+ * @brief Reads one byte if it arrives within the timeout.
+ * @param c Receives the byte.
+ * @param timeoutMs Maximum waiting time; 0 only checks, -1 waits forever.
+ * @return True if a byte was read, false on timeout or end of input.
+ */
+bool TerminalIO::pollByte(char& c, int timeoutMs) {
+    pollfd descriptor{inputFd, POLLIN, 0};
+    if (poll(&descriptor, 1, timeoutMs) <= 0) {
+        return false;
+    }
+    return read(inputFd, &c, 1) == 1;
+}
+
+/**
+ * @brief Enables or disables terminal raw mode on the input.
+ *
+ * When enabled, canonical input and echo are disabled so that key presses
+ * can be read byte-by-byte. When disabled, the settings saved by the last
+ * enable call are restored. Does nothing if the input is not a terminal.
+ *
+ * @param enable Set to true to enable raw mode, false to restore normal mode.
+ */
+void TerminalIO::setRawMode(bool enable) {
+    static termios savedSettings{};
+    static bool saved = false;
+    if (enable) {
+        termios raw{};
+        if (tcgetattr(inputFd, &savedSettings) != 0) {
+            saved = false;
+            return;
+        }
+        saved = true;
+        raw = savedSettings;
+        // Disable canonical mode (line-by-line input) and echo
+        raw.c_lflag &= ~(ICANON | ECHO);
+        tcsetattr(inputFd, TCSANOW, &raw);
+    } else if (saved) {
+        tcsetattr(inputFd, TCSANOW, &savedSettings);
+    }
+}
+
+/**
+ * @brief Marks the end of a frame: flushes the output so it reaches the terminal at once.
+ * With TICKETAUTOMAT_FRAME_MARKER set, FRAME_MARKER is appended, so the key replay
+ * harness can measure the time from a key press to the complete frame.
+ */
+void TerminalIO::endFrame() {
+    std::ostream& stream = out();
+    if (frameMarkerEnabled()) {
+        stream << FRAME_MARKER;
+    }
+    stream.flush();
+}
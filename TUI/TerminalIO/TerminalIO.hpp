@@ -0,0 +1,25 @@
+#pragma once
+#include <iosfwd>
+#include <stdexcept>
+
+// Thrown when the input reaches end of file, e.g. when a replayed key script ends
+struct InputClosedException : public std::runtime_error {
+    InputClosedException() : std::runtime_error("Terminal input closed") {}
+};
+
+// Where the TUI reads keys from and draws to. Defaults to stdin and std::cout;
+// tests and the key replay harness redirect it.
+class TerminalIO {
+public:
+    // Written after every frame if TICKETAUTOMAT_FRAME_MARKER is set; terminals ignore this OSC sequence
+    static constexpr const char* FRAME_MARKER = "\033]9999;frame\007";
+
+    static std::ostream& out();
+    static void setOutput(std::ostream* stream);
+    static int input();
+    static void setInput(int fd);
+    static char readByte();
+    static bool pollByte(char& c, int timeoutMs);
+    static void setRawMode(bool enable);
+    static void endFrame();
+};
@@ -0,0 +1,97 @@
+#include "../Simulation/ChangeBoxSimulator.hpp"
+#include <iostream>
+#include <cassert>
+
+// Kleines Netz, damit der Test unabhängig vom data/ Ordner ist
+std::vector<TramData> testLines() {
+    TramData a{"Linie A", 3, {"A1", "A2", "A3", "A4", "A5", "A6"}};
+    TramData b{"Linie B", 7, {"B1", "B2", "B3"}};
+    return {a, b};
+}
+
+void test_deterministic() {
+    std::cout << "Teste Reproduzierbarkeit..." << std::endl;
+
+    SimulationConfig config;
+    config.days = 50;
+    config.customersPerDay = 100;
+    config.seed = 42;
+
+    config.threads = 1;
+    SimulationReport single = ChangeBoxSimulator(testLines(), config).run();
+    config.threads = 4;
+    SimulationReport parallel = ChangeBoxSimulator(testLines(), config).run();
+
+    // Gleicher Seed -> gleiches Ergebnis, egal wie viele Threads
+    assert(single.sales == parallel.sales);
+    assert(single.failedPayouts == parallel.failedPayouts);
+    assert(single.paidOut == parallel.paidOut);
+    assert(single.sales > 0);
+
+    // Anderer Seed -> andere Kundenströme
+    config.seed = 43;
+    SimulationReport other = ChangeBoxSimulator(testLines(), config).run();
+    assert(other.sales != single.sales || other.paidOut != single.paidOut);
+}
+
+void test_bigger_stock_helps() {
+    std::cout << "Teste Kassettengröße..." << std::endl;
+
+    SimulationConfig config;
+    config.days = 30;
+    config.customersPerDay = 200;
+    SimulationReport small = ChangeBoxSimulator(testLines(), config).run();
+
+    for (auto& [value, count] : config.initialStock) {
+        count = 100;
+    }
+    SimulationReport big = ChangeBoxSimulator(testLines(), config).run();
+
+    assert(big.failedPayouts < small.failedPayouts);
+    assert(big.daysWithStockout <= small.daysWithStockout);
+}
+
+void test_exact_payers() {
+    std::cout << "Teste passend zahlende Kunden..." << std::endl;
+
+    SimulationConfig config;
+    config.days = 5;
+    config.exactShare = 1.0;
+    SimulationReport report = ChangeBoxSimulator(testLines(), config).run();
+
+    // Wer passend zahlt, bekommt kein Wechselgeld
+    assert(report.failedPayouts == 0);
+    assert(report.paidOut.empty());
+}
+
+void test_recycling_helps() {
+    std::cout << "Teste Recycling eingeworfener Münzen..." << std::endl;
+
+    SimulationConfig config;
+    config.days = 30;
+    config.customersPerDay = 200;
+    config.daysBetweenRefills = 2;
+    SimulationReport recycling = ChangeBoxSimulator(testLines(), config).run();
+
+    config.capacity.clear();
+    SimulationReport cashOnly = ChangeBoxSimulator(testLines(), config).run();
+
+    // Eingeworfene Münzen werden wieder Wechselgeld
+    assert(recycling.failedPayouts < cashOnly.failedPayouts);
+    assert(recycling.medianMinutesUntilRefill >= cashOnly.medianMinutesUntilRefill);
+    // Ohne Recycling landet alles in der Kasse
+    long cashOnlyPieces = 0;
+    for (const auto& [value, count] : cashOnly.cashBox) {
+        cashOnlyPieces += count;
+    }
+    assert(cashOnlyPieces >= cashOnly.sales);
+}
+
+int main() {
+    test_deterministic();
+    test_bigger_stock_helps();
+    test_exact_payers();
+    test_recycling_helps();
+    std::cout << "Simulator Tests fertig." << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "../Sync/DeltaSync.hpp"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+const std::string STAGING = "test_sync_staging";
+const std::string LIVE = "test_sync_live";
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+// Liniendatei mit vielen Haltestellen, damit es mehrere Blöcke gibt
+std::string makeLine(const std::string& name, int stops, const std::string& changedStop = "") {
+    std::string content = name + "\n3\n";
+    for (int i = 1; i <= stops; ++i) {
+        content += (i == stops / 2 && !changedStop.empty()) ? changedStop : "Haltestelle " + std::to_string(i);
+        content += '\n';
+    }
+    return content;
+}
+
+std::size_t literalBytes(const FileDelta& delta) {
+    std::size_t bytes = 0;
+    for (const auto& op : delta.ops) {
+        bytes += op.literal.size();
+    }
+    return bytes;
+}
+
+void test_delta() {
+    std::cout << "Teste Delta zwischen zwei Versionen..." << std::endl;
+    const std::string oldFile = makeLine("Linie 7", 200);
+    const FileSignature signature = DeltaSync::signature(oldFile, 64);
+    assert(signature.blocks.size() == (oldFile.size() + 63) / 64);
+
+    // Unverändert: eine einzige Kopie ohne neue Daten
+    assert(DeltaSync::unchanged(signature, oldFile));
+    FileDelta same = DeltaSync::delta(signature, oldFile);
+    assert(same.ops.size() == 1 && literalBytes(same) == 0);
+    assert(DeltaSync::patch(oldFile, same) == oldFile);
+
+    // Umbenannte Haltestelle in der Mitte verschiebt alles Folgende
+    const std::string renamed = makeLine("Linie 7", 200, "Neue Haltestelle am Markt");
+    assert(!DeltaSync::unchanged(signature, renamed));
+    FileDelta changed = DeltaSync::delta(signature, renamed);
+    assert(literalBytes(changed) < 3 * 64);
+    assert(DeltaSync::patch(oldFile, changed) == renamed);
+
+    // Einfügen am Anfang, Anhängen am Ende, Kürzen, leere Dateien
+    for (const std::string& target : {"Linie 7 (neu)\n" + oldFile.substr(8), oldFile + "Endstation\n",
+                                      oldFile.substr(0, oldFile.size() - 100), std::string(), oldFile.substr(0, 10)}) {
+        assert(DeltaSync::patch(oldFile, DeltaSync::delta(signature, target)) == target);
+    }
+    const FileSignature empty = DeltaSync::signature("", 64);
+    assert(empty.blocks.empty());
+    FileDelta all = DeltaSync::delta(empty, oldFile);
+    assert(literalBytes(all) == oldFile.size());
+    assert(DeltaSync::patch("", all) == oldFile);
+    std::cout << "Delta erfolgreich." << std::endl;
+}
+
+void test_encoding() {
+    std::cout << "Teste Kodierung für die Übertragung..." << std::endl;
+    const std::string oldFile = makeLine("Linie 3", 120);
+    const std::string newFile = makeLine("Linie 3", 120, "Rathaus");
+    const FileSignature signature = DeltaSync::decodeSignature(DeltaSync::encode(DeltaSync::signature(oldFile, 32)));
+    const std::string encoded = DeltaSync::encode(DeltaSync::delta(signature, newFile));
+    assert(encoded.size() < newFile.size() / 4);
+    assert(DeltaSync::patch(oldFile, DeltaSync::decodeDelta(encoded)) == newFile);
+
+    // Abgeschnittene Daten und Delta gegen eine andere Version werden erkannt
+    bool threw = false;
+    try {
+        (void) DeltaSync::decodeDelta(encoded.substr(0, encoded.size() - 1));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        (void) DeltaSync::patch(makeLine("Linie 3", 120, "Bahnhof"), DeltaSync::decodeDelta(encoded));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "Kodierung erfolgreich." << std::endl;
+}
+
+void test_directory() {
+    std::cout << "Teste Abgleich zweier Ordner..." << std::endl;
+    namespace fs = std::filesystem;
+    fs::create_directories(STAGING);
+    fs::create_directories(LIVE);
+    std::ofstream(LIVE + "/Linie1.txt") << makeLine("Linie 1", 100);
+    std::ofstream(LIVE + "/Linie2.txt") << makeLine("Linie 2", 100);
+    std::ofstream(LIVE + "/Linie2.times") << "06:00 20 24:00\n";
+    std::ofstream(LIVE + "/Alt.txt") << makeLine("Alt", 5);
+    fs::copy(LIVE + "/Linie1.txt", STAGING + "/Linie1.txt");
+    fs::copy(LIVE + "/Linie2.txt", STAGING + "/Linie2.txt");
+    std::ofstream(STAGING + "/Linie2.times") << "05:30 15 24:00\n";
+    std::ofstream(STAGING + "/Linie3.txt") << makeLine("Linie 3", 10);
+    std::ofstream(STAGING + "/notizen.md") << "keine Liniendatei\n";
+    const auto untouched = fs::last_write_time(LIVE + "/Linie1.txt");
+
+    // Probelauf ändert nichts
+    SyncOptions options;
+    options.dryRun = true;
+    SyncResult result = DeltaSync::syncDirectory(STAGING, LIVE, options);
+    assert((result.changedLines == std::vector<std::string>{"Linie2", "Linie3"}));
+    assert(result.filesWritten == 0 && !fs::exists(LIVE + "/Linie3.txt"));
+
+    options.dryRun = false;
+    options.removeMissing = true;
+    result = DeltaSync::syncDirectory(STAGING, LIVE, options);
+    assert((result.changedLines == std::vector<std::string>{"Alt", "Linie2", "Linie3"}));
+    assert(result.filesChecked == 4 && result.filesWritten == 2 && result.filesRemoved == 1);
+    assert(result.manifestBytes + result.signatureBytes + result.deltaBytes < result.stagedBytes);
+    for (const std::string name : {"Linie1.txt", "Linie2.txt", "Linie2.times", "Linie3.txt"}) {
+        assert(readFile(LIVE + "/" + name) == readFile(STAGING + "/" + name));
+    }
+    assert(!fs::exists(LIVE + "/Alt.txt") && !fs::exists(LIVE + "/notizen.md"));
+    // Unveränderte Dateien werden nicht neu geschrieben, keine Hilfsdateien bleiben liegen
+    assert(fs::last_write_time(LIVE + "/Linie1.txt") == untouched);
+    for (const auto& entry : fs::directory_iterator(LIVE)) {
+        assert(entry.path().extension() != ".sync");
+    }
+
+    // Zweiter Lauf: nichts mehr zu tun
+    result = DeltaSync::syncDirectory(STAGING, LIVE, options);
+    assert(result.changedLines.empty() && result.signatureBytes == 0 && result.deltaBytes == 0);
+    std::cout << "Ordnerabgleich erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests DeltaSync ---" << std::endl;
+    std::filesystem::remove_all(STAGING);
+    std::filesystem::remove_all(LIVE);
+    test_delta();
+    test_encoding();
+    test_directory();
+    std::filesystem::remove_all(STAGING);
+    std::filesystem::remove_all(LIVE);
+    std::cout << "--- Alle Tests DeltaSync bestanden ---" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "../Capping/FareLedger.hpp"
+#include <cassert>
+#include <climits>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+const std::string TEST_FOLDER = "test_fares";
+const std::string LEDGER = TEST_FOLDER + "/fares.ledger";
+// Montag, 2026-01-05, in Tagen seit 1970-01-01
+const std::uint16_t MONDAY = 20458;
+
+void test_caps() {
+    std::cout << "Teste Tages- und Wochendeckel..." << std::endl;
+    FareLedger ledger(LEDGER, CapConfig{10, 25});
+    ledger.open();
+    const std::uint64_t rider = ledger.riderId("KARTE-1234");
+    assert(rider != 0);
+    // Groß- und Kleinschreibung spielen keine Rolle
+    assert(ledger.riderId("karte-1234") == rider && ledger.riderId("KARTE-1235") != rider);
+
+    assert(ledger.allowance(rider, MONDAY) == 10);
+    ledger.record(rider, 6, MONDAY);
+    assert(ledger.allowance(rider, MONDAY) == 4);
+    ledger.record(rider, 4, MONDAY);
+    assert(ledger.allowance(rider, MONDAY) == 0);
+    // Fahrten mit 0 Geld ändern nichts
+    ledger.record(rider, 0, MONDAY);
+    assert(ledger.totals(rider, MONDAY).day == 10);
+
+    // Neuer Tag: Tagesdeckel wieder frei, bis der Wochendeckel greift
+    assert(ledger.allowance(rider, MONDAY + 1) == 10);
+    ledger.record(rider, 10, MONDAY + 1);
+    assert(ledger.allowance(rider, MONDAY + 2) == 5);
+    ledger.record(rider, 5, MONDAY + 2);
+    assert(ledger.allowance(rider, MONDAY + 6) == 0);
+
+    // Neue Woche ab Montag
+    const RiderTotals nextWeek = ledger.totals(rider, MONDAY + 7);
+    assert(nextWeek.day == 0 && nextWeek.week == 0);
+    assert(ledger.allowance(rider, MONDAY + 7) == 10);
+    ledger.record(rider, 3, MONDAY + 7);
+    assert(ledger.totals(rider, MONDAY + 7).week == 3);
+    assert(ledger.size() == 1);
+
+    FareLedger unlimited(TEST_FOLDER + "/ohne.ledger", CapConfig{0, 0});
+    unlimited.open();
+    assert(unlimited.allowance(unlimited.riderId("ABCD"), MONDAY) == INT_MAX);
+    std::cout << "Tages- und Wochendeckel erfolgreich." << std::endl;
+}
+
+void test_weeks() {
+    std::cout << "Teste Wochengrenzen..." << std::endl;
+    // 1970-01-01 war ein Donnerstag, 1970-01-05 ein Montag
+    assert(FareLedger::weekOfDay(0) == FareLedger::weekOfDay(3));
+    assert(FareLedger::weekOfDay(4) == FareLedger::weekOfDay(0) + 1);
+    assert(FareLedger::weekOfDay(MONDAY) == FareLedger::weekOfDay(MONDAY + 6));
+    assert(FareLedger::weekOfDay(MONDAY - 1) + 1 == FareLedger::weekOfDay(MONDAY));
+    std::cout << "Wochengrenzen erfolgreich." << std::endl;
+}
+
+void test_persistence() {
+    std::cout << "Teste Speicherung..." << std::endl;
+    std::uint64_t rider = 0;
+    {
+        FareLedger ledger(LEDGER);
+        ledger.open();
+        rider = ledger.riderId("ABC-987");
+        ledger.record(rider, 12, MONDAY);
+    }
+    // Der Schlüssel liegt in der Datei, die Kartennummer nicht
+    std::ifstream file(LEDGER, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    assert(content.find("ABC-987") == std::string::npos);
+
+    FareLedger reopened(LEDGER);
+    reopened.open();
+    assert(reopened.riderId("ABC-987") == rider);
+    assert(reopened.totals(rider, MONDAY).day == 12);
+
+    std::ofstream(TEST_FOLDER + "/kaputt.ledger") << "kein Fahrpreisdeckel";
+    FareLedger broken(TEST_FOLDER + "/kaputt.ledger");
+    bool threw = false;
+    try {
+        broken.open();
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "Speicherung erfolgreich." << std::endl;
+}
+
+void test_growth() {
+    std::cout << "Teste Wachstum und Bereinigung..." << std::endl;
+    FareLedger ledger(LEDGER, CapConfig{}, 16);
+    ledger.open();
+    assert(ledger.capacity() == 16);
+
+    // Fahrgäste der Vorwoche und dieser Woche
+    for (int i = 0; i < 40; ++i) {
+        ledger.record(ledger.riderId("ALT-" + std::to_string(i)), 5, MONDAY - 3);
+    }
+    assert(ledger.size() == 40 && ledger.capacity() >= 64);
+    for (int i = 0; i < 40; ++i) {
+        ledger.record(ledger.riderId("NEU-" + std::to_string(i)), 4, MONDAY);
+    }
+    // Beim Umbau fallen abgelaufene Wochen weg
+    assert(ledger.size() < 80);
+    for (int i = 0; i < 40; ++i) {
+        assert(ledger.totals(ledger.riderId("NEU-" + std::to_string(i)), MONDAY).day == 4);
+    }
+    assert(!std::filesystem::exists(LEDGER + ".new"));
+
+    FareLedger reopened(LEDGER);
+    reopened.open();
+    assert(reopened.size() == ledger.size());
+    assert(reopened.totals(reopened.riderId("NEU-39"), MONDAY + 1).week == 4);
+    std::cout << "Wachstum und Bereinigung erfolgreich." << std::endl;
+}
+
+void test_card_ids() {
+    std::cout << "Teste Kartennummern..." << std::endl;
+    assert(FareLedger::isValidCardId("1234"));
+    assert(FareLedger::isValidCardId("DE-0042-7781"));
+    assert(!FareLedger::isValidCardId("123"));
+    assert(!FareLedger::isValidCardId("12 34"));
+    assert(!FareLedger::isValidCardId(std::string(33, '7')));
+    std::cout << "Kartennummern erfolgreich." << std::endl;
+}
+
+void resetFolder() {
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::filesystem::create_directories(TEST_FOLDER);
+}
+
+int main() {
+    std::cout << "--- Start Tests FareLedger ---" << std::endl;
+    resetFolder();
+    test_caps();
+    test_weeks();
+    resetFolder();
+    test_persistence();
+    resetFolder();
+    test_growth();
+    test_card_ids();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests FareLedger bestanden ---" << std::endl;
+    return 0;
+}
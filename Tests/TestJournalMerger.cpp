@@ -0,0 +1,189 @@
+#include "../Sales/JournalMerger.hpp"
+#include "../Sales/SalesJournal.hpp"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const std::string TEST_FOLDER = "test_merge";
+
+TicketData sale(std::uint32_t serial, std::int64_t timestamp, int price = 6) {
+    TicketData ticket;
+    ticket.serial = serial;
+    ticket.timestamp = timestamp;
+    ticket.date = "2026-01-01";
+    ticket.tram = "Linie 4";
+    ticket.startStop = "Hauptbahnhof";
+    ticket.destinationStop = "Connewitz";
+    ticket.price = price;
+    return ticket;
+}
+
+// Schreibt ein Journal wie der Automat: Kopfzeile, dann ein Verkauf pro Zeile
+std::string writeJournal(const std::string& name, const std::string& machine, const std::vector<TicketData>& sales,
+                         const std::string& tail = "") {
+    const std::string path = TEST_FOLDER + "/" + name;
+    std::ofstream file(path, std::ios::binary);
+    file << SalesJournal::HEADER_PREFIX << machine << "\n";
+    for (const auto& ticket : sales) {
+        file << SalesJournal::formatRecord(ticket) << "\n";
+    }
+    file << tail;
+    return path;
+}
+
+std::vector<JournalRecord> mergeAll(const std::vector<std::string>& paths, MergeReport& report,
+                                    const MergeConfig& config = MergeConfig{}) {
+    std::vector<JournalRecord> merged;
+    report = JournalMerger::merge(paths, [&merged](const JournalRecord& record) { merged.push_back(record); },
+                                  config);
+    return merged;
+}
+
+void test_order_and_duplicates() {
+    std::cout << "Teste Reihenfolge und Duplikate..." << std::endl;
+    const auto a = writeJournal("a.journal", "automat-a", {sale(1, 100), sale(2, 300), sale(3, 300), sale(4, 500)});
+    const auto b = writeJournal("b.journal", "automat-b", {sale(1, 200), sale(2, 300), sale(3, 600)});
+    // Dasselbe Journal zweimal eingesammelt
+    const auto copy = writeJournal("a-kopie.journal", "automat-a", {sale(2, 300), sale(3, 300)});
+
+    MergeReport report;
+    const auto merged = mergeAll({a, b, copy}, report);
+    assert(report.recordsRead == 9);
+    assert(report.recordsWritten == 7 && merged.size() == 7);
+    assert(report.duplicates == 2 && report.conflicts == 0);
+    assert(report.gapCount == 0 && report.duplicateSerialCount == 0 && report.outOfOrder == 0);
+
+    // Nach Zeit, bei gleicher Sekunde nach Automat und Seriennummer
+    const std::vector<std::pair<std::string, std::uint32_t>> expected = {
+        {"automat-a", 1}, {"automat-b", 1}, {"automat-a", 2}, {"automat-a", 3},
+        {"automat-b", 2}, {"automat-a", 4}, {"automat-b", 3}};
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        assert(merged[i].machine == expected[i].first && merged[i].serial == expected[i].second);
+    }
+    // Der Datensatz wird unverändert weitergegeben
+    assert(SalesJournal::parseRecord(merged[0].text).destinationStop == "Connewitz");
+    std::cout << "Reihenfolge und Duplikate erfolgreich." << std::endl;
+}
+
+void test_serial_problems() {
+    std::cout << "Teste Lücken und doppelte Seriennummern..." << std::endl;
+    // Seriennummern 3 und 4 fehlen; nach einem Zurücksetzen beginnt der Automat wieder bei 1
+    const auto a = writeJournal("luecke.journal", "automat-a",
+                                {sale(1, 100), sale(2, 200), sale(5, 300), sale(1, 400), sale(6, 500)});
+    // Gleiche Seriennummer und Zeit, aber anderer Preis
+    const auto conflict = writeJournal("konflikt.journal", "automat-a", {sale(2, 200, 9)});
+    // Zeit läuft rückwärts (Uhr zurückgestellt)
+    const auto clock = writeJournal("uhr.journal", "automat-c", {sale(1, 900), sale(2, 800)});
+
+    MergeReport report;
+    const auto merged = mergeAll({a, conflict, clock}, report);
+    assert(report.conflicts == 1 && report.duplicates == 0);
+    assert(report.gapCount == 1 && report.missingSerials == 2);
+    assert(report.gaps[0].machine == "automat-a" && report.gaps[0].after == 2 && report.gaps[0].next == 5);
+    assert(report.duplicateSerialCount == 1);
+    assert(report.duplicateSerials[0].serial == 1 && report.duplicateSerials[0].timestamp == 400);
+    assert(report.outOfOrder == 1);
+    // Der erste Datensatz gewinnt; alle echten Verkäufe bleiben erhalten
+    assert(merged.size() == 7);
+    assert(SalesJournal::parseRecord(merged[1].text).price == 6);
+    std::cout << "Lücken und doppelte Seriennummern erfolgreich." << std::endl;
+}
+
+void test_multiple_passes() {
+    std::cout << "Teste mehrere Durchläufe..." << std::endl;
+    std::vector<std::string> paths;
+    for (int m = 0; m < 7; ++m) {
+        std::vector<TicketData> sales;
+        for (std::uint32_t s = 1; s <= 50; ++s) {
+            sales.push_back(sale(s, 1000 + s * 7 + m));
+        }
+        paths.push_back(writeJournal("flotte-" + std::to_string(m) + ".journal", "automat-" + std::to_string(m),
+                                     sales));
+    }
+    paths.push_back(paths.front());
+
+    MergeReport single;
+    const auto expected = mergeAll(paths, single);
+    MergeConfig config;
+    config.maxOpenFiles = 2;
+    config.tempFolder = TEST_FOLDER;
+    MergeReport multi;
+    const auto merged = mergeAll(paths, multi, config);
+
+    assert(single.passes == 1 && multi.passes == 3);
+    assert(merged.size() == 350 && merged.size() == expected.size());
+    for (std::size_t i = 0; i < merged.size(); ++i) {
+        assert(merged[i].machine == expected[i].machine && merged[i].text == expected[i].text);
+    }
+    assert(multi.recordsRead == 400 && multi.duplicates == 50);
+    assert(multi.gapCount == 0 && multi.duplicateSerialCount == 0);
+    // Keine Zwischendateien bleiben liegen
+    std::size_t files = 0;
+    for ([[maybe_unused]] const auto& entry : std::filesystem::directory_iterator(TEST_FOLDER)) {
+        files++;
+    }
+    assert(files == 7);
+    std::cout << "Mehrere Durchläufe erfolgreich." << std::endl;
+}
+
+void test_merged_file() {
+    std::cout << "Teste zusammengeführte Datei..." << std::endl;
+    // Abgebrochene letzte Zeile (Stromausfall beim Schreiben) wird ignoriert
+    const auto a = writeJournal("a.journal", "automat-a", {sale(1, 100), sale(2, 200)}, "3\t300\t2026");
+    const auto b = writeJournal("b.journal", "automat-b", {sale(1, 150)});
+    const std::string output = TEST_FOLDER + "/netz.journal";
+
+    const MergeReport report = JournalMerger::mergeToFile({a, b}, output, MergeConfig{});
+    assert(report.recordsWritten == 3);
+    assert(!std::filesystem::exists(output + ".tmp"));
+
+    // Die Datei ist selbst wieder ein Journal: lesbar mit Automat pro Verkauf
+    JournalReader reader(output, 4096);
+    assert(reader.isMerged());
+    TicketData ticket;
+    std::string machine;
+    std::vector<std::string> machines;
+    while (reader.next(ticket, machine)) {
+        machines.push_back(machine);
+        assert(ticket.tram == "Linie 4");
+    }
+    assert((machines == std::vector<std::string>{"automat-a", "automat-b", "automat-a"}));
+
+    // Erneutes Zusammenführen mit einem schon enthaltenen Journal ändert nichts
+    MergeReport again;
+    const auto merged = mergeAll({output, a}, again);
+    assert(merged.size() == 3 && again.duplicates == 2);
+
+    const auto broken = writeJournal("kaputt.journal", "automat-x", {sale(1, 100)}, "2\tkeine Zeit\t-\t-\t-\t-\t1\t-\t-\n");
+    bool threw = false;
+    try {
+        mergeAll({broken}, again);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("kaputt.journal:3:") != std::string::npos;
+    }
+    assert(threw);
+    std::cout << "Zusammengeführte Datei erfolgreich." << std::endl;
+}
+
+void resetFolder() {
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::filesystem::create_directories(TEST_FOLDER);
+}
+
+int main() {
+    std::cout << "--- Start Tests JournalMerger ---" << std::endl;
+    resetFolder();
+    test_order_and_duplicates();
+    resetFolder();
+    test_serial_problems();
+    resetFolder();
+    test_multiple_passes();
+    resetFolder();
+    test_merged_file();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests JournalMerger bestanden ---" << std::endl;
+    return 0;
+}
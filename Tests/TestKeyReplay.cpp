@@ -0,0 +1,134 @@
+#include "../Benchmark/KeyReplay.hpp"
+#include "../TUI/TerminalIO/TerminalIO.hpp"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Shell-Programm, das wie der Automat nach jeder Taste einen Frame mit Markierung zeichnet
+const std::string ECHO_PROGRAM =
+    "stty raw -echo; printf 'bereit\\033]9999;frame\\007'; "
+    "while c=$(dd bs=1 count=1 2>/dev/null) && [ -n \"$c\" ]; do "
+    "printf 'key:%s\\033]9999;frame\\007' \"$c\"; done";
+
+void test_parse_script() {
+    std::cout << "Teste Skript-Parser..." << std::endl;
+    std::istringstream script(
+        "# Linie wählen\n"
+        "down 2\n"
+        "  enter\n"
+        "\n"
+        "type 5ü\n"
+        "sleep 250\n"
+        "expect Gute Fahrt\n"
+        "esc\r\n");
+    const auto steps = KeyScript::parse(script, "test.keys");
+    assert(steps.size() == 8);
+    assert(steps[0].bytes == "\033[B" && steps[1].bytes == "\033[B" && steps[0].line == 2);
+    assert(steps[2].bytes == "\r" && steps[2].label == "enter");
+    // Jedes Zeichen ist ein eigener Tastendruck, auch mehrbytige
+    assert(steps[3].bytes == "5" && steps[4].bytes == "ü");
+    assert(steps[5].kind == KeyStep::Kind::Sleep && steps[5].sleepMs == 250);
+    assert(steps[6].kind == KeyStep::Kind::Expect && steps[6].bytes == "Gute Fahrt");
+    assert(steps[7].bytes == "\033");
+
+    // Aufgenommene Tasten ergeben wieder Skriptbefehle
+    assert(KeyScript::tokenFor("\033[A") == "up");
+    assert(KeyScript::tokenFor("\r") == "enter");
+    assert(KeyScript::tokenFor("7") == "type 7");
+    assert(KeyScript::tokenFor("\x01").empty());
+
+    std::istringstream broken("down\nspringe 3\n");
+    bool threw = false;
+    try {
+        KeyScript::parse(broken, "kaputt.keys");
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("kaputt.keys:2:") == 0;
+    }
+    assert(threw);
+    std::cout << "Skript-Parser erfolgreich." << std::endl;
+}
+
+void test_frame_markers() {
+    std::cout << "Teste Frame-Markierungen..." << std::endl;
+    const std::string marker = TerminalIO::FRAME_MARKER;
+    std::string text = "a" + marker + "bc" + marker;
+    assert(KeyReplay::stripFrameMarkers(text) == 2);
+    assert(text == "abc");
+
+    // Ohne TICKETAUTOMAT_FRAME_MARKER schreibt endFrame() nur die Ausgabe
+    std::ostringstream out;
+    TerminalIO::setOutput(&out);
+    TerminalIO::out() << "Menü";
+    TerminalIO::endFrame();
+    TerminalIO::setOutput(nullptr);
+    assert(out.str() == "Menü");
+
+    // Ende der Eingabe wird als Ausnahme gemeldet statt endlos zu lesen
+    int fds[2];
+    assert(pipe(fds) == 0);
+    assert(write(fds[1], "x", 1) == 1);
+    close(fds[1]);
+    TerminalIO::setInput(fds[0]);
+    assert(TerminalIO::readByte() == 'x');
+    bool closed = false;
+    try {
+        TerminalIO::readByte();
+    } catch (const InputClosedException&) {
+        closed = true;
+    }
+    assert(closed);
+    TerminalIO::setInput(STDIN_FILENO);
+    close(fds[0]);
+    std::cout << "Frame-Markierungen erfolgreich." << std::endl;
+}
+
+void test_replay() {
+    std::cout << "Teste Abspielen im Pseudo-Terminal..." << std::endl;
+    std::istringstream script("type ab\nexpect key:b\nenter\n");
+    const auto steps = KeyScript::parse(script, "echo.keys");
+
+    PtySession session({"/bin/sh", "-c", ECHO_PROGRAM}, "");
+    std::ostringstream capture;
+    const auto results = KeyReplay::replay(session, steps, ReplayConfig{}, &capture);
+    session.terminate();
+
+    assert(results.size() == 3);
+    assert(results[0].label == "type a" && results[2].label == "enter");
+    for (const auto& result : results) {
+        // "key:" und die Taste, ohne die Markierung
+        assert(result.framed);
+        assert(result.bytes == 5);
+        assert(result.latencyMs >= 0.0 && result.latencyMs < ReplayConfig{}.frameTimeoutMs);
+    }
+    assert(capture.str() == "bereitkey:akey:bkey:\r");
+    std::cout << "Abspielen erfolgreich." << std::endl;
+}
+
+void test_program_end() {
+    std::cout << "Teste vorzeitiges Programmende..." << std::endl;
+    std::istringstream script("enter\nenter\n");
+    const auto steps = KeyScript::parse(script, "ende.keys");
+    PtySession session({"/bin/sh", "-c", "printf 'tschüss'"}, "");
+    bool threw = false;
+    try {
+        KeyReplay::replay(session, steps, ReplayConfig{}, nullptr);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("program ended") != std::string::npos;
+    }
+    assert(threw);
+    assert(session.terminate() == 0);
+    std::cout << "Vorzeitiges Programmende erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests KeyReplay ---" << std::endl;
+    test_parse_script();
+    test_frame_markers();
+    test_replay();
+    test_program_end();
+    std::cout << "--- Alle Tests KeyReplay bestanden ---" << std::endl;
+    return 0;
+}
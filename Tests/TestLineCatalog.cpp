@@ -0,0 +1,134 @@
+#include "../Catalog/LineCatalog.hpp"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+
+const std::string TEST_DIR = "test_catalog_data";
+
+void write_line(const std::string& name, const std::string& content) {
+    // Erst in Hilfsdatei schreiben und dann umbenennen, wie es ein Editor tut
+    std::ofstream f(TEST_DIR + "/" + name + ".tmp");
+    f << content;
+    f.close();
+    std::filesystem::rename(TEST_DIR + "/" + name + ".tmp", TEST_DIR + "/" + name);
+}
+
+// Wartet bis zu 2 Sekunden auf einen neuen Snapshot
+std::shared_ptr<const CatalogSnapshot> wait_for_update(const LineCatalog& catalog, std::uint64_t oldVersion) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < deadline) {
+        auto current = catalog.snapshot();
+        if (current->version != oldVersion) {
+            return current;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return catalog.snapshot();
+}
+
+void test_initial_load() {
+    std::cout << "Teste Laden des Katalogs..." << std::endl;
+    LineCatalog catalog(TEST_DIR);
+    auto snapshot = catalog.snapshot();
+    assert(snapshot->lines.size() == 1);
+    assert(snapshot->find("LinieA") != nullptr);
+    assert(snapshot->find("LinieA")->data.stops.size() == 2);
+    assert(snapshot->find("gibts_nicht") == nullptr);
+}
+
+void test_hot_reload() {
+    std::cout << "Teste Hot Reload..." << std::endl;
+    LineCatalog catalog(TEST_DIR);
+    catalog.startWatching();
+
+    // Ein laufender Kauf hält seinen Snapshot fest
+    auto inProgress = catalog.snapshot();
+
+    write_line("LinieA.txt", "Linie A\n4\nA1\nA2\nA3\n");
+    auto updated = wait_for_update(catalog, inProgress->version);
+    assert(updated->version > inProgress->version);
+    assert(updated->find("LinieA")->data.stops.size() == 3);
+    assert(updated->find("LinieA")->data.pricePerStop == 4);
+    // Der alte Snapshot ist unverändert
+    assert(inProgress->find("LinieA")->data.stops.size() == 2);
+
+    // Neue Linie erscheint
+    write_line("LinieB.txt", "Linie B\n2\nB1\nB2\n");
+    updated = wait_for_update(catalog, updated->version);
+    assert(updated->find("LinieB") != nullptr);
+
+    // Gelöschte Linie verschwindet
+    std::filesystem::remove(TEST_DIR + "/LinieB.txt");
+    updated = wait_for_update(catalog, updated->version);
+    assert(updated->find("LinieB") == nullptr);
+    assert(updated->find("LinieA") != nullptr);
+
+    catalog.stopWatching();
+}
+
+void test_stop_index() {
+    std::cout << "Teste Haltestellen-Index..." << std::endl;
+    write_line("LinieX.txt", "Linie X\n2\nHauptbahnhof\nMarkt\nSüdplatz\n");
+    // Gleiche Haltestelle mit anderer Schreibweise, Markt auf beiden Linien
+    write_line("LinieY.txt", "Linie Y\n3\nWest\n  hauptbahnhof \nMarkt\nOst\n");
+    LineCatalog catalog(TEST_DIR);
+    auto snapshot = catalog.snapshot();
+    const StopIndex& stops = snapshot->stops;
+
+    // A1 bis A3 aus Linie A und fünf Haltestellen aus X und Y
+    assert(stops.stopCount() == 8);
+    const std::uint32_t hub = stops.find("HAUPTBAHNHOF");
+    assert(hub != StopIndex::NO_STOP && stops.name(hub) == "Hauptbahnhof");
+    assert(stops.find("Rathaus") == StopIndex::NO_STOP);
+    // Umsteigehaltestelle: beide Linien mit ihrer Position
+    assert(stops.servings(hub).size() == 2);
+    for (const auto& serving : stops.servings(hub)) {
+        const auto& line = snapshot->lines[serving.line].data;
+        assert(StopIndex::normalize(line.stops[serving.position]) == "hauptbahnhof");
+        assert(stops.stopAt(serving.line, serving.position) == hub);
+    }
+
+    // Ziele über beide Linien, je die günstigste Verbindung, alphabetisch
+    const auto connections = stops.destinations(hub);
+    assert(connections.size() == 4);
+    const std::vector<std::pair<std::string, int>> expected = {
+        {"Markt", 2}, {"Ost", 6}, {"Südplatz", 4}, {"West", 3}};
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        const auto& connection = connections[i];
+        assert(stops.name(connection.destination) == expected[i].first);
+        assert(connection.price == expected[i].second);
+        const auto& line = snapshot->lines[connection.line].data;
+        assert(line.stops[connection.destinationPosition] == expected[i].first);
+        assert(std::abs(static_cast<int>(connection.destinationPosition) -
+                        static_cast<int>(connection.startPosition)) * line.pricePerStop == connection.price);
+    }
+    assert(snapshot->lines[connections[0].line].data.name == "Linie X");
+
+    // Nach dem Entfernen einer Linie wird der Index neu aufgebaut
+    std::filesystem::remove(TEST_DIR + "/LinieY.txt");
+    catalog.reloadLines({"LinieY"});
+    const auto& reduced = catalog.snapshot()->stops;
+    assert(reduced.find("West") == StopIndex::NO_STOP);
+    assert(reduced.destinations(reduced.find("Hauptbahnhof")).size() == 2);
+    // Der alte Snapshot behält seinen Index
+    assert(snapshot->stops.find("West") != StopIndex::NO_STOP);
+}
+
+int main() {
+    std::filesystem::remove_all(TEST_DIR);
+    std::filesystem::create_directory(TEST_DIR);
+    write_line("LinieA.txt", "Linie A\n3\nA1\nA2\n");
+
+    test_initial_load();
+    test_hot_reload();
+    test_stop_index();
+
+    std::filesystem::remove_all(TEST_DIR);
+    std::cout << "LineCatalog Tests fertig." << std::endl;
+    return 0;
+}
@@ -0,0 +1,217 @@
+#include "../Logging/Logger.hpp"
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+const std::string TEST_FOLDER = "test_logs";
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+LogConfig testConfig(const std::string& name) {
+    LogConfig config;
+    config.path = TEST_FOLDER + "/" + name + ".log";
+    return config;
+}
+
+void test_levels() {
+    std::cout << "Teste Level-Filter..." << std::endl;
+    LogConfig config = testConfig("levels");
+    config.minLevel = LogLevel::Warning;
+    Logger::start(config);
+    assert(!Logger::enabled(LogLevel::Info));
+    assert(Logger::enabled(LogLevel::Error));
+    Logger::debug("nicht sichtbar %d", 1);
+    Logger::info("nicht sichtbar %d", 2);
+    Logger::warning("Warnung %d", 3);
+    Logger::error("Fehler %s", "vier");
+    Logger::stop();
+
+    const auto lines = readLines(config.path);
+    assert(lines.size() == 2);
+    // Format: "YYYY-MM-DD HH:MM:SS.mmm LEVEL Text"
+    assert(lines[0].size() > 24 && lines[0][4] == '-' && lines[0][19] == '.');
+    assert(lines[0].find(" WARN  Warnung 3") != std::string::npos);
+    assert(lines[1].find(" ERROR Fehler vier") != std::string::npos);
+
+    assert(Logger::parseLevel("DEBUG") == LogLevel::Debug);
+    assert(Logger::parseLevel("warn") == LogLevel::Warning);
+    bool threw = false;
+    try {
+        Logger::parseLevel("laut");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "Level-Filter erfolgreich." << std::endl;
+}
+
+void test_threads() {
+    std::cout << "Teste mehrere Threads..." << std::endl;
+    LogConfig config = testConfig("threads");
+    config.queueCapacity = 1 << 16;
+    Logger::start(config);
+    constexpr int THREADS = 4;
+    constexpr int MESSAGES = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < MESSAGES; ++i) {
+                Logger::info("thread=%d nr=%d", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    // stop() schreibt alle Meldungen, die noch in der Warteschlange stehen
+    Logger::stop();
+    assert(Logger::droppedMessages() == 0);
+
+    // Jede Meldung genau einmal, pro Thread in Reihenfolge
+    std::vector<int> next(THREADS, 0);
+    for (const auto& line : readLines(config.path)) {
+        int thread = -1;
+        int number = -1;
+        const auto position = line.find("thread=");
+        assert(position != std::string::npos);
+        const int parsed = std::sscanf(line.c_str() + position, "thread=%d nr=%d", &thread, &number);
+        assert(parsed == 2);
+        assert(number == next[thread]);
+        ++next[thread];
+    }
+    for (int count : next) {
+        assert(count == MESSAGES);
+    }
+    std::cout << "Mehrere Threads erfolgreich." << std::endl;
+}
+
+void test_rotation() {
+    std::cout << "Teste Rotation..." << std::endl;
+    LogConfig config = testConfig("rotation");
+    config.maxFileBytes = 4096;
+    config.maxFiles = 2;
+    Logger::start(config);
+    const std::string padding(100, 'x');
+    for (int i = 0; i < 200; ++i) {
+        Logger::info("Zeile %d %s", i, padding.c_str());
+        // Kleine Schübe, damit mehrmals rotiert wird
+        if (i % 20 == 19) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        }
+    }
+    Logger::stop();
+
+    assert(std::filesystem::exists(config.path));
+    assert(std::filesystem::exists(config.path + ".1"));
+    assert(std::filesystem::exists(config.path + ".2"));
+    assert(!std::filesystem::exists(config.path + ".3"));
+    assert(std::filesystem::file_size(config.path) <= config.maxFileBytes);
+    // Die letzte Meldung steht in der aktuellen Datei
+    const auto lines = readLines(config.path);
+    assert(!lines.empty() && lines.back().find("Zeile 199 ") != std::string::npos);
+    std::cout << "Rotation erfolgreich." << std::endl;
+}
+
+void test_full_queue() {
+    std::cout << "Teste volle Warteschlange..." << std::endl;
+    LogConfig config = testConfig("full");
+    config.queueCapacity = 16;
+    Logger::start(config);
+    // Schneller als der Schreib-Thread: Meldungen werden verworfen statt zu blockieren
+    for (int i = 0; i < 100000; ++i) {
+        Logger::info("Meldung %d", i);
+    }
+    const auto dropped = Logger::droppedMessages();
+    Logger::stop();
+    assert(dropped > 0);
+
+    const auto lines = readLines(config.path);
+    bool reported = false;
+    for (const auto& line : lines) {
+        reported = reported || line.find("verworfen") != std::string::npos;
+    }
+    assert(reported);
+    assert(lines.size() < 100000);
+    std::cout << "Volle Warteschlange erfolgreich." << std::endl;
+}
+
+void test_stop_while_logging() {
+    std::cout << "Teste Beenden während andere Threads schreiben..." << std::endl;
+    LogConfig config = testConfig("stop");
+    config.queueCapacity = 1 << 16;
+    // Warnungen nach stop() landen auf stderr; zusammen mit der Datei darf keine fehlen
+    const std::string stderrPath = TEST_FOLDER + "/stderr.txt";
+    std::fflush(stderr);
+    const int savedStderr = dup(STDERR_FILENO);
+    const int redirected = open(stderrPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    assert(savedStderr >= 0 && redirected >= 0);
+    dup2(redirected, STDERR_FILENO);
+    close(redirected);
+
+    Logger::start(config);
+    constexpr int THREADS = 4;
+    constexpr int MESSAGES = 3000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < MESSAGES; ++i) {
+                Logger::warning("thread=%d nr=%d", t, i);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(500));
+    Logger::stop();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::fflush(stderr);
+    dup2(savedStderr, STDERR_FILENO);
+    close(savedStderr);
+
+    std::vector<std::vector<int>> seen(THREADS, std::vector<int>(MESSAGES, 0));
+    for (const std::string& path : {config.path, stderrPath}) {
+        for (const auto& line : readLines(path)) {
+            int thread = -1;
+            int number = -1;
+            const auto position = line.find("thread=");
+            assert(position != std::string::npos);
+            assert(std::sscanf(line.c_str() + position, "thread=%d nr=%d", &thread, &number) == 2);
+            ++seen[thread][number];
+        }
+    }
+    for (const auto& counts : seen) {
+        for (int count : counts) {
+            assert(count == 1);
+        }
+    }
+    std::cout << "Beenden während des Schreibens erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests Logger ---" << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    test_levels();
+    test_threads();
+    test_rotation();
+    test_full_queue();
+    test_stop_while_logging();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests Logger bestanden ---" << std::endl;
+    return 0;
+}
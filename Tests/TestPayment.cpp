@@ -43,11 +43,65 @@ void test_not_enough_money() {
     }
 }
 
+void test_recycling() {
+    // Nur je eine 5 und eine 1 im Wechselgeld, Platz für 3 pro Münze
+    Payment p({{5, 1}, {1, 1}}, {{5, 3}, {1, 3}});
+
+    // Kunde zahlt 4 Geld mit vier 1ern für 3 Geld: die eigene Münze geht als Wechselgeld zurück
+    for (int i = 0; i < 4; ++i) assert(p.insert(1));
+    assert(p.insertedAmount() == 4);
+    auto change = p.payOutChange(1);
+    assert(change[1] == 1);
+    // Bestand 1 + 4 eingeworfen - 1 ausgezahlt, aber höchstens 3; der Rest in die Kasse
+    assert(p.getChangeBox()[1] == 2);
+    assert(p.getCashBox()[1] == 2);
+    assert(p.insertedAmount() == 0);
+
+    // Scheine werden angenommen, aber nie ausgezahlt
+    assert(!p.insert(4));
+    assert(p.insert(20));
+    change = p.payOutChange(7);
+    assert(change[5] == 1 && change[1] == 2);
+    assert(p.getCashBox()[20] == 1);
+    assert(p.getChangeBox().count(20) == 0);
+
+    p.reset();
+    assert(p.getCashBox().empty());
+    assert(p.getChangeBox()[1] == 1);
+}
+
+void test_rollback() {
+    Payment p({{5, 1}}, {{5, 3}, {2, 3}});
+    // 10-Schein für 2 Geld: 8 nicht auszahlbar, nichts darf gebucht werden
+    assert(p.insert(10));
+    assert(p.insert(2));
+    bool threw = false;
+    try {
+        p.payOutChange(10);
+    } catch (std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(p.getChangeBox()[5] == 1);
+    assert(p.getChangeBox()[2] == 0);
+    assert(p.getCashBox().empty());
+
+    // Geld zurück, dann passend zahlen
+    auto returned = p.returnInserted();
+    assert(returned[10] == 1 && returned[2] == 1);
+    assert(p.insertedAmount() == 0);
+    assert(p.insert(2));
+    assert(p.payOutChange(0).empty());
+    assert(p.getChangeBox()[2] == 1);
+}
+
 int main() {
     std::cout << "Teste Payment..." << std::endl;
     test_calc();
     test_payout();
     test_not_enough_money();
+    test_recycling();
+    test_rollback();
     std::cout << "Payment Tests fertig." << std::endl;
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,202 @@
+#include "../Printing/PrintSpooler.hpp"
+#include "../Printing/SpscRing.hpp"
+#include <cassert>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const std::string TEST_FOLDER = "test_spooler_data";
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+bool containsError(const std::vector<std::string>& errors, const std::string& part) {
+    for (const auto& error : errors) {
+        if (error.find(part) != std::string::npos) return true;
+    }
+    return false;
+}
+
+void test_ring_two_threads() {
+    std::cout << "Teste Ringpuffer mit zwei Threads..." << std::endl;
+    SpscRing<long> ring(5);
+    assert(ring.capacity() == 8);
+
+    const long count = 1000000;
+    std::thread producer([&ring, count]() {
+        for (long i = 1; i <= count; ++i) {
+            long value = i;
+            while (!ring.tryPush(value)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // Verbraucher: Reihenfolge und Vollständigkeit prüfen
+    long expected = 1;
+    while (expected <= count) {
+        long* value = ring.front();
+        if (value == nullptr) {
+            std::this_thread::yield();
+            continue;
+        }
+        assert(*value == expected);
+        ring.pop();
+        expected++;
+    }
+    producer.join();
+    assert(ring.size() == 0);
+    std::cout << "Ringpuffer erfolgreich." << std::endl;
+}
+
+void test_prints_in_order_and_flushes_on_shutdown() {
+    std::cout << "Teste Druckreihenfolge und Leeren beim Beenden..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    const std::string path = TEST_FOLDER + "/printer.out";
+    {
+        PrintSpooler spooler(path, 4);
+        for (int i = 0; i < 20; ++i) {
+            assert(spooler.submit("Ticket " + std::to_string(i) + "\n", std::chrono::seconds(5)));
+        }
+        // Destruktor druckt alle noch wartenden Tickets
+    }
+    std::string expected;
+    for (int i = 0; i < 20; ++i) expected += "Ticket " + std::to_string(i) + "\n";
+    assert(readFile(path) == expected);
+    std::cout << "Druckreihenfolge erfolgreich." << std::endl;
+}
+
+void test_slow_printer_backpressure() {
+    std::cout << "Teste langsamen Drucker und Rückstau..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::filesystem::create_directories(TEST_FOLDER);
+    // Eine FIFO ohne Leser verhält sich wie ein ausgeschalteter Drucker
+    const std::string fifo = TEST_FOLDER + "/printer.fifo";
+    assert(mkfifo(fifo.c_str(), 0600) == 0);
+
+    PrintSpooler spooler(fifo, 2);
+    const auto begin = std::chrono::steady_clock::now();
+    assert(spooler.submit("A\n", std::chrono::milliseconds(0)));
+    assert(spooler.submit("B\n", std::chrono::milliseconds(0)));
+    // Oberfläche ist sofort wieder frei
+    assert(std::chrono::steady_clock::now() - begin < std::chrono::milliseconds(50));
+    // Warteschlange voll: Rückstau nach Ablauf der Wartezeit
+    assert(!spooler.submit("C\n", std::chrono::milliseconds(100)));
+    assert(spooler.pending() == 2);
+
+    // Drucker wird frei; der Druck-Thread öffnet das Gerät pro Ticket neu
+    std::string received;
+    std::thread reader([&fifo, &received]() {
+        while (received.size() < 6) {
+            const int fd = open(fifo.c_str(), O_RDONLY);
+            char buffer[64];
+            ssize_t n;
+            while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+                received.append(buffer, static_cast<std::size_t>(n));
+            }
+            close(fd);
+        }
+    });
+    assert(spooler.submit("C\n", std::chrono::seconds(5)));
+    reader.join();
+    assert(spooler.flush(std::chrono::seconds(5)));
+    assert(received == "A\nB\nC\n");
+    std::cout << "Rückstau erfolgreich." << std::endl;
+}
+
+void test_error_reporting_and_recovery() {
+    std::cout << "Teste Fehlermeldung und Wiederaufnahme..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    const std::string path = TEST_FOLDER + "/printer.out";
+    // Ein Verzeichnis am Gerätepfad lässt jeden Schreibversuch scheitern
+    std::filesystem::create_directories(path);
+
+    PrintSpooler spooler(path, 4, std::chrono::milliseconds(20));
+    assert(spooler.submit("Ticket 1\n", std::chrono::seconds(1)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    const auto errors = spooler.takeErrors();
+    // Nur eine Meldung pro Ausfall, trotz mehrerer Versuche
+    assert(errors.size() == 1);
+    assert(containsError(errors, "Druckfehler"));
+    assert(spooler.pending() == 1);
+
+    // Drucker wieder verfügbar: Ticket wird nachgedruckt
+    std::filesystem::remove_all(path);
+    assert(spooler.flush(std::chrono::seconds(5)));
+    assert(readFile(path) == "Ticket 1\n");
+    assert(containsError(spooler.takeErrors(), "wieder bereit"));
+    std::cout << "Fehlermeldung und Wiederaufnahme erfolgreich." << std::endl;
+}
+
+void test_shutdown_with_offline_printer() {
+    std::cout << "Teste Beenden mit ausgefallenem Drucker..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    const std::string path = TEST_FOLDER + "/printer.out";
+    std::filesystem::create_directories(path);
+
+    PrintSpooler spooler(path, 4, std::chrono::milliseconds(20));
+    spooler.submit("Ticket 1\n", std::chrono::seconds(1));
+    spooler.submit("Ticket 2\n", std::chrono::seconds(1));
+    const auto begin = std::chrono::steady_clock::now();
+    spooler.shutdown(std::chrono::milliseconds(200));
+    assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(2));
+    assert(containsError(spooler.takeErrors(), "2 Dokument(e) nicht gedruckt"));
+    // Nach dem Beenden werden keine Tickets mehr angenommen
+    assert(!spooler.submit("Ticket 3\n", std::chrono::milliseconds(0)));
+    std::cout << "Beenden erfolgreich." << std::endl;
+}
+
+void test_shutdown_with_blocked_printer() {
+    std::cout << "Teste Beenden mit blockiertem Drucker..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::filesystem::create_directories(TEST_FOLDER);
+    const std::string fifo = TEST_FOLDER + "/printer.fifo";
+    assert(mkfifo(fifo.c_str(), 0600) == 0);
+
+    // Ohne Leser: Öffnen darf nicht hängen
+    {
+        PrintSpooler spooler(fifo, 2, std::chrono::milliseconds(20));
+        assert(spooler.submit("Ticket 1\n", std::chrono::seconds(1)));
+        const auto begin = std::chrono::steady_clock::now();
+        spooler.shutdown(std::chrono::milliseconds(200));
+        assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(2));
+        assert(containsError(spooler.takeErrors(), "1 Dokument(e) nicht gedruckt"));
+    }
+
+    // Leser, der nichts abnimmt: Schreiben darf nicht hängen, sobald die Pipe voll ist
+    const int reader = open(fifo.c_str(), O_RDONLY | O_NONBLOCK);
+    assert(reader >= 0);
+    {
+        PrintSpooler spooler(fifo, 2, std::chrono::milliseconds(20));
+        assert(spooler.submit(std::string(1 << 20, 'x'), std::chrono::seconds(1)));
+        const auto begin = std::chrono::steady_clock::now();
+        spooler.shutdown(std::chrono::milliseconds(200));
+        assert(std::chrono::steady_clock::now() - begin < std::chrono::seconds(2));
+        assert(containsError(spooler.takeErrors(), "1 Dokument(e) nicht gedruckt"));
+    }
+    close(reader);
+    std::cout << "Beenden mit blockiertem Drucker erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests PrintSpooler ---" << std::endl;
+    test_ring_two_threads();
+    test_prints_in_order_and_flushes_on_shutdown();
+    test_slow_printer_backpressure();
+    test_error_reporting_and_recovery();
+    test_shutdown_with_offline_printer();
+    test_shutdown_with_blocked_printer();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests PrintSpooler bestanden ---" << std::endl;
+    return 0;
+}
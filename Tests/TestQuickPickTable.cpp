@@ -0,0 +1,104 @@
+#include "../QuickPick/QuickPickTable.hpp"
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+const std::string TEST_FOLDER = "test_quickpick_state";
+const std::time_t START = 1767225600;
+const std::time_t HOUR = 3600;
+
+void test_ranking() {
+    std::cout << "Teste Rangfolge..." << std::endl;
+    QuickPickTable table(TEST_FOLDER + "/quickpick.bin");
+    for (int i = 0; i < 5; ++i) table.record("Linie 11", "Hauptbahnhof", "HTWK", START);
+    for (int i = 0; i < 3; ++i) table.record("Linie 10", "Lößnig", "Connewitz", START);
+    table.record("Linie 11", "HTWK", "Hauptbahnhof", START);
+
+    const auto top = table.top(2, START);
+    assert(top.size() == 2);
+    assert(top[0].destinationStop == "HTWK");
+    assert(std::abs(top[0].score - 5.0) < 1e-9);
+    assert(top[1].line == "Linie 10");
+    assert(table.top(10, START).size() == 3);
+    std::cout << "Rangfolge erfolgreich." << std::endl;
+}
+
+void test_decay() {
+    std::cout << "Teste Abklingen..." << std::endl;
+    QuickPickTable table(TEST_FOLDER + "/quickpick.bin", 256, 24.0);
+    // Alte Fahrt: 8 Verkäufe vor drei Tagen
+    for (int i = 0; i < 8; ++i) table.record("Linie 1", "A", "B", START);
+    // Neue Fahrt: 2 Verkäufe heute
+    const std::time_t later = START + 72 * HOUR;
+    table.record("Linie 2", "C", "D", later);
+    table.record("Linie 2", "C", "D", later);
+
+    const auto top = table.top(2, later);
+    // Nach drei Halbwertszeiten zählen die 8 alten Verkäufe wie einer
+    assert(std::abs(top[1].score - 1.0) < 1e-9);
+    assert(top[0].line == "Linie 2");
+    std::cout << "Abklingen erfolgreich." << std::endl;
+}
+
+void test_capacity() {
+    std::cout << "Teste Kapazität..." << std::endl;
+    QuickPickTable table(TEST_FOLDER + "/quickpick.bin", 3);
+    table.record("L", "A", "B", START);
+    table.record("L", "A", "B", START);
+    table.record("L", "B", "C", START);
+    table.record("L", "C", "D", START);
+    table.record("L", "C", "D", START);
+    // Neue Fahrt verdrängt die schwächste (B -> C)
+    table.record("L", "D", "E", START);
+    assert(table.size() == 3);
+    for (const auto& entry : table.top(3, START)) {
+        assert(entry.startStop != "B");
+    }
+    std::cout << "Kapazität erfolgreich." << std::endl;
+}
+
+void test_persistence() {
+    std::cout << "Teste Speichern und Laden..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    const std::string path = TEST_FOLDER + "/quickpick.bin";
+    {
+        QuickPickTable table(path);
+        table.record("Linie 11", "Hauptbahnhof", "Wilhelm‑Leuschner‑Platz", START);
+        table.record("Linie 11", "Hauptbahnhof", "Wilhelm‑Leuschner‑Platz", START + HOUR);
+        table.record("Linie 10", "Lößnig", "Connewitz", START);
+        table.save();
+    }
+
+    QuickPickTable restored(path);
+    restored.load();
+    assert(restored.size() == 2);
+    const auto top = restored.top(1, START + HOUR);
+    assert(top[0].destinationStop == "Wilhelm‑Leuschner‑Platz");
+    assert(top[0].score > 1.9 && top[0].score <= 2.0);
+
+    // Beschädigte Datei: Tabelle startet leer, Verkauf geht weiter
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "Unsinn";
+    QuickPickTable damaged(path);
+    damaged.load();
+    assert(damaged.size() == 0);
+
+    // Fehlende Datei ist kein Fehler
+    std::filesystem::remove_all(TEST_FOLDER);
+    QuickPickTable missing(path);
+    missing.load();
+    assert(missing.size() == 0);
+    std::cout << "Speichern und Laden erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests QuickPickTable ---" << std::endl;
+    test_ranking();
+    test_decay();
+    test_capacity();
+    test_persistence();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests QuickPickTable bestanden ---" << std::endl;
+    return 0;
+}
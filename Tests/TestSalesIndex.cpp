@@ -0,0 +1,141 @@
+#include "../Sales/SalesIndex.hpp"
+#include "../Sales/SalesJournal.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const std::string TEST_FOLDER = "test_sales_index";
+const std::string JOURNAL = TEST_FOLDER + "/sales.journal";
+
+// Verkauf mit Seriennummer; 100 Verkäufe pro Tag ab 2026-03-01
+TicketData makeSale(std::uint32_t serial) {
+    TicketData ticket;
+    ticket.serial = serial;
+    ticket.tram = "Linie " + std::to_string(serial % 4);
+    ticket.startStop = "Start " + std::to_string(serial);
+    ticket.destinationStop = "Ziel\t" + std::to_string(serial);
+    ticket.price = static_cast<int>(serial % 50);
+    ticket.date = TicketCode::dateFromDay(static_cast<std::uint16_t>(TicketCode::dayFromDate("2026-03-01") +
+                                                                     (serial - 1) / 100));
+    ticket.timestamp = 1772323200 + serial;
+    ticket.code = "CODE-" + std::to_string(serial);
+    return ticket;
+}
+
+void appendSales(SalesJournal& journal, std::uint32_t first, std::uint32_t last) {
+    for (std::uint32_t serial = first; serial <= last; ++serial) {
+        journal.append(makeSale(serial));
+    }
+}
+
+void test_lookup() {
+    std::cout << "Teste Suche nach Seriennummer und Datum..." << std::endl;
+    SalesJournal journal(JOURNAL, "automat-3");
+    assert(journal.openIndex());
+    appendSales(journal, 1, 250);
+
+    // Ein Eintrag pro 64 Verkäufe, einer pro Tag
+    assert(std::filesystem::file_size(SalesIndex::serialPath(JOURNAL)) == 16 + 4 * 16);
+    assert(std::filesystem::file_size(SalesIndex::datePath(JOURNAL)) == 16 + 3 * 16);
+
+    SalesIndex index(JOURNAL);
+    for (const std::uint32_t serial : {1u, 63u, 64u, 65u, 128u, 200u, 250u}) {
+        TicketData ticket;
+        assert(index.findSerial(serial, ticket));
+        assert(ticket.serial == serial && ticket.code == "CODE-" + std::to_string(serial));
+        assert(ticket.destinationStop == makeSale(serial).destinationStop);
+    }
+    TicketData missing;
+    assert(!index.findSerial(0, missing));
+    assert(!index.findSerial(251, missing));
+
+    const auto day = index.findDates("2026-03-02", "2026-03-02");
+    assert(day.size() == 100 && day.front().serial == 101 && day.back().serial == 200);
+    assert(index.findDates("2026-03-02", "2026-03-09").size() == 150);
+    assert(index.findDates("2026-02-01", "2026-02-28").empty());
+    bool threw = false;
+    try {
+        (void) index.findDates("1.3.2026", "2026-03-02");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(index.verify().empty());
+    std::cout << "Suche erfolgreich." << std::endl;
+}
+
+void test_catch_up() {
+    std::cout << "Teste Nachziehen des Index..." << std::endl;
+    // Verkäufe ohne geöffneten Index (z.B. Absturz vor dem Schreiben des Index)
+    {
+        SalesJournal journal(JOURNAL, "automat-3");
+        appendSales(journal, 251, 400);
+    }
+    SalesJournal journal(JOURNAL, "automat-3");
+    assert(!journal.openIndex());
+    appendSales(journal, 401, 420);
+
+    SalesIndex index(JOURNAL);
+    assert(index.verify().empty());
+    TicketData ticket;
+    assert(index.findSerial(333, ticket) && ticket.serial == 333);
+    assert(index.findSerial(420, ticket) && ticket.serial == 420);
+    assert(index.findDates("2026-03-05", "2026-03-05").size() == 20);
+    std::cout << "Nachziehen erfolgreich." << std::endl;
+}
+
+void test_rebuild() {
+    std::cout << "Teste Neuaufbau beschädigter Indexdateien..." << std::endl;
+    // Letzter Eintrag zeigt mitten in einen Datensatz
+    {
+        std::fstream file(SalesIndex::serialPath(JOURNAL), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-8, std::ios::end);
+        const std::uint64_t offset = 17;
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    SalesIndex index(JOURNAL);
+    assert(!index.verify().empty());
+    SalesJournal journal(JOURNAL, "automat-3");
+    assert(journal.openIndex());
+    assert(index.verify().empty());
+
+    // Fehlende Datumsdatei und ein beschädigter Eintrag in der Mitte
+    std::filesystem::remove(SalesIndex::datePath(JOURNAL));
+    assert(journal.openIndex());
+    {
+        std::fstream file(SalesIndex::serialPath(JOURNAL), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(16 + 16 * 2 + 8);
+        const std::uint64_t offset = 5;
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    const std::string problem = index.verify();
+    assert(problem.find("entry 2") != std::string::npos);
+    bool threw = false;
+    try {
+        TicketData ticket;
+        (void) index.findSerial(150, ticket);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    index.rebuild();
+    assert(index.verify().empty());
+    TicketData ticket;
+    assert(index.findSerial(150, ticket) && ticket.serial == 150);
+    std::cout << "Neuaufbau erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests SalesIndex ---" << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    test_lookup();
+    test_catch_up();
+    test_rebuild();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests SalesIndex bestanden ---" << std::endl;
+    return 0;
+}
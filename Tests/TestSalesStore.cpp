@@ -0,0 +1,217 @@
+#include "../Sales/SalesJournal.hpp"
+#include "../Sales/SalesStore.hpp"
+#include "../Sales/SalesQuery.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <tuple>
+
+const std::string TEST_FOLDER = "test_sales_data";
+
+TicketData makeTicket(const std::string& line, const std::string& start, const std::string& destination, int price,
+                      const std::string& date, std::map<int, int> change) {
+    TicketData ticket;
+    ticket.tram = line;
+    ticket.startStop = start;
+    ticket.destinationStop = destination;
+    ticket.price = price;
+    ticket.date = date;
+    ticket.timestamp = 1767225600;
+    ticket.change = std::move(change);
+    return ticket;
+}
+
+// Zufällige Verkäufe über 3 Linien, 6 Haltestellen und 40 Tage
+SalesStore randomStore(const std::string& machine, std::uint64_t seed, std::size_t rows) {
+    std::mt19937_64 random(seed);
+    SalesStore store;
+    const std::uint16_t firstDay = TicketCode::dayFromDate("2026-01-01");
+    for (std::size_t i = 0; i < rows; ++i) {
+        TicketData ticket = makeTicket("Linie " + std::to_string(random() % 3), "Halt " + std::to_string(random() % 6),
+                                       "Halt " + std::to_string(random() % 6), static_cast<int>(random() % 50),
+                                       TicketCode::dateFromDay(static_cast<std::uint16_t>(firstDay + random() % 40)),
+                                       {{17, static_cast<int>(random() % 2)}, {1, static_cast<int>(random() % 3)}});
+        store.append(ticket, machine);
+    }
+    return store;
+}
+
+void test_journal_roundtrip() {
+    std::cout << "Teste Verkaufsjournal..." << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    const std::string path = TEST_FOLDER + "/sales.journal";
+
+    SalesJournal journal(path, "automat-7");
+    TicketData first = makeTicket("Linie 11", "Hauptbahnhof", "Wilhelm‑Leuschner‑Platz", 45, "2026-02-01",
+                                  {{17, 1}, {5, 1}});
+    first.serial = 1;
+    first.code = "ABCD-EFGH";
+    TicketData second = makeTicket("Linie\t12", "A\\B", "C", 3, "2026-02-02", {});
+    second.serial = 2;
+    journal.append(first);
+    journal.append(second);
+
+    // Abgebrochener Schreibvorgang am Dateiende
+    std::ofstream(path, std::ios::app) << "3\t17672";
+
+    std::vector<TicketData> read;
+    const std::string machine = SalesJournal::read(path, [&read](const TicketData& t) { read.push_back(t); });
+    assert(machine == "automat-7");
+    assert(read.size() == 2);
+    assert(read[0].destinationStop == "Wilhelm‑Leuschner‑Platz");
+    assert(read[0].change.at(17) == 1 && read[0].change.at(5) == 1);
+    assert(read[0].code == "ABCD-EFGH");
+    assert(read[0].timestamp == 1767225600);
+    assert(read[1].tram == "Linie\t12");
+    assert(read[1].startStop == "A\\B");
+    assert(read[1].change.empty());
+    assert(read[1].code.empty());
+
+    // Der nächste Verkauf nach dem Stromausfall darf nicht an den Rest angehängt werden
+    TicketData third = makeTicket("Linie 3", "A", "B", 7, "2026-02-03", {});
+    third.serial = 3;
+    journal.append(third);
+    read.clear();
+    SalesJournal::read(path, [&read](const TicketData& t) { read.push_back(t); });
+    assert(read.size() == 3);
+    assert(read[2].serial == 3 && read[2].tram == "Linie 3");
+
+    // Abgebrochener Kopf: das Journal beginnt neu
+    const std::string torn = TEST_FOLDER + "/torn.journal";
+    std::ofstream(torn) << "# ticketautomat-jour";
+    SalesJournal(torn, "automat-8").append(third);
+    read.clear();
+    assert(SalesJournal::read(torn, [&read](const TicketData& t) { read.push_back(t); }) == "automat-8");
+    assert(read.size() == 1 && read[0].serial == 3);
+
+    // Gruppen-, Deckel- und Abfahrtsangaben bleiben für den Nachdruck erhalten
+    TicketData member = makeTicket("Linie 3", "A", "B", 4, "2026-02-03", {});
+    member.batchIndex = 2;
+    member.batchSize = 3;
+    member.capDiscount = 5;
+    member.departure = "14:05";
+    TicketData parsed = SalesJournal::parseRecord(SalesJournal::formatRecord(member));
+    assert(parsed.batchIndex == 2 && parsed.batchSize == 3);
+    assert(parsed.capDiscount == 5 && parsed.departure == "14:05");
+    parsed.reprint = true;
+    const std::string reprint = TicketMachine::renderTicket(parsed);
+    assert(reprint.find("Ticket:        2 of 3") != std::string::npos);
+    assert(reprint.find("Fare cap:      -5 Geld") != std::string::npos);
+    assert(reprint.find("Departure:     14:05") != std::string::npos);
+    assert(reprint.find("Change:") == std::string::npos);
+
+    // Datensätze älterer Journale (9 Felder) bleiben lesbar
+    const TicketData old = SalesJournal::parseRecord("7\t1767225600\t2026-02-01\tLinie 1\tA\tB\t3\t-\t-");
+    assert(old.serial == 7 && old.batchSize == 1 && old.capDiscount == 0 && old.departure.empty());
+    std::cout << "Verkaufsjournal erfolgreich." << std::endl;
+}
+
+void test_save_load_merge() {
+    std::cout << "Teste Speichern, Laden und Zusammenführen..." << std::endl;
+    std::filesystem::create_directories(TEST_FOLDER);
+    const SalesStore a = randomStore("automat-1", 1, 5000);
+    const SalesStore b = randomStore("automat-2", 2, 3000);
+    a.save(TEST_FOLDER + "/a.col");
+    b.save(TEST_FOLDER + "/b.col");
+
+    SalesStore merged = SalesStore::load(TEST_FOLDER + "/a.col");
+    assert(merged.size() == 5000);
+    merged.merge(SalesStore::load(TEST_FOLDER + "/b.col"));
+    assert(merged.size() == 8000);
+    assert(merged.machines.size() == 2);
+
+    // Zeile 5000 ist die erste Zeile von b, mit übersetzten Ids
+    const SalesColumns& columns = merged.data();
+    assert(merged.machines.at(columns.machine[5000]) == "automat-2");
+    assert(merged.lines.at(columns.line[5000]) == b.lines.at(b.data().line[0]));
+    assert(merged.stops.at(columns.destination[5000]) == b.stops.at(b.data().destination[0]));
+    assert(columns.price[5000] == b.data().price[0]);
+
+    // Abgeschnittene Datei wird abgelehnt
+    std::filesystem::resize_file(TEST_FOLDER + "/a.col", std::filesystem::file_size(TEST_FOLDER + "/a.col") - 10);
+    bool thrown = false;
+    try {
+        SalesStore::load(TEST_FOLDER + "/a.col");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Speichern, Laden und Zusammenführen erfolgreich." << std::endl;
+}
+
+void test_queries_match_row_scan() {
+    std::cout << "Teste Abfragen gegen zeilenweise Auswertung..." << std::endl;
+    // Mehr als ein Chunk, damit mehrere Threads arbeiten und ein Restblock bleibt
+    SalesStore store = randomStore("automat-1", 3, 150001);
+    store.merge(randomStore("automat-2", 4, 20000));
+    const SalesColumns& columns = store.data();
+
+    QueryFilter filter;
+    filter.fromDay = TicketCode::dayFromDate("2026-01-05");
+    filter.toDay = TicketCode::dayFromDate("2026-01-20");
+
+    std::map<std::pair<std::uint32_t, std::uint16_t>, std::pair<std::int64_t, std::uint64_t>> revenue;
+    std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint64_t> pairs;
+    std::map<int, std::uint64_t> coins;
+    for (std::size_t i = 0; i < store.size(); ++i) {
+        if (columns.day[i] < filter.fromDay || columns.day[i] > filter.toDay) continue;
+        revenue[{columns.line[i], columns.day[i]}].first += columns.price[i];
+        revenue[{columns.line[i], columns.day[i]}].second++;
+        pairs[{columns.start[i], columns.destination[i]}]++;
+        for (std::size_t k = 0; k < columns.denominations.size(); ++k) {
+            coins[columns.denominations[k]] += columns.change[k][i];
+        }
+    }
+
+    for (const unsigned threads : {1u, 4u}) {
+        const auto result = SalesQuery::revenuePerLinePerDay(store, filter, threads);
+        assert(result.size() == revenue.size());
+        for (const auto& entry : result) {
+            const auto& expected = revenue.at({entry.line, entry.day});
+            assert(entry.revenue == expected.first);
+            assert(entry.tickets == expected.second);
+        }
+
+        const auto od = SalesQuery::originDestination(store, filter, threads);
+        assert(od.size() == pairs.size());
+        for (const auto& entry : od) {
+            assert(entry.tickets == pairs.at({entry.start, entry.destination}));
+        }
+
+        const auto change = SalesQuery::changeTotals(store, filter, threads);
+        assert(change.size() == 2);
+        assert(change[0].denomination == 17 && change[0].coins == coins[17]);
+        assert(change[1].denomination == 1 && change[1].coins == coins[1]);
+    }
+
+    // Filter auf eine Linie
+    QueryFilter lineFilter;
+    lineFilter.filterLine = true;
+    assert(store.lines.find("Linie 2", lineFilter.line));
+    for (const auto& entry : SalesQuery::revenuePerLinePerDay(store, lineFilter, 2)) {
+        assert(entry.line == lineFilter.line);
+    }
+
+    // Vertauschter Zeitraum wählt nichts aus, statt über den Tageswert überzulaufen
+    QueryFilter inverted;
+    inverted.fromDay = filter.toDay;
+    inverted.toDay = filter.fromDay;
+    assert(SalesQuery::revenuePerLinePerDay(store, inverted).empty());
+    assert(SalesQuery::originDestination(store, inverted).empty());
+    assert(SalesQuery::changeTotals(store, inverted).empty());
+    std::cout << "Abfragen erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests SalesStore ---" << std::endl;
+    test_journal_roundtrip();
+    test_save_load_merge();
+    test_queries_match_row_scan();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests SalesStore bestanden ---" << std::endl;
+    return 0;
+}
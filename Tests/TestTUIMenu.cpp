@@ -0,0 +1,112 @@
+#include "../TUI/TUIMenu/TUIMenu.hpp"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// Leitet die Standardeingabe auf eine Pipe mit den gegebenen Tasten um
+void feedKeys(const std::string& keys) {
+    int fds[2];
+    assert(pipe(fds) == 0);
+    assert(write(fds[1], keys.data(), keys.size()) == static_cast<ssize_t>(keys.size()));
+    close(fds[1]);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+}
+
+void test_render_order() {
+    std::cout << "Teste Reihenfolge der Zeilen..." << std::endl;
+    const std::vector<std::string> stops = {"Hauptbahnhof", "Augustusplatz", "Connewitz"};
+    TUIMenu menu("Start:");
+    menu.addOption("Quick pick", []() {});
+    menu.setItems(stops);
+    menu.addOption("Cancel", []() {});
+
+    std::ostringstream out;
+    menu.render(out);
+    const std::string text = out.str();
+    // Optionen davor, dann die Einträge, dann die Optionen danach; die erste Zeile ist markiert
+    assert(text.find("● Quick pick") != std::string::npos);
+    const auto first = text.find("○ Hauptbahnhof");
+    const auto last = text.find("○ Connewitz");
+    const auto cancel = text.find("○ Cancel");
+    assert(first != std::string::npos && first < last && last < cancel);
+    std::cout << "Reihenfolge erfolgreich." << std::endl;
+}
+
+void test_index_selection() {
+    std::cout << "Teste Auswahl per Index..." << std::endl;
+    const std::vector<std::string> stops = {"A", "B", "C", "D"};
+    bool optionRan = false;
+
+    // Zweimal nach unten: dritter Eintrag
+    {
+        TUIMenu menu("Start:");
+        menu.setItems(stops);
+        menu.addOption("Cancel", [&optionRan]() { optionRan = true; });
+        feedKeys("\033[B\033[B\n");
+        assert(menu.run() == 2);
+        assert(!optionRan);
+    }
+
+    // Nach oben von der ersten Zeile: Umlauf auf die letzte Zeile, die Option
+    {
+        TUIMenu menu("Start:");
+        menu.setItems(stops);
+        menu.addOption("Cancel", [&optionRan]() { optionRan = true; });
+        feedKeys("\033[A\n");
+        assert(menu.run() == TUIMenu::NO_ITEM);
+        assert(optionRan);
+    }
+
+    // Option vor den Einträgen verschiebt die Indizes nicht
+    {
+        TUIMenu menu("Start:");
+        menu.addOption("Quick pick", []() {});
+        menu.setItems(4, [&stops](std::size_t index) { return std::string_view(stops[index]); });
+        feedKeys("\033[B\n");
+        assert(menu.run() == 0);
+    }
+    // Standard-Cancel beendet nicht sofort, sondern meldet sich beim Aufrufer
+    {
+        TUIMenu menu("Start:");
+        menu.setItems(stops);
+        menu.addCancelationOption();
+        feedKeys("\033[A\n");
+        bool exitRequested = false;
+        try {
+            (void) menu.run();
+        } catch (const ExitRequestedException&) {
+            exitRequested = true;
+        }
+        assert(exitRequested);
+    }
+    std::cout << "Auswahl per Index erfolgreich." << std::endl;
+}
+
+void test_large_menu() {
+    std::cout << "Teste großes Menü..." << std::endl;
+    std::vector<std::string> stops;
+    for (int i = 0; i < 5000; ++i) {
+        stops.push_back("Haltestelle " + std::to_string(i));
+    }
+    TUIMenu menu("Start:");
+    menu.setItems(stops);
+    // Labels werden erst beim Zeichnen gelesen: Änderungen am Vektor sind sofort sichtbar
+    stops[4999] = "Endstelle";
+    std::ostringstream out;
+    menu.render(out);
+    assert(out.str().find("○ Endstelle") != std::string::npos);
+    std::cout << "Großes Menü erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests TUIMenu ---" << std::endl;
+    test_render_order();
+    test_index_selection();
+    test_large_menu();
+    std::cout << "--- Alle Tests TUIMenu bestanden ---" << std::endl;
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "../TicketCode/TicketCode.hpp"
+#include "../TicketCode/SipHash.hpp"
+#include "../TicketCode/BatchVerifier.hpp"
+#include <cassert>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+const std::string STATE_FOLDER = "test_ticket_state";
+
+TicketKey testKey() {
+    TicketKey key;
+    for (std::size_t i = 0; i < key.bytes.size(); ++i) {
+        key.bytes[i] = static_cast<std::uint8_t>(i);
+    }
+    return key;
+}
+
+TicketPayload testPayload() {
+    TicketPayload payload;
+    payload.lineId = TicketCode::lineId("Linie 11");
+    payload.startIndex = 2;
+    payload.destinationIndex = 9;
+    payload.price = 45;
+    payload.day = TicketCode::dayFromDate("2026-02-01");
+    payload.serial = 123456;
+    return payload;
+}
+
+void test_siphash_reference() {
+    std::cout << "Teste SipHash-Referenzwerte..." << std::endl;
+    const TicketKey key = testKey();
+    std::uint8_t message[15];
+    for (std::uint8_t i = 0; i < 15; ++i) {
+        message[i] = i;
+    }
+    // Testvektoren aus dem SipHash-Paper (Schlüssel 00..0f, Nachricht 00..n-1)
+    assert(SipHash::hash24(key.bytes.data(), message, 0) == 0x726fdb47dd0e0e31ULL);
+    assert(SipHash::hash24(key.bytes.data(), message, 15) == 0xa129ca6149be45e5ULL);
+    std::cout << "SipHash-Referenzwerte erfolgreich." << std::endl;
+}
+
+void test_roundtrip() {
+    std::cout << "Teste Kodieren und Prüfen..." << std::endl;
+    const TicketKey key = testKey();
+    const TicketPayload payload = testPayload();
+    const std::string code = TicketCode::encode(payload, key);
+
+    // 32 Zeichen in Vierergruppen
+    assert(code.size() == 39);
+    assert(code[4] == '-');
+
+    TicketPayload decoded;
+    assert(TicketCode::verify(code, key, &decoded));
+    assert(decoded.lineId == payload.lineId);
+    assert(decoded.startIndex == 2);
+    assert(decoded.destinationIndex == 9);
+    assert(decoded.price == 45);
+    assert(decoded.serial == 123456);
+    assert(TicketCode::dateFromDay(decoded.day) == "2026-02-01");
+
+    // Kleinbuchstaben und fehlende Bindestriche werden akzeptiert
+    std::string relaxed;
+    for (const char c : code) {
+        if (c != '-') relaxed += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    assert(TicketCode::verify(relaxed, key));
+    std::cout << "Kodieren und Prüfen erfolgreich." << std::endl;
+}
+
+void test_tampering() {
+    std::cout << "Teste manipulierte Codes..." << std::endl;
+    const TicketKey key = testKey();
+    const std::string code = TicketCode::encode(testPayload(), key);
+
+    // Jedes einzelne geänderte Zeichen muss auffallen
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        if (code[i] == '-') continue;
+        std::string changed = code;
+        changed[i] = changed[i] == 'Z' ? '0' : (changed[i] == '9' ? 'A' : static_cast<char>(changed[i] + 1));
+        assert(!TicketCode::verify(changed, key));
+    }
+
+    TicketKey otherKey = key;
+    otherKey.bytes[0] ^= 1;
+    assert(!TicketCode::verify(code, otherKey));
+    assert(!TicketCode::verify(code.substr(0, 30), key));
+    assert(!TicketCode::verify(code + "A", key));
+    assert(!TicketCode::verify("", key));
+    std::cout << "Manipulierte Codes erkannt." << std::endl;
+}
+
+void test_dates() {
+    std::cout << "Teste Datumsumrechnung..." << std::endl;
+    assert(TicketCode::dayFromDate("1970-01-01") == 0);
+    assert(TicketCode::dayFromDate("2000-03-01") == 11017);
+    for (std::uint16_t day = 0; day < 60000; day += 7) {
+        assert(TicketCode::dayFromDate(TicketCode::dateFromDay(day)) == day);
+    }
+    bool thrown = false;
+    try {
+        TicketCode::dayFromDate("kein Datum");
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::cout << "Datumsumrechnung erfolgreich." << std::endl;
+}
+
+void test_signer_state() {
+    std::cout << "Teste Schlüssel und Seriennummern..." << std::endl;
+    std::filesystem::remove_all(STATE_FOLDER);
+
+    TicketPayload first = testPayload();
+    TicketPayload second = testPayload();
+    std::string firstCode;
+    {
+        TicketSigner signer(STATE_FOLDER);
+        firstCode = signer.sign(first);
+        signer.sign(second);
+    }
+    assert(first.serial == 1);
+    assert(second.serial == 2);
+
+    // Neuer Signierer (z. B. nach Neustart): gleicher Schlüssel, Seriennummer läuft weiter
+    TicketSigner restarted(STATE_FOLDER);
+    TicketPayload third = testPayload();
+    restarted.sign(third);
+    assert(third.serial == 3);
+
+    // Reservieren vor dem Bezahlen, danach nur noch im Speicher signieren
+    assert(restarted.reserveSerials(3) == 4);
+    TicketPayload reserved = testPayload();
+    reserved.serial = 5;
+    TicketPayload decoded;
+    assert(TicketCode::verify(restarted.signReserved(reserved), TicketKey::load(STATE_FOLDER + "/ticket.key"), &decoded));
+    assert(decoded.serial == 5);
+    TicketPayload fourth = testPayload();
+    restarted.sign(fourth);
+    assert(fourth.serial == 7);
+    // Nicht bezahlter Kauf gibt seine Nummern zurück, aber nur, wenn danach keine vergeben wurde
+    assert(restarted.reserveSerials(2) == 8);
+    restarted.releaseSerials(8, 2);
+    restarted.releaseSerials(4, 3);
+    assert(restarted.reserveSerials(1) == 8);
+    bool threw = false;
+    try {
+        TicketSigner(STATE_FOLDER).signReserved(reserved);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    const TicketKey stored = TicketKey::load(STATE_FOLDER + "/ticket.key");
+    assert(TicketCode::verify(firstCode, stored));
+    assert((std::filesystem::status(STATE_FOLDER + "/ticket.key").permissions() &
+            std::filesystem::perms::others_read) == std::filesystem::perms::none);
+
+    std::filesystem::remove_all(STATE_FOLDER);
+    std::cout << "Schlüssel und Seriennummern erfolgreich." << std::endl;
+}
+
+void test_batch() {
+    std::cout << "Teste Stapelprüfung..." << std::endl;
+    const TicketKey key = testKey();
+    std::string text;
+    for (std::uint32_t i = 1; i <= 10000; ++i) {
+        TicketPayload payload = testPayload();
+        payload.serial = i;
+        std::string code = TicketCode::encode(payload, key);
+        // Zeilen 500 und 7000 manipulieren, Zeile 800 leer lassen
+        if (i == 500 || i == 7000) code[0] = code[0] == '0' ? '1' : '0';
+        if (i == 800) code.clear();
+        text += code + (i % 3 == 0 ? "\r\n" : "\n");
+    }
+
+    for (const unsigned threads : {1u, 4u, 16u}) {
+        const BatchResult result = BatchVerifier::verifyText(text, key, threads);
+        assert(result.valid == 9997);
+        assert(result.invalid == 2);
+        assert(result.invalidLines.size() == 2);
+        assert(result.invalidLines[0] == 500);
+        assert(result.invalidLines[1] == 7000);
+    }
+    std::cout << "Stapelprüfung erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests TicketCode ---" << std::endl;
+    test_siphash_reference();
+    test_roundtrip();
+    test_tampering();
+    test_dates();
+    test_signer_state();
+    test_batch();
+    std::cout << "--- Alle Tests TicketCode bestanden ---" << std::endl;
+    return 0;
+}
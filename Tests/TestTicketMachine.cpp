@@ -1,9 +1,11 @@
 #include "../TicketMachine/TicketMachine.hpp"
 #include "../TramParser/TramParser.hpp"
+#include "../TUI/TerminalIO/TerminalIO.hpp"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <cassert>
+#include <unistd.h>
 
 // Hilfsfunktion für Testdaten
 void createTestTramFile(const std::string& filename, const std::string& lineName,
@@ -29,6 +31,11 @@ void test_printTicket() {
     ticket.price = 45;
     ticket.change = {{17, 1}, {5, 1}, {3, 1}};
     ticket.date = "2026-02-01";
+    ticket.departure = "14:05";
+    assert(TicketMachine::renderTicket(ticket).find("Departure:     14:05") != std::string::npos);
+    ticket.reprint = true;
+    assert(TicketMachine::renderTicket(ticket).find("=== TICKET (REPRINT) ===") != std::string::npos);
+    ticket.reprint = false;
 
     // Visuelle Prüfung
     TicketMachine::printTicket(ticket);
@@ -52,11 +59,264 @@ void test_full_process() {
     std::cout << "Logik-Tests OK." << std::endl;
 }
 
+// Leitet die Standardeingabe auf eine Pipe mit den gegebenen Tasten um
+void feedKeys(const std::string& keys) {
+    int fds[2];
+    assert(pipe(fds) == 0);
+    assert(write(fds[1], keys.data(), keys.size()) == static_cast<ssize_t>(keys.size()));
+    close(fds[1]);
+    dup2(fds[0], STDIN_FILENO);
+    close(fds[0]);
+}
+
+void test_cart() {
+    std::cout << "Teste Warenkorb..." << std::endl;
+    const std::string folder = "test_cart_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n3\nA\nB\nC\nD\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    auto signer = std::make_shared<TicketSigner>("test_cart_state");
+    TicketMachine machine(catalog, signer);
+
+    // Fahrt 1: A -> C (2 Stationen, 6 Geld) für 2 Personen
+    // Fahrt 2: B -> A (1 Station, 3 Geld) für 1 Person
+    // Bezahlung: ein 20-Geld-Schein für 15 Geld, ein Wechselgeld von 5
+    const std::string down = "\033[B";
+    feedKeys("\n" "\n" + down + down + "\n" + down + "\n" +
+             "\n" + down + "\n" "\n" "\n" +
+             "20\n");
+    machine.selectTram();
+    machine.selectStartStop();
+    machine.selectDestinationStop();
+    machine.addToCart(machine.selectPassengerCount());
+    machine.selectTram();
+    machine.selectStartStop();
+    machine.selectDestinationStop();
+    machine.addToCart(machine.selectPassengerCount());
+
+    assert(machine.getCart().size() == 2);
+    assert(machine.getCart()[0].passengers == 2);
+    assert(machine.cartTotal() == 15);
+
+    const auto tickets = machine.checkoutCart();
+    assert(machine.getCart().empty());
+    assert(tickets.size() == 3);
+    // Ein Wechselgeld für den ganzen Einkauf, auf dem ersten Ticket
+    assert((tickets[0].change == std::map<int, int>{{5, 1}}));
+    assert(tickets[1].change.empty() && tickets[2].change.empty());
+    assert(tickets[0].price == 6 && tickets[1].price == 6 && tickets[2].price == 3);
+    assert(tickets[2].startStop == "B" && tickets[2].destinationStop == "A");
+    for (std::size_t i = 0; i < tickets.size(); ++i) {
+        assert(tickets[i].batchIndex == static_cast<int>(i) + 1 && tickets[i].batchSize == 3);
+        assert(!tickets[i].code.empty());
+        assert(i == 0 || tickets[i].serial == tickets[i - 1].serial + 1);
+    }
+
+    // Alle Tickets in einem Dokument, Wechselgeld nur einmal
+    const std::string document = TicketMachine::renderTickets(tickets);
+    assert(document.find("Ticket:        3 of 3") != std::string::npos);
+    assert(document.find("Change:") == document.rfind("Change:"));
+
+    std::filesystem::remove_all(folder);
+    std::filesystem::remove_all("test_cart_state");
+    std::cout << "Warenkorb OK." << std::endl;
+}
+
+void test_price_too_large_for_code() {
+    std::cout << "Teste zu hohen Preis für den Prüfcode..." << std::endl;
+    const std::string folder = "test_code_range_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n40000\nA\nB\nC\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    auto signer = std::make_shared<TicketSigner>("test_code_range_state");
+    TicketMachine machine(catalog, signer);
+
+    // A -> C kostet 80000 Geld und passt nicht in den Code; Verkauf wird vor der Zahlung abgelehnt
+    const std::string down = "\033[B";
+    feedKeys("\n" "\n" + down + down + "\n" "\n");
+    machine.selectTram();
+    machine.selectStartStop();
+    machine.selectDestinationStop();
+    machine.addToCart(machine.selectPassengerCount());
+    assert(machine.cartTotal() == 80000);
+
+    bool threw = false;
+    try {
+        (void) machine.checkoutCart();
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("price 80000") != std::string::npos;
+    }
+    assert(threw);
+    // Es wurde keine Seriennummer vergeben
+    assert(!std::filesystem::exists("test_code_range_state/ticket.serial"));
+
+    std::filesystem::remove_all(folder);
+    std::filesystem::remove_all("test_code_range_state");
+    std::cout << "Zu hoher Preis OK." << std::endl;
+}
+
+void test_state_unwritable_before_payment() {
+    std::cout << "Teste nicht beschreibbaren Zustand vor der Zahlung..." << std::endl;
+    const std::string folder = "test_state_error_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n3\nA\nB\nC\n";
+    // Eine Datei, wo der Zustandsordner sein müsste
+    std::ofstream(folder + "/state") << "kein Ordner\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    TicketMachine machine(catalog, std::make_shared<TicketSigner>(folder + "/state"));
+    const std::string down = "\033[B";
+    // Keine Münzen: der Verkauf muss scheitern, bevor nach Geld gefragt wird
+    feedKeys("\n" "\n" + down + down + "\n" "\n");
+    machine.selectTram();
+    machine.selectStartStop();
+    machine.selectDestinationStop();
+    machine.addToCart(machine.selectPassengerCount());
+    bool beforePayment = false;
+    try {
+        (void) machine.checkoutCart();
+    } catch (const InputClosedException&) {
+        beforePayment = false;
+    } catch (const std::runtime_error&) {
+        beforePayment = true;
+    }
+    assert(beforePayment);
+
+    std::filesystem::remove_all(folder);
+    std::cout << "Zustand vor der Zahlung OK." << std::endl;
+}
+
+void test_input_ends_during_sale() {
+    std::cout << "Teste Ende der Eingabe beim Bezahlen und bei der Karte..." << std::endl;
+    const std::string folder = "test_input_end_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n3\nA\nB\nC\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    auto ledger = std::make_shared<FareLedger>("test_input_end_state/fares.ledger", CapConfig{15, 0});
+    ledger->open();
+    TicketMachine machine(catalog, nullptr, nullptr, ledger);
+    const std::string down = "\033[B";
+    // Eine Endlosschleife bei geschlossener Eingabe beendet den Test nach 10 s
+    alarm(10);
+
+    // A -> C, eine Person; eine Münze, dann endet die Eingabe an der Zahlungsaufforderung
+    feedKeys("\n" "\n" + down + down + "\n" "\n" "5\n");
+    machine.selectTram();
+    machine.selectStartStop();
+    machine.selectDestinationStop();
+    machine.addToCart(machine.selectPassengerCount());
+    bool closed = false;
+    try {
+        (void) machine.checkoutCart();
+    } catch (const InputClosedException&) {
+        closed = true;
+    }
+    assert(closed);
+
+    // "Use card for fare capping" wählen, dann endet die Eingabe an der Kartennummer
+    feedKeys(down + down + "\n" "kar");
+    closed = false;
+    try {
+        (void) machine.offerMoreTickets();
+    } catch (const InputClosedException&) {
+        closed = true;
+    }
+    assert(closed);
+    alarm(0);
+
+    std::filesystem::remove_all(folder);
+    std::filesystem::remove_all("test_input_end_state");
+    std::cout << "Ende der Eingabe OK." << std::endl;
+}
+
+void test_stop_first() {
+    std::cout << "Teste Kauf ab Haltestelle..." << std::endl;
+    const std::string folder = "test_stop_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n3\nA\nB\nC\nD\n";
+    std::ofstream(folder + "/Linie2.txt") << "Linie 2\n5\nC\nE\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    TicketMachine machine(catalog, nullptr);
+    // Erstes Menü: Linie 1, Linie 2, "Start from a stop"; Haltestellen A bis E, Start C;
+    // Ziele A, B, D (Linie 1) und E (Linie 2)
+    const std::string down = "\033[B";
+    feedKeys(down + down + "\n" + down + down + "\n" + down + down + down + "\n");
+    machine.selectTram();
+    assert(machine.hasSelectedJourney());
+    machine.addToCart(1);
+
+    const CartItem& item = machine.getCart().front();
+    assert(item.tram == "Linie 2" && item.startStop == "C" && item.destinationStop == "E");
+    assert(item.startIndex == 0 && item.destinationIndex == 1 && item.unitPrice == 5);
+
+    std::filesystem::remove_all(folder);
+    std::cout << "Kauf ab Haltestelle OK." << std::endl;
+}
+
+void test_fare_cap() {
+    std::cout << "Teste Fahrpreisdeckel..." << std::endl;
+    const std::string folder = "test_cap_data";
+    std::filesystem::create_directories(folder);
+    std::ofstream(folder + "/Linie1.txt") << "Linie 1\n3\nA\nB\nC\nD\n";
+
+    auto catalog = std::make_shared<LineCatalog>(folder);
+    auto ledger = std::make_shared<FareLedger>("test_cap_state/fares.ledger", CapConfig{15, 0});
+    ledger->open();
+    TicketMachine machine(catalog, nullptr, nullptr, ledger);
+    const std::string down = "\033[B";
+    // Linie 1, A -> D (3 Stationen, 9 Geld), eine Person
+    const std::string journey = "\n" "\n" + down + down + down + "\n" "\n";
+    auto buy = [&](const std::string& paid) {
+        feedKeys(journey + paid);
+        machine.selectTram();
+        machine.selectStartStop();
+        machine.selectDestinationStop();
+        machine.addToCart(machine.selectPassengerCount());
+        machine.setRiderCard("karte-4711");
+        return machine.checkoutCart();
+    };
+
+    // 9 Geld voll (Münzen 7 und 2), dann 6 bis zum Deckel von 15, danach kostenlos ohne Bezahlung
+    auto tickets = buy("7\n" "2\n");
+    assert(tickets[0].price == 9 && tickets[0].capDiscount == 0);
+    tickets = buy("5\n" "1\n");
+    assert(tickets[0].price == 6 && tickets[0].capDiscount == 3);
+    assert(TicketMachine::renderTicket(tickets[0]).find("Fare cap:      -3 Geld") != std::string::npos);
+    tickets = buy("");
+    assert(tickets[0].price == 0 && tickets[0].capDiscount == 9 && tickets[0].change.empty());
+    assert(!machine.hasRiderCard());
+
+    const std::uint16_t day = TicketCode::dayFromDate(tickets[0].date);
+    assert(ledger->totals(ledger->riderId("KARTE-4711"), day).day == 15);
+
+    bool threw = false;
+    try {
+        machine.setRiderCard("12");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::filesystem::remove_all(folder);
+    std::filesystem::remove_all("test_cap_state");
+    std::cout << "Fahrpreisdeckel OK." << std::endl;
+}
+
 int main() {
     std::cout << "--- Start Tests TicketMachine ---" << std::endl;
 
     test_printTicket();
     test_full_process();
+    test_cart();
+    test_price_too_large_for_code();
+    test_state_unwritable_before_payment();
+    test_input_ends_during_sale();
+    test_stop_first();
+    test_fare_cap();
 
     std::cout << "\nAlle Tests durchgelaufen." << std::endl;
     return 0;
@@ -0,0 +1,152 @@
+#include "../Timetable/Timetable.hpp"
+#include "../Catalog/LineCatalog.hpp"
+#include "../TramParser/TramParser.hpp"
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+const std::string TEST_FOLDER = "test_timetable";
+
+int at(int hours, int minutes) {
+    return hours * 60 + minutes;
+}
+
+void test_next_departures() {
+    std::cout << "Teste nächste Abfahrten..." << std::endl;
+    const Timetable table = Timetable::parse("# Testlinie\n"
+                                             "outbound\n"
+                                             "runtimes 0 2 5\n"
+                                             "every 06:00 07:00 20\n"
+                                             "at 23:50   # Spätfahrt\n"
+                                             "inbound\n"
+                                             "runtimes 0 3 4\n"
+                                             "every 23:00 00:30 30\n"
+                                             "at 00:10\n",
+                                             3, "test.times");
+    assert(table.stopCount() == 3);
+    assert(table.departureCount(1, Direction::Outbound) == 5);
+
+    // Zweite Haltestelle, 2 Minuten nach der ersten
+    auto next = table.nextDepartures(1, Direction::Outbound, at(6, 22), 3);
+    assert((next == std::vector<int>{at(6, 22), at(6, 42), at(7, 2)}));
+    // Nach der letzten Fahrt geht es am nächsten Morgen weiter
+    next = table.nextDepartures(1, Direction::Outbound, at(23, 55), 2);
+    assert((next == std::vector<int>{at(6, 2) + 1440, at(6, 22) + 1440}));
+    assert(Timetable::formatTime(next[0]) == "06:02");
+
+    // Rückrichtung: die letzte Haltestelle der Datei ist die erste der Fahrt
+    assert(table.nextDepartures(2, Direction::Inbound, at(22, 0), 1).front() == at(23, 0));
+    // Haltestelle 0 erreicht die Bahn nach 4 Minuten; um 00:05 fahren noch Bahnen von gestern (24:30)
+    next = table.nextDepartures(0, Direction::Inbound, at(0, 5), 3);
+    assert((next == std::vector<int>{at(0, 14), at(0, 34), at(23, 4)}));
+    assert(Timetable::formatTime(at(24, 34)) == "00:34");
+
+    assert(Timetable::directionOf(0, 2) == Direction::Outbound);
+    assert(Timetable::directionOf(2, 1) == Direction::Inbound);
+    std::cout << "Nächste Abfahrten erfolgreich." << std::endl;
+}
+
+void test_compression() {
+    std::cout << "Teste Blöcke und Deltas..." << std::endl;
+    // Minutentakt mit Lücken: viele Blöcke, Deltas über 127 Minuten
+    const std::string text = "outbound\nruntimes 0 7\n"
+                             "every 04:30 09:00 1\nevery 12:00 23:59 3\nat 26:15 02:40\n";
+    const Timetable table = Timetable::parse(text, 2, "takt.times");
+
+    std::vector<int> all;
+    for (int minute = at(4, 30); minute <= at(9, 0); ++minute) all.push_back(minute + 7);
+    for (int minute = at(12, 0); minute <= at(23, 59); minute += 3) all.push_back(minute + 7);
+    all.push_back(at(26, 15) + 7);
+    all.push_back(at(2, 40) + 7);
+    std::sort(all.begin(), all.end());
+    assert(table.departureCount(1, Direction::Outbound) == all.size());
+    assert(table.departureCount(1, Direction::Inbound) == 0);
+    assert(table.nextDepartures(1, Direction::Inbound, 0, 3).empty());
+    // Kleiner als ein uint16_t pro Abfahrt
+    assert(table.compressedBytes() < 2 * all.size() * sizeof(std::uint16_t));
+
+    // Vergleich mit einfacher Suche über gestern, heute und morgen
+    std::vector<int> days;
+    for (const int shift : {-1440, 0, 1440}) {
+        for (const int time : all) days.push_back(time + shift);
+    }
+    std::sort(days.begin(), days.end());
+    std::mt19937 random(5);
+    for (int i = 0; i < 2000; ++i) {
+        const int minute = static_cast<int>(random() % 1440);
+        const std::size_t count = 1 + random() % 40;
+        std::vector<int> expected;
+        for (auto it = std::lower_bound(days.begin(), days.end(), minute); it != days.end() && expected.size() < count;
+             ++it) {
+            expected.push_back(*it);
+        }
+        assert(table.nextDepartures(1, Direction::Outbound, minute, count) == expected);
+    }
+    std::cout << "Blöcke und Deltas erfolgreich." << std::endl;
+}
+
+void test_errors() {
+    std::cout << "Teste Fehlermeldungen..." << std::endl;
+    const std::vector<std::pair<std::string, std::string>> cases = {
+        {"outbound\nruntimes 0 2\n", "kaputt.times:2: expected 3 running times, got 2"},
+        {"outbound\nruntimes 0 2 1\n", "kaputt.times:2: running times must not decrease"},
+        {"outbound\nruntimes 0 1 2\nat 12:61\n", "kaputt.times:3: invalid time '12:61'"},
+        {"runtimes 0 1 2\n", "kaputt.times:1: expected 'outbound' or 'inbound' before 'runtimes'"},
+        {"inbound\nruntimes 0 1 2\nevery 05:00 06:00 0\n", "kaputt.times:3: invalid interval '0'"},
+        {"outbound\nabfahrt 05:00\n", "kaputt.times:2: unknown keyword 'abfahrt'"},
+        {"outbound\nat 05:00\n", "kaputt.times:2: outbound has trips but no running times"},
+    };
+    for (const auto& [text, message] : cases) {
+        bool threw = false;
+        try {
+            (void) Timetable::parse(text, 3, "kaputt.times");
+        } catch (const ParseError& e) {
+            threw = std::string(e.what()) == message;
+        }
+        assert(threw);
+    }
+    std::cout << "Fehlermeldungen erfolgreich." << std::endl;
+}
+
+void test_catalog() {
+    std::cout << "Teste Fahrpläne im Linienkatalog..." << std::endl;
+    std::ofstream(TEST_FOLDER + "/LinieA.txt") << "Linie A\n2\nA1\nA2\nA3\n";
+    std::ofstream(TEST_FOLDER + "/LinieA.times") << "outbound\nruntimes 0 1 2\nat 08:00\n";
+    std::ofstream(TEST_FOLDER + "/LinieB.txt") << "Linie B\n2\nB1\nB2\n";
+    // Falsche Anzahl Fahrzeiten: Linie bleibt verfügbar, nur ohne Fahrplan
+    std::ofstream(TEST_FOLDER + "/LinieB.times") << "outbound\nruntimes 0 1 2\n";
+    std::ofstream(TEST_FOLDER + "/LinieC.txt") << "Linie C\n2\nC1\nC2\n";
+
+    LineCatalog catalog(TEST_FOLDER);
+    const auto snapshot = catalog.snapshot();
+    assert(snapshot->lines.size() == 3);
+    const auto* a = snapshot->find("LinieA");
+    assert(a->timetable && a->timetable->nextDepartures(2, Direction::Outbound, 0, 1).front() == at(8, 2));
+    assert(snapshot->find("LinieB")->timetable == nullptr);
+    assert(snapshot->find("LinieC")->timetable == nullptr);
+
+    // Eine geänderte Fahrplandatei lädt die Linie neu
+    std::ofstream(TEST_FOLDER + "/LinieA.times") << "outbound\nruntimes 0 1 2\nat 09:00\n";
+    catalog.reloadLines({"LinieA"});
+    assert(catalog.snapshot()->find("LinieA")->timetable->nextDepartures(0, Direction::Outbound, 0, 1).front() ==
+           at(9, 0));
+    std::cout << "Fahrpläne im Linienkatalog erfolgreich." << std::endl;
+}
+
+int main() {
+    std::cout << "--- Start Tests Timetable ---" << std::endl;
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::filesystem::create_directories(TEST_FOLDER);
+    test_next_departures();
+    test_compression();
+    test_errors();
+    test_catalog();
+    std::filesystem::remove_all(TEST_FOLDER);
+    std::cout << "--- Alle Tests Timetable bestanden ---" << std::endl;
+    return 0;
+}
@@ -1,9 +1,11 @@
 #include "../TramParser/TramParser.hpp"
+#include "../TramParser/EmbeddedNetwork.hpp"
 #include <iostream>
 #include <cassert>
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <sstream>
 
 void write_file(std::string name, std::string content) {
     if (!std::filesystem::exists("data")) std::filesystem::create_directory("data");
@@ -42,9 +44,115 @@ void test_error() {
     }
 }
 
+void test_crlf_bom() {
+    std::cout << "Teste CRLF und BOM..." << std::endl;
+
+    std::string content = "\xEF\xBB\xBFLinie 12\r\n3\r\nStötteritz\r\nWilhelm\u2011Leuschner\u2011Platz\r\n\r\n";
+    TramData data = TramParser::parseTramBuffer(content, "crlf.txt");
+
+    assert(data.name == "Linie 12");
+    assert(data.pricePerStop == 3);
+    assert(data.stops.size() == 2);
+    assert(data.stops[0] == "Stötteritz");
+    assert(data.stops[1] == "Wilhelm\u2011Leuschner\u2011Platz");
+
+    // Menüname aus der Datei gleich dem geparsten Namen
+    write_file("Linie12.txt", content);
+    assert(TramParser::getDisplayNameFromFile("Linie12") == "Linie 12");
+    bool listed = false;
+    for (const auto& entry : TramParser::getAvailableLines("data")) {
+        if (entry.fileName == "Linie12") {
+            listed = entry.displayName == TramParser::parseTramFile("Linie12").name;
+        }
+    }
+    assert(listed);
+    std::filesystem::remove("data/Linie12.txt");
+}
+
+void test_diagnostics() {
+    std::cout << "Teste Fehlermeldungen mit Zeilennummer..." << std::endl;
+
+    // Ungültiges UTF-8 in Zeile 4
+    try {
+        TramParser::parseTramBuffer("Linie 1\n2\nA\nB\xC3(\n", "kaputt.txt");
+        assert(false);
+    } catch (const ParseError& e) {
+        assert(e.getLine() == 4);
+        assert(std::string(e.what()).rfind("kaputt.txt:4:", 0) == 0);
+    }
+
+    // Preis ist keine Zahl
+    try {
+        TramParser::parseTramBuffer("Linie 1\nsieben\nA\n", "preis.txt");
+        assert(false);
+    } catch (const ParseError& e) {
+        assert(e.getLine() == 2);
+    }
+
+    // Datei ohne Preis
+    try {
+        TramParser::parseTramBuffer("Linie 1\n", "leer.txt");
+        assert(false);
+    } catch (const ParseError& e) {
+        assert(e.getLine() == 2);
+    }
+}
+
+void test_same_as_stream_parser() {
+    std::cout << "Vergleiche mit Stream-Parser..." << std::endl;
+
+    std::string content = "Linie 4\n7\n\nKolmstraße\nRathaus Stötteritz\nEnde";
+    std::istringstream stream(content);
+    TramData expected = TramParser::parseTramStream(stream);
+    TramData actual = TramParser::parseTramBuffer(content, "vergleich.txt");
+
+    assert(actual.name == expected.name);
+    assert(actual.pricePerStop == expected.pricePerStop);
+    assert(actual.stops == expected.stops);
+}
+
+void test_embedded_network() {
+    std::cout << "Teste eingebettetes Netz..." << std::endl;
+    if (!EmbeddedNetwork::available()) {
+        std::cout << "Kein eingebettetes Netz gebaut, übersprungen." << std::endl;
+        return;
+    }
+
+    // Im erzwungenen Modus wird kein Ordner gelesen, auch kein fehlender
+    EmbeddedNetwork::setForced(true);
+    const auto entries = TramParser::getAvailableLines("ordner_gibt_es_nicht");
+    assert(entries.size() == EmbeddedNetwork::lineCount());
+    std::vector<TramData> embedded;
+    for (const auto& entry : entries) {
+        embedded.push_back(TramParser::parseTramFile("ordner_gibt_es_nicht", entry.fileName));
+        assert(embedded.back().name == entry.displayName);
+    }
+    bool threw = false;
+    try {
+        TramParser::parseTramFile("ordner_gibt_es_nicht", "KeineLinie");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    EmbeddedNetwork::setForced(false);
+
+    // Eingebettete Daten entsprechen den Dateien in data/, aus denen sie gebaut wurden
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const TramData fromFile = TramParser::parseTramFile("data", entries[i].fileName);
+        assert(fromFile.name == embedded[i].name);
+        assert(fromFile.pricePerStop == embedded[i].pricePerStop);
+        assert(fromFile.stops == embedded[i].stops);
+    }
+    std::cout << "Eingebettetes Netz OK." << std::endl;
+}
+
 int main() {
     test_parser();
     test_error();
+    test_crlf_bom();
+    test_diagnostics();
+    test_same_as_stream_parser();
+    test_embedded_network();
     std::cout << "TramParser Tests fertig." << std::endl;
     return 0;
 }
\ No newline at end of file
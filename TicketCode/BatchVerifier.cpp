@@ -0,0 +1,107 @@
+#include "BatchVerifier.hpp"
+#include "../TramParser/LineFileBuffer.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace {
+struct ChunkResult {
+    std::size_t valid = 0;
+    std::size_t invalid = 0;
+    std::size_t lineCount = 0;
+    // Line numbers relative to the start of the chunk
+    std::vector<std::size_t> invalidLines;
+};
+
+void verifyChunk(std::string_view chunk, const TicketKey& key, std::size_t maxReported, ChunkResult& result) {
+    std::size_t position = 0;
+    while (position < chunk.size()) {
+        std::size_t end = TextScanner::findNewline(chunk, position);
+        if (end == std::string_view::npos) {
+            end = chunk.size();
+        }
+        std::string_view code = chunk.substr(position, end - position);
+        if (!code.empty() && code.back() == '\r') {
+            code.remove_suffix(1);
+        }
+
+        // Blank lines are skipped but still counted for line numbers
+        if (!code.empty()) {
+            if (TicketCode::verify(code, key)) {
+                result.valid++;
+            } else {
+                result.invalid++;
+                if (result.invalidLines.size() < maxReported) {
+                    result.invalidLines.push_back(result.lineCount);
+                }
+            }
+        }
+        result.lineCount++;
+        position = end + 1;
+    }
+}
+}
+
+/**
+ * @brief Verifies a text with one ticket code per line on several threads.
+ *
+ * The text is cut into chunks at line boundaries, and idle threads take the
+ * next chunk, so a slow core does not hold up the rest. Line numbers are
+ * restored afterwards from the line count of each chunk.
+ *
+ * @param text Codes separated by newlines, e.g. a memory-mapped scan export.
+ * @param key Secret key.
+ * @param threads Number of worker threads; 0 means one per core.
+ * @param maxReported Maximum number of invalid line numbers to collect.
+ * @return Counts of valid and invalid codes and the first invalid line numbers.
+ */
+BatchResult BatchVerifier::verifyText(std::string_view text, const TicketKey& key, unsigned threads,
+                                      std::size_t maxReported) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // About 1 MiB per chunk, at least a few chunks per thread for load balancing
+    const std::size_t targetChunks = std::max<std::size_t>(threads * 4, text.size() >> 20);
+    const std::size_t chunkSize = std::max<std::size_t>(1, text.size() / targetChunks);
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    while (begin < text.size()) {
+        std::size_t end = std::min(text.size(), begin + chunkSize);
+        const std::size_t newline = TextScanner::findNewline(text, end > 0 ? end - 1 : 0);
+        end = newline == std::string_view::npos ? text.size() : newline + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+
+    std::vector<ChunkResult> results(chunks.size());
+    std::atomic<std::size_t> nextChunk{0};
+    auto worker = [&]() {
+        for (std::size_t index = nextChunk++; index < chunks.size(); index = nextChunk++) {
+            verifyChunk(chunks[index], key, maxReported, results[index]);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < threads; ++i) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+
+    BatchResult total;
+    std::size_t firstLine = 1;
+    for (const auto& result : results) {
+        total.valid += result.valid;
+        total.invalid += result.invalid;
+        for (const std::size_t line : result.invalidLines) {
+            if (total.invalidLines.size() < maxReported) {
+                total.invalidLines.push_back(firstLine + line);
+            }
+        }
+        firstLine += result.lineCount;
+    }
+    return total;
+}
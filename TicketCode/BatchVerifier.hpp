@@ -0,0 +1,18 @@
+#pragma once
+#include "TicketCode.hpp"
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+struct BatchResult {
+    std::size_t valid = 0;
+    std::size_t invalid = 0;
+    // 1-based line numbers of the first invalid codes, in file order
+    std::vector<std::size_t> invalidLines;
+};
+
+class BatchVerifier {
+public:
+    static BatchResult verifyText(std::string_view text, const TicketKey& key, unsigned threads,
+                                  std::size_t maxReported = 100);
+};
@@ -0,0 +1,67 @@
+#include "SipHash.hpp"
+
+namespace {
+inline std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline std::uint64_t readLittleEndian64(const std::uint8_t* bytes) {
+    std::uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+inline void sipRound(std::uint64_t& v0, std::uint64_t& v1, std::uint64_t& v2, std::uint64_t& v3) {
+    v0 += v1; v1 = rotateLeft(v1, 13); v1 ^= v0; v0 = rotateLeft(v0, 32);
+    v2 += v3; v3 = rotateLeft(v3, 16); v3 ^= v2;
+    v0 += v3; v3 = rotateLeft(v3, 21); v3 ^= v0;
+    v2 += v1; v1 = rotateLeft(v1, 17); v1 ^= v2; v2 = rotateLeft(v2, 32);
+}
+}
+
+/**
+ * @brief Computes SipHash-2-4 of a message (Aumasson/Bernstein reference algorithm).
+ * @param key 128-bit secret key.
+ * @param data Message bytes.
+ * @param length Message length in bytes.
+ * @return The 64-bit MAC.
+ */
+std::uint64_t SipHash::hash24(const std::uint8_t key[16], const std::uint8_t* data, std::size_t length) {
+    const std::uint64_t k0 = readLittleEndian64(key);
+    const std::uint64_t k1 = readLittleEndian64(key + 8);
+    std::uint64_t v0 = 0x736f6d6570736575ULL ^ k0;
+    std::uint64_t v1 = 0x646f72616e646f6dULL ^ k1;
+    std::uint64_t v2 = 0x6c7967656e657261ULL ^ k0;
+    std::uint64_t v3 = 0x7465646279746573ULL ^ k1;
+
+    // Compression: two rounds per full 8-byte block
+    const std::size_t fullBlocks = length / 8;
+    for (std::size_t block = 0; block < fullBlocks; ++block) {
+        const std::uint64_t m = readLittleEndian64(data + block * 8);
+        v3 ^= m;
+        sipRound(v0, v1, v2, v3);
+        sipRound(v0, v1, v2, v3);
+        v0 ^= m;
+    }
+
+    // Last block: remaining bytes plus the message length in the top byte
+    std::uint64_t last = static_cast<std::uint64_t>(length & 0xff) << 56;
+    const std::uint8_t* tail = data + fullBlocks * 8;
+    for (std::size_t i = 0; i < (length & 7); ++i) {
+        last |= static_cast<std::uint64_t>(tail[i]) << (8 * i);
+    }
+    v3 ^= last;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    v0 ^= last;
+
+    // Finalization: four rounds
+    v2 ^= 0xff;
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    sipRound(v0, v1, v2, v3);
+    return v0 ^ v1 ^ v2 ^ v3;
+}
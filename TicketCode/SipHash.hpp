@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+class SipHash {
+public:
+    static std::uint64_t hash24(const std::uint8_t key[16], const std::uint8_t* data, std::size_t length);
+};
@@ -0,0 +1,418 @@
+#include "TicketCode.hpp"
+#include "SipHash.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+// Crockford base32: no I, L, O or U, so codes survive being read aloud or typed in
+constexpr char ALPHABET[] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+constexpr std::uint8_t INVALID_SYMBOL = 0xff;
+constexpr std::size_t CODE_BYTES = TicketCode::PAYLOAD_BYTES + TicketCode::TAG_BYTES;
+
+struct SymbolTable {
+    std::uint8_t values[256];
+
+    constexpr SymbolTable() : values() {
+        for (auto& value : values) {
+            value = INVALID_SYMBOL;
+        }
+        for (std::uint8_t i = 0; i < 32; ++i) {
+            values[static_cast<unsigned char>(ALPHABET[i])] = i;
+            // Lower case is accepted as well
+            if (ALPHABET[i] >= 'A') {
+                values[static_cast<unsigned char>(ALPHABET[i] - 'A' + 'a')] = i;
+            }
+        }
+        // Common misreadings map to the digit they look like
+        values['O'] = values['o'] = 0;
+        values['I'] = values['i'] = values['L'] = values['l'] = 1;
+    }
+};
+constexpr SymbolTable SYMBOLS;
+
+void writeBigEndian(std::uint8_t* out, std::uint64_t value, int bytes) {
+    for (int i = bytes - 1; i >= 0; --i) {
+        out[i] = static_cast<std::uint8_t>(value);
+        value >>= 8;
+    }
+}
+
+std::uint64_t readBigEndian(const std::uint8_t* in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+std::uint64_t computeTag(const std::uint8_t* payload, const TicketKey& key) {
+    // The code carries the low 40 bits of the 64-bit MAC
+    return SipHash::hash24(key.bytes.data(), payload, TicketCode::PAYLOAD_BYTES) & 0xffffffffffULL;
+}
+
+// A new or renamed file only survives a crash once its directory entry is on disk
+bool syncDirectory(const std::string& path) {
+    const int dir = open(path.empty() ? "." : path.c_str(), O_RDONLY | O_DIRECTORY);
+    const bool synced = dir >= 0 && fsync(dir) == 0;
+    if (dir >= 0) {
+        close(dir);
+    }
+    return synced;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+}
+
+/**
+ * @brief Reads a ticket key stored as 32 hex digits.
+ * @param path Key file.
+ * @return The key.
+ * @throws std::runtime_error If the file is missing or malformed.
+ */
+TicketKey TicketKey::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    std::string hex;
+    file >> hex;
+    if (hex.size() != 32) {
+        throw std::runtime_error("Invalid ticket key file: " + path);
+    }
+
+    TicketKey key;
+    for (std::size_t i = 0; i < key.bytes.size(); ++i) {
+        const int high = hexValue(hex[2 * i]);
+        const int low = hexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            throw std::runtime_error("Invalid ticket key file: " + path);
+        }
+        key.bytes[i] = static_cast<std::uint8_t>(high << 4 | low);
+    }
+    return key;
+}
+
+/**
+ * @brief Reads the ticket key, creating a new random key on first use.
+ * The key file is only readable by its owner. Nothing leaves the machine.
+ * @param path Key file.
+ * @return The key.
+ * @throws std::runtime_error If the key cannot be read or written.
+ */
+TicketKey TicketKey::loadOrCreate(const std::string& path) {
+    if (std::filesystem::exists(path)) {
+        return load(path);
+    }
+
+    const std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) {
+        std::filesystem::create_directories(parent);
+    }
+
+    TicketKey key;
+    std::random_device random;
+    for (std::size_t i = 0; i < key.bytes.size(); i += 4) {
+        const std::uint32_t word = random();
+        writeBigEndian(key.bytes.data() + i, word, 4);
+    }
+
+    std::string hex;
+    for (const std::uint8_t byte : key.bytes) {
+        hex += "0123456789abcdef"[byte >> 4];
+        hex += "0123456789abcdef"[byte & 0xf];
+    }
+    hex += '\n';
+
+    const int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+        // Another process created the key in the meantime
+        if (errno == EEXIST) {
+            return load(path);
+        }
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    const bool written = write(fd, hex.data(), hex.size()) == static_cast<ssize_t>(hex.size()) && fsync(fd) == 0;
+    close(fd);
+    if (!written || !syncDirectory(parent.string())) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    return key;
+}
+
+/**
+ * @brief Encodes and signs a ticket as a 32-symbol base32 code in groups of four.
+ * @param payload Ticket fields.
+ * @param key Secret key.
+ * @return The printable code, e.g. "1A2B-3C4D-...".
+ */
+std::string TicketCode::encode(const TicketPayload& payload, const TicketKey& key) {
+    std::uint8_t bytes[CODE_BYTES];
+    bytes[0] = VERSION;
+    writeBigEndian(bytes + 1, payload.lineId, 2);
+    writeBigEndian(bytes + 3, payload.startIndex, 2);
+    writeBigEndian(bytes + 5, payload.destinationIndex, 2);
+    writeBigEndian(bytes + 7, payload.price, 2);
+    writeBigEndian(bytes + 9, payload.day, 2);
+    writeBigEndian(bytes + 11, payload.serial, 4);
+    writeBigEndian(bytes + PAYLOAD_BYTES, computeTag(bytes, key), TAG_BYTES);
+
+    std::string code;
+    code.reserve(CODE_SYMBOLS + CODE_SYMBOLS / 4);
+    // Every 5 bytes give 8 symbols
+    for (std::size_t group = 0; group < CODE_BYTES; group += 5) {
+        const std::uint64_t bits = readBigEndian(bytes + group, 5);
+        for (int shift = 35; shift >= 0; shift -= 5) {
+            if (!code.empty() && (code.size() + 1) % 5 == 0) {
+                code += '-';
+            }
+            code += ALPHABET[(bits >> shift) & 0x1f];
+        }
+    }
+    return code;
+}
+
+/**
+ * @brief Checks a ticket code and optionally decodes its fields.
+ * Dashes and spaces are ignored, lower case and O/I/L misreadings are accepted.
+ * Runs without allocations, as the batch verifier calls it millions of times.
+ * @param code The code as printed or scanned.
+ * @param key Secret key.
+ * @param payload Receives the decoded fields if the code is valid; may be nullptr.
+ * @return True if the code is well-formed and its MAC matches.
+ */
+bool TicketCode::verify(std::string_view code, const TicketKey& key, TicketPayload* payload) {
+    std::uint8_t symbols[CODE_SYMBOLS];
+    std::size_t count = 0;
+    for (const char c : code) {
+        if (c == '-' || c == ' ') {
+            continue;
+        }
+        const std::uint8_t value = SYMBOLS.values[static_cast<unsigned char>(c)];
+        if (value == INVALID_SYMBOL || count == CODE_SYMBOLS) {
+            return false;
+        }
+        symbols[count++] = value;
+    }
+    if (count != CODE_SYMBOLS) {
+        return false;
+    }
+
+    std::uint8_t bytes[CODE_BYTES];
+    for (std::size_t group = 0; group < CODE_BYTES / 5; ++group) {
+        std::uint64_t bits = 0;
+        for (std::size_t i = 0; i < 8; ++i) {
+            bits = (bits << 5) | symbols[group * 8 + i];
+        }
+        writeBigEndian(bytes + group * 5, bits, 5);
+    }
+
+    if (bytes[0] != VERSION || readBigEndian(bytes + PAYLOAD_BYTES, TAG_BYTES) != computeTag(bytes, key)) {
+        return false;
+    }
+
+    if (payload != nullptr) {
+        payload->lineId = static_cast<std::uint16_t>(readBigEndian(bytes + 1, 2));
+        payload->startIndex = static_cast<std::uint16_t>(readBigEndian(bytes + 3, 2));
+        payload->destinationIndex = static_cast<std::uint16_t>(readBigEndian(bytes + 5, 2));
+        payload->price = static_cast<std::uint16_t>(readBigEndian(bytes + 7, 2));
+        payload->day = static_cast<std::uint16_t>(readBigEndian(bytes + 9, 2));
+        payload->serial = static_cast<std::uint32_t>(readBigEndian(bytes + 11, 4));
+    }
+    return true;
+}
+
+/**
+ * @brief Derives the 16-bit line id stored in ticket codes from the line name (FNV-1a, folded).
+ * Inspectors map it back by computing the id of every known line.
+ * @param lineName Name of the tram line as in the first row of its file.
+ * @return The line id.
+ */
+std::uint16_t TicketCode::lineId(std::string_view lineName) {
+    std::uint32_t hash = 2166136261u;
+    for (const char c : lineName) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return static_cast<std::uint16_t>(hash ^ (hash >> 16));
+}
+
+/**
+ * @brief Converts a date in the format YYYY-MM-DD to days since 1970-01-01.
+ * @param date The date string.
+ * @return Number of days.
+ * @throws std::runtime_error If the date is malformed or outside 1970..2149.
+ */
+std::uint16_t TicketCode::dayFromDate(const std::string& date) {
+    int year = 0;
+    unsigned month = 0;
+    unsigned dayOfMonth = 0;
+    if (std::sscanf(date.c_str(), "%d-%u-%u", &year, &month, &dayOfMonth) != 3 ||
+        month < 1 || month > 12 || dayOfMonth < 1 || dayOfMonth > 31) {
+        throw std::runtime_error("Invalid date: " + date);
+    }
+
+    // Days from civil date (Howard Hinnant's algorithm)
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + dayOfMonth - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    const long days = static_cast<long>(era) * 146097 + static_cast<long>(dayOfEra) - 719468;
+
+    if (days < 0 || days > 0xffff) {
+        throw std::runtime_error("Invalid date: " + date);
+    }
+    return static_cast<std::uint16_t>(days);
+}
+
+/**
+ * @brief Converts days since 1970-01-01 back to YYYY-MM-DD.
+ * @param day Number of days.
+ * @return The date string.
+ */
+std::string TicketCode::dateFromDay(std::uint16_t day) {
+    // Civil date from days (Howard Hinnant's algorithm)
+    const long z = static_cast<long>(day) + 719468;
+    const long era = z / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(z - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned shiftedMonth = (5 * dayOfYear + 2) / 153;
+    const unsigned dayOfMonth = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    const unsigned month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    const long year = static_cast<long>(yearOfEra) + era * 400 + (month <= 2);
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%04ld-%02u-%02u", year, month, dayOfMonth);
+    return buffer;
+}
+
+/**
+ * @brief Creates a signer that keeps its key and serial counter in the given folder.
+ * The key is loaded (or created) on the first signed ticket.
+ * @param stateFolder Folder for ticket.key and ticket.serial.
+ */
+TicketSigner::TicketSigner(std::string stateFolder) : stateFolder(std::move(stateFolder)) {}
+
+/**
+ * @brief Assigns the next serial number to a ticket and returns its signed code.
+ * @param payload Ticket fields; payload.serial is overwritten.
+ * @return The printable code.
+ * @throws std::runtime_error If the key or serial counter cannot be accessed.
+ */
+std::string TicketSigner::sign(TicketPayload& payload) {
+    payload.serial = reserveSerials(1);
+    return signReserved(payload);
+}
+
+/**
+ * @brief Loads the key and reserves consecutive serial numbers for a purchase.
+ * All disk access of signing happens here, so it can be done before the customer pays.
+ * Serials of a purchase that is cancelled afterwards go back with releaseSerials().
+ * @param count Number of tickets.
+ * @return The first reserved serial number.
+ * @throws std::runtime_error If the key or serial counter cannot be accessed.
+ */
+std::uint32_t TicketSigner::reserveSerials(std::uint32_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!keyLoaded) {
+        key = TicketKey::loadOrCreate(stateFolder + "/ticket.key");
+        keyLoaded = true;
+    }
+    return advanceSerial(count);
+}
+
+/**
+ * @brief Signs a ticket whose serial was taken from reserveSerials(); touches no files.
+ * @param payload Ticket fields including the reserved serial.
+ * @return The printable code.
+ * @throws std::logic_error If no serials were reserved yet, so the key is not loaded.
+ */
+std::string TicketSigner::signReserved(const TicketPayload& payload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!keyLoaded) {
+        throw std::logic_error("Ticket key not loaded; reserve serials first");
+    }
+    return TicketCode::encode(payload, key);
+}
+
+/**
+ * @brief Gives back the serials of a purchase that was not paid.
+ * Only done if no later serial was reserved in between, so a serial is never handed out twice.
+ * @param first First serial returned by reserveSerials().
+ * @param count Number of serials reserved.
+ * @throws std::runtime_error If the counter cannot be written.
+ */
+void TicketSigner::releaseSerials(std::uint32_t first, std::uint32_t count) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count > 0 && readCounter() == first + count - 1) {
+        writeCounter(first - 1);
+    }
+}
+
+/**
+ * @brief Advances the persistent serial counter.
+ * @param count Number of serials to take.
+ * @return The first of the new serial numbers.
+ * @throws std::runtime_error If the counter cannot be read or written.
+ */
+std::uint32_t TicketSigner::advanceSerial(std::uint32_t count) {
+    const std::uint32_t last = readCounter();
+    writeCounter(last + count);
+    return last + 1;
+}
+
+/**
+ * @brief Reads the last handed out serial number; 0 before the first sale.
+ * @throws std::runtime_error If the counter file is malformed.
+ */
+std::uint32_t TicketSigner::readCounter() const {
+    const std::string path = stateFolder + "/ticket.serial";
+    std::uint32_t serial = 0;
+    std::ifstream in(path);
+    if (in.is_open() && !(in >> serial)) {
+        throw std::runtime_error("Invalid serial counter: " + path);
+    }
+    return serial;
+}
+
+/**
+ * @brief Stores the serial counter.
+ * The value is written to a temporary file, renamed over the old one and the
+ * state folder is synced before returning, so a power failure never loses or
+ * repeats a serial.
+ * @param serial The last handed out serial number.
+ * @throws std::runtime_error If the counter cannot be written.
+ */
+void TicketSigner::writeCounter(std::uint32_t serial) const {
+    const std::string path = stateFolder + "/ticket.serial";
+    std::filesystem::create_directories(stateFolder);
+
+    const std::string temporary = path + ".tmp";
+    const std::string content = std::to_string(serial) + "\n";
+    const int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Could not write file: " + temporary);
+    }
+    const bool written = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()) &&
+                         fsync(fd) == 0;
+    close(fd);
+    if (!written || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    if (!syncDirectory(stateFolder)) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+}
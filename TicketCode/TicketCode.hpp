@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+struct TicketKey {
+    std::array<std::uint8_t, 16> bytes{};
+
+    static TicketKey load(const std::string& path);
+    static TicketKey loadOrCreate(const std::string& path);
+};
+
+// Fields covered by the ticket code; stops are indices into the line's stop list
+struct TicketPayload {
+    std::uint16_t lineId = 0;
+    std::uint16_t startIndex = 0;
+    std::uint16_t destinationIndex = 0;
+    std::uint16_t price = 0;
+    // Days since 1970-01-01
+    std::uint16_t day = 0;
+    std::uint32_t serial = 0;
+};
+
+class TicketCode {
+public:
+    static constexpr std::uint8_t VERSION = 1;
+    static constexpr std::size_t PAYLOAD_BYTES = 15;
+    static constexpr std::size_t TAG_BYTES = 5;
+    // (15 + 5) bytes * 8 / 5 bits per symbol
+    static constexpr std::size_t CODE_SYMBOLS = 32;
+
+    static std::string encode(const TicketPayload& payload, const TicketKey& key);
+    static bool verify(std::string_view code, const TicketKey& key, TicketPayload* payload = nullptr);
+    static std::uint16_t lineId(std::string_view lineName);
+    static std::uint16_t dayFromDate(const std::string& date);
+    static std::string dateFromDay(std::uint16_t day);
+};
+
+class TicketSigner {
+public:
+    explicit TicketSigner(std::string stateFolder = "state");
+
+    std::string sign(TicketPayload& payload);
+    std::uint32_t reserveSerials(std::uint32_t count);
+    std::string signReserved(const TicketPayload& payload);
+    void releaseSerials(std::uint32_t first, std::uint32_t count);
+
+private:
+    std::string stateFolder;
+    TicketKey key;
+    bool keyLoaded = false;
+    std::mutex mutex;
+
+    std::uint32_t advanceSerial(std::uint32_t count);
+    std::uint32_t readCounter() const;
+    void writeCounter(std::uint32_t serial) const;
+};
@@ -3,6 +3,8 @@
 #include "../Payment/Payment.hpp"
 #include "../TUI/TUIMenu/TUIMenu.hpp"
 #include "../TUI/TUIInputField/TUIInputField.hpp"
+#include "../TUI/TerminalIO/TerminalIO.hpp"
+#include "../Logging/Logger.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
@@ -10,38 +12,176 @@
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
+#include <ctime>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+// The inspection code stores stops and price in 16 bits; larger values must not wrap
+std::uint16_t codeField(long long value, const char* name) {
+    if (value < 0 || value > std::numeric_limits<std::uint16_t>::max()) {
+        throw std::runtime_error(std::string("Ticket code cannot hold ") + name + " " + std::to_string(value));
+    }
+    return static_cast<std::uint16_t>(value);
+}
+}
 
 /**
- * @brief Allows the user to select a tram line from available files.
- * Loads the tram data using TramParser and resets start/destination indices.
- * @throws std::runtime_error If no tram files are found.
+ * @brief Allows the user to select a tram line from the line catalog.
+ * Takes the tram data from the current catalog snapshot and resets start/destination indices.
+ * The snapshot is kept for the rest of the purchase, so a data update in between does not affect it.
+ * The most frequent journeys of this machine are offered first and select line, start and destination at once.
+ * @throws std::runtime_error If no tram lines are available.
  */
 void TicketMachine::selectTram() {
-    // Step 1: Retrieve all available tram configuration files from the "data" directory
-    std::vector<FileEntry> entries = TramParser::getAvailableLines("data");
+    // Step 1: Take the current snapshot of all loaded tram lines
+    snapshot = catalog->snapshot();
 
     // Check if any tram lines were found
-    if (entries.empty()) {
+    if (snapshot->lines.empty()) {
         throw std::runtime_error("No tram available");
     }
 
-    // Step 2: Create a TUI menu for tram selection
+    // Step 2: Create a TUI menu for tram selection, quick picks first
     TUIMenu menu("Select a tram:");
-    for (const auto& entry : entries) {
-        // Add each tram line as an option in the menu
-        menu.addOption(entry.displayName, [this, entry]() {
-            // Action to perform when a tram is selected:
-            // 1. Parse the selected tram file to load stops and price info
-            this->currentTram = TramParser::parseTramFile(entry.fileName);
-            // 2. Reset the start and destination stop indices for the new tram
-            this->selectedStartIndex = 0;
-            this->selectedDestinationIndex = 0;
-        });
-    }
+    journeyPreselected = false;
+    addQuickPicks(menu);
+    // Each tram line is a row labelled with its display name; no copy per line
+    const auto& lines = snapshot->lines;
+    menu.setItems(lines.size(), [&lines](size_t index) {
+        return std::string_view(lines[index].entry.displayName);
+    });
+    // Customers who do not know the line start from their stop instead
+    bool byStop = false;
+    menu.addOption("Start from a stop", [&byStop]() { byStop = true; });
     // Add cancel option
     menu.addCancelationOption();
     // Step 3: Run the menu and wait for user selection
-    menu.run();
+    const size_t chosen = menu.run();
+    if (chosen != TUIMenu::NO_ITEM) {
+        // The catalog parsed every line in the background, so Enter does no file access;
+        // the line is taken from the snapshot without copying, start and destination are reset
+        useLine(lines[chosen]);
+    }
+    if (byStop) {
+        selectJourneyByStop();
+    }
+}
+
+/**
+ * @brief Lets the customer choose the start stop first and then any destination reachable from it.
+ * All stops of the snapshot are listed; a transfer stop appears once with every line through it.
+ * Destinations come from the stop index with the cheapest direct line and its price.
+ * Selects line, start and destination at once, like a quick pick.
+ * @throws std::runtime_error If there are no stops or no destination can be reached.
+ */
+void TicketMachine::selectJourneyByStop() {
+    if (!snapshot) {
+        snapshot = catalog->snapshot();
+    }
+    const StopIndex& stops = snapshot->stops;
+    if (stops.stopCount() == 0) {
+        throw std::runtime_error("No stops available");
+    }
+
+    TUIMenu startMenu("Start stop:");
+    startMenu.setItems(stops.stopCount(), [&stops](size_t stop) {
+        return std::string_view(stops.name(static_cast<std::uint32_t>(stop)));
+    });
+    startMenu.addCancelationOption();
+    const size_t start = startMenu.run();
+    if (start == TUIMenu::NO_ITEM) {
+        return;
+    }
+
+    const auto startStop = static_cast<std::uint32_t>(start);
+    const auto connections = stops.destinations(startStop);
+    if (connections.empty()) {
+        throw std::runtime_error("No destination reachable from " + stops.name(startStop));
+    }
+    std::string lines;
+    std::uint32_t previousLine = UINT32_MAX;
+    for (const auto& serving : stops.servings(startStop)) {
+        // Servings are in line order; a loop line passes the stop twice
+        if (serving.line != previousLine) {
+            lines += (lines.empty() ? "" : ", ") + snapshot->lines[serving.line].data.name;
+            previousLine = serving.line;
+        }
+    }
+
+    std::vector<std::string> labels;
+    labels.reserve(connections.size());
+    for (const auto& connection : connections) {
+        const CatalogLine& line = snapshot->lines[connection.line];
+        const std::string next = departuresText(
+            line.timetable.get(), connection.startPosition,
+            Timetable::directionOf(connection.startPosition, connection.destinationPosition), 1);
+        labels.push_back(stops.name(connection.destination) + " (" + line.data.name + ", " +
+                         std::to_string(connection.price) + " Geld" + (next.empty() ? "" : ", next " + next) + ")");
+    }
+    TUIMenu menu("Start: " + stops.name(startStop) + "\nLines: " + lines + "\nDestination:");
+    menu.setItems(labels);
+    menu.addCancelationOption();
+    const size_t chosen = menu.run();
+    if (chosen == TUIMenu::NO_ITEM) {
+        return;
+    }
+
+    const StopConnection& connection = connections[chosen];
+    useLine(snapshot->lines[connection.line]);
+    selectedStartIndex = connection.startPosition;
+    selectedDestinationIndex = connection.destinationPosition;
+    journeyPreselected = true;
+}
+
+/**
+ * @brief Adds the top journeys of the quick pick table as one-press menu entries.
+ * Journeys whose line or stops are no longer in the current snapshot are skipped.
+ * @param menu The tram selection menu.
+ */
+void TicketMachine::addQuickPicks(TUIMenu& menu) {
+    if (!quickPicks) {
+        return;
+    }
+
+    const StopIndex& stops = snapshot->stops;
+    for (const auto& pick : quickPicks->top(QUICK_PICK_COUNT, std::time(nullptr))) {
+        const std::uint32_t start = stops.find(pick.startStop);
+        const std::uint32_t destination = stops.find(pick.destinationStop);
+        if (start == StopIndex::NO_STOP || destination == StopIndex::NO_STOP || start == destination) {
+            continue;
+        }
+        // The line must still serve both stops
+        for (const auto& serving : stops.servings(start)) {
+            const CatalogLine& line = snapshot->lines[serving.line];
+            if (line.data.name != pick.line) {
+                continue;
+            }
+            size_t destinationIndex = SIZE_MAX;
+            for (const auto& arrival : stops.servings(destination)) {
+                if (arrival.line == serving.line) {
+                    destinationIndex = arrival.position;
+                    break;
+                }
+            }
+            if (destinationIndex == SIZE_MAX) {
+                continue;
+            }
+
+            const size_t startIndex = serving.position;
+            const int price = quotePrice(line.data, startIndex, destinationIndex);
+            menu.addOption("Quick pick: " + pick.line + ", " + pick.startStop + " -> " + pick.destinationStop +
+                           " (" + std::to_string(price) + " Geld)",
+                           [this, &line, startIndex, destinationIndex]() {
+                               this->useLine(line);
+                               this->selectedStartIndex = startIndex;
+                               this->selectedDestinationIndex = destinationIndex;
+                               this->journeyPreselected = true;
+                           });
+            break;
+        }
+    }
 }
 
 /**
@@ -51,25 +191,22 @@ void TicketMachine::selectTram() {
  */
 void TicketMachine::selectStartStop() {
     // Ensure a tram is selected before proceeding
-    if (currentTram.stops.empty()) {
+    if (!currentTram || currentTram->stops.empty()) {
         throw std::runtime_error("No tram selected!");
     }
 
     // Initialize the menu with the price per stop information
-    TUIMenu menu("Price per Stop: " + std::to_string(currentTram.pricePerStop) + " Geld\nStart:");
+    TUIMenu menu("Price per Stop: " + std::to_string(currentTram->pricePerStop) + " Geld\nStart:");
 
-    // Step 1: Add all stops of the current tram as menu options
-    for (size_t i = 0; i < currentTram.stops.size(); ++i) {
-        const std::string& stop = currentTram.stops.at(i);
-        menu.addOption(stop, [this, i]() {
-            // Update the selected start index when a stop is chosen
-            selectedStartIndex = i;
-        });
-    }
+    // Step 1: Show all stops of the current tram; the menu only views the names
+    menu.setItems(currentTram->stops);
     // Add cancel option
     menu.addCancelationOption();
-    // Step 2: Display the menu to the user
-    menu.run();
+    // Step 2: Display the menu to the user and take the chosen index as start
+    const size_t chosen = menu.run();
+    if (chosen != TUIMenu::NO_ITEM) {
+        selectedStartIndex = chosen;
+    }
 }
 
 /**
@@ -79,26 +216,33 @@ void TicketMachine::selectStartStop() {
  */
 void TicketMachine::selectDestinationStop() {
     // Ensure a tram is selected before proceeding
-    if (currentTram.stops.empty()) {
+    if (!currentTram || currentTram->stops.empty()) {
         throw std::runtime_error("No tram selected!");
     }
 
-    // Initialize menu, showing price and the already selected start stop
-    TUIMenu menu("Price per Stop: " + std::to_string(currentTram.pricePerStop) +
-                 " Geld\nStart: " + stopAtIndex(selectedStartIndex) + "\nDestination:");
-
-    // Step 1: Add all stops as menu options
-    for (size_t i = 0; i < currentTram.stops.size(); i++) {
-        const std::string& stop = currentTram.stops[i];
-        menu.addOption(stop, [this, i]() {
-            // Update the selected destination index when a stop is chosen
-            this->selectedDestinationIndex = i;
-        });
+    // Initialize menu, showing price, the already selected start stop and its next departures
+    std::string title = "Price per Stop: " + std::to_string(currentTram->pricePerStop) +
+                        " Geld\nStart: " + stopAtIndex(selectedStartIndex) + "\n";
+    const std::pair<Direction, size_t> terminals[] = {{Direction::Outbound, currentTram->stops.size() - 1},
+                                                      {Direction::Inbound, 0}};
+    for (const auto& [direction, terminal] : terminals) {
+        const std::string departures =
+            departuresText(currentTimetable.get(), selectedStartIndex, direction, NEXT_DEPARTURES);
+        if (terminal != selectedStartIndex && !departures.empty()) {
+            title += "Departures to " + currentTram->stops[terminal] + ": " + departures + "\n";
+        }
     }
+    TUIMenu menu(title + "Destination:");
+
+    // Step 1: Show all stops; the menu only views the names
+    menu.setItems(currentTram->stops);
     // Add cancel option
     menu.addCancelationOption();
-    // Step 2: Display the menu to the user
-    menu.run();
+    // Step 2: Display the menu to the user and take the chosen index as destination
+    const size_t chosen = menu.run();
+    if (chosen != TUIMenu::NO_ITEM) {
+        selectedDestinationIndex = chosen;
+    }
 }
 
 /**
@@ -108,77 +252,503 @@ void TicketMachine::selectDestinationStop() {
  * @throws std::runtime_error If no tram is selected.
  */
 TicketData TicketMachine::buyTicket() {
-    if (currentTram.stops.empty()) {
-        throw std::runtime_error("No tram selected! Please select a tram first.");
+    return settle({currentJourney(1)}).front();
+}
+
+/**
+ * @brief Asks how many passengers travel on the selected journey.
+ * @return The chosen number of passengers (1 to MAX_PASSENGERS).
+ * @throws std::runtime_error If no journey has been selected yet.
+ */
+int TicketMachine::selectPassengerCount() {
+    const int unitPrice = currentJourney(1).unitPrice;
+
+    std::vector<std::string> labels;
+    labels.reserve(MAX_PASSENGERS);
+    for (int passengers = 1; passengers <= MAX_PASSENGERS; ++passengers) {
+        labels.push_back(std::to_string(passengers) + (passengers == 1 ? " passenger" : " passengers") +
+                         " (" + std::to_string(passengers * unitPrice) + " Geld)");
     }
-    if (selectedStartIndex == selectedDestinationIndex) {
-        throw std::runtime_error("Invalid stop selection! Please select different stops.");
+
+    TUIMenu menu("Start: " + stopAtIndex(selectedStartIndex) + "\nDestination: " +
+                 stopAtIndex(selectedDestinationIndex) + "\nPassengers:");
+    menu.setItems(labels);
+    menu.addCancelationOption();
+    const size_t chosen = menu.run();
+    return chosen == TUIMenu::NO_ITEM ? 1 : static_cast<int>(chosen) + 1;
+}
+
+/**
+ * @brief Puts the selected journey into the cart.
+ * Journeys are paid together by checkoutCart().
+ * @param passengers Number of passengers; each gets an own ticket.
+ * @throws std::runtime_error If the journey is incomplete or passengers is not positive.
+ */
+void TicketMachine::addToCart(int passengers) {
+    if (passengers < 1) {
+        throw std::runtime_error("Invalid number of passengers");
     }
+    cart.push_back(currentJourney(passengers));
+}
+
+/**
+ * @brief Shows the cart and asks whether to pay or add another journey.
+ * With a fare ledger, the rider can enter a card first; the price shown is then the capped one.
+ * @return True if the customer wants to add another journey, false to pay now.
+ */
+bool TicketMachine::offerMoreTickets() {
+    while (true) {
+        int tickets = 0;
+        std::string title = "Cart:\n";
+        for (const auto& item : cart) {
+            title += "  " + std::to_string(item.passengers) + " x " + item.tram + ", " + item.startStop + " -> " +
+                     item.destinationStop + " (" + std::to_string(item.passengers * item.unitPrice) + " Geld)\n";
+            tickets += item.passengers;
+        }
+        if (hasRiderCard()) {
+            title += riderLabel + ": fare cap applied\n";
+        }
 
-    TicketData ticket;
-    ticket.startStop = stopAtIndex(selectedStartIndex);
-    ticket.destinationStop = stopAtIndex(selectedDestinationIndex);
-    ticket.tram = currentTram.name;
-    ticket.date = getCurrentDate();
-    ticket.price = calculatePrice();
+        bool addAnother = false;
+        bool enterCard = false;
+        TUIMenu menu(title);
+        menu.addOption("Pay " + std::to_string(tickets) + (tickets == 1 ? " ticket (" : " tickets (") +
+                       std::to_string(cappedCartTotal()) + " Geld)", []() {});
+        menu.addOption("Add another journey", [&addAnother]() { addAnother = true; });
+        if (fareLedger && !hasRiderCard()) {
+            menu.addOption("Use card for fare capping", [&enterCard]() { enterCard = true; });
+        }
+        menu.addCancelationOption();
+        menu.run();
+        if (!enterCard) {
+            return addAnother;
+        }
+        enterRiderCard();
+    }
+}
 
+/**
+ * @brief Asks for the rider's card id until a valid one is entered or the input is cancelled.
+ */
+void TicketMachine::enterRiderCard() {
     while (true) {
         try {
-            const int insertedAmount = processPayment(ticket);
-            const int changeAmount = Payment::calculateChange(ticket.price, insertedAmount);
-            ticket.change = payment.payOutChange(std::abs(changeAmount));
-            return ticket;
+            setRiderCard(TUIInputField::getInput("Card id (4-32 letters, digits or -): "));
+            return;
+        } catch (const InputCancelledException&) {
+            return;
+        } catch (const InputClosedException&) {
+            // No more keys will come; asking again would loop forever
+            throw;
         } catch (const std::runtime_error& e) {
-            std::string errorMsg = e.what();
-            if (errorMsg == "Purchase cancelled by user.") {
+            std::cerr << e.what() << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Sets the card whose spending counts towards the daily and weekly caps.
+ * The card applies to the rider's own ticket of every journey in the cart.
+ * @param cardId The card id as entered.
+ * @throws std::runtime_error If the machine has no fare ledger or the id is invalid.
+ */
+void TicketMachine::setRiderCard(const std::string& cardId) {
+    if (!fareLedger) {
+        throw std::runtime_error("Fare capping is not available");
+    }
+    if (!FareLedger::isValidCardId(cardId)) {
+        throw std::runtime_error("Invalid card id: use 4 to 32 letters, digits or dashes");
+    }
+    rider = fareLedger->riderId(cardId);
+    riderLabel = "Card ..." + cardId.substr(cardId.size() - 4);
+}
+
+/**
+ * @brief Pays all journeys in the cart at once and empties the cart.
+ *
+ * The customer pays the total once and receives the change in one payout,
+ * which needs fewer coins than paying every ticket on its own.
+ *
+ * @return One ticket per passenger, in cart order.
+ * @throws std::runtime_error If the cart is empty or the purchase is cancelled.
+ */
+std::vector<TicketData> TicketMachine::checkoutCart() {
+    if (cart.empty()) {
+        throw std::runtime_error("Cart is empty");
+    }
+    auto tickets = settle(cart);
+    cart.clear();
+    rider = 0;
+    riderLabel.clear();
+    return tickets;
+}
+
+/**
+ * @brief Returns the total price of all journeys in the cart.
+ */
+int TicketMachine::cartTotal() const {
+    int total = 0;
+    for (const auto& item : cart) {
+        total += item.unitPrice * item.passengers;
+    }
+    return total;
+}
+
+/**
+ * @brief Returns the total price of the cart after the rider's fare cap.
+ * Equals cartTotal() without a rider card.
+ */
+int TicketMachine::cappedCartTotal() const {
+    if (!hasRiderCard()) {
+        return cartTotal();
+    }
+    int remaining = fareLedger->allowance(rider, TicketCode::dayFromDate(getCurrentDate()));
+    int total = 0;
+    for (const auto& item : cart) {
+        const int charged = std::min(item.unitPrice, remaining);
+        remaining -= charged;
+        total += charged + item.unitPrice * (item.passengers - 1);
+    }
+    return total;
+}
+
+/**
+ * @brief Captures the selected line and stops as a cart entry.
+ * @param passengers Number of passengers for the journey.
+ * @return The journey with its price per passenger.
+ * @throws std::runtime_error If no tram is selected or start equals destination.
+ */
+CartItem TicketMachine::currentJourney(int passengers) const {
+    if (!currentTram || currentTram->stops.empty()) {
+        throw std::runtime_error("No tram selected! Please select a tram first.");
+    }
+    if (selectedStartIndex == selectedDestinationIndex) {
+        throw std::runtime_error("Invalid stop selection! Please select different stops.");
+    }
+
+    CartItem item;
+    item.tram = currentTram->name;
+    item.startStop = stopAtIndex(selectedStartIndex);
+    item.destinationStop = stopAtIndex(selectedDestinationIndex);
+    item.startIndex = selectedStartIndex;
+    item.destinationIndex = selectedDestinationIndex;
+    item.unitPrice = calculatePrice();
+    item.passengers = passengers;
+    item.departure = departuresText(currentTimetable.get(), selectedStartIndex,
+                                    Timetable::directionOf(selectedStartIndex, selectedDestinationIndex), 1);
+    return item;
+}
+
+/**
+ * @brief Makes a line of the snapshot the current line, with its timetable.
+ * The line data is shared with the snapshot instead of copied, so choosing a line costs
+ * the same for 5 stops as for 5000. Start and destination are reset; callers that
+ * preselect a journey set them afterwards.
+ * @param line The line from the current snapshot.
+ */
+void TicketMachine::useLine(const CatalogLine& line) {
+    // Aliasing pointer: keeps the snapshot alive and points at the line inside it
+    currentTram = std::shared_ptr<const TramData>(snapshot, &line.data);
+    currentTimetable = line.timetable;
+    selectedStartIndex = 0;
+    selectedDestinationIndex = 0;
+}
+
+/**
+ * @brief Formats the next departures at a stop, e.g. "14:05, 14:15".
+ * @param timetable Timetable of the line, or nullptr.
+ * @param stop Index of the stop on the line.
+ * @param direction Direction of travel.
+ * @param count Maximum number of departures.
+ * @return The departure times, or an empty string without timetable or departures.
+ */
+std::string TicketMachine::departuresText(const Timetable* timetable, size_t stop, Direction direction,
+                                          size_t count) const {
+    if (timetable == nullptr || count == 0) {
+        return "";
+    }
+    int departures[NEXT_DEPARTURES];
+    const size_t found =
+        timetable->nextDepartures(stop, direction, currentMinuteOfDay(), departures, std::min(count, NEXT_DEPARTURES));
+    std::string text;
+    for (size_t i = 0; i < found; ++i) {
+        text += (i == 0 ? "" : ", ") + Timetable::formatTime(departures[i]);
+    }
+    return text;
+}
+
+/**
+ * @brief Returns the local time in minutes after midnight.
+ */
+int TicketMachine::currentMinuteOfDay() {
+    const std::time_t now = std::time(nullptr);
+    std::tm localTime{};
+    localtime_r(&now, &localTime);
+    return localTime.tm_hour * 60 + localTime.tm_min;
+}
+
+/**
+ * @brief Takes one payment for the given journeys and issues the tickets.
+ *
+ * The change for the whole purchase goes through a single payOutChange() and is
+ * recorded on the first ticket, so journal totals stay correct.
+ *
+ * @param items Journeys to pay.
+ * @return One signed ticket per passenger.
+ * @throws std::runtime_error If the purchase is cancelled by the user, or if a journey
+ *         cannot be signed or no serials can be reserved; this happens before any money is taken.
+ */
+std::vector<TicketData> TicketMachine::settle(const std::vector<CartItem>& items) {
+    if (signer) {
+        for (const auto& item : items) {
+            codeField(static_cast<long long>(item.startIndex), "start stop");
+            codeField(static_cast<long long>(item.destinationIndex), "destination stop");
+            codeField(item.unitPrice, "price");
+        }
+    }
+    const std::string date = getCurrentDate();
+    const std::int64_t timestamp = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+    std::vector<TicketData> tickets;
+    int total = 0;
+    for (const auto& item : items) {
+        for (int passenger = 0; passenger < item.passengers; ++passenger) {
+            TicketData ticket;
+            ticket.tram = item.tram;
+            ticket.startStop = item.startStop;
+            ticket.destinationStop = item.destinationStop;
+            ticket.date = date;
+            ticket.timestamp = timestamp;
+            ticket.price = item.unitPrice;
+            ticket.departure = item.departure;
+            tickets.push_back(std::move(ticket));
+        }
+        total += item.unitPrice * item.passengers;
+    }
+    std::string summary = describePurchase(items, date);
+    const std::uint16_t day = TicketCode::dayFromDate(date);
+    const int fullTotal = total;
+    const int riderCharged = applyFareCap(tickets, items, day);
+    total = 0;
+    for (const auto& ticket : tickets) {
+        total += ticket.price;
+    }
+    if (total < fullTotal) {
+        summary += "Fare cap (" + riderLabel + "): -" + std::to_string(fullTotal - total) + " Geld\n";
+    }
+
+    // Everything signing needs from disk is done before money is taken
+    const std::uint32_t firstSerial =
+        signer ? signer->reserveSerials(static_cast<std::uint32_t>(tickets.size())) : 0;
+
+    // Rides beyond the cap cost nothing and need no payment
+    try {
+        while (total > 0) {
+            try {
+                const int insertedAmount = processPayment(summary, total);
+                const int changeAmount = Payment::calculateChange(total, insertedAmount);
+                tickets.front().change = payment->payOutChange(std::abs(changeAmount));
+                Logger::info("Verkauf: %zu Ticket(s), %d Geld, %d Geld Wechselgeld",
+                             tickets.size(), total, std::abs(changeAmount));
+                break;
+            } catch (const InputClosedException&) {
+                throw;
+            } catch (const std::runtime_error& e) {
+                std::string errorMsg = e.what();
+                if (errorMsg == "Purchase cancelled by user.") {
+                    throw;
+                }
+                if (errorMsg == "Change not available") {
+                    const int returned = calculateChangeSum(payment->returnInserted());
+                    std::cerr << "Wechselgeld nicht verfügbar! " << returned
+                              << " Geld werden zurückgegeben. Bitte passend zahlen.\n";
+                    std::cout << "Drücken Sie eine Taste um fortzufahren...";
+                    TUIMenu::waitForKey();
+                    continue;
+                }
                 throw;
             }
-            if (errorMsg == "Change not available") {
-                std::cerr << "Wechselgeld nicht verfügbar! Bitte passend zahlen oder kleineren Betrag wählen.\n";
-                std::cout << "Drücken Sie eine Taste um fortzufahren...";
-                TUIMenu::waitForKey();
-                continue;
+        }
+    } catch (...) {
+        // Not paid: the serials go back so the journal has no gap
+        if (signer) {
+            try {
+                signer->releaseSerials(firstSerial, static_cast<std::uint32_t>(tickets.size()));
+            } catch (const std::runtime_error& e) {
+                Logger::warning("Seriennummern nicht freigegeben: %s", e.what());
             }
-            throw;
         }
+        throw;
+    }
+    recordFare(riderCharged, day);
+
+    size_t next = 0;
+    for (const auto& item : items) {
+        for (int passenger = 0; passenger < item.passengers; ++passenger, ++next) {
+            TicketData& ticket = tickets[next];
+            ticket.batchIndex = static_cast<int>(next) + 1;
+            ticket.batchSize = static_cast<int>(tickets.size());
+            signTicket(ticket, item, firstSerial + static_cast<std::uint32_t>(next));
+            recordQuickPick(ticket);
+            Logger::info("Ticket: Serial %u, %s, %s -> %s, %d Geld", ticket.serial, ticket.tram.c_str(),
+                         ticket.startStop.c_str(), ticket.destinationStop.c_str(), ticket.price);
+        }
+    }
+    return tickets;
+}
+
+/**
+ * @brief Caps the rider's own tickets at what the rider may still be charged today and this week.
+ * The rider travels once per journey, so only the first ticket of every cart item is capped;
+ * fellow passengers pay the full price.
+ * @param tickets Tickets in cart order; price and capDiscount of capped tickets are updated.
+ * @param items Journeys the tickets belong to.
+ * @param day Day of the purchase (days since 1970-01-01).
+ * @return The amount charged for the rider's tickets, to be recorded after payment.
+ */
+int TicketMachine::applyFareCap(std::vector<TicketData>& tickets, const std::vector<CartItem>& items,
+                                std::uint16_t day) const {
+    if (!fareLedger || rider == 0) {
+        return 0;
+    }
+    int remaining = fareLedger->allowance(rider, day);
+    int charged = 0;
+    size_t first = 0;
+    for (const auto& item : items) {
+        TicketData& ticket = tickets[first];
+        const int price = std::min(ticket.price, remaining);
+        ticket.capDiscount = ticket.price - price;
+        ticket.price = price;
+        remaining -= price;
+        charged += price;
+        first += static_cast<size_t>(item.passengers);
+    }
+    return charged;
+}
+
+/**
+ * @brief Adds the rider's paid amount to the fare ledger.
+ * The tickets are already paid at this point, so a failed update only logs a warning.
+ * @param charged Amount charged for the rider's tickets.
+ * @param day Day of the purchase.
+ */
+void TicketMachine::recordFare(int charged, std::uint16_t day) const {
+    if (!fareLedger || rider == 0) {
+        return;
+    }
+    try {
+        fareLedger->record(rider, charged, day);
+    } catch (const std::exception& e) {
+        Logger::warning("Fahrpreisdeckel nicht gespeichert: %s", e.what());
+    }
+}
+
+/**
+ * @brief Builds the purchase overview shown during payment.
+ * A single ticket is shown with line, stops and date; several journeys as a list.
+ * @param items Journeys to pay.
+ * @param date Date of the purchase.
+ * @return The overview text.
+ */
+std::string TicketMachine::describePurchase(const std::vector<CartItem>& items, const std::string& date) {
+    std::ostringstream out;
+    if (items.size() == 1 && items.front().passengers == 1) {
+        out << "Tram: " << items.front().tram << "\n";
+        out << "From: " << items.front().startStop << "\n";
+        out << "To:   " << items.front().destinationStop << "\n";
+    } else {
+        for (const auto& item : items) {
+            out << item.passengers << " x " << item.tram << ", " << item.startStop << " -> "
+                << item.destinationStop << " (" << item.unitPrice << " Geld each)\n";
+        }
+    }
+    out << "Date: " << date << "\n";
+    return out.str();
+}
+
+/**
+ * @brief Assigns a reserved serial number and the signed inspection code to a paid ticket.
+ * Only computes the code in memory; the serial was reserved before payment.
+ * Does nothing if the machine has no signer.
+ * @param ticket The paid ticket.
+ * @param item The journey the ticket belongs to.
+ * @param serial Serial number from TicketSigner::reserveSerials().
+ * @throws std::runtime_error If a stop index or the price does not fit into the code.
+ */
+void TicketMachine::signTicket(TicketData& ticket, const CartItem& item, std::uint32_t serial) const {
+    if (!signer) {
+        return;
     }
+    TicketPayload payload;
+    payload.lineId = TicketCode::lineId(item.tram);
+    payload.startIndex = codeField(static_cast<long long>(item.startIndex), "start stop");
+    payload.destinationIndex = codeField(static_cast<long long>(item.destinationIndex), "destination stop");
+    payload.price = codeField(ticket.price, "price");
+    payload.day = TicketCode::dayFromDate(ticket.date);
+    payload.serial = serial;
+    ticket.code = signer->signReserved(payload);
+    ticket.serial = serial;
+}
 
-    return ticket;
+/**
+ * @brief Counts the sold journey in the quick pick table and saves the table.
+ * The ticket is already paid at this point, so a failed save only prints a warning.
+ * @param ticket The paid ticket.
+ */
+void TicketMachine::recordQuickPick(const TicketData& ticket) const {
+    if (!quickPicks) {
+        return;
+    }
+    quickPicks->record(ticket.tram, ticket.startStop, ticket.destinationStop, static_cast<std::time_t>(ticket.timestamp));
+    try {
+        quickPicks->save();
+    } catch (const std::exception& e) {
+        Logger::warning("Schnellwahl nicht gespeichert: %s", e.what());
+    }
 }
 
 /**
  * @brief Handles the payment interaction loop.
- * @param ticket The ticket data containing price and journey details.
+ * Takes one coin or note per input into the payment unit's escrow until the price is covered.
+ * @param summary Overview of the journeys being paid.
+ * @param price Total price to pay.
  * @return The total valid amount inserted by the user.
+ * @throws std::runtime_error If the user cancels; the inserted pieces are returned first.
  */
-int TicketMachine::processPayment(const TicketData& ticket) {
-    while (true) {
+int TicketMachine::processPayment(const std::string& summary, int price) {
+    std::string accepted;
+    for (const int value : payment->acceptedDenominations()) {
+        accepted += (accepted.empty() ? "" : ", ") + std::to_string(value);
+    }
+    while (payment->insertedAmount() < price) {
         std::cout << "\n--- Payment ---\n";
-        std::cout << "Tram: " << ticket.tram << "\n";
-        std::cout << "From: " << ticket.startStop << "\n";
-        std::cout << "To:   " << ticket.destinationStop << "\n";
-        std::cout << "Date: " << ticket.date << "\n";
+        std::cout << summary;
         std::cout << "----------------\n";
         std::cout << "[ESC] Cancel payment\n";
-        
-        std::string prompt = "Price: " + std::to_string(ticket.price) + " Geld\nAmount paid in: ";
+
+        std::string prompt = "Price: " + std::to_string(price) + " Geld\nInserted: " +
+                             std::to_string(payment->insertedAmount()) + " Geld\nInsert coin or note (" +
+                             accepted + "): ";
         try {
-            int inserted = std::stoi(TUIInputField::getInput(prompt));
-            if (inserted < 0) {
-                std::cerr << "Amount cannot be negative. Please try again.\n\n";
-                continue;
+            const int inserted = std::stoi(TUIInputField::getInput(prompt));
+            if (!payment->insert(inserted)) {
+                std::cerr << "Not accepted: " << inserted << " Geld. Please insert " << accepted << ".\n\n";
             }
-            if (inserted < ticket.price) {
-                std::cerr << "Insufficient funds! Needed: " << ticket.price << "\n\n";
-                continue;
-            }
-            return inserted;
         } catch (const InputCancelledException&) {
+            const int returned = calculateChangeSum(payment->returnInserted());
+            if (returned > 0) {
+                std::cout << returned << " Geld returned.\n";
+            }
             throw std::runtime_error("Purchase cancelled by user.");
+        } catch (const InputClosedException&) {
+            // No more keys will come; the inserted pieces go back before the sale is given up
+            payment->returnInserted();
+            throw;
         } catch (const std::exception&) {
             std::cerr << "Invalid input! Please enter a valid number.\n\n";
         }
     }
+    return payment->insertedAmount();
 }
 
 /**
@@ -199,7 +769,7 @@ std::vector<std::string> TicketMachine::getFileNames(const std::string& folderPa
         }
     } catch (const std::filesystem::filesystem_error& e) {
         // Handle filesystem errors (e.g., permission issues)
-        std::cerr << "Error while trying to access the folder path: " << e.what() << std::endl;
+        Logger::error("Error while trying to access the folder path: %s", e.what());
     }
 
     return tramNames;
@@ -211,10 +781,22 @@ std::vector<std::string> TicketMachine::getFileNames(const std::string& folderPa
  * @return Ticket price as integer.
  */
 int TicketMachine::calculatePrice() const {
+    return quotePrice(*currentTram, selectedStartIndex, selectedDestinationIndex);
+}
+
+/**
+ * @brief Calculates the price of a journey on the given tram line.
+ * Uses absolute difference between indices multiplied by price per stop.
+ * @param tram The tram line.
+ * @param startIndex Index of the start stop.
+ * @param destinationIndex Index of the destination stop.
+ * @return Ticket price as integer.
+ */
+int TicketMachine::quotePrice(const TramData& tram, size_t startIndex, size_t destinationIndex) {
     // Calculate the distance (number of stops) between start and destination
-    int routeLength = std::abs(static_cast<int>(selectedStartIndex) - static_cast<int>(selectedDestinationIndex));
+    int routeLength = std::abs(static_cast<int>(startIndex) - static_cast<int>(destinationIndex));
     // Multiply by the price per stop
-    return routeLength * currentTram.pricePerStop;
+    return routeLength * tram.pricePerStop;
 }
 
 /**
@@ -224,11 +806,11 @@ int TicketMachine::calculatePrice() const {
  */
 std::string TicketMachine::stopAtIndex(size_t index) const {
     // Validate that a tram is selected
-    if (currentTram.stops.empty()) return "No tram selected";
+    if (!currentTram || currentTram->stops.empty()) return "No tram selected";
     // Validate index bounds
-    if (index >= currentTram.stops.size()) return "Invalid stop";
+    if (index >= currentTram->stops.size()) return "Invalid stop";
 
-    return currentTram.stops.at(index);
+    return currentTram->stops.at(index);
 }
 
 /**
@@ -236,18 +818,59 @@ std::string TicketMachine::stopAtIndex(size_t index) const {
  * @param ticket The ticket data object to print.
  */
 void TicketMachine::printTicket(const TicketData& ticket) {
-    std::cout << "\n=== TICKET ===\n";
-    std::cout << "Line:          " << ticket.tram << '\n';
-    std::cout << "Start:         " << ticket.startStop << '\n';
-    std::cout << "Destination:   " << ticket.destinationStop << '\n';
-    std::cout << "Price:         " << ticket.price << " Geld\n";
-    // Print breakdown of change dispensed
-    std::cout << "Change:        " << calculateChangeSum(ticket.change) << " Geld\n";
-    for (const auto& [value, count] : ticket.change) {
-        std::cout << "  " << count << " x " << value << " Geld" << '\n';
-    }
-
-    std::cout << "==============\n";
+    std::cout << renderTicket(ticket);
+}
+
+/**
+ * @brief Renders the ticket as printer text, e.g. for the print spooler.
+ * @param ticket The ticket data object to render.
+ * @return The ticket text including a trailing newline.
+ */
+std::string TicketMachine::renderTicket(const TicketData& ticket) {
+    std::ostringstream out;
+    out << (ticket.reprint ? "\n=== TICKET (REPRINT) ===\n" : "\n=== TICKET ===\n");
+    out << "Line:          " << ticket.tram << '\n';
+    out << "Start:         " << ticket.startStop << '\n';
+    out << "Destination:   " << ticket.destinationStop << '\n';
+    out << "Date:          " << ticket.date << '\n';
+    if (!ticket.departure.empty()) {
+        out << "Departure:     " << ticket.departure << '\n';
+    }
+    out << "Price:         " << ticket.price << " Geld\n";
+    if (ticket.capDiscount > 0) {
+        out << "Fare cap:      -" << ticket.capDiscount << " Geld\n";
+    }
+    if (ticket.batchSize > 1) {
+        out << "Ticket:        " << ticket.batchIndex << " of " << ticket.batchSize << '\n';
+    }
+    // Print breakdown of change dispensed; in a batch only the first ticket carries it
+    if (ticket.batchIndex == 1) {
+        out << "Change:        " << calculateChangeSum(ticket.change) << " Geld\n";
+        for (const auto& [value, count] : ticket.change) {
+            out << "  " << count << " x " << value << " Geld" << '\n';
+        }
+    }
+    if (!ticket.code.empty()) {
+        out << "Serial:        " << ticket.serial << '\n';
+        out << "Code:          " << ticket.code << '\n';
+    }
+
+    out << "==============\n";
+    return out.str();
+}
+
+/**
+ * @brief Renders several tickets as one printer document.
+ * Tickets paid together are printed as one batch.
+ * @param tickets The tickets to render.
+ * @return The concatenated ticket texts.
+ */
+std::string TicketMachine::renderTickets(const std::vector<TicketData>& tickets) {
+    std::string document;
+    for (const auto& ticket : tickets) {
+        document += renderTicket(ticket);
+    }
+    return document;
 }
 
 /**
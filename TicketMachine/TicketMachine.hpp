@@ -2,7 +2,17 @@
 #include <string>
 #include "../TramParser/TramParser.hpp"
 #include "../Payment/Payment.hpp"
+#include "../Catalog/LineCatalog.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include "../QuickPick/QuickPickTable.hpp"
+#include "../Capping/FareLedger.hpp"
+#include <cstdint>
+#include <ctime>
 #include <map>
+#include <memory>
+#include <utility>
+
+class TUIMenu;
 
 struct TicketData {
     std::string tram;
@@ -11,32 +21,116 @@ struct TicketData {
     int price;
     std::map<int, int> change;
     std::string date;
+    // Time of sale in seconds since the Unix epoch
+    std::int64_t timestamp = 0;
+    // Serial number and signed code for inspection; empty code if the ticket is unsigned
+    std::uint32_t serial = 0;
+    std::string code;
+    // Position within a purchase paid together; the change is on the first ticket
+    int batchIndex = 1;
+    int batchSize = 1;
+    // Amount the fare cap took off the full price; price is what was charged
+    int capDiscount = 0;
+    // Next departure from the start stop at the time of sale (HH:MM); empty without timetable
+    std::string departure;
+    // Printed again from the sales journal (reprint_ticket), marked as such on the ticket
+    bool reprint = false;
+};
+
+// One journey in the cart; every passenger gets an own ticket
+struct CartItem {
+    std::string tram;
+    std::string startStop;
+    std::string destinationStop;
+    size_t startIndex = 0;
+    size_t destinationIndex = 0;
+    int unitPrice = 0;
+    int passengers = 1;
+    // Next departure from the start stop when the journey was chosen (HH:MM); may be empty
+    std::string departure;
 };
 
 class TicketMachine {
 public:
     TicketMachine()
-        : selectedStartIndex(0), selectedDestinationIndex(0) {
-        currentTram.pricePerStop = 0;
-        payment = Payment();
-    }
+        : TicketMachine(std::make_shared<LineCatalog>("data")) {}
+
+    explicit TicketMachine(std::shared_ptr<LineCatalog> catalog,
+                           std::shared_ptr<TicketSigner> signer = std::make_shared<TicketSigner>("state"),
+                           std::shared_ptr<QuickPickTable> quickPicks = nullptr,
+                           std::shared_ptr<FareLedger> fareLedger = nullptr,
+                           std::shared_ptr<Payment> payment = nullptr)
+        : catalog(std::move(catalog)), signer(std::move(signer)), quickPicks(std::move(quickPicks)),
+          fareLedger(std::move(fareLedger)),
+          payment(payment ? std::move(payment) : std::make_shared<Payment>()),
+          selectedStartIndex(0), selectedDestinationIndex(0), journeyPreselected(false) {}
 
     void selectTram();
+    // Stop-first flow: start stop, then a destination on any line through it
+    void selectJourneyByStop();
     void selectStartStop();
     void selectDestinationStop();
     TicketData buyTicket();
+    int selectPassengerCount();
+    void addToCart(int passengers = 1);
+    // Asks whether to pay now or add another journey; returns true for another journey
+    bool offerMoreTickets();
+    std::vector<TicketData> checkoutCart();
+    [[nodiscard]] const std::vector<CartItem>& getCart() const { return cart; }
+    [[nodiscard]] int cartTotal() const;
+    // Card of the rider whose spending counts towards the fare caps; kept until checkout
+    void setRiderCard(const std::string& cardId);
+    [[nodiscard]] bool hasRiderCard() const { return rider != 0; }
+    [[nodiscard]] int cappedCartTotal() const;
+    // True if a quick pick already chose start and destination in selectTram()
+    [[nodiscard]] bool hasSelectedJourney() const { return journeyPreselected; }
     static void printTicket(const TicketData& ticket);
+    static std::string renderTicket(const TicketData& ticket);
+    static std::string renderTickets(const std::vector<TicketData>& tickets);
+    static int quotePrice(const TramData& tram, size_t startIndex, size_t destinationIndex);
 
 private:
-    TramData currentTram;
-    Payment payment;
+    std::shared_ptr<LineCatalog> catalog;
+    std::shared_ptr<TicketSigner> signer;
+    std::shared_ptr<QuickPickTable> quickPicks;
+    std::shared_ptr<FareLedger> fareLedger;
+    // Rider key in the fare ledger (0 = no card) and the masked card id shown to the rider
+    std::uint64_t rider = 0;
+    std::string riderLabel;
+    // Snapshot the current purchase works on; later data updates do not affect it
+    std::shared_ptr<const CatalogSnapshot> snapshot;
+    // Current line inside snapshot; nullptr until a line is chosen
+    std::shared_ptr<const TramData> currentTram;
+    // Timetable of the current line; nullptr if the line has none
+    std::shared_ptr<const Timetable> currentTimetable;
+    // Coin and note unit of the kiosk; shared by all customers so recycled coins stay in the change box
+    std::shared_ptr<Payment> payment;
     size_t selectedStartIndex;
     size_t selectedDestinationIndex;
+    bool journeyPreselected;
+    std::vector<CartItem> cart;
+
+    static constexpr size_t QUICK_PICK_COUNT = 3;
+    static constexpr int MAX_PASSENGERS = 10;
+    static constexpr size_t NEXT_DEPARTURES = 3;
 
     static std::vector<std::string> getFileNames(const std::string& folderPath);
     [[nodiscard]] int calculatePrice() const;
+    void useLine(const CatalogLine& line);
+    [[nodiscard]] std::string departuresText(const Timetable* timetable, size_t stop, Direction direction,
+                                             size_t count) const;
+    static int currentMinuteOfDay();
     [[nodiscard]] std::string stopAtIndex(size_t index) const;
     static std::string getCurrentDate();
-    static int processPayment(const TicketData& ticket);
+    [[nodiscard]] CartItem currentJourney(int passengers) const;
+    std::vector<TicketData> settle(const std::vector<CartItem>& items);
+    int applyFareCap(std::vector<TicketData>& tickets, const std::vector<CartItem>& items, std::uint16_t day) const;
+    void recordFare(int charged, std::uint16_t day) const;
+    void enterRiderCard();
+    static std::string describePurchase(const std::vector<CartItem>& items, const std::string& date);
+    int processPayment(const std::string& summary, int price);
+    void signTicket(TicketData& ticket, const CartItem& item, std::uint32_t serial) const;
+    void addQuickPicks(TUIMenu& menu);
+    void recordQuickPick(const TicketData& ticket) const;
     static int calculateChangeSum(const std::map<int, int>& change);
 };
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "Timetable.hpp"
+#include "../TramParser/TramParser.hpp"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+// Latest time a departure may have: 47:59, i.e. the early morning after the service day
+constexpr int MAX_MINUTE = 2 * Timetable::MINUTES_PER_DAY - 1;
+
+/**
+ * @brief Parses "HH:MM" with hours up to 47.
+ * @return Minutes after midnight, or -1 if the text is not a valid time.
+ */
+int parseTime(const std::string& text) {
+    const auto colon = text.find(':');
+    if (colon == std::string::npos || colon == 0 || colon > 2 || text.size() != colon + 3) {
+        return -1;
+    }
+    int hours = 0;
+    for (std::size_t i = 0; i < colon; ++i) {
+        if (text[i] < '0' || text[i] > '9') return -1;
+        hours = hours * 10 + (text[i] - '0');
+    }
+    if (text[colon + 1] < '0' || text[colon + 1] > '5' || text[colon + 2] < '0' || text[colon + 2] > '9') {
+        return -1;
+    }
+    const int minutes = hours * 60 + (text[colon + 1] - '0') * 10 + (text[colon + 2] - '0');
+    return minutes <= MAX_MINUTE ? minutes : -1;
+}
+
+void writeVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint32_t readVarint(const std::uint8_t*& in) {
+    std::uint32_t value = 0;
+    int shift = 0;
+    while (*in & 0x80) {
+        value |= static_cast<std::uint32_t>(*in++ & 0x7f) << shift;
+        shift += 7;
+    }
+    return value | static_cast<std::uint32_t>(*in++) << shift;
+}
+
+// Trips and running times of one direction while parsing
+struct DirectionPlan {
+    std::vector<int> runtimes;
+    std::vector<int> trips;
+    bool seen = false;
+};
+}
+
+class Timetable::Cursor {
+public:
+    /**
+     * @brief Positions the cursor on the first departure at or after a time.
+     * Bisects the block starts, then decodes at most one block.
+     */
+    Cursor(const Timetable& table, const Column& column, int from) : table(table), remaining(column.count) {
+        const std::size_t blockCount = (column.count + BLOCK - 1) / BLOCK;
+        const auto first = table.blockStarts.begin() + column.firstBlock;
+        const auto after = std::upper_bound(first, first + static_cast<std::ptrdiff_t>(blockCount), from);
+        const std::size_t skipped = after == first ? 0 : static_cast<std::size_t>(after - first) - 1;
+        block = column.firstBlock + skipped;
+        remaining -= std::min<std::size_t>(remaining, skipped * BLOCK);
+        enterBlock();
+        while (valid() && current < from) {
+            next();
+        }
+    }
+
+    [[nodiscard]] bool valid() const { return remaining > 0; }
+    [[nodiscard]] int value() const { return current; }
+
+    void next() {
+        if (--remaining == 0) {
+            return;
+        }
+        if (++position == BLOCK) {
+            block++;
+            enterBlock();
+        } else {
+            current += static_cast<int>(readVarint(data));
+        }
+    }
+
+private:
+    const Timetable& table;
+    std::size_t remaining;
+    std::size_t block = 0;
+    std::size_t position = 0;
+    const std::uint8_t* data = nullptr;
+    int current = 0;
+
+    void enterBlock() {
+        if (remaining == 0) {
+            return;
+        }
+        position = 0;
+        current = table.blockStarts[block];
+        data = table.deltas.data() + table.blockOffsets[block];
+    }
+};
+
+/**
+ * @brief Parses a timetable file belonging to a line file.
+ *
+ * Format, one entry per line; # starts a comment:
+ *   outbound | inbound        starts the section of a direction (inbound = reverse file order)
+ *   runtimes 0 2 4 ...        minutes from the first stop of the direction, one per stop
+ *   every 05:00 23:30 10      trips from the first stop, every 10 minutes from 05:00 to 23:30
+ *   at 00:20 05:07            single trips from the first stop
+ * Times may go up to 47:59 for trips after midnight; an end before the start of
+ * "every" runs past midnight.
+ *
+ * @param text Content of the file.
+ * @param stopCount Number of stops of the line.
+ * @param sourceName File name for error messages.
+ * @return The compressed timetable.
+ * @throws ParseError On syntax errors, with file and line.
+ */
+Timetable Timetable::parse(std::string_view text, std::size_t stopCount, const std::string& sourceName) {
+    std::array<DirectionPlan, 2> plans;
+    DirectionPlan* plan = nullptr;
+    std::istringstream input{std::string(text)};
+    std::string row;
+    std::size_t lineNumber = 0;
+
+    while (std::getline(input, row)) {
+        lineNumber++;
+        row = row.substr(0, row.find('#'));
+        std::istringstream words(row);
+        std::string keyword;
+        if (!(words >> keyword)) {
+            continue;
+        }
+        std::vector<std::string> arguments;
+        for (std::string word; words >> word;) {
+            arguments.push_back(word);
+        }
+        const auto fail = [&](const std::string& message) { throw ParseError(sourceName, lineNumber, message); };
+        const auto time = [&](const std::string& word) {
+            const int minutes = parseTime(word);
+            if (minutes < 0) fail("invalid time '" + word + "'");
+            return minutes;
+        };
+
+        if (keyword == "outbound" || keyword == "inbound") {
+            plan = &plans[keyword == "outbound" ? 0 : 1];
+            if (plan->seen) fail("direction '" + keyword + "' given twice");
+            plan->seen = true;
+            continue;
+        }
+        if (plan == nullptr) fail("expected 'outbound' or 'inbound' before '" + keyword + "'");
+
+        if (keyword == "runtimes") {
+            if (arguments.size() != stopCount) {
+                fail("expected " + std::to_string(stopCount) + " running times, got " +
+                     std::to_string(arguments.size()));
+            }
+            plan->runtimes.clear();
+            for (const auto& word : arguments) {
+                std::size_t used = 0;
+                int minutes = -1;
+                try {
+                    minutes = std::stoi(word, &used);
+                } catch (const std::exception&) {
+                }
+                if (used != word.size() || minutes < 0 || minutes > MINUTES_PER_DAY) {
+                    fail("invalid running time '" + word + "'");
+                }
+                if (!plan->runtimes.empty() && minutes < plan->runtimes.back()) {
+                    fail("running times must not decrease");
+                }
+                plan->runtimes.push_back(minutes);
+            }
+        } else if (keyword == "every") {
+            if (arguments.size() != 3) fail("expected 'every <first> <last> <minutes>'");
+            const int first = time(arguments[0]);
+            int last = time(arguments[1]);
+            const int interval = std::atoi(arguments[2].c_str());
+            if (interval <= 0) fail("invalid interval '" + arguments[2] + "'");
+            if (last < first) last += MINUTES_PER_DAY;
+            if (last > MAX_MINUTE) fail("last trip after 47:59");
+            for (int trip = first; trip <= last; trip += interval) {
+                plan->trips.push_back(trip);
+            }
+        } else if (keyword == "at") {
+            if (arguments.empty()) fail("expected at least one time after 'at'");
+            for (const auto& word : arguments) {
+                plan->trips.push_back(time(word));
+            }
+        } else {
+            fail("unknown keyword '" + keyword + "'");
+        }
+    }
+
+    for (std::size_t direction = 0; direction < plans.size(); ++direction) {
+        auto& current = plans[direction];
+        if (!current.trips.empty() && current.runtimes.empty()) {
+            throw ParseError(sourceName, lineNumber, std::string(direction == 0 ? "outbound" : "inbound") +
+                                                         " has trips but no running times");
+        }
+        std::sort(current.trips.begin(), current.trips.end());
+        current.trips.erase(std::unique(current.trips.begin(), current.trips.end()), current.trips.end());
+        if (!current.trips.empty() && current.trips.back() + current.runtimes.back() > MAX_MINUTE) {
+            throw ParseError(sourceName, lineNumber, "departure after 47:59");
+        }
+    }
+
+    Timetable table;
+    table.stops = stopCount;
+    std::vector<int> times;
+    for (std::size_t direction = 0; direction < plans.size(); ++direction) {
+        const auto& current = plans[direction];
+        for (std::size_t stop = 0; stop < stopCount; ++stop) {
+            // Running times are listed in travel order, columns in file order
+            const std::size_t travelled = direction == 0 ? stop : stopCount - 1 - stop;
+            times.clear();
+            for (const int trip : current.trips) {
+                times.push_back(trip + current.runtimes[travelled]);
+            }
+            table.addColumn(times);
+        }
+    }
+    return table;
+}
+
+/**
+ * @brief Reads and parses a timetable file.
+ * @param path Path of the .times file.
+ * @param stopCount Number of stops of the line.
+ * @throws std::runtime_error If the file cannot be read; ParseError on syntax errors.
+ */
+Timetable Timetable::load(const std::string& path, std::size_t stopCount) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    std::ostringstream content;
+    content << file.rdbuf();
+    return parse(content.str(), stopCount, path);
+}
+
+/**
+ * @brief Appends one sorted column as blocks of a start value and varint deltas.
+ */
+void Timetable::addColumn(const std::vector<int>& times) {
+    Column entry;
+    entry.firstBlock = static_cast<std::uint32_t>(blockStarts.size());
+    entry.count = static_cast<std::uint32_t>(times.size());
+    for (std::size_t i = 0; i < times.size(); ++i) {
+        if (i % BLOCK == 0) {
+            blockStarts.push_back(static_cast<std::uint16_t>(times[i]));
+            blockOffsets.push_back(static_cast<std::uint32_t>(deltas.size()));
+        } else {
+            writeVarint(deltas, static_cast<std::uint32_t>(times[i] - times[i - 1]));
+        }
+    }
+    columns.push_back(entry);
+}
+
+const Timetable::Column& Timetable::column(std::size_t stop, Direction direction) const {
+    if (stop >= stops) {
+        throw std::out_of_range("Stop index out of range");
+    }
+    return columns[static_cast<std::size_t>(direction) * stops + stop];
+}
+
+/**
+ * @brief Returns the direction of a journey between two stops of the line.
+ */
+Direction Timetable::directionOf(std::size_t startIndex, std::size_t destinationIndex) {
+    return destinationIndex >= startIndex ? Direction::Outbound : Direction::Inbound;
+}
+
+/**
+ * @brief Formats minutes as HH:MM on a 24-hour clock.
+ */
+std::string Timetable::formatTime(int minutes) {
+    minutes = (minutes % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+    const char text[] = {static_cast<char>('0' + minutes / 600), static_cast<char>('0' + minutes / 60 % 10), ':',
+                         static_cast<char>('0' + minutes % 60 / 10), static_cast<char>('0' + minutes % 10)};
+    return std::string(text, sizeof(text));
+}
+
+/**
+ * @brief Finds the next departures at a stop.
+ *
+ * Trips after midnight of yesterday's service day and the first trips of
+ * tomorrow are included, so the answer does not run dry around midnight.
+ * Each of the three days is one cursor positioned by binary search; the
+ * cursors are merged until enough departures are found.
+ *
+ * @param stop Index of the stop in the line file.
+ * @param direction Direction of travel.
+ * @param minuteOfDay Current time in minutes after midnight.
+ * @param out Receives the departures in minutes after today's midnight (may exceed 1440).
+ * @param count Maximum number of departures.
+ * @return Number of departures written.
+ */
+std::size_t Timetable::nextDepartures(std::size_t stop, Direction direction, int minuteOfDay, int* out,
+                                      std::size_t count) const {
+    const Column& entry = column(stop, direction);
+    if (count == 0 || entry.count == 0) {
+        return 0;
+    }
+    minuteOfDay = (minuteOfDay % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY;
+
+    // Service day relative to today: yesterday, today, tomorrow
+    std::array<Cursor, 3> days = {Cursor(*this, entry, minuteOfDay + MINUTES_PER_DAY),
+                                  Cursor(*this, entry, minuteOfDay), Cursor(*this, entry, 0)};
+    constexpr std::array<int, 3> shifts = {-MINUTES_PER_DAY, 0, MINUTES_PER_DAY};
+    std::size_t found = 0;
+    while (found < count) {
+        std::size_t earliest = days.size();
+        for (std::size_t day = 0; day < days.size(); ++day) {
+            if (days[day].valid() && (earliest == days.size() || days[day].value() + shifts[day] <
+                                                                     days[earliest].value() + shifts[earliest])) {
+                earliest = day;
+            }
+        }
+        if (earliest == days.size()) {
+            break;
+        }
+        out[found++] = days[earliest].value() + shifts[earliest];
+        days[earliest].next();
+    }
+    return found;
+}
+
+/**
+ * @brief Convenience overload returning the departures as a vector.
+ */
+std::vector<int> Timetable::nextDepartures(std::size_t stop, Direction direction, int minuteOfDay,
+                                           std::size_t count) const {
+    std::vector<int> result(count);
+    result.resize(nextDepartures(stop, direction, minuteOfDay, result.data(), count));
+    return result;
+}
+
+/**
+ * @brief Returns the number of departures per service day at a stop.
+ */
+std::size_t Timetable::departureCount(std::size_t stop, Direction direction) const {
+    return column(stop, direction).count;
+}
+
+/**
+ * @brief Returns the memory used by the departure data in bytes.
+ */
+std::size_t Timetable::compressedBytes() const {
+    return columns.size() * sizeof(Column) + blockStarts.size() * sizeof(std::uint16_t) +
+           blockOffsets.size() * sizeof(std::uint32_t) + deltas.size();
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Outbound runs in the order of the line file, inbound the other way round
+enum class Direction : std::uint8_t { Outbound = 0, Inbound = 1 };
+
+// Departure times of one line at every stop and in both directions.
+// Times are minutes after midnight of the service day; trips after midnight go beyond 1440.
+// Every (direction, stop) column is a sorted list, stored in blocks of BLOCK values:
+// the first value of each block is kept as is for binary search, the rest as varint deltas.
+class Timetable {
+public:
+    static constexpr int MINUTES_PER_DAY = 1440;
+    static constexpr std::size_t BLOCK = 16;
+
+    static Timetable parse(std::string_view text, std::size_t stopCount, const std::string& sourceName);
+    static Timetable load(const std::string& path, std::size_t stopCount);
+    static Direction directionOf(std::size_t startIndex, std::size_t destinationIndex);
+    static std::string formatTime(int minutes);
+
+    [[nodiscard]] std::size_t nextDepartures(std::size_t stop, Direction direction, int minuteOfDay, int* out,
+                                             std::size_t count) const;
+    [[nodiscard]] std::vector<int> nextDepartures(std::size_t stop, Direction direction, int minuteOfDay,
+                                                  std::size_t count) const;
+    [[nodiscard]] std::size_t departureCount(std::size_t stop, Direction direction) const;
+    [[nodiscard]] std::size_t stopCount() const { return stops; }
+    [[nodiscard]] std::size_t compressedBytes() const;
+
+private:
+    struct Column {
+        std::uint32_t firstBlock = 0;
+        std::uint32_t count = 0;
+    };
+    // Reads one column value by value, starting at the first departure at or after a time
+    class Cursor;
+
+    std::size_t stops = 0;
+    // Index direction * stops + stop
+    std::vector<Column> columns;
+    std::vector<std::uint16_t> blockStarts;
+    // Start of the deltas of each block in deltas; the block ends where the next one starts
+    std::vector<std::uint32_t> blockOffsets;
+    std::vector<std::uint8_t> deltas;
+
+    void addColumn(const std::vector<int>& times);
+    [[nodiscard]] const Column& column(std::size_t stop, Direction direction) const;
+};
@@ -0,0 +1,64 @@
+#include "../Capping/FareLedger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures the fare cap per sale: allowance lookup plus recording the charge.
+ * The ledger is first filled with the given number of riders over one week,
+ * then random riders (known and new) buy tickets on the last day.
+ */
+int main(int argc, char* argv[]) {
+    const std::size_t riders = argc > 1 ? std::stoul(argv[1]) : 2000000;
+    const std::size_t sales = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    const std::string folder = "bench_capping_data";
+    std::filesystem::remove_all(folder);
+    FareLedger ledger(folder + "/fares.ledger");
+    ledger.open();
+
+    const std::uint16_t monday = 20458; // 2026-01-05
+    std::mt19937_64 random(7);
+    std::vector<std::uint64_t> ids;
+    ids.reserve(riders);
+
+    const auto fillBegin = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < riders; ++i) {
+        ids.push_back(ledger.riderId("KARTE-" + std::to_string(i)));
+        ledger.record(ids.back(), 3 * static_cast<int>(1 + random() % 10),
+                      static_cast<std::uint16_t>(monday + random() % 6));
+    }
+    const double fillTime =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - fillBegin).count();
+
+    // Rider keys are computed when the card is entered, not per sale
+    std::vector<std::uint64_t> buyers(sales);
+    for (auto& buyer : buyers) {
+        buyer = random() % 10 == 0 ? ledger.riderId("NEU-" + std::to_string(random())) : ids[random() % ids.size()];
+    }
+
+    const std::uint16_t sunday = monday + 6;
+    long long charged = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto buyer : buyers) {
+        const int price = std::min(9, ledger.allowance(buyer, sunday));
+        ledger.record(buyer, price, sunday);
+        charged += price;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    const double fileSize = static_cast<double>(std::filesystem::file_size(folder + "/fares.ledger")) / (1 << 20);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Fahrgäste: " << ledger.size() << ", Plätze: " << ledger.capacity() << ", Datei: " << fileSize
+              << " MiB\n"
+              << "Befüllen: " << fillTime << " s\n"
+              << "Verkäufe: " << sales << " (" << charged << " Geld berechnet)\n"
+              << "Deckel pro Verkauf: " << seconds / static_cast<double>(sales) * 1e6 << " µs\n";
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "../TramParser/TramParser.hpp"
+#include "../TramParser/LineFileBuffer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * @brief Writes a line file of roughly the requested size with realistic UTF-8 stop names.
+ * @param path Target file.
+ * @param megabytes Approximate file size in MiB.
+ * @return Number of stops written.
+ */
+std::size_t writeBenchmarkFile(const std::string& path, std::size_t megabytes) {
+    static const char* names[] = {
+        "Stötteritz, Holzhäuser Str.", "Wilhelm‑Leuschner‑Platz", "Kolmstraße",
+        "Hauptbahnhof, Westseite", "Connewitz, Kreuz", "Lößnig, Südstraße", "Markkleeberg-Ost"
+    };
+
+    std::ofstream file(path, std::ios::binary);
+    file << "Benchmark-Linie\n7\n";
+    std::size_t written = 0;
+    std::size_t stops = 0;
+    const std::size_t target = megabytes << 20;
+    while (written < target) {
+        std::string stop = std::string(names[stops % 7]) + " " + std::to_string(stops) + "\n";
+        file << stop;
+        written += stop.size();
+        stops++;
+    }
+    return stops;
+}
+
+/**
+ * @brief Runs the given parse function several times and returns the best time.
+ * @param iterations Number of runs.
+ * @param parse Function parsing the file and returning the number of stops.
+ * @param stops Receives the number of stops of the last run.
+ * @return Best wall-clock time in seconds.
+ */
+double bestOf(int iterations, const std::function<std::size_t()>& parse, std::size_t& stops) {
+    double best = 1e300;
+    for (int i = 0; i < iterations; ++i) {
+        const auto begin = std::chrono::steady_clock::now();
+        stops = parse();
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    const std::size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 16;
+    const int iterations = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    const std::string folder = "bench_parser_data";
+    const std::string path = folder + "/BenchLine.txt";
+    std::filesystem::create_directories(folder);
+    const std::size_t expected = writeBenchmarkFile(path, megabytes);
+    const double size = static_cast<double>(std::filesystem::file_size(path)) / (1 << 20);
+
+    std::size_t streamStops = 0;
+    const double streamTime = bestOf(iterations, [&]() {
+        std::ifstream file(path);
+        return TramParser::parseTramStream(file).stops.size();
+    }, streamStops);
+
+    std::size_t bufferStops = 0;
+    const double bufferTime = bestOf(iterations, [&]() {
+        LineFileBuffer file(path);
+        return TramParser::parseTramBuffer(file.view(), path).stops.size();
+    }, bufferStops);
+
+    std::filesystem::remove_all(folder);
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Datei: " << size << " MiB, " << expected << " Haltestellen, bestes von " << iterations << " Läufen\n";
+    std::cout << "  Stream-Parser (getline):  " << std::setw(8) << streamTime * 1000 << " ms  "
+              << std::setw(8) << size / streamTime << " MiB/s\n";
+    std::cout << "  Block-Parser (SIMD):      " << std::setw(8) << bufferTime * 1000 << " ms  "
+              << std::setw(8) << size / bufferTime << " MiB/s  (inkl. UTF-8-Prüfung)\n";
+    std::cout << "  Faktor:                   " << streamTime / bufferTime << "x\n";
+
+    if (streamStops != expected || bufferStops != expected) {
+        std::cerr << "Fehler: Anzahl der Haltestellen weicht ab!" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include "../Benchmark/NetworkGenerator.hpp"
+#include "../TramParser/TramParser.hpp"
+#include "../TicketMachine/TicketMachine.hpp"
+#include "../TUI/TUIMenu/TUIMenu.hpp"
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Timings of one network size, sent from the measuring child process to the parent
+struct StageResult {
+    std::size_t lines;
+    double scanMs;
+    double parseMs;
+    double menuBuildMs;
+    double quoteMs;
+    double renderMs;
+    std::size_t renderBytes;
+    long peakRssKb;
+    bool ok;
+};
+
+// Stream buffer that only counts the bytes written to it
+class CountingBuffer : public std::streambuf {
+public:
+    std::size_t count = 0;
+
+protected:
+    int_type overflow(int_type c) override {
+        count++;
+        return c;
+    }
+    std::streamsize xsputn(const char*, std::streamsize n) override {
+        count += static_cast<std::size_t>(n);
+        return n;
+    }
+};
+
+/**
+ * @brief Runs a callable and returns its wall-clock time in milliseconds.
+ */
+template <typename F>
+double measureMs(F&& work) {
+    const auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @brief Returns the peak resident set size of this process in KiB.
+ */
+long peakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    return usage.ru_maxrss;        // KiB on Linux
+#endif
+}
+
+/**
+ * @brief Measures all stages for one generated network.
+ * @param folder Directory containing the generated line files.
+ * @param lines Number of lines in the network.
+ * @return The measured timings.
+ */
+StageResult measure(const std::string& folder, std::size_t lines) {
+    StageResult result{};
+    result.lines = lines;
+
+    // 1. Directory scan with display names
+    std::vector<FileEntry> entries;
+    result.scanMs = measureMs([&]() { entries = TramParser::getAvailableLines(folder); });
+
+    // 2. Parse every line file
+    std::vector<TramData> trams;
+    trams.reserve(entries.size());
+    result.parseMs = measureMs([&]() {
+        for (const auto& entry : entries) {
+            trams.push_back(TramParser::parseTramFile(folder, entry.fileName));
+        }
+    });
+
+    // 3. Build the tram menu and the stop menu of the first line, as TicketMachine does
+    TUIMenu tramMenu("Select a tram:");
+    TUIMenu stopMenu("Start:");
+    result.menuBuildMs = measureMs([&]() {
+        tramMenu.setItems(entries.size(), [&entries](std::size_t index) {
+            return std::string_view(entries[index].displayName);
+        });
+        tramMenu.addCancelationOption();
+        if (!trams.empty()) {
+            stopMenu.setItems(trams[0].stops);
+        }
+        stopMenu.addCancelationOption();
+    });
+
+    // 4. Quote the price of every start/destination pair of every line
+    long long checksum = 0;
+    result.quoteMs = measureMs([&]() {
+        for (const auto& tram : trams) {
+            for (std::size_t start = 0; start < tram.stops.size(); ++start) {
+                for (std::size_t destination = 0; destination < tram.stops.size(); ++destination) {
+                    checksum += TicketMachine::quotePrice(tram, start, destination);
+                }
+            }
+        }
+    });
+
+    // 5. Render both menus once, as a single key press would
+    CountingBuffer sink;
+    std::ostream out(&sink);
+    result.renderMs = measureMs([&]() {
+        tramMenu.render(out);
+        stopMenu.render(out);
+    });
+    result.renderBytes = sink.count;
+
+    result.peakRssKb = peakRssKb();
+    result.ok = trams.size() == lines && checksum >= 0;
+    return result;
+}
+
+/**
+ * @brief Generates and measures one network size in a child process.
+ *
+ * A separate process per size gives each size its own peak RSS and keeps the
+ * parser's console output out of the report.
+ *
+ * @param baseFolder Parent directory for generated networks.
+ * @param config Network shape; config.lines is the size to measure.
+ * @param keep Whether to keep the generated files.
+ * @return The measured result, with ok == false on failure.
+ */
+StageResult runIsolated(const std::string& baseFolder, const NetworkConfig& config, bool keep) {
+    int channel[2];
+    if (pipe(channel) != 0) {
+        return StageResult{};
+    }
+
+    const pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        const int devNull = open("/dev/null", O_WRONLY);
+        dup2(devNull, STDOUT_FILENO);
+        dup2(devNull, STDERR_FILENO);
+
+        StageResult result{};
+        const std::string folder = baseFolder + "/net" + std::to_string(config.lines);
+        try {
+            NetworkGenerator::generate(folder, config);
+            result = measure(folder, config.lines);
+        } catch (const std::exception&) {
+            result.ok = false;
+        }
+        if (!keep) {
+            std::filesystem::remove_all(folder);
+        }
+        (void) write(channel[1], &result, sizeof(result));
+        _exit(0);
+    }
+
+    close(channel[1]);
+    StageResult result{};
+    if (read(channel[0], &result, sizeof(result)) != static_cast<ssize_t>(sizeof(result))) {
+        result.ok = false;
+    }
+    close(channel[0]);
+    waitpid(child, nullptr, 0);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::size_t> sizes = {10, 1000, 10000, 100000};
+    NetworkConfig config;
+    bool keep = false;
+    double interactiveMs = 100.0;
+    // Rough output bandwidth of a kiosk terminal, used to estimate the time to display a frame
+    double terminalMiBps = 10.0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (option == "--sizes") {
+            sizes.clear();
+            std::stringstream stream(value);
+            std::string item;
+            while (std::getline(stream, item, ',')) {
+                sizes.push_back(std::stoul(item));
+            }
+            i++;
+        } else if (option == "--stops") {
+            config.stopsPerLine = std::stoul(value);
+            i++;
+        } else if (option == "--limit") {
+            interactiveMs = std::stod(value);
+            i++;
+        } else if (option == "--tty") {
+            terminalMiBps = std::stod(value);
+            i++;
+        } else if (option == "--keep") {
+            keep = true;
+        } else {
+            std::cout << "Aufruf: benchmark_scaling [--sizes 10,1000,10000,100000] [--stops 30] [--limit 100] [--tty 10] [--keep]\n";
+            return option == "--help" ? 0 : 1;
+        }
+    }
+
+    const std::string baseFolder = (std::filesystem::temp_directory_path() /
+                                    ("ticketautomat-scaling-" + std::to_string(getpid()))).string();
+
+    std::cout << "Haltestellen pro Linie: " << config.stopsPerLine << ", Grenze für interaktiv: "
+              << interactiveMs << " ms (Menü bauen + Zeichnen + Ausgabe bei "
+              << terminalMiBps << " MiB/s)\n\n";
+    std::cout << std::setw(8) << "Linien" << std::setw(11) << "Scan ms" << std::setw(11) << "Parse ms"
+              << std::setw(11) << "Menü ms" << std::setw(11) << "Preis ms" << std::setw(11) << "Render ms"
+              << std::setw(11) << "Render KiB" << std::setw(11) << "RSS MiB" << "  Interaktiv\n";
+
+    std::cout << std::fixed << std::setprecision(1);
+    for (const std::size_t size : sizes) {
+        config.lines = size;
+        const StageResult result = runIsolated(baseFolder, config, keep);
+        if (!result.ok) {
+            std::cout << std::setw(8) << size << "  Fehler bei der Messung\n";
+            continue;
+        }
+        const double outputMs = result.renderBytes / (terminalMiBps * 1024 * 1024) * 1000.0;
+        const bool interactive = result.menuBuildMs + result.renderMs + outputMs < interactiveMs;
+        std::cout << std::setw(8) << result.lines << std::setw(11) << result.scanMs << std::setw(11) << result.parseMs
+                  << std::setw(11) << result.menuBuildMs << std::setw(11) << result.quoteMs
+                  << std::setw(11) << result.renderMs << std::setw(11) << result.renderBytes / 1024.0
+                  << std::setw(11) << result.peakRssKb / 1024.0 << "  " << (interactive ? "ja" : "nein") << '\n'
+                  << std::flush;
+    }
+
+    if (!keep) {
+        std::filesystem::remove_all(baseFolder);
+    }
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "../Benchmark/NetworkGenerator.hpp"
+#include "../Catalog/LineCatalog.hpp"
+#include "../Timetable/Timetable.hpp"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Measures next-departure lookups on a generated network with full-day timetables.
+ * Every lookup asks for the next 3 departures at a random stop, direction and time,
+ * as a menu redraw does.
+ */
+int main(int argc, char* argv[]) {
+    NetworkConfig config;
+    config.lines = argc > 1 ? std::stoul(argv[1]) : 1000;
+    config.timetables = true;
+    const std::size_t lookups = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    const std::string folder = "bench_timetable_data";
+    std::filesystem::remove_all(folder);
+    NetworkGenerator::generate(folder, config);
+
+    const auto loadBegin = std::chrono::steady_clock::now();
+    LineCatalog catalog(folder);
+    const double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadBegin).count();
+    const auto snapshot = catalog.snapshot();
+    std::filesystem::remove_all(folder);
+
+    std::size_t departures = 0;
+    std::size_t compressed = 0;
+    std::vector<const Timetable*> tables;
+    for (const auto& line : snapshot->lines) {
+        if (!line.timetable) continue;
+        tables.push_back(line.timetable.get());
+        compressed += line.timetable->compressedBytes();
+        for (std::size_t stop = 0; stop < line.timetable->stopCount(); ++stop) {
+            departures += line.timetable->departureCount(stop, Direction::Outbound) +
+                          line.timetable->departureCount(stop, Direction::Inbound);
+        }
+    }
+    if (tables.empty()) {
+        std::cerr << "Fehler: keine Fahrpläne geladen" << std::endl;
+        return 1;
+    }
+
+    struct Query {
+        const Timetable* table;
+        std::size_t stop;
+        Direction direction;
+        int minute;
+    };
+    std::mt19937_64 random(3);
+    std::vector<Query> queries(lookups);
+    for (auto& query : queries) {
+        query.table = tables[random() % tables.size()];
+        query.stop = random() % query.table->stopCount();
+        query.direction = random() % 2 == 0 ? Direction::Outbound : Direction::Inbound;
+        query.minute = static_cast<int>(random() % Timetable::MINUTES_PER_DAY);
+    }
+
+    int next[3];
+    long long checksum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+    for (const auto& query : queries) {
+        const std::size_t found = query.table->nextDepartures(query.stop, query.direction, query.minute, next, 3);
+        checksum += found > 0 ? next[0] : 0;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "Linien: " << tables.size() << ", Abfahrten: " << departures << "\n"
+              << "Speicher: " << static_cast<double>(compressed) / (1 << 20) << " MiB ("
+              << static_cast<double>(compressed) / static_cast<double>(departures) << " Byte pro Abfahrt, unkomprimiert "
+              << sizeof(std::uint16_t) << ")\n"
+              << "Laden: " << loadTime << " s\n"
+              << "Nächste 3 Abfahrten: " << seconds / static_cast<double>(lookups) * 1e6 << " µs pro Abfrage"
+              << " (Prüfsumme " << checksum << ")\n";
+    return 0;
+}
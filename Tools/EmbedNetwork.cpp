@@ -0,0 +1,164 @@
+#include "../TramParser/TramParser.hpp"
+#include "../TramParser/LineFileBuffer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Build step: turns data/*.txt into constexpr tables for TramParser/EmbeddedNetwork.cpp.
+// Every file goes through the real parser, so malformed data stops the build.
+
+struct SourceLine {
+    std::string fileName;
+    TramData data;
+};
+
+void printUsage() {
+    std::cout << "Aufruf: embed_network <Datenordner> <Ausgabedatei>\n"
+              << "  Erzeugt EmbeddedNetworkData.hpp mit allen Linien des Ordners.\n";
+}
+
+std::vector<SourceLine> readLines(const std::string& folder) {
+    if (!std::filesystem::is_directory(folder)) {
+        throw std::runtime_error("Not a directory: " + folder);
+    }
+    std::vector<std::string> fileNames;
+    for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+        if (entry.path().extension() == ".txt") {
+            fileNames.push_back(entry.path().stem().string());
+        }
+    }
+    // Sorted, so the generated file only changes when the data does
+    std::sort(fileNames.begin(), fileNames.end());
+    if (fileNames.empty()) {
+        throw std::runtime_error("No line files in " + folder);
+    }
+
+    std::vector<SourceLine> lines;
+    for (const auto& fileName : fileNames) {
+        const std::string path = folder + "/" + fileName + ".txt";
+        LineFileBuffer file(path);
+        TramData data = TramParser::parseTramBuffer(file.view(), path);
+        // Stricter than at runtime: a line without two stops cannot sell a single ticket
+        if (data.stops.size() < 2) {
+            throw ParseError(path, 1, "line needs at least two stops");
+        }
+        lines.push_back({fileName, std::move(data)});
+    }
+    return lines;
+}
+
+// Appends a C++ string literal; every byte outside printable ASCII becomes an octal escape
+void appendLiteral(std::string& out, const std::string& value) {
+    out += '"';
+    for (const unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c >= 0x20 && c < 0x7F) {
+            out += static_cast<char>(c);
+        } else {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\%03o", c);
+            out += escape;
+        }
+    }
+    out += '"';
+}
+
+std::string generateHeader(const std::vector<SourceLine>& lines, const std::string& folder) {
+    std::string blob;
+    std::string blobSource;
+    std::ostringstream lineTable;
+    std::ostringstream stopTable;
+    std::size_t stopIndex = 0;
+
+    auto intern = [&](const std::string& value) {
+        const std::size_t offset = blob.size();
+        blob += value;
+        blobSource += "    ";
+        appendLiteral(blobSource, value);
+        blobSource += '\n';
+        return "{" + std::to_string(offset) + ", " + std::to_string(value.size()) + "}";
+    };
+
+    for (const auto& line : lines) {
+        const std::string fileName = intern(line.fileName);
+        const std::string name = intern(line.data.name);
+        lineTable << "    {" << fileName << ", " << name << ", " << line.data.pricePerStop << ", "
+                  << stopIndex << ", " << line.data.stops.size() << "},\n";
+        for (const auto& stop : line.data.stops) {
+            stopTable << "    " << intern(stop) << ",\n";
+        }
+        stopIndex += line.data.stops.size();
+    }
+
+    std::string out;
+    out += "// Generated by embed_network from " + folder + "/ - do not edit.\n";
+    out += "// Included by TramParser/EmbeddedNetwork.cpp only.\n";
+    out += "#pragma once\n\n";
+    out += "namespace EmbeddedNetworkData {\n";
+    out += "constexpr char BLOB[] =\n" + blobSource + "    ;\n\n";
+    out += "constexpr EmbeddedLine LINES[] = {\n" + lineTable.str() + "};\n";
+    out += "constexpr std::size_t LINE_COUNT = sizeof(LINES) / sizeof(LINES[0]);\n\n";
+    out += "constexpr EmbeddedText STOPS[] = {\n" + stopTable.str() + "};\n";
+    out += "constexpr std::size_t STOP_COUNT = sizeof(STOPS) / sizeof(STOPS[0]);\n\n";
+    out += "static_assert(sizeof(BLOB) == " + std::to_string(blob.size() + 1) + ", \"embedded text blob has the wrong size\");\n";
+    out += "static_assert(EmbeddedNetwork::isValid(sizeof(BLOB) - 1, LINES, LINE_COUNT, STOPS, STOP_COUNT),\n";
+    out += "              \"embedded network tables are inconsistent\");\n";
+    out += "}\n";
+    return out;
+}
+
+// Replaces the output only if its content changed, so unchanged data does not trigger a rebuild
+void writeIfChanged(const std::string& path, const std::string& content) {
+    {
+        std::ifstream existing(path, std::ios::binary);
+        if (existing.is_open()) {
+            std::ostringstream current;
+            current << existing.rdbuf();
+            if (current.str() == content) {
+                return;
+            }
+        }
+    }
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path());
+    }
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+        file << content;
+        if (!file) {
+            throw std::runtime_error("Could not write file: " + tmpPath);
+        }
+    }
+    std::filesystem::rename(tmpPath, path);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        printUsage();
+        return 1;
+    }
+    const std::string folder = argv[1];
+    const std::string output = argv[2];
+    try {
+        const auto lines = readLines(folder);
+        writeIfChanged(output, generateHeader(lines, folder));
+        std::size_t stops = 0;
+        for (const auto& line : lines) {
+            stops += line.data.stops.size();
+        }
+        std::cout << lines.size() << " Linien mit " << stops << " Haltestellen eingebettet: " << output << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include "../Benchmark/NetworkGenerator.hpp"
+#include <iostream>
+#include <string>
+
+void printUsage() {
+    std::cout << "Aufruf: generate_network <Zielordner> [Optionen]\n"
+              << "  --lines N       Anzahl Linien (Standard 10)\n"
+              << "  --stops M       Haltestellen pro Linie (Standard 30)\n"
+              << "  --transfer P    Anteil Umsteigehaltestellen (Standard 0.2)\n"
+              << "  --long P        Anteil langer Namen (Standard 0.1)\n"
+              << "  --seed S        Startwert (Standard 1)\n"
+              << "  --timetables    Fahrplan (.times) für jede Linie schreiben\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[1]) == "--help") {
+        printUsage();
+        return argc < 2 ? 1 : 0;
+    }
+
+    const std::string folder = argv[1];
+    NetworkConfig config;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--timetables") {
+                config.timetables = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            const std::string value = argv[++i];
+            if (option == "--lines") config.lines = std::stoul(value);
+            else if (option == "--stops") config.stopsPerLine = std::stoul(value);
+            else if (option == "--transfer") config.transferShare = std::stod(value);
+            else if (option == "--long") config.longNameShare = std::stod(value);
+            else if (option == "--seed") config.seed = std::stoull(value);
+            else throw std::invalid_argument("Unknown option " + option);
+        }
+
+        const std::size_t bytes = NetworkGenerator::generate(folder, config);
+        std::cout << config.lines << " Linien mit je " << config.stopsPerLine << " Haltestellen in "
+                  << folder << " geschrieben (" << bytes / 1024 << " KiB)." << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
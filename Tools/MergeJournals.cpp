@@ -0,0 +1,178 @@
+#include "../Sales/JournalMerger.hpp"
+#include "../Sales/SalesJournal.hpp"
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+void printUsage() {
+    std::cout << "Aufruf:\n"
+              << "  merge_journals <journal>... -o <datei> [--memory MiB] [--max-open N] [--show 20]\n"
+              << "  merge_journals generate <ordner> [--machines 300] [--days 30] [--per-day 400] [--faults]\n";
+}
+
+std::string formatDate(std::int64_t timestamp) {
+    const std::time_t time = static_cast<std::time_t>(timestamp);
+    std::tm parts{};
+    gmtime_r(&time, &parts);
+    char text[11];
+    std::strftime(text, sizeof(text), "%Y-%m-%d", &parts);
+    return text;
+}
+
+/**
+ * @brief Writes one journal per machine and day, as collected from a fleet.
+ * With faults, machine 1 loses a sale (gap), one journal is collected twice
+ * (duplicates) and machine 2 reuses a serial after a reset.
+ * @return Number of sales written.
+ */
+std::size_t generateFleet(const std::string& folder, std::size_t machines, std::size_t days, std::size_t perDay,
+                          bool faults) {
+    std::filesystem::create_directories(folder);
+    const std::int64_t firstDay = 1767225600; // 2026-01-01 00:00 UTC
+    const char* const lines[] = {"Linie 4", "Linie 11", "Linie 15"};
+    std::mt19937_64 random(42);
+    std::size_t written = 0;
+
+    for (std::size_t m = 1; m <= machines; ++m) {
+        const std::string machine = "automat-" + std::to_string(m);
+        std::uint32_t serial = 0;
+        for (std::size_t d = 0; d < days; ++d) {
+            const std::int64_t dayStart = firstDay + static_cast<std::int64_t>(d) * 86400;
+            const std::string path = folder + "/" + machine + "-" + formatDate(dayStart) + ".journal";
+            std::ofstream file(path, std::ios::binary);
+            file << SalesJournal::HEADER_PREFIX << machine << "\n";
+
+            // Operating hours 5:00 to 24:00, sales in ascending time
+            std::int64_t time = dayStart + 5 * 3600;
+            const std::int64_t step = 19 * 3600 / static_cast<std::int64_t>(perDay + 1);
+            for (std::size_t i = 0; i < perDay; ++i) {
+                time += 1 + static_cast<std::int64_t>(random() % static_cast<std::uint64_t>(2 * step));
+                TicketData ticket;
+                ticket.serial = ++serial;
+                if (faults && m == 1 && d == 0 && i == 10) {
+                    ticket.serial = ++serial; // Lost sale
+                }
+                if (faults && m == 2 && d == 1 && i == 0) {
+                    serial = 1; // Serial counter reset
+                    ticket.serial = serial;
+                }
+                ticket.timestamp = time;
+                ticket.date = formatDate(time);
+                ticket.tram = lines[random() % 3];
+                ticket.startStop = "Haltestelle " + std::to_string(random() % 30);
+                ticket.destinationStop = "Haltestelle " + std::to_string(random() % 30);
+                ticket.price = 3 * static_cast<int>(1 + random() % 10);
+                if (random() % 3 == 0) {
+                    ticket.change[1] = 1 + static_cast<int>(random() % 2);
+                }
+                file << SalesJournal::formatRecord(ticket) << "\n";
+                written++;
+            }
+        }
+    }
+    if (faults && machines > 0 && days > 0) {
+        const std::string original = folder + "/automat-1-" + formatDate(firstDay) + ".journal";
+        std::filesystem::copy_file(original, folder + "/automat-1-" + formatDate(firstDay) + "-kopie.journal",
+                                   std::filesystem::copy_options::overwrite_existing);
+    }
+    return written;
+}
+
+void printReport(const MergeReport& report, std::size_t show) {
+    std::cout << "Eingaben: " << report.inputs << " Datei(en), " << report.passes << " Durchlauf/Durchläufe\n"
+              << "Gelesen: " << report.recordsRead << ", geschrieben: " << report.recordsWritten
+              << ", doppelt: " << report.duplicates << ", widersprüchlich: " << report.conflicts
+              << ", Zeit rückwärts: " << report.outOfOrder << "\n";
+
+    std::cout << "Lücken: " << report.gapCount << " (" << report.missingSerials << " fehlende Seriennummern)\n";
+    for (std::size_t i = 0; i < report.gaps.size() && i < show; ++i) {
+        const auto& gap = report.gaps[i];
+        std::cout << "  " << gap.machine << ": " << gap.after + 1;
+        if (gap.next - gap.after > 2) {
+            std::cout << " bis " << gap.next - 1;
+        }
+        std::cout << " fehlt\n";
+    }
+    std::cout << "Doppelte Seriennummern: " << report.duplicateSerialCount << "\n";
+    for (std::size_t i = 0; i < report.duplicateSerials.size() && i < show; ++i) {
+        const auto& duplicate = report.duplicateSerials[i];
+        std::cout << "  " << duplicate.machine << ": " << duplicate.serial << " erneut am "
+                  << formatDate(duplicate.timestamp) << "\n";
+    }
+    if (report.conflicts > 0 || report.duplicateSerialCount > 0) {
+        std::cout << "Warnung: Seriennummern mehrfach vergeben, Automaten prüfen\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::vector<std::string> files;
+    std::string output;
+    MergeConfig config;
+    std::size_t show = 20;
+    std::size_t machines = 300;
+    std::size_t days = 30;
+    std::size_t perDay = 400;
+    bool faults = false;
+    const bool generate = std::string(argv[1]) == "generate";
+
+    try {
+        for (int i = generate ? 2 : 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            const std::string value = i + 1 < argc ? argv[i + 1] : "";
+            if (option == "-o") { output = value; i++; }
+            else if (option == "--memory") { config.memoryBudget = std::stoul(value) << 20; i++; }
+            else if (option == "--max-open") { config.maxOpenFiles = std::stoul(value); i++; }
+            else if (option == "--show") { show = std::stoul(value); i++; }
+            else if (option == "--machines") { machines = std::stoul(value); i++; }
+            else if (option == "--days") { days = std::stoul(value); i++; }
+            else if (option == "--per-day") { perDay = std::stoul(value); i++; }
+            else if (option == "--faults") { faults = true; }
+            else if (option[0] == '-') { printUsage(); return 1; }
+            else files.push_back(option);
+        }
+
+        if (generate) {
+            if (files.size() != 1) {
+                printUsage();
+                return 1;
+            }
+            const std::size_t sales = generateFleet(files[0], machines, days, perDay, faults);
+            std::cout << sales << " Verkäufe von " << machines << " Automaten über " << days << " Tage in "
+                      << files[0] << " geschrieben.\n";
+            return 0;
+        }
+
+        if (output.empty() || files.empty()) {
+            printUsage();
+            return 1;
+        }
+        std::uintmax_t inputBytes = 0;
+        for (const auto& file : files) {
+            inputBytes += std::filesystem::file_size(file);
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        const MergeReport report = JournalMerger::mergeToFile(files, output, config);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        printReport(report, show);
+        std::cout << std::fixed << std::setprecision(1) << "Zeit: " << seconds << " s, "
+                  << static_cast<double>(report.recordsRead) / seconds / 1e6 << " Mio. Verkäufe/s, "
+                  << static_cast<double>(inputBytes) / seconds / (1 << 20) << " MiB/s\n"
+                  << "Zusammengeführt nach " << output << "\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,201 @@
+#include "../Sales/SalesStore.hpp"
+#include "../Sales/SalesQuery.hpp"
+#include "../Sales/SalesJournal.hpp"
+#include "../Sales/JournalMerger.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Fills a store with a synthetic year of sales for load tests.
+ * Lines and stops follow a skewed distribution, as in the real network.
+ */
+SalesStore generateSales(std::size_t rows, std::size_t machineCount, std::size_t lineCount, std::size_t stopsPerLine,
+                         std::uint16_t firstDay, std::uint16_t days) {
+    SalesStore store;
+    store.reserve(rows);
+    for (std::size_t m = 0; m < machineCount; ++m) store.machines.intern("automat-" + std::to_string(m + 1));
+    for (std::size_t l = 0; l < lineCount; ++l) store.lines.intern("Linie " + std::to_string(l + 1));
+    for (std::size_t s = 0; s < lineCount * stopsPerLine; ++s) store.stops.intern("Haltestelle " + std::to_string(s + 1));
+
+    std::mt19937_64 random(7);
+    std::vector<std::uint32_t> serials(machineCount, 0);
+    const int coins[] = {17, 11, 7, 5, 3, 2, 1};
+    for (std::size_t i = 0; i < rows; ++i) {
+        SaleRow row;
+        row.machine = static_cast<std::uint16_t>(random() % machineCount);
+        row.serial = ++serials[row.machine];
+        row.day = static_cast<std::uint16_t>(firstDay + i * days / rows);
+        row.secondOfDay = static_cast<std::uint32_t>(5 * 3600 + random() % (19 * 3600));
+        // Squaring a uniform number favours the first lines
+        const double skew = static_cast<double>(random() % 1000) / 1000.0;
+        row.line = static_cast<std::uint32_t>(skew * skew * lineCount);
+        const auto startIndex = static_cast<std::uint32_t>(random() % stopsPerLine);
+        const auto destinationIndex = static_cast<std::uint32_t>(random() % stopsPerLine);
+        row.start = static_cast<std::uint32_t>(row.line * stopsPerLine + startIndex);
+        row.destination = static_cast<std::uint32_t>(row.line * stopsPerLine + destinationIndex);
+        row.price = static_cast<std::int32_t>(3 * (startIndex > destinationIndex ? startIndex - destinationIndex
+                                                                               : destinationIndex - startIndex));
+        std::map<int, int> change;
+        if (random() % 3 == 0) {
+            change[coins[random() % 7]] = 1 + static_cast<int>(random() % 2);
+        }
+        store.appendRow(row, change);
+    }
+    return store;
+}
+
+template <typename F>
+double measureMs(F&& work) {
+    const auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+void printUsage() {
+    std::cout << "Aufruf:\n"
+              << "  query_sales import <journal>... -o <datei>   (auch zusammengeführte Journale)\n"
+              << "  query_sales generate <datei> [--rows 10000000] [--machines 8] [--lines 20] [--stops 30]\n"
+              << "  query_sales revenue|od|change <datei>... [--from JJJJ-MM-TT] [--to JJJJ-MM-TT]\n"
+              << "                                 [--line NAME] [--top 20] [--threads N]\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    const std::string command = argv[1];
+    std::vector<std::string> files;
+    std::string output;
+    std::string lineName;
+    std::string from;
+    std::string to;
+    std::size_t rows = 10000000;
+    std::size_t machines = 8;
+    std::size_t lines = 20;
+    std::size_t stops = 30;
+    std::size_t top = 20;
+    unsigned threads = 0;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            const std::string option = argv[i];
+            const std::string value = i + 1 < argc ? argv[i + 1] : "";
+            if (option == "-o") { output = value; i++; }
+            else if (option == "--from") { from = value; i++; }
+            else if (option == "--to") { to = value; i++; }
+            else if (option == "--line") { lineName = value; i++; }
+            else if (option == "--rows") { rows = std::stoul(value); i++; }
+            else if (option == "--machines") { machines = std::stoul(value); i++; }
+            else if (option == "--lines") { lines = std::stoul(value); i++; }
+            else if (option == "--stops") { stops = std::stoul(value); i++; }
+            else if (option == "--top") { top = std::stoul(value); i++; }
+            else if (option == "--threads") { threads = static_cast<unsigned>(std::stoul(value)); i++; }
+            else if (option[0] == '-') { printUsage(); return 1; }
+            else files.push_back(option);
+        }
+
+        std::cout << std::fixed << std::setprecision(1);
+
+        if (command == "import") {
+            if (output.empty() || files.empty()) {
+                printUsage();
+                return 1;
+            }
+            SalesStore store;
+            for (const auto& file : files) {
+                // Journals of one machine and merged journals (merge_journals) alike
+                JournalReader reader(file, 1 << 20);
+                TicketData ticket;
+                std::string machine;
+                while (reader.next(ticket, machine)) {
+                    store.append(ticket, machine);
+                }
+            }
+            store.save(output);
+            std::cout << store.size() << " Verkäufe nach " << output << " geschrieben.\n";
+            return 0;
+        }
+
+        if (command == "generate") {
+            const std::uint16_t firstDay = TicketCode::dayFromDate("2025-01-01");
+            SalesStore store;
+            const double ms = measureMs([&]() { store = generateSales(rows, machines, lines, stops, firstDay, 365); });
+            store.save(files.at(0));
+            std::cout << rows << " Verkäufe (" << machines << " Automaten, 365 Tage) in " << ms << " ms erzeugt.\n";
+            return 0;
+        }
+
+        QueryFilter filter;
+        if (!from.empty()) filter.fromDay = TicketCode::dayFromDate(from);
+        if (!to.empty()) filter.toDay = TicketCode::dayFromDate(to);
+        if (filter.fromDay > filter.toDay) {
+            std::cerr << "Fehler: --from " << from << " liegt nach --to " << to << std::endl;
+            printUsage();
+            return 1;
+        }
+
+        // Load and merge the stores of all machines
+        SalesStore store;
+        const double loadMs = measureMs([&]() {
+            for (const auto& file : files) {
+                if (store.size() == 0) {
+                    store = SalesStore::load(file);
+                } else {
+                    store.merge(SalesStore::load(file));
+                }
+            }
+        });
+
+        if (!lineName.empty()) {
+            filter.filterLine = true;
+            if (!store.lines.find(lineName, filter.line)) {
+                std::cout << "Linie nicht gefunden: " << lineName << '\n';
+                return 1;
+            }
+        }
+
+        double queryMs = 0.0;
+        if (command == "revenue") {
+            std::vector<LineDayRevenue> result;
+            queryMs = measureMs([&]() { result = SalesQuery::revenuePerLinePerDay(store, filter, threads); });
+            std::cout << std::setw(24) << std::left << "Linie" << std::right << std::setw(12) << "Datum"
+                      << std::setw(10) << "Tickets" << std::setw(12) << "Umsatz\n";
+            for (std::size_t i = 0; i < result.size() && i < top; ++i) {
+                std::cout << std::setw(24) << std::left << store.lines.at(result[i].line) << std::right
+                          << std::setw(12) << TicketCode::dateFromDay(result[i].day) << std::setw(10) << result[i].tickets
+                          << std::setw(11) << result[i].revenue << '\n';
+            }
+            std::cout << "(" << result.size() << " Gruppen)\n";
+        } else if (command == "od") {
+            std::vector<OriginDestination> result;
+            queryMs = measureMs([&]() { result = SalesQuery::originDestination(store, filter, threads); });
+            for (std::size_t i = 0; i < result.size() && i < top; ++i) {
+                std::cout << std::setw(10) << result[i].tickets << "  " << store.stops.at(result[i].start) << " -> "
+                          << store.stops.at(result[i].destination) << "  (" << result[i].revenue << " Geld)\n";
+            }
+            std::cout << "(" << result.size() << " Relationen)\n";
+        } else if (command == "change") {
+            std::vector<ChangeTotal> result;
+            queryMs = measureMs([&]() { result = SalesQuery::changeTotals(store, filter, threads); });
+            for (const auto& total : result) {
+                std::cout << std::setw(6) << total.denomination << " Geld: " << total.coins << " Stück\n";
+            }
+        } else {
+            printUsage();
+            return 1;
+        }
+
+        std::cout << store.size() << " Verkäufe aus " << files.size() << " Datei(en): laden " << loadMs
+                  << " ms, Abfrage " << queryMs << " ms\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,170 @@
+#include "../Benchmark/KeyReplay.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+void printUsage() {
+    std::cout << "Aufruf:\n"
+              << "  replay_keys <skript> [--binary ./ticketautomat] [--workdir DIR] [--capture DATEI]\n"
+              << "              [--max-latency MS] [--max-bytes N] [--frame-timeout MS] [-- ARGUMENTE...]\n"
+              << "  replay_keys --record <skript> [--binary ./ticketautomat] [--workdir DIR] [-- ARGUMENTE...]\n"
+              << "Skriptbefehle: up [n], down [n], enter, esc, backspace, type TEXT, sleep MS, expect TEXT\n";
+}
+
+double percentile(std::vector<double> values, double share) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    std::sort(values.begin(), values.end());
+    const auto index = static_cast<std::size_t>(share * static_cast<double>(values.size() - 1) + 0.5);
+    return values[std::min(index, values.size() - 1)];
+}
+
+/**
+ * @brief Prints latency and bytes per key and checks the limits.
+ * @return True if no key exceeded a limit.
+ */
+bool report(const std::vector<StepResult>& results, double maxLatencyMs, std::size_t maxBytes) {
+    // Per key type: how many presses, worst latency, most bytes
+    struct Summary {
+        std::size_t count = 0;
+        double worstMs = 0.0;
+        std::size_t maxBytes = 0;
+        std::size_t totalBytes = 0;
+    };
+    std::map<std::string, Summary> byKey;
+    std::vector<double> latencies;
+    std::size_t totalBytes = 0;
+    std::size_t unframed = 0;
+    bool ok = true;
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& result = results[i];
+        latencies.push_back(result.latencyMs);
+        totalBytes += result.bytes;
+        if (!result.framed) {
+            unframed++;
+        }
+        const std::string key = result.label.rfind("type ", 0) == 0 ? "type" : result.label;
+        auto& summary = byKey[key];
+        summary.count++;
+        summary.worstMs = std::max(summary.worstMs, result.latencyMs);
+        summary.maxBytes = std::max(summary.maxBytes, result.bytes);
+        summary.totalBytes += result.bytes;
+
+        const bool slow = maxLatencyMs > 0 && result.latencyMs > maxLatencyMs;
+        const bool large = maxBytes > 0 && result.bytes > maxBytes;
+        if (slow || large) {
+            ok = false;
+            std::cout << "Grenze überschritten: Taste " << (i + 1) << " (" << result.label << "): "
+                      << result.latencyMs << " ms, " << result.bytes << " Bytes\n";
+        }
+    }
+
+    std::cout << "\nTaste        Anzahl   max. ms   Bytes/Taste   max. Bytes\n";
+    for (const auto& [key, summary] : byKey) {
+        std::cout << std::left << std::setw(12) << key << std::right << std::setw(7) << summary.count
+                  << std::setw(10) << summary.worstMs << std::setw(14)
+                  << static_cast<double>(summary.totalBytes) / static_cast<double>(summary.count)
+                  << std::setw(13) << summary.maxBytes << "\n";
+    }
+    std::cout << "\nTasten: " << results.size() << ", Latenz Median " << percentile(latencies, 0.5)
+              << " ms, p95 " << percentile(latencies, 0.95) << " ms, max " << percentile(latencies, 1.0)
+              << " ms\nBytes: " << totalBytes << " gesamt, "
+              << (results.empty() ? 0.0 : static_cast<double>(totalBytes) / static_cast<double>(results.size()))
+              << " pro Taste\n";
+    if (unframed > 0) {
+        std::cout << "Warnung: " << unframed << " Taste(n) ohne Frame-Markierung, Latenz bis zum letzten Byte\n";
+    }
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::string scriptPath;
+    std::string binary = "./ticketautomat";
+    std::string workdir;
+    std::string capturePath;
+    std::vector<std::string> programArguments;
+    bool recordMode = false;
+    double maxLatencyMs = 0.0;
+    std::size_t maxBytes = 0;
+    ReplayConfig config;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::runtime_error("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--") {
+                programArguments.assign(argv + i + 1, argv + argc);
+                break;
+            } else if (arg == "--record") {
+                recordMode = true;
+            } else if (arg == "--binary") {
+                binary = value();
+            } else if (arg == "--workdir") {
+                workdir = value();
+            } else if (arg == "--capture") {
+                capturePath = value();
+            } else if (arg == "--max-latency") {
+                maxLatencyMs = std::stod(value());
+            } else if (arg == "--max-bytes") {
+                maxBytes = std::stoul(value());
+            } else if (arg == "--frame-timeout") {
+                config.frameTimeoutMs = std::stoi(value());
+            } else if (!arg.empty() && arg[0] != '-' && scriptPath.empty()) {
+                scriptPath = arg;
+            } else {
+                printUsage();
+                return 1;
+            }
+        }
+        if (scriptPath.empty()) {
+            printUsage();
+            return 1;
+        }
+
+        // The program runs in workdir, so a relative binary path has to be resolved first
+        if (binary.find('/') != std::string::npos) {
+            binary = std::filesystem::absolute(binary).string();
+        }
+        std::vector<std::string> command = {binary};
+        command.insert(command.end(), programArguments.begin(), programArguments.end());
+
+        std::ofstream capture;
+        if (!capturePath.empty()) {
+            capture.open(capturePath, std::ios::binary);
+            if (!capture.is_open()) throw std::runtime_error("Cannot write " + capturePath);
+        }
+        std::ostream* captureStream = capture.is_open() ? &capture : nullptr;
+
+        if (recordMode) {
+            std::ofstream script(scriptPath);
+            if (!script.is_open()) throw std::runtime_error("Cannot write " + scriptPath);
+            std::cerr << "Aufnahme läuft, Ende mit Strg+]\r\n";
+            PtySession session(command, workdir);
+            KeyReplay::record(session, STDIN_FILENO, script, captureStream);
+            session.terminate();
+            std::cerr << "\nSkript gespeichert: " << scriptPath << "\n";
+            return 0;
+        }
+
+        const auto steps = KeyScript::load(scriptPath);
+        PtySession session(command, workdir);
+        const auto results = KeyReplay::replay(session, steps, config, captureStream);
+        session.terminate();
+        return report(results, maxLatencyMs, maxBytes) ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << "\n";
+        return 2;
+    }
+}
@@ -0,0 +1,172 @@
+#include "../Sales/SalesIndex.hpp"
+#include "../Sales/SalesJournal.hpp"
+#include "../TicketMachine/TicketMachine.hpp"
+#include "../TicketCode/TicketCode.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+template <typename F>
+double measureMs(F&& work) {
+    const auto begin = std::chrono::steady_clock::now();
+    work();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @brief Writes a synthetic journal with consecutive serials spread evenly over some days.
+ * @param path Journal file.
+ * @param sales Number of sales.
+ * @param days Number of days, starting on 2025-01-01.
+ */
+void generateJournal(const std::string& path, std::size_t sales, std::size_t days) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    file << SalesJournal::HEADER_PREFIX << "automat-1\n";
+    const std::uint16_t firstDay = TicketCode::dayFromDate("2025-01-01");
+    std::mt19937_64 random(11);
+    for (std::size_t i = 0; i < sales; ++i) {
+        TicketData ticket;
+        ticket.serial = static_cast<std::uint32_t>(i + 1);
+        ticket.date = TicketCode::dateFromDay(static_cast<std::uint16_t>(firstDay + i * days / sales));
+        ticket.timestamp = 1735689600 + static_cast<std::int64_t>(i * days * 86400 / sales);
+        ticket.tram = "Linie " + std::to_string(1 + random() % 20);
+        ticket.startStop = "Haltestelle " + std::to_string(1 + random() % 30);
+        ticket.destinationStop = "Haltestelle " + std::to_string(1 + random() % 30);
+        ticket.price = static_cast<int>(random() % 60);
+        if (random() % 3 == 0) ticket.change[5] = 1;
+        ticket.code = "GEN-" + std::to_string(ticket.serial);
+        file << SalesJournal::formatRecord(ticket) << '\n';
+    }
+}
+
+void printUsage() {
+    std::cout << "Aufruf:\n"
+              << "  reprint_ticket serial <journal> <seriennummer> [-o <drucker>]\n"
+              << "  reprint_ticket dates <journal> <von JJJJ-MM-TT> [<bis JJJJ-MM-TT>]\n"
+              << "  reprint_ticket check|rebuild <journal>\n"
+              << "  reprint_ticket generate <journal> [--sales 1000000] [--days 180]\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    const std::string command = argv[1];
+    const std::string journal = argv[2];
+    std::vector<std::string> arguments;
+    std::string output;
+    std::size_t sales = 1000000;
+    std::size_t days = 180;
+
+    try {
+        for (int i = 3; i < argc; ++i) {
+            const std::string option = argv[i];
+            const std::string value = i + 1 < argc ? argv[i + 1] : "";
+            if (option == "-o") { output = value; i++; }
+            else if (option == "--sales") { sales = std::stoul(value); i++; }
+            else if (option == "--days") { days = std::stoul(value); i++; }
+            else if (option[0] == '-') { printUsage(); return 1; }
+            else arguments.push_back(option);
+        }
+
+        std::cout << std::fixed << std::setprecision(3);
+        SalesIndex index(journal);
+
+        if (command == "serial" && arguments.size() == 1) {
+            const auto serial = static_cast<std::uint32_t>(std::stoul(arguments[0]));
+            TicketData ticket;
+            bool found = false;
+            const double ms = measureMs([&]() { found = index.findSerial(serial, ticket); });
+            if (!found) {
+                std::cout << "Seriennummer " << serial << " nicht gefunden (" << ms << " ms)\n";
+                return 1;
+            }
+            ticket.reprint = true;
+            const std::string text = TicketMachine::renderTicket(ticket);
+            if (output.empty()) {
+                std::cout << text;
+            } else {
+                // Printer device or file, as for the kiosk (TICKETAUTOMAT_PRINTER)
+                std::ofstream printer(output, std::ios::binary | std::ios::app);
+                if (!(printer << text << std::flush)) {
+                    throw std::runtime_error("Could not write file: " + output);
+                }
+                std::cout << "Ticket " << serial << " an " << output << " gesendet.\n";
+            }
+            std::cout << "(gefunden in " << ms << " ms)\n";
+            return 0;
+        }
+
+        if (command == "dates" && (arguments.size() == 1 || arguments.size() == 2)) {
+            std::vector<TicketData> found;
+            const double ms = measureMs([&]() {
+                found = index.findDates(arguments[0], arguments.size() == 2 ? arguments[1] : arguments[0]);
+            });
+            for (const auto& ticket : found) {
+                std::cout << std::setw(10) << ticket.serial << "  " << ticket.date << "  " << ticket.tram << ": "
+                          << ticket.startStop << " -> " << ticket.destinationStop << "  (" << ticket.price
+                          << " Geld)\n";
+            }
+            std::cout << "(" << found.size() << " Verkäufe in " << ms << " ms)\n";
+            return 0;
+        }
+
+        if (command == "check" && arguments.empty()) {
+            const std::string problem = index.verify();
+            if (!problem.empty()) {
+                std::cout << "Index fehlerhaft: " << problem << "\nNeu aufbauen mit: reprint_ticket rebuild "
+                          << journal << '\n';
+                return 1;
+            }
+            std::cout << "Index in Ordnung.\n";
+            return 0;
+        }
+
+        if (command == "rebuild" && arguments.empty()) {
+            const double ms = measureMs([&]() { index.rebuild(); });
+            std::cout << "Index neu aufgebaut in " << ms << " ms.\n";
+            return 0;
+        }
+
+        if (command == "generate" && arguments.empty()) {
+            const double generateMs = measureMs([&]() { generateJournal(journal, sales, days); });
+            const double rebuildMs = measureMs([&]() { index.rebuild(); });
+
+            // Random serials through the index against one pass over the whole journal
+            std::mt19937_64 random(5);
+            const std::size_t lookups = 1000;
+            TicketData ticket;
+            const double lookupMs = measureMs([&]() {
+                for (std::size_t i = 0; i < lookups; ++i) {
+                    if (!index.findSerial(static_cast<std::uint32_t>(1 + random() % sales), ticket)) {
+                        throw std::runtime_error("Generated serial not found");
+                    }
+                }
+            });
+            std::size_t dayCount = 0;
+            const double dayMs = measureMs([&]() { dayCount = index.findDates("2025-02-01", "2025-02-01").size(); });
+            const double scanMs = measureMs([&]() { SalesJournal::read(journal, [](const TicketData&) {}); });
+
+            std::cout << sales << " Verkäufe über " << days << " Tage erzeugt in " << generateMs << " ms, Index in "
+                      << rebuildMs << " ms\n"
+                      << "Suche nach Seriennummer: " << lookupMs / static_cast<double>(lookups) << " ms\n"
+                      << "Ein Tag (" << dayCount << " Verkäufe): " << dayMs << " ms\n"
+                      << "Zum Vergleich ganzes Journal lesen: " << scanMs << " ms\n";
+            return 0;
+        }
+
+        printUsage();
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+}
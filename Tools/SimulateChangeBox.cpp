@@ -0,0 +1,128 @@
+#include "../Simulation/ChangeBoxSimulator.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+/**
+ * @brief Parses a comma separated list of integers, e.g. "10,20,50".
+ * @param text The list to parse.
+ * @return The parsed values.
+ */
+std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+/**
+ * @brief Parses a change box stock like "17=4,11=4,5=10".
+ * @param text The stock description.
+ * @return Map of denomination to initial count.
+ */
+std::map<int, int> parseStock(const std::string& text) {
+    std::map<int, int> stock;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        const auto separator = item.find('=');
+        if (separator == std::string::npos) {
+            throw std::invalid_argument("Invalid stock entry: " + item);
+        }
+        stock[std::stoi(item.substr(0, separator))] = std::stoi(item.substr(separator + 1));
+    }
+    return stock;
+}
+
+void printUsage() {
+    std::cout << "Aufruf: simulate_changebox [Optionen]\n"
+              << "  --days N          Anzahl simulierter Betriebstage (Standard 1000)\n"
+              << "  --customers X     Mittlere Kunden pro Tag (Standard 400)\n"
+              << "  --seed S          Startwert des Zufallsgenerators (Standard 1)\n"
+              << "  --stock 17=2,...  Anfangsbestand je Stückelung\n"
+              << "  --capacity 17=20,... Höchstbestand je Münze für eingeworfene Münzen\n"
+              << "  --no-recycling    Eingeworfenes Geld nur in die Kasse (wie früher)\n"
+              << "  --refill-days N   Betriebstage zwischen zwei Nachfüllungen (Standard 1)\n"
+              << "  --exact P         Anteil passend zahlender Kunden (Standard 0.2)\n"
+              << "  --roundup P       Anteil Kunden, die auf --step aufrunden (Standard 0.3)\n"
+              << "  --step N          Aufrundungsschritt (Standard 5)\n"
+              << "  --notes 10,20,50  Scheine der übrigen Kunden\n"
+              << "  --threads N       Anzahl Threads (Standard: alle Kerne)\n";
+}
+
+int main(int argc, char* argv[]) {
+    SimulationConfig config;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--help") {
+                printUsage();
+                return 0;
+            }
+            if (option == "--no-recycling") {
+                config.capacity.clear();
+                continue;
+            }
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            const std::string value = argv[++i];
+            if (option == "--days") config.days = std::stoi(value);
+            else if (option == "--customers") config.customersPerDay = std::stod(value);
+            else if (option == "--seed") config.seed = std::stoull(value);
+            else if (option == "--stock") config.initialStock = parseStock(value);
+            else if (option == "--capacity") config.capacity = parseStock(value);
+            else if (option == "--refill-days") config.daysBetweenRefills = std::stoi(value);
+            else if (option == "--exact") config.exactShare = std::stod(value);
+            else if (option == "--roundup") config.roundUpShare = std::stod(value);
+            else if (option == "--step") config.roundUpStep = std::stoi(value);
+            else if (option == "--notes") config.notes = parseList(value);
+            else if (option == "--threads") config.threads = static_cast<unsigned>(std::stoul(value));
+            else throw std::invalid_argument("Unknown option " + option);
+        }
+
+        ChangeBoxSimulator simulator(ChangeBoxSimulator::loadLines(), config);
+
+        const auto begin = std::chrono::steady_clock::now();
+        const SimulationReport report = simulator.run();
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin);
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "\n=== Wechselgeld-Simulation ===\n";
+        std::cout << "Tage:                    " << report.days;
+        if (config.daysBetweenRefills > 1) {
+            std::cout << " Nachfüllungen, alle " << config.daysBetweenRefills << " Betriebstage";
+        }
+        std::cout << '\n';
+        std::cout << "Recycling:               " << (config.capacity.empty() ? "aus" : "an") << '\n';
+        std::cout << "Verkäufe:                " << report.sales << '\n';
+        std::cout << "Wechselgeld fehlte:      " << report.failedPayouts << " Mal ("
+                  << (report.sales > 0 ? 100.0 * report.failedPayouts / report.sales : 0.0) << " % der Verkäufe)\n";
+        std::cout << "Tage mit Engpass:        " << report.daysWithStockout << " ("
+                  << (report.days > 0 ? 100.0 * report.daysWithStockout / report.days : 0.0) << " %)\n";
+        std::cout << "Engpass nach (Mittel):   " << report.meanMinutesUntilStockout << " min\n";
+        std::cout << "Nachfüllen nötig nach:   Median " << report.medianMinutesUntilRefill
+                  << " min, 10%-Quantil " << report.p10MinutesUntilRefill << " min\n";
+        std::cout << "Stücke pro Verkauf:      " << report.piecesPerSale << '\n';
+        std::cout << "Ausgezahlt je Stückelung:\n";
+        for (auto it = report.paidOut.rbegin(); it != report.paidOut.rend(); ++it) {
+            std::cout << "  " << std::setw(3) << it->first << " Geld: " << it->second << '\n';
+        }
+        std::cout << "In der Kasse je Stückelung:\n";
+        for (auto it = report.cashBox.rbegin(); it != report.cashBox.rend(); ++it) {
+            std::cout << "  " << std::setw(3) << it->first << " Geld: " << it->second << '\n';
+        }
+        std::cout << "Laufzeit:                " << elapsed.count() << " s\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "../Sync/DeltaSync.hpp"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+void printUsage() {
+    std::cout << "Aufruf: sync_lines <Staging-Ordner> <data-Ordner> [Optionen]\n"
+              << "  --block N       Blockgröße in Bytes (Standard 256)\n"
+              << "  --delete        Liniendateien löschen, die im Staging fehlen\n"
+              << "  --dry-run       Nur anzeigen, was sich ändern würde\n"
+              << "Geänderte Linien stehen zeilenweise auf stdout, die Statistik auf stderr.\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || std::string(argv[1]) == "--help") {
+        printUsage();
+        return argc < 3 ? 1 : 0;
+    }
+
+    SyncOptions options;
+    try {
+        for (int i = 3; i < argc; ++i) {
+            const std::string option = argv[i];
+            if (option == "--delete") options.removeMissing = true;
+            else if (option == "--dry-run") options.dryRun = true;
+            else if (option == "--block" && i + 1 < argc) {
+                options.blockSize = static_cast<std::uint32_t>(std::stoul(argv[++i]));
+            }
+            else throw std::invalid_argument("Unknown option " + option);
+        }
+
+        const auto begin = std::chrono::steady_clock::now();
+        const SyncResult result = DeltaSync::syncDirectory(argv[1], argv[2], options);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        // Only the names on stdout, so they can be passed on to a reload script
+        for (const auto& line : result.changedLines) {
+            std::cout << line << '\n';
+        }
+        const std::uint64_t shipped = result.manifestBytes + result.signatureBytes + result.deltaBytes;
+        std::cerr << std::fixed << std::setprecision(1)
+                  << result.filesChecked << " Dateien geprüft, " << result.changedLines.size()
+                  << " Linien geändert" << (options.dryRun ? " (Probelauf)" : "") << ", " << result.filesWritten
+                  << " geschrieben, " << result.filesRemoved << " gelöscht\n"
+                  << "Übertragen: " << shipped << " Bytes (Prüfsummen " << result.manifestBytes << ", Signaturen "
+                  << result.signatureBytes << ", Deltas " << result.deltaBytes << ", davon neue Daten "
+                  << result.literalBytes << ")\n"
+                  << "Kopieren aller Dateien: " << result.stagedBytes << " Bytes ("
+                  << (result.stagedBytes > 0 ? 100.0 * static_cast<double>(shipped) / result.stagedBytes : 0.0)
+                  << " %)\n"
+                  << "Dauer: " << ms << " ms\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "../TicketCode/TicketCode.hpp"
+#include "../TicketCode/BatchVerifier.hpp"
+#include "../TramParser/TramParser.hpp"
+#include "../TramParser/LineFileBuffer.hpp"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+/**
+ * @brief Writes random signed codes for load tests, a share of them with one symbol changed.
+ * @param path Output file, one code per line.
+ * @param count Number of codes.
+ * @param invalidShare Share of tampered codes.
+ * @param key Secret key.
+ * @return Number of tampered codes.
+ */
+std::size_t generateCodes(const std::string& path, std::size_t count, double invalidShare, const TicketKey& key) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not write file: " + path);
+    }
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::size_t tampered = 0;
+
+    for (std::size_t i = 0; i < count; ++i) {
+        TicketPayload payload;
+        payload.lineId = static_cast<std::uint16_t>(random());
+        payload.startIndex = static_cast<std::uint16_t>(random() % 40);
+        payload.destinationIndex = static_cast<std::uint16_t>(random() % 40);
+        payload.price = static_cast<std::uint16_t>(random() % 400);
+        payload.day = static_cast<std::uint16_t>(20000 + random() % 1000);
+        payload.serial = static_cast<std::uint32_t>(i + 1);
+        std::string code = TicketCode::encode(payload, key);
+        if (uniform(random) < invalidShare) {
+            // Swap one symbol for its neighbour in the alphabet
+            char& symbol = code[random() % code.size()];
+            if (symbol != '-') {
+                symbol = symbol == 'Z' ? '0' : (symbol == '9' ? 'A' : static_cast<char>(symbol + 1));
+                tampered++;
+            }
+        }
+        file << code << '\n';
+    }
+    return tampered;
+}
+
+/**
+ * @brief Prints the fields of a single code; resolves line and stop names from the data folder.
+ * @return 0 if the code is valid, otherwise 1.
+ */
+int showCode(const std::string& code, const TicketKey& key, const std::string& dataFolder) {
+    TicketPayload payload;
+    if (!TicketCode::verify(code, key, &payload)) {
+        std::cout << "UNGÜLTIG: " << code << '\n';
+        return 1;
+    }
+
+    std::string line = "unbekannt (Id " + std::to_string(payload.lineId) + ")";
+    std::string start = "#" + std::to_string(payload.startIndex);
+    std::string destination = "#" + std::to_string(payload.destinationIndex);
+    for (const auto& entry : TramParser::getAvailableLines(dataFolder)) {
+        if (TicketCode::lineId(entry.displayName) != payload.lineId) {
+            continue;
+        }
+        const TramData tram = TramParser::parseTramFile(dataFolder, entry.fileName);
+        line = tram.name;
+        if (payload.startIndex < tram.stops.size()) start = tram.stops[payload.startIndex];
+        if (payload.destinationIndex < tram.stops.size()) destination = tram.stops[payload.destinationIndex];
+        break;
+    }
+
+    std::cout << "GÜLTIG\n";
+    std::cout << "  Seriennummer: " << payload.serial << '\n';
+    std::cout << "  Datum:        " << TicketCode::dateFromDay(payload.day) << '\n';
+    std::cout << "  Linie:        " << line << '\n';
+    std::cout << "  Start:        " << start << '\n';
+    std::cout << "  Ziel:         " << destination << '\n';
+    std::cout << "  Preis:        " << payload.price << " Geld\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = "verify";
+    std::string keyPath = "state/ticket.key";
+    std::string dataFolder = "data";
+    std::string target;
+    std::size_t count = 1000000;
+    double invalidShare = 0.001;
+    unsigned threads = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string option = argv[i];
+        const std::string value = i + 1 < argc ? argv[i + 1] : "";
+        if (option == "--key") {
+            keyPath = value;
+            i++;
+        } else if (option == "--threads") {
+            threads = static_cast<unsigned>(std::stoul(value));
+            i++;
+        } else if (option == "--data") {
+            dataFolder = value;
+            i++;
+        } else if (option == "--show") {
+            mode = "show";
+            target = value;
+            i++;
+        } else if (option == "--generate") {
+            mode = "generate";
+            target = value;
+            i++;
+        } else if (option == "--count") {
+            count = std::stoul(value);
+            i++;
+        } else if (option == "--invalid") {
+            invalidShare = std::stod(value);
+            i++;
+        } else if (option[0] != '-' && target.empty()) {
+            target = option;
+        } else {
+            target.clear();
+            break;
+        }
+    }
+
+    if (target.empty()) {
+        std::cout << "Aufruf:\n"
+                  << "  verify_tickets <datei> [--threads N] [--key state/ticket.key]\n"
+                  << "  verify_tickets --show <code> [--data data] [--key state/ticket.key]\n"
+                  << "  verify_tickets --generate <datei> [--count 1000000] [--invalid 0.001] [--key state/ticket.key]\n";
+        return 1;
+    }
+
+    try {
+        if (mode == "generate") {
+            const TicketKey key = TicketKey::loadOrCreate(keyPath);
+            const std::size_t tampered = generateCodes(target, count, invalidShare, key);
+            std::cout << count << " Codes nach " << target << " geschrieben, davon " << tampered << " manipuliert.\n";
+            return 0;
+        }
+
+        const TicketKey key = TicketKey::load(keyPath);
+        if (mode == "show") {
+            return showCode(target, key, dataFolder);
+        }
+
+        LineFileBuffer file(target);
+        const auto begin = std::chrono::steady_clock::now();
+        const BatchResult result = BatchVerifier::verifyText(file.view(), key, threads);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+
+        const double total = static_cast<double>(result.valid + result.invalid);
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Geprüft:  " << result.valid + result.invalid << " Codes in " << elapsed.count() * 1000 << " ms ("
+                  << total / elapsed.count() / 1e6 << " Mio. Codes/s)\n";
+        std::cout << "Gültig:   " << result.valid << '\n';
+        std::cout << "Ungültig: " << result.invalid << '\n';
+        for (const std::size_t line : result.invalidLines) {
+            std::cout << "  Zeile " << line << '\n';
+        }
+        if (result.invalid > result.invalidLines.size()) {
+            std::cout << "  ... und " << result.invalid - result.invalidLines.size() << " weitere\n";
+        }
+        return result.invalid == 0 ? 0 : 2;
+    } catch (const std::exception& e) {
+        std::cerr << "Fehler: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,110 @@
+#include "EmbeddedNetwork.hpp"
+#include <atomic>
+#include <filesystem>
+#include <string_view>
+
+// The tables are generated at build time; without them no network is embedded
+#if __has_include("EmbeddedNetworkData.hpp")
+#include "EmbeddedNetworkData.hpp"
+#else
+namespace EmbeddedNetworkData {
+constexpr char BLOB[] = "";
+constexpr EmbeddedLine* LINES = nullptr;
+constexpr std::size_t LINE_COUNT = 0;
+constexpr EmbeddedText* STOPS = nullptr;
+}
+#endif
+
+namespace {
+std::atomic<bool> forcedMode{false};
+
+std::string_view text(const EmbeddedText& position) {
+    return {EmbeddedNetworkData::BLOB + position.offset, position.length};
+}
+}
+
+/**
+ * @brief Checks whether this executable contains an embedded network.
+ * @return True if the build embedded at least one line.
+ */
+bool EmbeddedNetwork::available() {
+    return EmbeddedNetworkData::LINE_COUNT > 0;
+}
+
+/**
+ * @brief Returns the number of embedded lines.
+ */
+std::size_t EmbeddedNetwork::lineCount() {
+    return EmbeddedNetworkData::LINE_COUNT;
+}
+
+/**
+ * @brief Selects embedded mode for every folder, even if it exists on disk.
+ * Has no effect if no network is embedded.
+ * @param forced True to always serve the embedded lines.
+ */
+void EmbeddedNetwork::setForced(bool forced) {
+    forcedMode.store(forced);
+}
+
+bool EmbeddedNetwork::isForced() {
+    return forcedMode.load() && available();
+}
+
+/**
+ * @brief Decides whether line requests for a folder are served from the executable.
+ *
+ * This is the case in forced mode, or if the default data/ folder is missing, e.g.
+ * on a read-only kiosk image. In forced mode no filesystem access happens at all.
+ *
+ * @param folderPath The folder the caller wants to read lines from.
+ * @return True if the embedded lines should be used instead of the folder.
+ */
+bool EmbeddedNetwork::serves(const std::string& folderPath) {
+    if (!available()) {
+        return false;
+    }
+    if (forcedMode.load()) {
+        return true;
+    }
+    std::error_code error;
+    return folderPath == DEFAULT_FOLDER && !std::filesystem::exists(folderPath, error);
+}
+
+/**
+ * @brief Lists the embedded lines in the order of their file names.
+ * @return Display name and file name of every embedded line.
+ */
+std::vector<FileEntry> EmbeddedNetwork::lines() {
+    std::vector<FileEntry> entries;
+    entries.reserve(EmbeddedNetworkData::LINE_COUNT);
+    for (std::size_t i = 0; i < EmbeddedNetworkData::LINE_COUNT; ++i) {
+        const EmbeddedLine& line = EmbeddedNetworkData::LINES[i];
+        entries.push_back({std::string(text(line.name)), std::string(text(line.fileName))});
+    }
+    return entries;
+}
+
+/**
+ * @brief Copies an embedded line into a TramData object.
+ * @param fileName Base name of the original line file (without extension).
+ * @param data Target for name, price and stops.
+ * @return True if the line is embedded, false otherwise.
+ */
+bool EmbeddedNetwork::find(const std::string& fileName, TramData& data) {
+    for (std::size_t i = 0; i < EmbeddedNetworkData::LINE_COUNT; ++i) {
+        const EmbeddedLine& line = EmbeddedNetworkData::LINES[i];
+        if (text(line.fileName) != fileName) {
+            continue;
+        }
+        data.name = std::string(text(line.name));
+        data.pricePerStop = line.pricePerStop;
+        data.stops.clear();
+        data.stops.reserve(line.stopCount);
+        for (std::uint32_t stop = line.firstStop; stop < line.firstStop + line.stopCount; ++stop) {
+            data.stops.emplace_back(text(EmbeddedNetworkData::STOPS[stop]));
+        }
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "TramParser.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Position of a string in the embedded text blob
+struct EmbeddedText {
+    std::uint32_t offset;
+    std::uint32_t length;
+};
+
+struct EmbeddedLine {
+    EmbeddedText fileName;
+    EmbeddedText name;
+    int pricePerStop;
+    // Range in the stop table
+    std::uint32_t firstStop;
+    std::uint32_t stopCount;
+};
+
+// Line files compiled into the executable by embed_network (see CMakeLists.txt)
+class EmbeddedNetwork {
+public:
+    static constexpr const char* DEFAULT_FOLDER = "data";
+
+    static bool available();
+    static std::size_t lineCount();
+    static void setForced(bool forced);
+    static bool isForced();
+    static bool serves(const std::string& folderPath);
+    static std::vector<FileEntry> lines();
+    static bool find(const std::string& fileName, TramData& data);
+
+    // Checked by a static_assert in the generated tables
+    static constexpr bool isValid(std::size_t blobSize, const EmbeddedLine* lines, std::size_t lineCount,
+                                  const EmbeddedText* stops, std::size_t stopCount) {
+        for (std::size_t i = 0; i < stopCount; ++i) {
+            if (stops[i].length == 0 || stops[i].offset + stops[i].length > blobSize) {
+                return false;
+            }
+        }
+        for (std::size_t i = 0; i < lineCount; ++i) {
+            const EmbeddedLine& line = lines[i];
+            if (line.fileName.length == 0 || line.fileName.offset + line.fileName.length > blobSize ||
+                line.name.offset + line.name.length > blobSize || line.pricePerStop < 0 ||
+                line.stopCount < 2 || line.firstStop + line.stopCount > stopCount) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
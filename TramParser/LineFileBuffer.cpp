@@ -0,0 +1,430 @@
+#include "LineFileBuffer.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <tmmintrin.h>
+#define LINEFILE_HAVE_SSSE3_LOOKUP 1
+#endif
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace {
+constexpr std::size_t BLOCK = 16;
+// Smaller files are read in one block; mapping only pays off for large inputs.
+// Reading also avoids SIGBUS if a small file is truncated while being parsed.
+constexpr std::size_t MAP_THRESHOLD = 1 << 20;
+
+/**
+ * @brief Checks whether a 16-byte block at the given position contains only ASCII.
+ * @param ptr Start of the block, at least 16 readable bytes.
+ * @return True if no byte has its high bit set.
+ */
+inline bool isAsciiBlock(const char* ptr) {
+#if defined(__SSE2__)
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    return _mm_movemask_epi8(block) == 0;
+#elif defined(__ARM_NEON)
+    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(ptr));
+    return vmaxvq_u8(block) < 0x80;
+#else
+    unsigned char combined = 0;
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        combined |= static_cast<unsigned char>(ptr[i]);
+    }
+    return combined < 0x80;
+#endif
+}
+
+/**
+ * @brief Returns a bit mask of '\n' positions within a 16-byte block.
+ * @param ptr Start of the block, at least 16 readable bytes.
+ * @return Bit i is set if ptr[i] is a newline.
+ */
+inline unsigned newlineMask(const char* ptr) {
+#if defined(__SSE2__)
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n'))));
+#elif defined(__ARM_NEON)
+    const uint8x16_t block = vld1q_u8(reinterpret_cast<const uint8_t*>(ptr));
+    const uint8x16_t matches = vceqq_u8(block, vdupq_n_u8('\n'));
+    if (vmaxvq_u8(matches) == 0) {
+        return 0;
+    }
+    unsigned mask = 0;
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        mask |= static_cast<unsigned>(ptr[i] == '\n') << i;
+    }
+    return mask;
+#else
+    unsigned mask = 0;
+    for (std::size_t i = 0; i < BLOCK; ++i) {
+        mask |= static_cast<unsigned>(ptr[i] == '\n') << i;
+    }
+    return mask;
+#endif
+}
+
+inline bool isContinuation(unsigned char c) {
+    return (c & 0xC0) == 0x80;
+}
+
+/*
+ * Lookup tables of the vectorized UTF-8 check (Keiser & Lemire, "Validating UTF-8
+ * In Less Than One Instruction Per Byte"). Each error class gets one bit; a byte
+ * pair is invalid if the bit survives the AND of the three nibble lookups.
+ */
+constexpr uint8_t TOO_SHORT = 1 << 0;      // lead byte not followed by a continuation
+constexpr uint8_t TOO_LONG = 1 << 1;       // ASCII followed by a continuation
+constexpr uint8_t OVERLONG_3 = 1 << 2;
+constexpr uint8_t TOO_LARGE = 1 << 3;
+constexpr uint8_t SURROGATE = 1 << 4;
+constexpr uint8_t OVERLONG_2 = 1 << 5;
+constexpr uint8_t TOO_LARGE_1000 = 1 << 6;
+constexpr uint8_t OVERLONG_4 = 1 << 6;
+constexpr uint8_t TWO_CONTS = 1 << 7;      // continuation after continuation (checked below)
+constexpr uint8_t CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+alignas(16) constexpr uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4
+};
+alignas(16) constexpr uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000
+};
+alignas(16) constexpr uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT
+};
+
+#if defined(LINEFILE_HAVE_SSSE3_LOOKUP)
+/**
+ * @brief Checks one 16-byte block against the error tables (SSSE3).
+ * @param input The current block.
+ * @param previous The previous block; replaced by the current one.
+ * @param error Accumulated error bits.
+ */
+__attribute__((target("ssse3")))
+inline void checkBlockSsse3(__m128i input, __m128i& previous, __m128i& error) {
+    const __m128i lowNibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+    const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+    const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+
+    const __m128i byte1High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_HIGH)),
+                                               _mm_and_si128(_mm_srli_epi16(prev1, 4), lowNibble));
+    const __m128i byte1Low = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_1_LOW)),
+                                              _mm_and_si128(prev1, lowNibble));
+    const __m128i byte2High = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(BYTE_2_HIGH)),
+                                               _mm_and_si128(_mm_srli_epi16(input, 4), lowNibble));
+    const __m128i special = _mm_and_si128(_mm_and_si128(byte1High, byte1Low), byte2High);
+
+    // Third and fourth bytes of a sequence must be continuations; the high bit marks them
+    const __m128i thirdByte = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+    const __m128i fourthByte = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+    const __m128i mustBeContinuation = _mm_and_si128(_mm_or_si128(thirdByte, fourthByte),
+                                                     _mm_set1_epi8(static_cast<char>(0x80)));
+
+    error = _mm_or_si128(error, _mm_xor_si128(mustBeContinuation, special));
+    previous = input;
+}
+
+/**
+ * @brief Vectorized UTF-8 check using SSSE3 byte shuffles.
+ * @param text The text to validate.
+ * @return True if the text is valid UTF-8. Does not locate the error.
+ */
+__attribute__((target("ssse3")))
+bool validateUtf8Lookup(std::string_view text) {
+    __m128i previous = _mm_setzero_si128();
+    __m128i error = _mm_setzero_si128();
+
+    std::size_t i = 0;
+    for (; i + BLOCK <= text.size(); i += BLOCK) {
+        checkBlockSsse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + i)), previous, error);
+    }
+    // Zero padding acts like ASCII, so a truncated sequence at the end is reported as too short
+    alignas(16) char tail[BLOCK] = {};
+    std::copy(text.data() + i, text.data() + text.size(), tail);
+    checkBlockSsse3(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)), previous, error);
+    checkBlockSsse3(_mm_setzero_si128(), previous, error);
+
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+}
+
+bool hasLookupValidator() {
+    static const bool supported = __builtin_cpu_supports("ssse3");
+    return supported;
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/**
+ * @brief Vectorized UTF-8 check using NEON table lookups.
+ * @param text The text to validate.
+ * @return True if the text is valid UTF-8. Does not locate the error.
+ */
+bool validateUtf8Lookup(std::string_view text) {
+    const uint8x16_t byte1High = vld1q_u8(BYTE_1_HIGH);
+    const uint8x16_t byte1Low = vld1q_u8(BYTE_1_LOW);
+    const uint8x16_t byte2High = vld1q_u8(BYTE_2_HIGH);
+    const uint8x16_t lowNibble = vdupq_n_u8(0x0F);
+
+    uint8x16_t previous = vdupq_n_u8(0);
+    uint8x16_t error = vdupq_n_u8(0);
+
+    auto check = [&](uint8x16_t input) {
+        const uint8x16_t prev1 = vextq_u8(previous, input, 15);
+        const uint8x16_t prev2 = vextq_u8(previous, input, 14);
+        const uint8x16_t prev3 = vextq_u8(previous, input, 13);
+
+        const uint8x16_t special = vandq_u8(
+            vandq_u8(vqtbl1q_u8(byte1High, vshrq_n_u8(prev1, 4)), vqtbl1q_u8(byte1Low, vandq_u8(prev1, lowNibble))),
+            vqtbl1q_u8(byte2High, vshrq_n_u8(input, 4)));
+
+        const uint8x16_t thirdByte = vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80));
+        const uint8x16_t fourthByte = vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80));
+        const uint8x16_t mustBeContinuation = vandq_u8(vorrq_u8(thirdByte, fourthByte), vdupq_n_u8(0x80));
+
+        error = vorrq_u8(error, veorq_u8(mustBeContinuation, special));
+        previous = input;
+    };
+
+    std::size_t i = 0;
+    for (; i + BLOCK <= text.size(); i += BLOCK) {
+        check(vld1q_u8(reinterpret_cast<const uint8_t*>(text.data() + i)));
+    }
+    alignas(16) uint8_t tail[BLOCK] = {};
+    std::copy(text.data() + i, text.data() + text.size(), tail);
+    check(vld1q_u8(tail));
+    check(vdupq_n_u8(0));
+
+    return vmaxvq_u8(error) == 0;
+}
+
+bool hasLookupValidator() {
+    return true;
+}
+#else
+bool validateUtf8Lookup(std::string_view) {
+    return false;
+}
+
+bool hasLookupValidator() {
+    return false;
+}
+#endif
+}
+
+/**
+ * @brief Opens a file and maps it into memory.
+ *
+ * Small files and files that cannot be mapped are read into a heap buffer
+ * with a single large read instead.
+ *
+ * @param path Path of the file.
+ * @throws std::runtime_error If the file cannot be opened or read.
+ */
+LineFileBuffer::LineFileBuffer(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + path);
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Could not open file: " + path);
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    if (size == 0) {
+        close(fd);
+        return;
+    }
+
+    void* address = size >= MAP_THRESHOLD ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+    if (address != MAP_FAILED) {
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(address);
+        mapped = true;
+        close(fd);
+        return;
+    }
+
+    // Read the whole file in one go
+    char* buffer = new char[size];
+    std::size_t done = 0;
+    while (done < size) {
+        const ssize_t n = read(fd, buffer + done, size - done);
+        if (n <= 0) {
+            break;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    close(fd);
+    data = buffer;
+    size = done;
+}
+
+/**
+ * @brief Unmaps or frees the file contents.
+ */
+LineFileBuffer::~LineFileBuffer() {
+    if (mapped) {
+        munmap(const_cast<char*>(data), size);
+    } else {
+        delete[] data;
+    }
+}
+
+/**
+ * @brief Returns the file contents.
+ * @return View over the whole file; valid as long as this object lives.
+ */
+std::string_view LineFileBuffer::view() const {
+    return {data, size};
+}
+
+/**
+ * @brief Finds the next '\n' at or after the given position.
+ * @param text The text to search.
+ * @param from Start position.
+ * @return Position of the newline, or text.size() if there is none.
+ */
+std::size_t TextScanner::findNewline(std::string_view text, std::size_t from) {
+    const char* ptr = text.data();
+    std::size_t i = from;
+
+    // Check 16 bytes per step and jump straight to the first match
+    for (; i + BLOCK <= text.size(); i += BLOCK) {
+        const unsigned mask = newlineMask(ptr + i);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+    }
+    for (; i < text.size(); ++i) {
+        if (ptr[i] == '\n') {
+            return i;
+        }
+    }
+    return text.size();
+}
+
+/**
+ * @brief Counts the newlines in the given text.
+ * @param text The text to scan.
+ * @return Number of '\n' characters.
+ */
+std::size_t TextScanner::countNewlines(std::string_view text) {
+    const char* ptr = text.data();
+    std::size_t count = 0;
+    std::size_t i = 0;
+
+    for (; i + BLOCK <= text.size(); i += BLOCK) {
+        count += static_cast<std::size_t>(__builtin_popcount(newlineMask(ptr + i)));
+    }
+    for (; i < text.size(); ++i) {
+        count += ptr[i] == '\n';
+    }
+    return count;
+}
+
+/**
+ * @brief Validates that the text is well-formed UTF-8.
+ *
+ * Uses the vectorized lookup check where the CPU supports it, which handles text
+ * with many umlauts as fast as plain ASCII. Only if that check fails is the text
+ * decoded sequence by sequence to locate the error. Overlong encodings,
+ * surrogates and code points above U+10FFFF are rejected.
+ *
+ * @param text The text to validate.
+ * @param errorOffset Receives the byte offset of the first invalid sequence.
+ * @return True if the whole text is valid UTF-8.
+ */
+bool TextScanner::validateUtf8(std::string_view text, std::size_t& errorOffset) {
+    if (hasLookupValidator() && validateUtf8Lookup(text)) {
+        return true;
+    }
+
+    // Scalar decoder: pure ASCII runs are still skipped 16 bytes at a time
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const std::size_t size = text.size();
+    std::size_t i = 0;
+
+    while (i < size) {
+        // Fast path: skip pure ASCII blocks
+        if (i + BLOCK <= size && isAsciiBlock(text.data() + i)) {
+            i += BLOCK;
+            continue;
+        }
+
+        const unsigned char lead = bytes[i];
+        if (lead < 0x80) {
+            i++;
+            continue;
+        }
+
+        std::size_t length;
+        if (lead >= 0xC2 && lead <= 0xDF) {
+            length = 2;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3;
+        } else if (lead >= 0xF0 && lead <= 0xF4) {
+            length = 4;
+        } else {
+            errorOffset = i;
+            return false;
+        }
+
+        if (i + length > size) {
+            errorOffset = i;
+            return false;
+        }
+        for (std::size_t k = 1; k < length; ++k) {
+            if (!isContinuation(bytes[i + k])) {
+                errorOffset = i;
+                return false;
+            }
+        }
+
+        const unsigned char second = bytes[i + 1];
+        const bool overlong = (lead == 0xE0 && second < 0xA0) || (lead == 0xF0 && second < 0x90);
+        const bool surrogate = lead == 0xED && second > 0x9F;
+        const bool tooLarge = lead == 0xF4 && second > 0x8F;
+        if (overlong || surrogate || tooLarge) {
+            errorOffset = i;
+            return false;
+        }
+        i += length;
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole line file, memory-mapped where possible
+class LineFileBuffer {
+public:
+    explicit LineFileBuffer(const std::string& path);
+    ~LineFileBuffer();
+    LineFileBuffer(const LineFileBuffer&) = delete;
+    LineFileBuffer& operator=(const LineFileBuffer&) = delete;
+
+    [[nodiscard]] std::string_view view() const;
+
+private:
+    const char* data = nullptr;
+    std::size_t size = 0;
+    bool mapped = false;
+};
+
+// Bulk scanning helpers, vectorized with SSE2 or NEON where available
+class TextScanner {
+public:
+    static std::size_t findNewline(std::string_view text, std::size_t from);
+    static std::size_t countNewlines(std::string_view text);
+    static bool validateUtf8(std::string_view text, std::size_t& errorOffset);
+};
@@ -1,8 +1,27 @@
 #include "TramParser.hpp"
+#include "LineFileBuffer.hpp"
+#include "EmbeddedNetwork.hpp"
+#include "../Logging/Logger.hpp"
+#include <charconv>
 #include <fstream>
 #include <stdexcept>
 #include <filesystem>
-#include <iostream>
+
+namespace {
+// Skips a UTF-8 byte order mark written by some editors
+void stripByteOrderMark(std::string_view& text) {
+    if (text.substr(0, 3) == "\xEF\xBB\xBF") {
+        text.remove_prefix(3);
+    }
+}
+
+// Removes the "\r" of a "\r\n" line ending
+void stripCarriageReturn(std::string_view& line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+}
+}
 
 /**
  * @brief Main entry point for parsing a tram configuration file.
@@ -15,17 +34,118 @@
  * @throws std::runtime_error If the file cannot be opened.
  */
 TramData TramParser::parseTramFile(const std::string& filename) {
+    return parseTramFile("data", filename);
+}
+
+/**
+ * @brief Parses a tram configuration file from the given directory.
+ *
+ * The file is read as one block (memory-mapped for large files) and handed to
+ * parseTramBuffer().
+ * Served from the embedded network instead if EmbeddedNetwork::serves() the folder.
+ *
+ * @param folderPath The directory containing the line files.
+ * @param filename The name of the file (without extension).
+ * @return A populated TramData object containing the tram's name, stops, and price info.
+ * @throws std::runtime_error If the file cannot be opened or the line is not embedded.
+ * @throws ParseError If the file content is malformed.
+ */
+TramData TramParser::parseTramFile(const std::string& folderPath, const std::string& filename) {
     validateFilename(filename);
-    std::string path = createFilePath(filename);
-    std::ifstream file(path);
+    if (EmbeddedNetwork::serves(folderPath)) {
+        TramData data;
+        if (!EmbeddedNetwork::find(filename, data)) {
+            throw std::runtime_error("Line not found in embedded network: " + filename);
+        }
+        return data;
+    }
+    std::string path = createFilePath(folderPath, filename);
+    LineFileBuffer file(path);
 
-    if (!file.is_open()) {
-        throw std::runtime_error("Could not open file: " + path);
+    TramData data = parseTramBuffer(file.view(), path);
+
+    Logger::info("Tram geladen: %s (%zu Haltestellen, %d Geld/Stop)",
+                 data.name.c_str(), data.stops.size(), data.pricePerStop);
+    return data;
+}
+
+/**
+ * @brief Parses the content of a line file held in memory.
+ *
+ * Format: first line is the line name, the next non-blank line the price per stop,
+ * every following non-empty line a stop. A UTF-8 byte order mark and "\r\n" line
+ * endings are accepted. Newlines are located and UTF-8 is validated in 16-byte
+ * blocks, so large files are scanned at memory speed.
+ *
+ * @param text The file content.
+ * @param sourceName Name used in error messages, usually the file path.
+ * @return The parsed tram data.
+ * @throws ParseError With file and line number if the content is malformed.
+ */
+TramData TramParser::parseTramBuffer(std::string_view text, const std::string& sourceName) {
+    stripByteOrderMark(text);
+
+    std::size_t errorOffset = 0;
+    if (!TextScanner::validateUtf8(text, errorOffset)) {
+        const std::size_t lineNumber = TextScanner::countNewlines(text.substr(0, errorOffset)) + 1;
+        const std::size_t lineStart = lineNumber == 1 ? 0 : text.rfind('\n', errorOffset) + 1;
+        throw ParseError(sourceName, lineNumber,
+                         "invalid UTF-8 sequence at byte " + std::to_string(errorOffset - lineStart + 1));
+    }
+
+    TramData data;
+    data.pricePerStop = 0;
+    // One counting pass is cheaper than regrowing the stop list for large files
+    data.stops.reserve(TextScanner::countNewlines(text));
+    bool hasName = false;
+    bool hasPrice = false;
+    std::size_t lineNumber = 0;
+    std::size_t pos = 0;
+
+    while (pos < text.size()) {
+        const std::size_t end = TextScanner::findNewline(text, pos);
+        std::string_view line = text.substr(pos, end - pos);
+        stripCarriageReturn(line);
+        lineNumber++;
+        pos = end + 1;
+
+        if (!hasName) {
+            // First line is the tram line name
+            data.name.assign(line);
+            hasName = true;
+        } else if (!hasPrice) {
+            // Blank lines before the price are tolerated, as before
+            if (line.find_first_not_of(" \t") == std::string_view::npos) {
+                continue;
+            }
+            data.pricePerStop = parsePrice(line, sourceName, lineNumber);
+            hasPrice = true;
+        } else if (!line.empty()) {
+            data.stops.emplace_back(line);
+        }
+    }
+
+    if (!hasName) {
+        throw ParseError(sourceName, 1, "missing tram line name");
     }
+    if (!hasPrice) {
+        throw ParseError(sourceName, lineNumber + 1, "missing price per stop");
+    }
+    return data;
+}
 
+/**
+ * @brief Parses a line file with the original stream-based reader.
+ *
+ * Kept as reference implementation for comparisons and benchmarks.
+ *
+ * @param stream Input stream positioned at the start of the file content.
+ * @return The parsed tram data.
+ * @throws std::runtime_error If reading critical data (name, price) fails.
+ */
+TramData TramParser::parseTramStream(std::istream& stream) {
     TramData data;
-    extractData(file, data);
-    file.close();
+    extractData(stream, data);
     return data;
 }
 
@@ -39,21 +159,42 @@ TramData TramParser::parseTramFile(const std::string& filename) {
  * @return The display name found in the file, or the filename as a fallback.
  */
 std::string TramParser::getDisplayNameFromFile(const std::string &filename) {
+    return getDisplayNameFromFile("data", filename);
+}
+
+/**
+ * @brief Retrieves the display name of a tram line from a file in the given directory.
+ *
+ * Byte order mark and "\r\n" line ending are removed as in parseTramBuffer(), so the
+ * name matches TramData::name.
+ *
+ * @param folderPath The directory containing the line files.
+ * @param filename The base name of the file to read.
+ * @return The display name found in the file, or the filename as a fallback.
+ */
+std::string TramParser::getDisplayNameFromFile(const std::string& folderPath, const std::string& filename) {
     validateFilename(filename);
-    std::string path = createFilePath(filename);
+    if (EmbeddedNetwork::serves(folderPath)) {
+        TramData data;
+        return EmbeddedNetwork::find(filename, data) ? data.name : filename;
+    }
+    std::string path = createFilePath(folderPath, filename);
 
     std::ifstream file(path);
     if (!file.is_open()) {
         return filename; // Fallback: return filename if file is not readable
     }
 
-    std::string displayName;
+    std::string firstLine;
     // Attempt to read the first line
-    if (!std::getline(file, displayName)) {
+    if (!std::getline(file, firstLine)) {
         return filename; // Fallback: return filename if file is empty
     }
 
-    return displayName;
+    std::string_view displayName = firstLine;
+    stripByteOrderMark(displayName);
+    stripCarriageReturn(displayName);
+    return std::string(displayName);
 }
 
 /**
@@ -66,19 +207,24 @@ std::string TramParser::getDisplayNameFromFile(const std::string &filename) {
  * @return A vector of FileEntry objects containing filenames and display names.
  */
 std::vector<FileEntry> TramParser::getAvailableLines(const std::string& folderPath) {
+    if (EmbeddedNetwork::serves(folderPath)) {
+        Logger::info("Verwende eingebettetes Netz (%zu Linien)", EmbeddedNetwork::lineCount());
+        return EmbeddedNetwork::lines();
+    }
+
     std::vector<FileEntry> entries;
 
-    std::cout << "Suche Tramlinien in: " << folderPath << std::endl;
+    Logger::info("Suche Tramlinien in: %s", folderPath.c_str());
 
     try {
         // Verify the directory exists and is valid
         if (!std::filesystem::exists(folderPath)) {
-            std::cerr << "Warnung: Verzeichnis existiert nicht: " << folderPath << std::endl;
+            Logger::warning("Verzeichnis existiert nicht: %s", folderPath.c_str());
             return entries;
         }
 
         if (!std::filesystem::is_directory(folderPath)) {
-            std::cerr << "Warnung: Pfad ist kein Verzeichnis: " << folderPath << std::endl;
+            Logger::warning("Pfad ist kein Verzeichnis: %s", folderPath.c_str());
             return entries;
         }
 
@@ -87,35 +233,35 @@ std::vector<FileEntry> TramParser::getAvailableLines(const std::string& folderPa
             // Filter for .txt files
             if (entry.path().extension() == ".txt") {
                 std::string baseName = entry.path().stem().string();
-                std::cout << "  Gefunden: " << baseName << std::endl;
+                Logger::debug("Gefunden: %s", baseName.c_str());
                 
                 // Add the file to the list with its display name
                 entries.push_back({
-                    getDisplayNameFromFile(baseName),
+                    getDisplayNameFromFile(folderPath, baseName),
                     baseName
                 });
             }
         }
 
-        std::cout << "Insgesamt " << entries.size() << " Linien gefunden." << std::endl;
+        Logger::info("Insgesamt %zu Linien gefunden.", entries.size());
 
     } catch (const std::exception& e) {
-        std::cerr << "Fehler beim Lesen des Verzeichnisses: " << e.what() << std::endl;
+        Logger::error("Fehler beim Lesen des Verzeichnisses %s: %s", folderPath.c_str(), e.what());
     }
 
     return entries;
 }
 
 /**
- * @brief Core extraction logic to parse a tram data file.
+ * @brief Core extraction logic of the stream-based parser.
  *
- * Reads the tram name, price per stop, and the list of stops from the file stream.
+ * Reads the tram name, price per stop, and the list of stops from the stream.
  *
- * @param file Open input file stream.
+ * @param file Open input stream.
  * @param data Target TramData struct to populate.
  * @throws std::runtime_error If reading critical data (name, price) fails.
  */
-void TramParser::extractData(std::ifstream& file, TramData& data) {
+void TramParser::extractData(std::istream& file, TramData& data) {
     // Read the tram line name (first line)
     if (!std::getline(file, data.name)) {
         throw std::runtime_error("Failed to read tram line name");
@@ -137,9 +283,47 @@ void TramParser::extractData(std::ifstream& file, TramData& data) {
             data.stops.push_back(stop);
         }
     }
+}
+
+/**
+ * @brief Parses the price line of a line file.
+ * @param line The line content without line ending.
+ * @param sourceName Name used in error messages.
+ * @param lineNumber Line number used in error messages.
+ * @return The price per stop.
+ * @throws ParseError If the line is not a non-negative integer.
+ */
+int TramParser::parsePrice(std::string_view line, const std::string& sourceName, std::size_t lineNumber) {
+    const std::size_t first = line.find_first_not_of(" \t");
+    const std::size_t last = line.find_last_not_of(" \t");
+    const std::string_view digits = line.substr(first, last - first + 1);
+
+    int price = 0;
+    const auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), price);
+    if (error != std::errc() || end != digits.data() + digits.size()) {
+        throw ParseError(sourceName, lineNumber, "price per stop is not a number: '" + std::string(digits) + "'");
+    }
+    if (price < 0) {
+        throw ParseError(sourceName, lineNumber, "price per stop must not be negative");
+    }
+    return price;
+}
+
+/**
+ * @brief Constructs a parse error with location information.
+ * @param source The file (or other source) that failed to parse.
+ * @param line The 1-based line number of the error.
+ * @param message Description of the problem.
+ */
+ParseError::ParseError(const std::string& source, std::size_t line, const std::string& message)
+    : std::runtime_error(source + ":" + std::to_string(line) + ": " + message), source(source), line(line) {}
 
-    std::cout << "Tram geladen: " << data.name << " (" << data.stops.size()
-              << " Haltestellen, " << data.pricePerStop << " Geld/Stop)" << std::endl;
+const std::string& ParseError::getSource() const {
+    return source;
+}
+
+std::size_t ParseError::getLine() const {
+    return line;
 }
 
 /**
@@ -148,7 +332,17 @@ void TramParser::extractData(std::ifstream& file, TramData& data) {
  * @return A string representing "data/filename.txt".
  */
 std::string TramParser::createFilePath(const std::string &filename) {
-    return "data/" + filename + ".txt";
+    return createFilePath("data", filename);
+}
+
+/**
+ * @brief Constructs the path for a configuration file in the given directory.
+ * @param folderPath The directory containing the line files.
+ * @param filename The base name of the file.
+ * @return A string representing "folderPath/filename.txt".
+ */
+std::string TramParser::createFilePath(const std::string& folderPath, const std::string& filename) {
+    return folderPath + "/" + filename + ".txt";
 }
 
 /**
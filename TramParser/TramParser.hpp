@@ -1,5 +1,9 @@
 #pragma once
+#include <cstddef>
+#include <iosfwd>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 struct TramData {
@@ -13,15 +17,33 @@ struct FileEntry {
     std::string fileName;
 };
 
+// Malformed line file; what() reads "file:line: message"
+class ParseError : public std::runtime_error {
+public:
+    ParseError(const std::string& source, std::size_t line, const std::string& message);
+    [[nodiscard]] const std::string& getSource() const;
+    [[nodiscard]] std::size_t getLine() const;
+
+private:
+    std::string source;
+    std::size_t line;
+};
+
 class TramParser {
 public:
     static TramData parseTramFile(const std::string& filename);
+    static TramData parseTramFile(const std::string& folderPath, const std::string& filename);
     static std::string getDisplayNameFromFile(const std::string& filename);
+    static std::string getDisplayNameFromFile(const std::string& folderPath, const std::string& filename);
     static std::vector<FileEntry> getAvailableLines(const std::string& folderPath);
+    static TramData parseTramBuffer(std::string_view text, const std::string& sourceName);
+    static TramData parseTramStream(std::istream& stream);
 
 private:
-    static void extractData(std::ifstream& file, TramData& data);
+    static void extractData(std::istream& file, TramData& data);
+    static int parsePrice(std::string_view line, const std::string& sourceName, std::size_t lineNumber);
     static std::string createFilePath(const std::string& filename);
+    static std::string createFilePath(const std::string& folderPath, const std::string& filename);
     static void validateFilename(const std::string& filename);
     static void validateDirectory(const std::string& folderPath);
     static void extractStops(std::ifstream& file, TramData& data);
@@ -1,29 +1,277 @@
 #include "TicketMachine/TicketMachine.hpp"
 #include "TUI/TUIMenu/TUIMenu.hpp"
+#include "Catalog/LineCatalog.hpp"
+#include "TicketCode/TicketCode.hpp"
+#include "Sales/SalesJournal.hpp"
+#include "QuickPick/QuickPickTable.hpp"
+#include "Capping/FareLedger.hpp"
+#include "Printing/PrintSpooler.hpp"
+#include "Logging/Logger.hpp"
+#include "TramParser/EmbeddedNetwork.hpp"
+#include "TUI/TerminalIO/TerminalIO.hpp"
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <string>
+#include <utility>
+#include <vector>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
 
-void runTicketMachineCycle() {
+// Long-lived parts of the machine, shared by all sales
+struct MachineServices {
+    std::shared_ptr<LineCatalog> catalog;
+    std::shared_ptr<TicketSigner> signer;
+    std::shared_ptr<QuickPickTable> quickPicks;
+    std::shared_ptr<FareLedger> fares;
+    std::shared_ptr<Payment> payment;
+    std::unique_ptr<SalesJournal> journal;
+    std::unique_ptr<PrintSpooler> spooler;
+};
+
+/**
+ * @brief Shows errors reported by the print thread since the last sale.
+ */
+void showPrinterErrors(PrintSpooler& spooler) {
+    const auto errors = spooler.takeErrors();
+    if (errors.empty()) {
+        return;
+    }
+    for (const auto& error : errors) {
+        std::cerr << error << '\n';
+    }
+    std::cout << "Beliebige Taste zum Fortfahren..." << std::endl;
+    TUIMenu::waitForKey(5000);
+}
+
+/**
+ * @brief Hands a rendered ticket to the print spooler.
+ * Waits while the spooler queue is full, so a paid ticket is never dropped.
+ */
+void queueTicket(PrintSpooler& spooler, const std::string& document) {
+    while (!spooler.submit(document, std::chrono::seconds(1))) {
+        std::cout << "Drucker ausgelastet, bitte warten..." << std::endl;
+        showPrinterErrors(spooler);
+    }
+}
+
+/**
+ * @brief Writes the paid tickets to the sales journal.
+ * A ticket that cannot be journaled is logged with its data and the others are still written.
+ */
+void journalTickets(SalesJournal& journal, const std::vector<TicketData>& tickets) {
+    for (const auto& ticket : tickets) {
+        try {
+            journal.append(ticket);
+        } catch (const std::exception& e) {
+            Logger::error("Verkauf nicht im Journal (Serial %u, %s, %s -> %s, %d Geld): %s", ticket.serial,
+                          ticket.tram.c_str(), ticket.startStop.c_str(), ticket.destinationStop.c_str(),
+                          ticket.price, e.what());
+        }
+    }
+}
+
+void runTicketMachineCycle(MachineServices& services) {
     try {
-        TicketMachine machine;
-        machine.selectTram();
-        machine.selectStartStop();
-        machine.selectDestinationStop();
+        showPrinterErrors(*services.spooler);
 
-        auto ticket = machine.buyTicket();
-        TicketMachine::printTicket(ticket);
+        TicketMachine machine(services.catalog, services.signer, services.quickPicks, services.fares,
+                              services.payment);
+        // Families and groups put several journeys into the cart and pay once
+        do {
+            machine.selectTram();
+            // A quick pick already chose start and destination
+            if (!machine.hasSelectedJourney()) {
+                machine.selectStartStop();
+                machine.selectDestinationStop();
+            }
+            machine.addToCart(machine.selectPassengerCount());
+        } while (machine.offerMoreTickets());
 
-        std::cout << "\nBeliebige Taste für neuen Kauf..." << std::endl;
-        TUIMenu::waitForKey();
+        const auto tickets = machine.checkoutCart();
+        // The tickets are paid: print first, a journal error must not cancel the sale.
+        // Printing runs in the background; all tickets of the purchase go out as one document
+        queueTicket(*services.spooler, TicketMachine::renderTickets(tickets));
+        journalTickets(*services.journal, tickets);
+
+        if (tickets.size() == 1) {
+            std::cout << "\nTicket wird gedruckt (Seriennummer " << tickets.front().serial << "). Gute Fahrt!" << std::endl;
+        } else {
+            std::cout << "\n" << tickets.size() << " Tickets werden gedruckt (Seriennummern " << tickets.front().serial
+                      << " bis " << tickets.back().serial << "). Gute Fahrt!" << std::endl;
+        }
+        TerminalIO::endFrame();
+        TUIMenu::waitForKey(2000);
+    } catch (const InputClosedException&) {
+        // No more keys will come (e.g. end of a replayed key script)
+        throw;
+    } catch (const ExitRequestedException&) {
+        throw;
     } catch (const std::exception& e) {
+        Logger::warning("Verkauf abgebrochen: %s", e.what());
         std::cerr << "\nFehler: " << e.what() << std::endl;
         std::cout << "Beliebige Taste zum Neustart..." << std::endl;
+        TerminalIO::endFrame();
         TUIMenu::waitForKey();
     }
 }
 
-int main() {
-    while (true) {
-        runTicketMachineCycle();
+/**
+ * @brief Starts the background logger writing to logs/.
+ * The level can be set with TICKETAUTOMAT_LOG_LEVEL (debug, info, warn, error, off).
+ */
+void startLogging() {
+    LogConfig config;
+    if (const char* level = std::getenv("TICKETAUTOMAT_LOG_LEVEL")) {
+        try {
+            config.minLevel = Logger::parseLevel(level);
+        } catch (const std::exception& e) {
+            std::cerr << "Warnung: " << e.what() << ", verwende info" << std::endl;
+        }
+    }
+    Logger::start(config);
+    Logger::info("Automat gestartet");
+}
+
+/**
+ * @brief Reads the fare caps from TICKETAUTOMAT_DAILY_CAP and TICKETAUTOMAT_WEEKLY_CAP.
+ * A cap of 0 switches it off; invalid values keep the default.
+ */
+CapConfig readFareCaps() {
+    CapConfig caps;
+    const std::pair<const char*, int*> settings[] = {{"TICKETAUTOMAT_DAILY_CAP", &caps.dailyCap},
+                                                     {"TICKETAUTOMAT_WEEKLY_CAP", &caps.weeklyCap}};
+    for (const auto& [name, cap] : settings) {
+        const char* value = std::getenv(name);
+        if (value == nullptr) {
+            continue;
+        }
+        try {
+            const int parsed = std::stoi(value);
+            if (parsed < 0) {
+                throw std::invalid_argument(value);
+            }
+            *cap = parsed;
+        } catch (const std::exception&) {
+            std::cerr << "Warnung: ungültiger Wert für " << name << ", verwende " << *cap << std::endl;
+        }
+    }
+    return caps;
+}
+
+/**
+ * @brief Prints the queued tickets and stops the logger; every way of ending the program goes through here.
+ * Runs only once, even if a signal arrives while the main thread is already shutting down.
+ * @param reason Log message naming why the machine stops.
+ */
+void shutdownMachine(MachineServices& services, const std::string& reason) {
+    static std::once_flag once;
+    std::call_once(once, [&services, &reason]() {
+        services.spooler->shutdown(std::chrono::seconds(5));
+        for (const auto& error : services.spooler->takeErrors()) {
+            std::cerr << error << '\n';
+        }
+        Logger::info("%s", reason.c_str());
+        Logger::stop();
+    });
+}
+
+/**
+ * @brief Handles SIGINT, SIGTERM and SIGHUP on a dedicated thread.
+ * Prints queued tickets before exiting and restores the terminal settings.
+ * The signals must be blocked in all other threads.
+ */
+void startShutdownHandler(MachineServices& services, sigset_t signals) {
+    static termios originalTerminal{};
+    const bool haveTerminal = tcgetattr(STDIN_FILENO, &originalTerminal) == 0;
+
+    std::thread([&services, signals, haveTerminal]() {
+        int signal = 0;
+        sigwait(&signals, &signal);
+        shutdownMachine(services, "Automat beendet (Signal " + std::to_string(signal) + ")");
+        if (haveTerminal) {
+            tcsetattr(STDIN_FILENO, TCSANOW, &originalTerminal);
+        }
+        std::cout << "\033[?25h" << std::flush; // Cursor on
+        std::_Exit(0);
+    }).detach();
+}
+
+int main(int argc, char* argv[]) {
+    // Block shutdown signals before any thread starts, so only the shutdown handler receives them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    // Diagnostics go to logs/ through a background thread, never onto the customer screen
+    startLogging();
+
+    // --embedded: use the lines compiled into the executable even if data/ exists
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--embedded") {
+            if (!EmbeddedNetwork::available()) {
+                std::cerr << "Warnung: Kein eingebettetes Netz vorhanden, lese data/" << std::endl;
+            }
+            EmbeddedNetwork::setForced(true);
+        }
+    }
+
+    MachineServices services;
+    // Lines are parsed once and re-parsed in the background when data/ changes
+    services.catalog = std::make_shared<LineCatalog>("data");
+    services.catalog->startWatching();
+    // Ticket key and serial counter live in state/ and never leave the machine
+    services.signer = std::make_shared<TicketSigner>("state");
+    // Frequent journeys of this machine, offered as one-press entries
+    services.quickPicks = std::make_shared<QuickPickTable>("state/quickpick.bin");
+    services.quickPicks->load();
+    // Day and week spending per rider card for the fare caps
+    services.fares = std::make_shared<FareLedger>("state/fares.ledger", readFareCaps());
+    try {
+        services.fares->open();
+    } catch (const std::exception& e) {
+        std::cerr << "Warnung: " << e.what() << ", Fahrpreisdeckel deaktiviert" << std::endl;
+        Logger::warning("Fahrpreisdeckel deaktiviert: %s", e.what());
+        services.fares = nullptr;
+    }
+    // Inserted coins are recycled as change, so the change box lives as long as the kiosk
+    services.payment = std::make_shared<Payment>();
+    // Every sale is appended to the journal, from which finance builds the column store
+    const char* machineId = std::getenv("TICKETAUTOMAT_MACHINE");
+    services.journal = std::make_unique<SalesJournal>("state/sales.journal",
+                                                      machineId != nullptr ? machineId : "automat-1");
+    // Serial and date index for finding and reprinting sales (reprint_ticket)
+    try {
+        if (services.journal->openIndex()) {
+            Logger::warning("Verkaufsindex fehlte oder war beschädigt und wurde neu aufgebaut");
+        }
+    } catch (const std::exception& e) {
+        Logger::warning("Verkaufsindex nicht verfügbar: %s", e.what());
+    }
+    // Printer device, e.g. /dev/usb/lp0; without one, tickets go to a file
+    const char* printer = std::getenv("TICKETAUTOMAT_PRINTER");
+    services.spooler = std::make_unique<PrintSpooler>(printer != nullptr ? printer : "state/printer.out");
+
+    startShutdownHandler(services, signals);
+
+    try {
+        while (true) {
+            runTicketMachineCycle(services);
+        }
+    } catch (const InputClosedException&) {
+        // Print what was sold before the input ended
+        shutdownMachine(services, "Eingabe beendet, Automat wird beendet");
+    } catch (const ExitRequestedException&) {
+        shutdownMachine(services, "Automat über Cancel beendet");
     }
     return 0;
-}
\ No newline at end of file
+}